@@ -1,4 +1,4 @@
-var gateway = `ws://${window.location.hostname}/ws`;
+var gateway = `ws://${window.location.host}/ws`;
 var websocket;
 // Init web socket when the page loads
 window.addEventListener('load', onload);
@@ -14,6 +14,7 @@ function getReadings(){
 function initWebSocket() {
     console.log('Trying to open a WebSocket connection…');
     websocket = new WebSocket(gateway);
+    websocket.binaryType = 'arraybuffer';
     websocket.onopen = onOpen;
     websocket.onclose = onClose;
     websocket.onmessage = onMessage;
@@ -30,9 +31,55 @@ function onClose(event) {
     setTimeout(initWebSocket, 2000);
 }
 
+function setText(id, text) {
+    document.getElementById(id).innerHTML = text;
+}
+
+function triple(view, offset, scale, digits) {
+    var values = [];
+    for (var i = 0; i < 3; i++) {
+        values.push((view.getInt16(offset + i * 2, true) / scale).toFixed(digits));
+    }
+    return values.join(' / ');
+}
+
+// Binary status frame, laid out as in include/telemetry.h
+function onStatus(view) {
+    var flags = view.getUint8(1);
+    setText('encoder', view.getInt32(8, true));
+    setText('gate', (flags & 1) ? 'ON' : 'OFF');
+    setText('button', (flags & 2) ? 'DOWN' : 'UP');
+    setText('ble', (flags & 4) ? 'CONNECTED' : 'WAITING');
+    setText('accel', triple(view, 12, 1000, 3));
+    setText('gyro', triple(view, 18, 10, 1));
+    setText('orientation', triple(view, 24, 100, 1));
+    setText('temperature', (view.getInt16(30, true) / 100).toFixed(1));
+    setText('latency', view.getUint16(32, true) + ' / ' + view.getUint16(34, true) + ' / ' + view.getUint16(36, true));
+    setText('hid', view.getUint16(38, true));
+}
+
+var KEY_ACTIONS = ['press', 'release', 'tap'];
+
+// Binary key event frame
+function onKey(view) {
+    var action = KEY_ACTIONS[view.getUint8(1)] || view.getUint8(1);
+    var key = view.getUint8(2);
+    var name = (key >= 0x20 && key < 0x7F) ? String.fromCharCode(key) : '0x' + key.toString(16);
+    setText('key', name + ' (' + action + ')');
+}
+
 // Function that receives the message from the ESP32 with the readings
 function onMessage(event) {
-    console.log(event.data);
+    if (event.data instanceof ArrayBuffer) {
+        var view = new DataView(event.data);
+        if (view.byteLength == 40 && view.getUint8(0) == 1) {
+            onStatus(view);
+        } else if (view.byteLength == 8 && view.getUint8(0) == 2) {
+            onKey(view);
+        }
+        return;
+    }
+
     var myObj = JSON.parse(event.data);
     var keys = Object.keys(myObj);
 
@@ -40,4 +87,4 @@ function onMessage(event) {
         var key = keys[i];
         document.getElementById(key).innerHTML = myObj[key];
     }
-}
\ No newline at end of file
+}
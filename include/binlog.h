@@ -0,0 +1,180 @@
+#ifndef __BINLOG_H__
+#define __BINLOG_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "spsc_ring.h"
+
+// Compile-time levels: call sites above BINLOG_LEVEL are dead code (still
+// type-checked, arguments never evaluated, no code emitted).
+// Override with e.g. -DBINLOG_LEVEL=BINLOG_LEVEL_WARN
+#define BINLOG_LEVEL_NONE   0
+#define BINLOG_LEVEL_ERROR  1
+#define BINLOG_LEVEL_WARN   2
+#define BINLOG_LEVEL_INFO   3
+#define BINLOG_LEVEL_DEBUG  4
+
+#ifndef BINLOG_LEVEL
+#define BINLOG_LEVEL        BINLOG_LEVEL_INFO
+#endif
+
+static constexpr uint8_t BINLOG_MAX_ARGS = 8;
+static constexpr size_t BINLOG_CAPACITY = 64;             // records buffered between producer and task
+static constexpr uint32_t BINLOG_STACK_SIZE = 3072;       // output task stack (bytes)
+static constexpr uint8_t BINLOG_FRAME_SYNC = 0xA5;        // first byte of every raw frame
+
+/**
+ * @brief Message ids, one per entry of binlog_messages.h.
+ */
+typedef enum binlog_msg {
+#define BINLOG_MESSAGE(name, format) BINLOG_MSG_##name,
+#include "binlog_messages.h"
+#undef BINLOG_MESSAGE
+    BINLOG_MSG_COUNT,
+} binlog_msg_t;
+
+/**
+ * @brief Output encoding used by the output task.
+ */
+typedef enum binlog_mode {
+    BINLOG_MODE_TEXT = 0,   ///< Format on the device (printf-compatible output)
+    BINLOG_MODE_RAW,        ///< Emit frames for tools/binlog_decode.py
+} binlog_mode_t;
+
+/**
+ * @brief One log call: id, micros() timestamp and raw 32-bit arguments.
+ *
+ * Raw frame on the wire (little endian):
+ * sync(0xA5) id argc timestamp[4] args[4 * argc] checksum, where checksum
+ * is the 8-bit sum of every byte between sync and checksum.
+ */
+typedef struct binlog_record {
+    uint32_t timestamp_us;
+    uint8_t id;
+    uint8_t argc;
+    uint32_t args[BINLOG_MAX_ARGS];
+} binlog_record_t;
+
+typedef struct binlog_stats {
+    uint32_t written;   ///< Records queued
+    uint32_t dropped;   ///< Records discarded because the ring was full
+    uint32_t emitted;   ///< Records formatted or framed by the output task
+} binlog_stats_t;
+
+typedef spsc_ring<binlog_record_t, BINLOG_CAPACITY> binlog_ring_t;
+
+/**
+ * @brief Queues a record. Never blocks; counts a drop when the ring is full.
+ *
+ * Single producer: call from one task (loop()) only, never from an ISR.
+ */
+void binlog_write_raw(binlog_msg_t id, const uint32_t* args, uint8_t argc);
+
+static inline uint32_t binlog_arg(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline uint32_t binlog_arg(double value) {
+    return binlog_arg(static_cast<float>(value));
+}
+
+template <typename T>
+static inline uint32_t binlog_arg(T value) {
+    return static_cast<uint32_t>(value);
+}
+
+/**
+ * @brief Packs up to BINLOG_MAX_ARGS integer/float arguments into a record.
+ */
+template <typename... Args>
+static inline void binlog_write(binlog_msg_t id, Args... args) {
+    static_assert(sizeof...(Args) <= BINLOG_MAX_ARGS, "too many binlog arguments");
+    const uint32_t packed[] = {0, binlog_arg(args)...};
+    binlog_write_raw(id, packed + 1, sizeof...(Args));
+}
+
+#if BINLOG_LEVEL >= BINLOG_LEVEL_ERROR
+#define BINLOG_ERROR(msg, ...) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__)
+#else
+#define BINLOG_ERROR(msg, ...) do { if (false) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__); } while (0)
+#endif
+
+#if BINLOG_LEVEL >= BINLOG_LEVEL_WARN
+#define BINLOG_WARN(msg, ...) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__)
+#else
+#define BINLOG_WARN(msg, ...) do { if (false) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__); } while (0)
+#endif
+
+#if BINLOG_LEVEL >= BINLOG_LEVEL_INFO
+#define BINLOG_INFO(msg, ...) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__)
+#else
+#define BINLOG_INFO(msg, ...) do { if (false) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__); } while (0)
+#endif
+
+#if BINLOG_LEVEL >= BINLOG_LEVEL_DEBUG
+#define BINLOG_DEBUG(msg, ...) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__)
+#else
+#define BINLOG_DEBUG(msg, ...) do { if (false) binlog_write(BINLOG_MSG_##msg, ##__VA_ARGS__); } while (0)
+#endif
+
+/**
+ * @brief Sets where and how records are emitted.
+ *
+ * @param out Output stream (usually Serial)
+ * @param mode Text or raw frames
+ */
+void binlog_init(Print* out, binlog_mode_t mode);
+
+/**
+ * @brief Switches between text and raw output at runtime.
+ */
+void binlog_set_mode(binlog_mode_t mode);
+
+/**
+ * @brief Starts the output task that drains the ring.
+ *
+ * @param core CPU core the task is pinned to
+ * @param priority FreeRTOS priority (keep it below the input path)
+ * @return true if the task is running; otherwise call binlog_service() yourself
+ */
+bool binlog_start(uint8_t core, uint8_t priority);
+
+/**
+ * @brief Emits up to `max_records` queued records.
+ *
+ * Called by the output task; may be called from loop() instead when no
+ * task is running. Blocks for as long as the output stream does.
+ *
+ * @return Number of records emitted
+ */
+size_t binlog_service(size_t max_records);
+
+/**
+ * @brief Snapshot of the logger counters.
+ */
+void binlog_get_stats(binlog_stats_t* stats);
+
+/**
+ * @brief Returns the printf-style format of a message id, or NULL.
+ */
+const char* binlog_format(uint8_t id);
+
+#if defined(PIO_UNIT_TESTING)
+/**
+ * @brief Formats `args` with `format` as the text output would.
+ *
+ * For the host tests (test/test_binlog), which need conversions no
+ * catalog message uses. Not built into the firmware.
+ *
+ * @return Length written, without the terminator
+ */
+size_t binlog_test_format(char* out, size_t size, const char* format, const uint32_t* args, uint8_t argc);
+#endif
+
+#endif  // __BINLOG_H__
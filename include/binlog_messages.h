@@ -0,0 +1,22 @@
+// Message catalog for the deferred binary logger.
+//
+// BINLOG_MESSAGE(name, format): ids are assigned in order, so append new
+// messages at the end. Arguments are 32-bit integers or floats only (no
+// %s) so a record can be formatted later, on the device or on the host by
+// tools/binlog_decode.py, which reads this file.
+//
+// No include guard: included once per expansion of BINLOG_MESSAGE.
+
+BINLOG_MESSAGE(KEY_ECHO, "%c")
+BINLOG_MESSAGE(KEY_DOWN, "%c DOWN\n")
+BINLOG_MESSAGE(KEY_UP, "%c UP\n")
+BINLOG_MESSAGE(GATE_ENABLED, "Keyboard gate ENABLED\n")
+BINLOG_MESSAGE(GATE_DISABLED, "Keyboard gate DISABLED\n")
+BINLOG_MESSAGE(STATUS_INPUT, "Enc:%ld | Btn:%d | KeyGate:%d | IMU:%lu ovr:%lu miss:%lu | ")
+BINLOG_MESSAGE(STATUS_TIMING, "RPY:%.1f/%.1f/%.1f | In late:%lu/%luus run:%luus | ")
+BINLOG_MESSAGE(STATUS_LINK_UP, "HID sent:%lu mrg:%lu drop:%lu | BLE:CONNECTED\n")
+BINLOG_MESSAGE(STATUS_LINK_DOWN, "HID sent:%lu mrg:%lu drop:%lu offline:%lu | BLE:OFFLINE\n")
+BINLOG_MESSAGE(DROPPED, "[binlog] %lu records dropped\n")
+BINLOG_MESSAGE(GESTURE, "Gesture:%u active:%d strength:%.1f\n")
+BINLOG_MESSAGE(STATUS_LINK_DIRECTED, "HID sent:%lu mrg:%lu drop:%lu offline:%lu | BLE:RECONNECTING host:%u\n")
+BINLOG_MESSAGE(BLE_RECONNECTED, "BLE host:%u back after %lums\n")
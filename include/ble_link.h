@@ -0,0 +1,180 @@
+#ifndef __BLE_LINK_H__
+#define __BLE_LINK_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "hid_transport.h"
+#include "spsc_ring.h"
+
+static constexpr uint8_t BLE_LINK_MAX_HOSTS = 4;
+static constexpr uint8_t BLE_LINK_NO_HOST = 0xFF;
+static constexpr uint8_t BLE_LINK_EVENTS = 8;                 ///< Link changes queued between services
+static constexpr uint32_t BLE_LINK_RECORD_MAGIC = 0x314B4C42; ///< "BLK1"
+
+typedef enum ble_link_state {
+    BLE_LINK_STOPPED = 0,
+    BLE_LINK_DIRECTED,          ///< High-duty directed advertising toward the target host
+    BLE_LINK_GENERAL,           ///< Any host may connect (pairing, or the target did not answer)
+    BLE_LINK_CONNECTED,
+} ble_link_state_t;
+
+typedef struct ble_link_config {
+    uint32_t directed_ms;       ///< Directed advertising before falling back to general
+} ble_link_config_t;
+
+typedef struct ble_link_host {
+    hid_transport_addr_t addr;
+    uint32_t used;              ///< Connection number it last connected with; 0 = empty slot
+} ble_link_host_t;
+
+/**
+ * @brief What survives a power cycle (the bonds themselves live in the stack).
+ */
+typedef struct ble_link_record {
+    uint32_t magic;             ///< BLE_LINK_RECORD_MAGIC
+    uint32_t seq;               ///< Connections so far, for `used`
+    uint8_t last;               ///< Slot of the last-connected host
+    ble_link_host_t hosts[BLE_LINK_MAX_HOSTS];
+} ble_link_record_t;
+
+/**
+ * @brief Persistence and wake-up, supplied by the application.
+ */
+typedef struct ble_link_hooks {
+    bool (*load)(void* ctx, ble_link_record_t* record);         ///< false if there is none
+    bool (*save)(void* ctx, const ble_link_record_t* record);
+    void (*notify)(void* ctx);      ///< A link change is queued: run ble_link_service() (any task)
+    void* ctx;
+} ble_link_hooks_t;
+
+typedef struct ble_link_event {
+    bool up;
+    hid_transport_addr_t peer;
+    uint32_t ms;
+} ble_link_event_t;
+
+typedef struct ble_link_stats {
+    ble_link_state_t state;
+    uint8_t peer;               ///< Slot connected, BLE_LINK_NO_HOST if none
+    uint8_t target;             ///< Slot directed advertising goes to, BLE_LINK_NO_HOST if none
+    uint8_t hosts;              ///< Stored hosts
+    uint32_t connects;          ///< Links up (encrypted)
+    uint32_t disconnects;
+    uint32_t directed;          ///< Directed bursts started
+    uint32_t directed_hits;     ///< Reconnects by the target during its burst
+    uint32_t fallbacks;         ///< Bursts that ran out and fell back to general advertising
+    uint32_t switches;          ///< ble_link_select() of another host
+    uint32_t boot_ms;           ///< ble_link_start() to the first link up; 0 until then
+    uint32_t reconnects;        ///< Drops followed by a link up
+    uint32_t last_reconnect_ms; ///< Drop to link up
+    uint32_t max_reconnect_ms;
+    uint32_t total_reconnect_ms;
+    uint32_t saves;
+    uint32_t save_errors;
+    uint32_t overruns;          ///< Link changes lost to a full queue
+} ble_link_stats_t;
+
+/**
+ * @brief Connection manager for the BLE keyboard: remembers its hosts
+ * and gets back to the last one fast.
+ *
+ * Every host that connects and encrypts the link (pairs, or re-encrypts
+ * with its bond) is stored in one of BLE_LINK_MAX_HOSTS slots, the least
+ * recently used one giving way (and losing its bond) when they are full;
+ * the slots and the last host are saved through the hooks whenever they
+ * change. After boot and after every drop the manager sends high-duty
+ * directed advertising to that host for `directed_ms`: only it can
+ * connect, and a host still scanning for the keyboard answers within a
+ * few milliseconds rather than waiting for its background scan to come
+ * across general advertising. If it does not, the manager falls back to
+ * general advertising, so any host, bonded or new, can connect.
+ *
+ * ble_link_select() moves to another stored host by dropping the current
+ * link and directing the burst at the new target; ble_link_pair() drops
+ * it and advertises to everyone, to add a host.
+ *
+ * The time from each drop (or from ble_link_start()) to the next link up
+ * is kept in the stats: the figure to track for reconnects.
+ *
+ * Link changes arrive in the stack's task and are queued; everything
+ * else, including the hooks' load and save, runs in ble_link_service()'s.
+ */
+typedef struct ble_link {
+    hid_transport_t* transport;
+    ble_link_config_t config;
+    ble_link_hooks_t hooks;
+    uint32_t (*now_ms)(void);       ///< Clock (millis() unless replaced)
+    ble_link_record_t record;
+    ble_link_state_t state;
+    uint8_t peer;
+    uint8_t target;
+    bool down_pending;              ///< Waiting for a link up to time
+    bool booting;                   ///< ... after ble_link_start()
+    uint32_t down_ms;
+    uint32_t burst_ms;              ///< Start of the directed burst
+    spsc_ring<ble_link_event_t, BLE_LINK_EVENTS> events;
+    ble_link_stats_t stats;
+} ble_link_t;
+
+/**
+ * @brief Fills `config` with defaults: one 1.28 s high-duty burst.
+ */
+void ble_link_default_config(ble_link_config_t* config);
+
+/**
+ * @brief Loads the stored hosts and takes over the transport's link callback.
+ *
+ * Call before hid_transport_begin() so no link change is missed.
+ *
+ * @param link Pointer to manager instance
+ * @param transport Stack to manage
+ * @param config Parameters (copied)
+ * @param hooks Application callbacks (copied)
+ */
+void ble_link_init(ble_link_t* link, hid_transport_t* transport, const ble_link_config_t* config,
+                   const ble_link_hooks_t* hooks);
+
+/**
+ * @brief Starts advertising: directed to the last host if there is one,
+ * general otherwise. Boot-to-reconnect is timed from here.
+ */
+void ble_link_start(ble_link_t* link);
+
+/**
+ * @brief Handles queued link changes and the end of a directed burst.
+ *
+ * @return Milliseconds until it must run again (UINT32_MAX: only after a notify)
+ */
+uint32_t ble_link_service(ble_link_t* link);
+
+/**
+ * @brief Switches to the host stored in `slot`.
+ *
+ * @return false if the slot is empty
+ */
+bool ble_link_select(ble_link_t* link, uint8_t slot);
+
+/**
+ * @brief Drops the link and advertises to any host, to pair a new one.
+ */
+void ble_link_pair(ble_link_t* link);
+
+/**
+ * @brief Removes the host in `slot` and deletes its bond; drops it if connected.
+ *
+ * @return false if the slot is empty
+ */
+bool ble_link_forget(ble_link_t* link, uint8_t slot);
+
+/**
+ * @brief The host stored in `slot`, NULL if empty.
+ */
+const ble_link_host_t* ble_link_host(const ble_link_t* link, uint8_t slot);
+
+/**
+ * @brief Copies the stats.
+ */
+void ble_link_get_stats(const ble_link_t* link, ble_link_stats_t* stats);
+
+#endif  // __BLE_LINK_H__
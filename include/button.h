@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <stdint.h>
 
+#include "input_event.h"
 #include "pin.h"
 
 /**
@@ -14,9 +15,12 @@ typedef struct button {
     void (*callback)(struct button* ctx);  // Function to call when button is pressed
     void* ctx;                    // User data passed to callback
     // ISR/debounce state (managed internally)
-    volatile bool event_pending;  // set in ISR, cleared in button_process
-    volatile uint8_t last_raw;    // raw level sampled in ISR
-    volatile uint32_t last_debounce_ms; // millis() timestamp used by process
+    input_event_queue_t events;   // edges queued by the ISR, drained in button_process
+    uint8_t raw_level;            // latest level seen in the edge stream
+    uint32_t raw_change_us;       // edge time at which raw_level was entered
+    uint32_t raw_change_stamp;    // latency stamp of that edge
+    uint32_t press_stamp;         // latency stamp of the edge behind the current press
+    uint32_t overruns_seen;       // queue overruns already resynchronised
     uint32_t debounce_ms;         // debounce interval (ms)
     bool stable_state;            // debounced stable state (true == pressed)
 } button_t;
@@ -29,6 +33,19 @@ typedef struct button {
  */
 void button_init(button_t* btn, pin_t pin);
 
+/**
+ * @brief Resets the debounce state without touching the pin or interrupts.
+ *
+ * Used by button_init() and to drive a detached button from recorded
+ * edges (see button_inject()).
+ *
+ * @param btn Pointer to button instance.
+ * @param pin Pin number the edges belong to.
+ * @param level Current pin level.
+ * @param now_us Time at which `level` was sampled.
+ */
+void button_reset(button_t* btn, pin_t pin, uint8_t level, uint32_t now_us);
+
 /**
  * @brief Assigns a callback function to the button.
  *
@@ -58,9 +75,74 @@ void attach_button_interrupt(button_t* btn, pin_t pin);
 /**
  * @brief Process pending button events and run debounced callbacks.
  *
+ * Edges are debounced against their ISR timestamps, not the time this is
+ * called, so a level held for at least `debounce_ms` between two edges is
+ * accepted even if the loop was late. If the edge queue overflowed the
+ * level is resynchronised from the pin.
+ *
  * This must be called from the main loop or a task (not from ISR).
  */
 void button_process(button_t* btn);
 
+/**
+ * @brief Like button_process(), with the current time supplied by the caller.
+ *
+ * Lets a replay drive the debounce logic from a virtual clock.
+ *
+ * @param btn Pointer to button instance.
+ * @param now_us Current time (micros()).
+ */
+void button_process_at(button_t* btn, uint32_t now_us);
+
+/**
+ * @brief Queues an edge as if the ISR had captured it.
+ *
+ * @param btn Pointer to button instance.
+ * @param event Edge to queue.
+ * @return true if queued, false if the queue was full.
+ */
+bool button_inject(button_t* btn, const input_event_t* event);
+
+/**
+ * @brief Returns the number of edges dropped because the queue was full.
+ *
+ * @param btn Pointer to button instance.
+ */
+uint32_t button_get_overruns(const button_t* btn);
+
+/**
+ * @brief Returns the latency stamp of the edge that started the current press.
+ *
+ * 0 if the button is released, the edge was lost, or tracing is compiled out.
+ *
+ * @param btn Pointer to button instance.
+ */
+uint32_t button_get_press_stamp(const button_t* btn);
+
+/**
+ * @brief Queues the edge the interrupt missed, if the pin moved.
+ *
+ * For a pin whose interrupt was disabled for a while (light sleep): if
+ * the pin no longer reads the level of the last drained edge, the ISR
+ * body runs once, so button_process() debounces the change as usual.
+ * Call it before the interrupt is re-enabled.
+ *
+ * @param btn Pointer to button instance.
+ * @return true if an edge was queued.
+ */
+bool button_resync(button_t* btn);
+
+#if defined(PIO_UNIT_TESTING)
+/**
+ * @brief Runs the edge ISR body once, as if the pin had changed.
+ *
+ * For the host benchmarks (test/test_bench); only call it on a button
+ * whose interrupt is not attached. Not built into the firmware.
+ *
+ * @param btn Pointer to button instance.
+ */
+void button_bench_isr(button_t* btn);
+#endif
+
 
 #endif  // __BUTTON_H__
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "ble_link.h"
+#include "hid_report.h"
+#include "hid_transport.h"
+#include "idle.h"
+#include "imu_duty.h"
+#include "key_matrix.h"
+#include "web_server.h"
+
+static constexpr size_t CONSOLE_LINE_SIZE = 32;     // longer lines are cut
+
+/**
+ * @brief Subsystems the console queries and configures.
+ */
+typedef struct console_targets {
+    hid_transport_t* ble;
+    ble_link_t* ble_link;
+    hid_composer_t* hid;
+    key_matrix_t* keys;
+    imu_duty_t* imu_duty;
+    idle_manager_t* idle;
+    web_server_t* web;
+} console_targets_t;
+
+/**
+ * @brief Commands the application carries out itself, all run from the console job.
+ */
+typedef struct console_hooks {
+    void (*trace_start)(void* ctx);     ///< "trace start"
+    void (*trace_stop)(void* ctx);      ///< "trace stop"
+    void (*trace_replay)(void* ctx);    ///< "trace replay"
+    void (*fs_format)(void* ctx);       ///< "fs format"
+    void* ctx;
+} console_hooks_t;
+
+/**
+ * @brief Line-based serial queries, e.g. "lat".
+ *
+ * Bytes are collected until CR or LF and the line is run as one command;
+ * replies go back to the same stream.
+ */
+typedef struct console {
+    Stream* io;
+    console_targets_t targets;
+    console_hooks_t hooks;
+    char line[CONSOLE_LINE_SIZE];
+    size_t length;
+} console_t;
+
+/**
+ * @brief Prepares a console.
+ *
+ * @param con Pointer to console instance
+ * @param io Stream commands are read from and replies written to
+ * @param targets Subsystems to query
+ * @param hooks Application commands
+ */
+void console_init(console_t* con, Stream* io, const console_targets_t* targets, const console_hooks_t* hooks);
+
+/**
+ * @brief Reads whatever is available and runs each complete line.
+ */
+void console_poll(console_t* con);
+
+/**
+ * @brief Runs one command line; empty lines are ignored.
+ */
+void console_execute(console_t* con, const char* line);
+
+#endif  // __CONSOLE_H__
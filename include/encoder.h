@@ -3,25 +3,75 @@
 
 #include <Arduino.h>
 #include <stdint.h>
+#include <atomic>
+#include "input_event.h"
 #include "pin.h"
 
+// Quadrature transitions per reported detent. Select with a build flag,
+// e.g. -DENCODER_STEP_MODE=ENCODER_FULL_STEP
+#define ENCODER_QUARTER_STEP    1   ///< Every transition counts (x4 decoding)
+#define ENCODER_HALF_STEP       2   ///< Two transitions per detent
+#define ENCODER_FULL_STEP       4   ///< One full quadrature cycle per detent
+
+#ifndef ENCODER_STEP_MODE
+#define ENCODER_STEP_MODE       ENCODER_QUARTER_STEP
+#endif
+
+// AB state the encoder rests in at a detent (0b11 for lines idling high on
+// pull-ups). In half-step mode its complement is a detent too. Half- and
+// full-step detents are reported on arriving there, which re-syncs the
+// decoder after a missed or bounced transition.
+#ifndef ENCODER_DETENT_STATE
+#define ENCODER_DETENT_STATE    0x3
+#endif
+
+static constexpr uint32_t ENCODER_VELOCITY_TIMEOUT_US = 250000;  // no detent for this long == stopped
+
+/**
+ * @brief Acceleration curve applied by encoder_take_accel_delta().
+ *
+ * Output gain is 1 up to `min_speed`, rises linearly to `max_gain` at
+ * `max_speed` and stays there. Speeds are in detents per second.
+ */
+typedef struct encoder_accel {
+    float min_speed;
+    float max_speed;
+    float max_gain;
+} encoder_accel_t;
+
 /**
  * @brief Simple rotary encoder abstraction with spin and button callbacks.
  * 
  * The encoder tracks quadrature input from two channels (A/B)
  * and a pushbutton input. Callbacks receive the encoder pointer so
  * users can easily access state or data from within their handlers.
+ * The ISRs only decode and queue timestamped edges; callbacks run from
+ * encoder_process(), never in interrupt context.
  */
 typedef struct encoder {
     pin_t pin_a;   ///< Channel A pin
     pin_t pin_b;   ///< Channel B pin
     pin_t pin_btn; ///< Button pin
 
-    volatile int32_t position;  ///< Accumulated position
+    std::atomic<int32_t> position; ///< Accumulated position (detents)
+    std::atomic<int32_t> pending;  ///< Detents not yet collected by encoder_take_delta
     volatile uint8_t last_state;///< Last AB state (00..11)
+    volatile int8_t substep;    ///< Transitions since the last detent state
+    input_event_queue_t events; ///< Edges queued by the ISRs, drained in encoder_process
+    uint8_t btn_level;          ///< Button level as of the last drained edge
+    uint32_t overruns_seen;     ///< Queue overruns already resynchronised
+
+    // Velocity tracking (written by the ISR on every detent)
+    volatile uint32_t last_detent_us;     ///< Timestamp of the latest detent
+    volatile uint32_t detent_interval_us; ///< Smoothed time between detents
+    volatile int8_t last_dir;             ///< Direction of the latest detent (+1/-1, 0 = none)
+    volatile uint32_t pending_stamp;      ///< Latency stamp of the first detent in `pending`
+
+    encoder_accel_t accel;      ///< Acceleration curve (max_gain <= 1 disables)
+    float accel_residual;       ///< Fractional output carried between takes
 
     void (*spin_cb)(struct encoder* enc, int32_t delta); ///< Called on rotation
-    void (*button_cb)(struct encoder* enc);              ///< Called on button press
+    void (*button_cb)(struct encoder* enc);              ///< Called when the button pin goes high
 } encoder_t;
 
 /**
@@ -34,11 +84,26 @@ typedef struct encoder {
  */
 void encoder_init(encoder_t* enc, pin_t pin_a, pin_t pin_b, pin_t pin_btn);
 
+/**
+ * @brief Resets the decoder state without touching the pins or interrupts.
+ * 
+ * Used by encoder_init() and to drive a detached encoder from recorded
+ * edges (see encoder_inject()).
+ * 
+ * @param enc Pointer to encoder instance
+ * @param pin_a Channel A pin
+ * @param pin_b Channel B pin
+ * @param pin_btn Button pin
+ * @param ab_state Current AB state (A << 1 | B)
+ * @param btn_level Current button pin level
+ */
+void encoder_reset(encoder_t* enc, pin_t pin_a, pin_t pin_b, pin_t pin_btn, uint8_t ab_state, uint8_t btn_level);
+
 /**
  * @brief Assigns a callback for spin events.
  * 
  * @param enc Pointer to encoder instance
- * @param cb  Function called when the encoder rotates (receives ±1 delta)
+ * @param cb  Function called when the encoder rotates (receives ±1 delta per detent)
  */
 void encoder_set_spin_callback(encoder_t* enc, void (*cb)(encoder_t* enc, int32_t delta));
 
@@ -67,10 +132,127 @@ int32_t encoder_get_position(const encoder_t* enc);
 void encoder_set_position(encoder_t* enc, int32_t pos);
 
 /**
- * @brief Attaches CHANGE interrupts to A/B pins and a RISING interrupt to the button pin.
+ * @brief Atomically returns and clears the detents counted since the last call.
+ * 
+ * Read-and-clear is a single atomic exchange, so detents that arrive while
+ * the caller is working are kept for the next call rather than lost.
+ * 
+ * @param enc Pointer to encoder instance
+ * @return Signed detent count
+ */
+int32_t encoder_take_delta(encoder_t* enc);
+
+/**
+ * @brief Returns the latency stamp of the oldest detent not yet taken.
+ * 
+ * Read it before encoder_take_delta() to attribute the resulting key
+ * change to the edge that caused it. 0 if tracing is compiled out.
+ * 
+ * @param enc Pointer to encoder instance
+ */
+uint32_t encoder_get_pending_stamp(const encoder_t* enc);
+
+/**
+ * @brief Like encoder_take_delta(), scaled by the acceleration curve.
+ * 
+ * The gain is chosen from the current velocity; fractional output is
+ * carried over so slow turns still produce exactly one step per detent.
+ * 
+ * @param enc Pointer to encoder instance
+ * @return Signed, speed-scaled step count
+ */
+int32_t encoder_take_accel_delta(encoder_t* enc);
+
+/**
+ * @brief Returns the estimated rotation speed.
+ * 
+ * Derived from the smoothed interval between detent timestamps; decays as
+ * time passes without a detent and reads 0 after ENCODER_VELOCITY_TIMEOUT_US.
+ * 
+ * @param enc Pointer to encoder instance
+ * @return Signed speed in detents per second
+ */
+float encoder_get_velocity(const encoder_t* enc);
+
+/**
+ * @brief Sets the acceleration curve used by encoder_take_accel_delta().
+ * 
+ * @param enc Pointer to encoder instance
+ * @param accel Curve to copy, or NULL for a flat 1:1 response
+ */
+void encoder_set_accel(encoder_t* enc, const encoder_accel_t* accel);
+
+/**
+ * @brief Drains queued edges and runs the spin/button callbacks.
+ * 
+ * Must be called from the main loop or a task (not from ISR).
+ * 
+ * @param enc Pointer to encoder instance
+ */
+void encoder_process(encoder_t* enc);
+
+/**
+ * @brief Queues a decoded edge as if the ISRs had captured it.
+ * 
+ * The edge's `delta` is applied to the position, pending and velocity
+ * state. Only for encoders whose interrupts are not attached.
+ * 
+ * @param enc Pointer to encoder instance
+ * @param event Edge to queue
+ * @return true if queued, false if the queue was full
+ */
+bool encoder_inject(encoder_t* enc, const input_event_t* event);
+
+/**
+ * @brief Returns whether the button is held (pin low), as of the last encoder_process().
+ * 
+ * Follows the queued edges; after a queue overrun it is re-read from the pin.
+ * 
+ * @param enc Pointer to encoder instance
+ */
+bool encoder_button_pressed(const encoder_t* enc);
+
+/**
+ * @brief Returns the number of edges dropped because the queue was full.
+ * 
+ * Position tracking is unaffected; only callbacks for those edges are lost.
+ * 
+ * @param enc Pointer to encoder instance
+ */
+uint32_t encoder_get_overruns(const encoder_t* enc);
+
+/**
+ * @brief Attaches CHANGE interrupts to the A/B and button pins.
  * 
  * @param enc Pointer to encoder instance
  */
 void attach_encoder_interrupts(encoder_t* enc);
 
+/**
+ * @brief Decodes the edges the interrupts missed, if the pins moved.
+ * 
+ * For pins whose interrupts were disabled for a while (light sleep): a
+ * changed A/B state runs the quadrature decoder from `last_state`, so a
+ * single transition still counts towards its detent, and a changed
+ * button level is queued as an edge. Two transitions in a row read as
+ * one jump of unknown direction and are dropped, as they would be in the
+ * ISR. Call it before the interrupts are re-enabled.
+ * 
+ * @param enc Pointer to encoder instance
+ * @return true if any edge was queued
+ */
+bool encoder_resync(encoder_t* enc);
+
+#if defined(PIO_UNIT_TESTING)
+/**
+ * @brief Runs the A/B edge ISR body once with the pins as they are.
+ * 
+ * For the host benchmarks (test/test_bench); only call it on an encoder
+ * whose interrupts are not attached. Not built into the firmware.
+ * 
+ * @param enc Pointer to encoder instance
+ */
+void encoder_bench_isr(encoder_t* enc);
+#endif
+
 #endif  // __ENCODER_H__
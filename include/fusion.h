@@ -0,0 +1,78 @@
+#ifndef __FUSION_H__
+#define __FUSION_H__
+
+#include <stdint.h>
+
+#include "imu.h"
+
+static constexpr float FUSION_DEFAULT_BETA = 0.1f;    // Madgwick gain (gyro drift vs accel noise)
+static constexpr float FUSION_MAX_DT_S = 0.1f;        // longer gaps are clamped, not integrated
+
+/**
+ * @brief Streaming orientation filter (Madgwick, 6-axis IMU variant).
+ *
+ * Consumes timestamped accel/gyro samples and keeps a unit quaternion
+ * rotating the sensor frame into the earth frame. Updates do no allocation
+ * and no trigonometry (two reciprocal square roots), so they fit a few
+ * microseconds on the ESP32 FPU; Euler angles are derived only on request.
+ */
+typedef struct fusion {
+    float q0, q1, q2, q3;  ///< Orientation quaternion (w, x, y, z)
+    float beta;            ///< Accelerometer correction gain
+    uint32_t last_us;      ///< Timestamp of the previous sample
+    bool has_time;         ///< last_us is valid
+    bool aligned;          ///< Quaternion seeded from gravity
+    uint32_t updates;      ///< Samples integrated
+} fusion_t;
+
+/**
+ * @brief Initializes the filter to the identity orientation.
+ *
+ * The first sample with valid accelerometer data seeds roll and pitch from
+ * gravity so the filter does not have to converge from identity.
+ *
+ * @param fusion Pointer to fusion instance
+ * @param beta Correction gain (FUSION_DEFAULT_BETA if unsure)
+ */
+void fusion_init(fusion_t* fusion, float beta);
+
+/**
+ * @brief Integrates one timestamped sample.
+ *
+ * The time step is taken from consecutive timestamp_us values and clamped
+ * to FUSION_MAX_DT_S. Samples without gyro data are ignored.
+ *
+ * @param fusion Pointer to fusion instance
+ * @param sample Sample from imu_read_sample(), imu_fifo_read() or imu_stream_pop()
+ * @return true if the sample was integrated
+ */
+bool fusion_update(fusion_t* fusion, const imu_sample_t* sample);
+
+/**
+ * @brief Integrates one sample with an explicit time step.
+ *
+ * @param fusion Pointer to fusion instance
+ * @param data Accel (g) and gyro (deg/s) readings; zero accel skips correction
+ * @param dt_s Time since the previous sample in seconds
+ */
+void fusion_update_dt(fusion_t* fusion, const imu_data_t* data, float dt_s);
+
+/**
+ * @brief Returns the current orientation quaternion.
+ *
+ * @param fusion Pointer to fusion instance
+ * @param q Array receiving w, x, y, z
+ */
+void fusion_get_quaternion(const fusion_t* fusion, float q[4]);
+
+/**
+ * @brief Returns the current orientation as Euler angles.
+ *
+ * @param fusion Pointer to fusion instance
+ * @param roll Rotation about X in degrees (may be NULL)
+ * @param pitch Rotation about Y in degrees (may be NULL)
+ * @param yaw Rotation about Z in degrees, relative to start (may be NULL)
+ */
+void fusion_get_euler(const fusion_t* fusion, float* roll, float* pitch, float* yaw);
+
+#endif  // __FUSION_H__
@@ -0,0 +1,135 @@
+#ifndef __GESTURE_H__
+#define __GESTURE_H__
+
+#include <stdint.h>
+
+#include "imu.h"
+
+static constexpr uint8_t GESTURE_WINDOW = 32;                 // samples per feature window (power of two)
+static constexpr uint8_t GESTURE_AXES = 3;
+static constexpr uint8_t GESTURE_MAX_CROSSINGS = 8;           // zero crossings remembered per axis
+
+/**
+ * @brief Gestures reported by gesture_update().
+ */
+typedef enum gesture_type {
+    GESTURE_NONE = 0,
+    GESTURE_FLICK_LEFT,     ///< Fast rotation about -Z that stops again
+    GESTURE_FLICK_RIGHT,    ///< Fast rotation about +Z
+    GESTURE_FLICK_UP,       ///< Fast rotation about -X
+    GESTURE_FLICK_DOWN,     ///< Fast rotation about +X
+    GESTURE_SHAKE,          ///< Sustained oscillation with high linear energy
+    GESTURE_TILT_LEFT,      ///< Held roll to the left (begin/end events)
+    GESTURE_TILT_RIGHT,
+    GESTURE_TILT_FORWARD,   ///< Held pitch forward (begin/end events)
+    GESTURE_TILT_BACK,
+    GESTURE_COUNT,
+} gesture_type_t;
+
+/**
+ * @brief Classifier thresholds; tune against recorded samples.
+ */
+typedef struct gesture_config {
+    float flick_peak_dps;       ///< Minimum peak angular rate of a flick
+    float flick_min_deg;        ///< Minimum rotation swept within the window
+    uint8_t flick_max_crossings;///< More zero crossings than this is a shake, not a flick
+    float shake_energy_g2;      ///< Minimum mean squared linear acceleration (g^2)
+    uint8_t shake_min_crossings;///< Minimum zero crossings on one gyro axis (<= GESTURE_MAX_CROSSINGS)
+    uint32_t crossing_window_us;///< Zero crossings older than this are forgotten
+    float tilt_enter_deg;       ///< Tilt begins beyond this angle...
+    float tilt_exit_deg;        ///< ...and ends below this one (hysteresis)
+    uint32_t tilt_hold_us;      ///< Angle must be held this long before a tilt begins
+    uint32_t refractory_us;     ///< Quiet time after a flick or shake
+} gesture_config_t;
+
+static constexpr gesture_config_t GESTURE_DEFAULT_CONFIG = {
+    400.0f,     // flick_peak_dps
+    35.0f,      // flick_min_deg
+    1,          // flick_max_crossings
+    0.35f,      // shake_energy_g2
+    4,          // shake_min_crossings
+    500000,     // crossing_window_us
+    25.0f,      // tilt_enter_deg
+    15.0f,      // tilt_exit_deg
+    150000,     // tilt_hold_us
+    300000,     // refractory_us
+};
+
+typedef struct gesture_event {
+    gesture_type_t type;
+    bool active;            ///< false only for the end of a tilt
+    float strength;         ///< Peak rate (flick, dps), energy (shake, g^2) or angle (tilt, deg)
+    uint32_t timestamp_us;  ///< Sample that triggered the event
+} gesture_event_t;
+
+/**
+ * @brief Streaming gesture recognizer.
+ *
+ * Every sample updates sliding-window features in O(1): running sums of
+ * linear-acceleration energy and per-axis swept angle over the last
+ * GESTURE_WINDOW samples, the latest zero crossings per axis (counted over
+ * a fixed time so the result does not depend on the sample rate), and a
+ * monotonic queue per axis for the peak angular rate. A small decision tree then looks for shakes,
+ * flicks and held tilts. No allocation and no trigonometry per sample.
+ */
+typedef struct gesture {
+    gesture_config_t config;
+
+    // Sliding window (ring indexed by the sample counter)
+    float energy[GESTURE_WINDOW];              ///< Linear acceleration squared per sample
+    float swept[GESTURE_AXES][GESTURE_WINDOW]; ///< Rotation per sample (deg)
+    float energy_sum;
+    float swept_sum[GESTURE_AXES];
+    uint32_t crossing_us[GESTURE_AXES][GESTURE_MAX_CROSSINGS]; ///< Times of the latest zero crossings
+    uint8_t crossing_head[GESTURE_AXES];       ///< Slot of the newest crossing
+    uint8_t crossing_len[GESTURE_AXES];
+    int8_t last_sign[GESTURE_AXES];
+    float last_rate[GESTURE_AXES];
+    uint8_t peak_queue[GESTURE_AXES][GESTURE_WINDOW]; ///< Sample numbers (mod 256), decreasing |rate|
+    float peak_rate[GESTURE_AXES][GESTURE_WINDOW];    ///< Signed rate of each slot
+    uint8_t peak_head[GESTURE_AXES];
+    uint8_t peak_len[GESTURE_AXES];
+    uint32_t count;                            ///< Samples seen
+
+    // Gravity estimate and tilt state
+    float gravity[GESTURE_AXES];
+    bool gravity_valid;
+    float tilt_enter_sin;
+    float tilt_exit_sin;
+    gesture_type_t tilt;                       ///< Active tilt, GESTURE_NONE if level
+    gesture_type_t tilt_candidate;
+    uint32_t tilt_since_us;
+
+    uint32_t last_us;
+    bool has_time;
+    uint32_t quiet_until_us;                   ///< End of the refractory period
+    bool quiet;
+} gesture_t;
+
+/**
+ * @brief Initializes the recognizer.
+ *
+ * @param g Pointer to gesture instance
+ * @param config Thresholds to copy, or NULL for GESTURE_DEFAULT_CONFIG
+ */
+void gesture_init(gesture_t* g, const gesture_config_t* config);
+
+/**
+ * @brief Feeds one sample; reports at most one gesture per sample.
+ *
+ * Samples without valid accel or gyro data are ignored. The sample
+ * timestamps set the integration step, so any rate from 100 to 400 Hz works.
+ *
+ * @param g Pointer to gesture instance
+ * @param sample Timestamped IMU sample
+ * @param event Filled in when the function returns true
+ * @return true if a gesture began or ended with this sample
+ */
+bool gesture_update(gesture_t* g, const imu_sample_t* sample, gesture_event_t* event);
+
+/**
+ * @brief Short name of a gesture for logs.
+ */
+const char* gesture_name(gesture_type_t type);
+
+#endif  // __GESTURE_H__
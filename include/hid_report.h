@@ -0,0 +1,168 @@
+#ifndef __HID_REPORT_H__
+#define __HID_REPORT_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "latency.h"
+
+static constexpr uint8_t HID_REPORT_MAX_KEYS = 6;            // boot keyboard 6-key rollover
+static constexpr uint8_t HID_REPORT_QUEUE_CAPACITY = 16;     // composed reports awaiting transmit
+static constexpr uint32_t HID_COMPOSER_DEFAULT_WINDOW_US = 7500;  // shortest BLE connection interval
+
+/**
+ * @brief Keyboard input report (same layout as BleKeyboard's KeyReport).
+ */
+typedef struct hid_key_report {
+    uint8_t modifiers;
+    uint8_t reserved;
+    uint8_t keys[HID_REPORT_MAX_KEYS];
+} hid_key_report_t;
+
+/**
+ * @brief What to do with a new report when the transmit queue is full.
+ */
+typedef enum hid_backpressure {
+    HID_BACKPRESSURE_MERGE = 0, ///< Fold it into the newest queued report
+    HID_BACKPRESSURE_DROP,      ///< Discard it; the final state is resent once the queue drains
+    HID_BACKPRESSURE_REPEAT,    ///< Keep it pending and retry on the next poll
+} hid_backpressure_t;
+
+/**
+ * @brief What the sink did with a report.
+ */
+typedef enum hid_send_result {
+    HID_SEND_OK = 0,        ///< Handed to the host
+    HID_SEND_BUSY,          ///< Congested: kept queued and retried on the next poll
+    HID_SEND_DISCARDED,     ///< No host to send it to: dequeued without being sent
+} hid_send_result_t;
+
+typedef struct hid_composer_stats {
+    uint32_t changes;       ///< Key press/release requests
+    uint32_t composed;      ///< Reports queued
+    uint32_t sent;          ///< Reports the sink handed to the host
+    uint32_t discarded;     ///< Reports the sink discarded (offline)
+    uint32_t merged;        ///< Changes/reports coalesced into another report
+    uint32_t dropped;       ///< Reports discarded under backpressure
+    uint32_t congested;     ///< Polls that stopped because the sink refused a report
+} hid_composer_stats_t;
+
+/**
+ * @brief Coalescing keyboard report composer with a bounded transmit queue.
+ *
+ * Key changes update a 6KRO state. The first change after an idle window is
+ * queued immediately; further changes within the same window (one BLE
+ * connection interval) are merged into a single report. Queued reports are
+ * handed to the sink from hid_composer_poll(), never from the caller of
+ * press/release, and a sink that refuses a report stalls only the queue.
+ *
+ * ASCII codes and the KEY_* constants of BleKeyboard are accepted
+ * (>= 0x80 modifiers, >= 0x88 raw usage codes), so this is a drop-in for
+ * BleKeyboard::press()/release()/write().
+ */
+typedef struct hid_composer {
+    hid_key_report_t state;      ///< Current composed key state
+    uint8_t held_modifiers;      ///< Modifiers pressed explicitly (KEY_LEFT_CTRL etc.)
+    uint8_t shifted_slots;       ///< Bit per key slot that was pressed as a shifted character
+    hid_key_report_t published;  ///< State of the newest queued report
+    bool dirty;                  ///< state != published
+    uint32_t window_us;          ///< Coalescing window
+    uint32_t last_queued_us;     ///< When the newest report was queued
+    uint8_t max_per_poll;        ///< Reports handed to the sink per poll
+
+    uint32_t origin_stamp;       ///< Latency stamp of the input behind the pending change (0 = none)
+    uint8_t origin_source;       ///< latency_source_t of origin_stamp
+
+    hid_key_report_t queue[HID_REPORT_QUEUE_CAPACITY];
+    uint32_t queue_origin[HID_REPORT_QUEUE_CAPACITY];  ///< Origin stamp per queued report
+    uint8_t queue_source[HID_REPORT_QUEUE_CAPACITY];   ///< Origin source per queued report
+    uint8_t queue_head;
+    uint8_t queue_count;
+    bool resync;                 ///< A report was dropped; resend state when drained
+    hid_backpressure_t policy;
+
+    hid_send_result_t (*send)(void* ctx, const hid_key_report_t* report);
+    void* send_ctx;
+    uint32_t (*now_us)(void);    ///< Clock (micros() unless replaced)
+
+    hid_composer_stats_t stats;
+} hid_composer_t;
+
+/**
+ * @brief Initializes the composer.
+ *
+ * @param hid Pointer to composer instance
+ * @param send Report sink; returns what it did with the report
+ * @param ctx User data passed to `send`
+ */
+void hid_composer_init(hid_composer_t* hid, hid_send_result_t (*send)(void* ctx, const hid_key_report_t* report),
+                       void* ctx);
+
+/**
+ * @brief Replaces the microsecond clock (NULL restores micros()).
+ */
+void hid_composer_set_clock(hid_composer_t* hid, uint32_t (*now_us)(void));
+
+/**
+ * @brief Sets the coalescing window (typically the BLE connection interval).
+ */
+void hid_composer_set_window(hid_composer_t* hid, uint32_t window_us);
+
+/**
+ * @brief Sets the queue-full policy and the per-poll transmit budget.
+ */
+void hid_composer_set_backpressure(hid_composer_t* hid, hid_backpressure_t policy, uint8_t max_per_poll);
+
+/**
+ * @brief Tags the next key change with the input edge that caused it.
+ *
+ * The stamp travels with the report that carries the change and is
+ * recorded with latency_record() when the sink hands that report to the
+ * host; a discarded report records nothing. An older stamp already
+ * waiting is kept.
+ *
+ * @param hid Pointer to composer instance
+ * @param source latency_source_t the stamp belongs to
+ * @param stamp latency_stamp() taken in the ISR, 0 for none
+ */
+void hid_composer_set_origin(hid_composer_t* hid, latency_source_t source, uint32_t stamp);
+
+/**
+ * @brief Adds a key to the state.
+ *
+ * @return false if the key is unknown or all six slots are in use
+ */
+bool hid_composer_press(hid_composer_t* hid, uint8_t key);
+
+/**
+ * @brief Removes a key from the state.
+ *
+ * A key that was pressed but not yet queued is queued first, so a press
+ * immediately followed by a release is never merged away.
+ */
+bool hid_composer_release(hid_composer_t* hid, uint8_t key);
+
+/**
+ * @brief Press immediately followed by release.
+ */
+bool hid_composer_tap(hid_composer_t* hid, uint8_t key);
+
+/**
+ * @brief Releases every key.
+ */
+void hid_composer_release_all(hid_composer_t* hid);
+
+/**
+ * @brief Queues the state if its window elapsed and feeds the sink.
+ *
+ * @param hid Pointer to composer instance
+ * @return Microseconds until the next poll is useful, 0 if nothing waits
+ */
+uint32_t hid_composer_poll(hid_composer_t* hid);
+
+/**
+ * @brief Returns true if reports or changes are waiting.
+ */
+bool hid_composer_busy(const hid_composer_t* hid);
+
+#endif  // __HID_REPORT_H__
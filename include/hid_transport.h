@@ -0,0 +1,215 @@
+#ifndef __HID_TRANSPORT_H__
+#define __HID_TRANSPORT_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "hid_report.h"
+
+// Build with -DHID_TRANSPORT_NIMBLE=1 (and the NimBLE-Arduino library in
+// place of ESP32 BLE Keyboard, see the esp32dev-nimble env) to run the
+// keyboard on the NimBLE host instead of Bluedroid.
+#ifndef HID_TRANSPORT_NIMBLE
+#define HID_TRANSPORT_NIMBLE 0
+#endif
+
+static constexpr uint32_t HID_TRANSPORT_MIN_INTERVAL_US = 7500;    // shortest interval BLE allows
+static constexpr uint32_t HID_TRANSPORT_MAX_INTERVAL_US = 15000;
+static constexpr uint32_t HID_TRANSPORT_SUPERVISION_MS = 1000;
+static constexpr uint16_t HID_TRANSPORT_RATE_REPORTS = 500;        // empty reports per hid_transport_measure_rate()
+static constexpr uint8_t HID_TRANSPORT_FAKE_LOG = 64;
+static constexpr uint8_t HID_TRANSPORT_ADDR_PUBLIC = 0;
+static constexpr uint8_t HID_TRANSPORT_ADDR_RANDOM = 1;   // static or identity random address
+
+typedef struct hid_transport_config {
+    const char* name;               ///< Advertised device name
+    const char* manufacturer;
+    uint8_t battery_level;
+    uint32_t min_interval_us;       ///< Connection interval requested from the host
+    uint32_t max_interval_us;
+    uint32_t supervision_ms;
+} hid_transport_config_t;
+
+typedef struct hid_transport_addr {
+    uint8_t type;               ///< HID_TRANSPORT_ADDR_PUBLIC or HID_TRANSPORT_ADDR_RANDOM
+    uint8_t addr[6];            ///< Most significant byte first, as printed
+} hid_transport_addr_t;
+
+/**
+ * @brief Link change, from the BLE stack's task.
+ *
+ * @param up true once a host has encrypted the link with its bond (a
+ *           first connection: once pairing completes), false on disconnect
+ * @param peer The host's identity address (NULL when the link drops)
+ */
+typedef void (*hid_transport_link_fn)(void* ctx, bool up, const hid_transport_addr_t* peer);
+
+/**
+ * @brief One BLE HID keyboard stack. Every function runs in the caller's task.
+ *
+ * Bonds are kept by the stack itself, in NVS.
+ */
+typedef struct hid_transport_ops {
+    const char* name;                                                       ///< "bluedroid", "nimble", "fake"
+    bool (*begin)(void* impl, const hid_transport_config_t* config);       ///< Starts advertising
+    bool (*connected)(void* impl);
+    bool (*send)(void* impl, const hid_key_report_t* report);              ///< false if the stack refused it
+    uint32_t (*conn_interval_us)(void* impl);                               ///< Negotiated interval, 0 if unknown
+    bool (*advertise)(void* impl, const hid_transport_addr_t* peer);       ///< Directed to `peer`, general if NULL
+    void (*disconnect)(void* impl);
+    void (*forget)(void* impl, const hid_transport_addr_t* peer);          ///< Deletes the bond with `peer`
+} hid_transport_ops_t;
+
+typedef struct hid_transport_stats {
+    const char* backend;
+    bool connected;
+    uint32_t heap_before;           ///< Free heap before begin()
+    uint32_t heap_after;            ///< Free heap once advertising
+    uint32_t begin_us;              ///< Time spent in begin()
+    uint32_t advertising_us;        ///< Boot to advertising (micros() when begin() returned)
+    uint32_t conn_interval_us;
+    uint32_t sent;                  ///< Reports the stack accepted
+    uint32_t refused;               ///< Reports it did not (congestion)
+    uint32_t rate;                  ///< Reports/s of the last hid_transport_measure_rate()
+} hid_transport_stats_t;
+
+/**
+ * @brief Keyboard transport: the composer's report sink on top of a BLE stack.
+ *
+ * Backends fill `ops` and `impl`; the stack is chosen at build time
+ * (hid_transport_init()), or a fake is bound for host tests
+ * (hid_transport_fake_init()). Keys are composed into reports by
+ * hid_composer_t, so only whole reports cross this interface.
+ */
+typedef struct hid_transport {
+    const hid_transport_ops_t* ops;
+    void* impl;
+    hid_transport_link_fn link_fn;
+    void* link_ctx;
+    hid_transport_stats_t stats;
+} hid_transport_t;
+
+/**
+ * @brief Fills `config` with the link parameters: 7.5-15 ms interval, no
+ * slave latency, 1 s supervision timeout.
+ */
+void hid_transport_default_config(hid_transport_config_t* config, const char* name, const char* manufacturer);
+
+/**
+ * @brief Binds the BLE stack selected at build time (HID_TRANSPORT_NIMBLE).
+ */
+void hid_transport_init(hid_transport_t* transport);
+
+/**
+ * @brief Binds an arbitrary backend (tests, fakes).
+ */
+void hid_transport_bind(hid_transport_t* transport, const hid_transport_ops_t* ops, void* impl);
+
+/**
+ * @brief Brings the stack up and starts advertising; records heap and timing.
+ */
+bool hid_transport_begin(hid_transport_t* transport, const hid_transport_config_t* config);
+
+static inline bool hid_transport_connected(hid_transport_t* transport) {
+    return transport->ops && transport->ops->connected(transport->impl);
+}
+
+/**
+ * @brief Assigns the link change callback (see hid_transport_link_fn).
+ */
+void hid_transport_set_link_callback(hid_transport_t* transport, hid_transport_link_fn fn, void* ctx);
+
+/**
+ * @brief Reports a link change to the callback; for backends, from any task.
+ */
+void hid_transport_link_event(hid_transport_t* transport, bool up, const hid_transport_addr_t* peer);
+
+/**
+ * @brief Restarts advertising, replacing whatever the stack was doing.
+ *
+ * @param peer Host to send high-duty directed advertising to: it alone
+ *             can connect, within ~3.75 ms of scanning, and the controller
+ *             gives up after 1.28 s. NULL for general (undirected) advertising.
+ * @return false if the stack refused
+ */
+bool hid_transport_advertise(hid_transport_t* transport, const hid_transport_addr_t* peer);
+
+/**
+ * @brief Drops the current connection, if any; the link callback follows.
+ */
+void hid_transport_disconnect(hid_transport_t* transport);
+
+/**
+ * @brief Deletes the stack's bond with `peer`; it has to pair again.
+ */
+void hid_transport_forget(hid_transport_t* transport, const hid_transport_addr_t* peer);
+
+/**
+ * @brief Hands one report to the stack.
+ *
+ * @return false if the stack is congested; the caller keeps the report
+ */
+bool hid_transport_send(hid_transport_t* transport, const hid_key_report_t* report);
+
+/**
+ * @brief Sends HID_TRANSPORT_RATE_REPORTS empty reports back to back and
+ * times them, waiting 1 ms whenever the stack refuses one.
+ *
+ * Blocks the caller for the duration; the host sees only key-up reports.
+ *
+ * @return Reports/s (also kept in the stats), 0 if not connected
+ */
+uint32_t hid_transport_measure_rate(hid_transport_t* transport);
+
+/**
+ * @brief Copies the stats, with the current link state.
+ */
+void hid_transport_get_stats(hid_transport_t* transport, hid_transport_stats_t* stats);
+
+/**
+ * @brief Host stand-in for a BLE link.
+ *
+ * Accepts at most `per_event` reports per connection event of
+ * `interval_us` and refuses the rest, like a stack out of transmit
+ * buffers. Accepted reports are kept in a ring for inspection.
+ *
+ * Advertising requests are only recorded; the test plays the host and
+ * connects with hid_transport_fake_link().
+ */
+typedef struct hid_transport_fake {
+    hid_transport_t* transport;
+    bool connected;
+    uint32_t interval_us;
+    uint8_t per_event;
+    uint32_t (*now_us)(void);       ///< Clock (micros() unless replaced)
+    uint32_t event_start_us;        ///< Connection event the budget applies to
+    uint8_t event_sent;
+    uint32_t received;              ///< Reports accepted; log holds the newest HID_TRANSPORT_FAKE_LOG
+    hid_key_report_t log[HID_TRANSPORT_FAKE_LOG];
+    bool advertising;
+    bool directed;                  ///< Last advertise() was directed, to `target`
+    hid_transport_addr_t target;
+    uint32_t advertised;            ///< advertise() calls
+    uint32_t forgotten;             ///< forget() calls
+    hid_transport_addr_t last_forgotten;
+} hid_transport_fake_t;
+
+/**
+ * @brief Resets `fake` (connected, 7.5 ms interval, 4 reports per event)
+ * and binds it to `transport`.
+ */
+void hid_transport_fake_init(hid_transport_t* transport, hid_transport_fake_t* fake);
+
+/**
+ * @brief Connects `peer` (up) or drops the link, and reports it like a stack would.
+ */
+void hid_transport_fake_link(hid_transport_fake_t* fake, bool up, const hid_transport_addr_t* peer);
+
+/**
+ * @brief The `index`th report accepted since init (0 = first).
+ *
+ * @return NULL if not received yet or already pushed out of the log
+ */
+const hid_key_report_t* hid_transport_fake_report(const hid_transport_fake_t* fake, uint32_t index);
+
+#endif  // __HID_TRANSPORT_H__
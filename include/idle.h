@@ -0,0 +1,136 @@
+#ifndef __IDLE_H__
+#define __IDLE_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "latency.h"
+#include "pin.h"
+#include "scheduler.h"
+
+static constexpr uint8_t IDLE_MAX_WAKE_PINS = 6;
+
+typedef struct idle_config {
+    uint32_t idle_after_ms;     ///< Time without activity before going idle
+    uint32_t min_sleep_us;      ///< Shorter waits are spent awake (light sleep costs ~1 ms to enter and leave)
+    uint32_t max_sleep_ms;      ///< Longest single light sleep; the timer wakes the chip after it
+    uint32_t report_window_ms;  ///< A report later than this after a wake is not attributed to it
+} idle_config_t;
+
+/**
+ * @brief Callbacks into the application, all run from the scheduler's task.
+ */
+typedef struct idle_hooks {
+    bool (*can_sleep)(void* ctx);           ///< false while something light sleep would cut off is in flight (NULL: always)
+    void (*on_idle)(void* ctx, bool idle);  ///< Pause periodic work on entering idle, resume it on leaving
+    bool (*on_wake)(void* ctx);             ///< After a GPIO wake, wake-pin interrupts still off: resync drivers; true if an input moved
+    void* ctx;
+} idle_hooks_t;
+
+typedef struct idle_wake_pin {
+    pin_t pin;
+    uint8_t mode;               ///< Interrupt mode the pin's driver attached (CHANGE, RISING, ...)
+} idle_wake_pin_t;
+
+typedef struct idle_stats {
+    bool enabled;
+    bool idle;
+    uint32_t entries;           ///< Active -> idle transitions
+    uint32_t sleeps;            ///< Light sleeps entered
+    uint32_t gpio_wakes;
+    uint32_t timer_wakes;
+    uint32_t resynced;          ///< GPIO wakes whose input change was recovered by on_wake
+    uint32_t asleep_ms;         ///< Time in light sleep
+    uint32_t idle_ms;           ///< Time in the idle state, asleep or not
+    uint32_t wake_reports;      ///< GPIO wakes followed by a report within the window
+    uint32_t last_wake_report_us;  ///< Light-sleep exit to the first report after it
+    uint32_t max_wake_report_us;
+} idle_stats_t;
+
+/**
+ * @brief Light-sleep idle manager, installed as the scheduler's wait primitive.
+ *
+ * After `idle_after_ms` without activity (input edges, reports, or
+ * anything the application reports through idle_activity()) the manager
+ * goes idle and on_idle() pauses the fast periodic jobs. From then on,
+ * every scheduler wait of at least `min_sleep_us` is spent in light sleep
+ * instead, woken by the next deadline (capped at `max_sleep_ms`) or by any
+ * wake pin leaving its current level.
+ *
+ * GPIO wakeup on the ESP32 is level-triggered, so each pin is armed for
+ * the opposite of the level it reads when the chip goes to sleep, with
+ * its edge interrupt disabled meanwhile (a level interrupt would fire
+ * continuously). The edge that wakes the chip is therefore never seen by
+ * the drivers' ISRs: on_wake() re-reads the pins and feeds the missed
+ * edges through the drivers before the interrupts are re-enabled. A GPIO
+ * wake counts as activity, so the jobs resume right after it.
+ *
+ * The time from each GPIO wake to the next HID report (idle_report_sent())
+ * is recorded under LATENCY_SRC_WAKE and in the stats.
+ */
+typedef struct idle_manager {
+    scheduler_t* sched;
+    idle_config_t config;
+    idle_hooks_t hooks;
+    idle_wake_pin_t pins[IDLE_MAX_WAKE_PINS];
+    uint8_t pin_count;
+    volatile uint32_t last_activity_us;
+    volatile bool enabled;
+    bool idle;
+    uint32_t idle_since_us;
+    uint32_t asleep_carry_us;   ///< Sub-millisecond remainder of asleep_ms
+    bool wake_pending;          ///< A GPIO wake waits for its first report
+    uint32_t wake_us;
+    uint32_t wake_stamp;
+    idle_stats_t stats;
+} idle_manager_t;
+
+/**
+ * @brief Fills `config` with defaults: idle after 2 s, sleeps of 5 ms to 1 s,
+ * 1 s report window.
+ */
+void idle_default_config(idle_config_t* config);
+
+/**
+ * @brief Resets the manager and installs it as `sched`'s wait primitive.
+ *
+ * @param idle Pointer to manager instance
+ * @param sched Scheduler whose waits become light sleeps
+ * @param config Parameters (copied)
+ * @param hooks Application callbacks (copied)
+ * @param enabled Whether the manager may go idle
+ */
+void idle_init(idle_manager_t* idle, scheduler_t* sched, const idle_config_t* config,
+               const idle_hooks_t* hooks, bool enabled);
+
+/**
+ * @brief Adds a pin that wakes the chip when it changes level.
+ *
+ * @param mode Interrupt mode its driver attached, restored after each sleep
+ * @return false if IDLE_MAX_WAKE_PINS are already registered
+ */
+bool idle_add_wake_pin(idle_manager_t* idle, pin_t pin, uint8_t mode);
+
+/**
+ * @brief Restarts the idle timeout. Safe to call from an ISR.
+ */
+static inline void idle_activity(idle_manager_t* idle) {
+    idle->last_activity_us = micros();
+}
+
+/**
+ * @brief Notes a HID report hand-off: activity, and the end of a wake measurement.
+ */
+void idle_report_sent(idle_manager_t* idle);
+
+/**
+ * @brief Allows or forbids idling; takes effect on the next scheduler wait.
+ */
+void idle_set_enabled(idle_manager_t* idle, bool enabled);
+
+/**
+ * @brief Copies the stats, with the current idle period so far.
+ */
+void idle_get_stats(const idle_manager_t* idle, idle_stats_t* stats);
+
+#endif  // __IDLE_H__
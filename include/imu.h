@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <stdint.h>
 #include <Wire.h>
+#include "imu_config.h"
 #include "pin.h"
 
 /**
@@ -13,6 +14,22 @@
  * for initializing and reading data from a BMI323 IMU sensor via I2C.
  */
 
+static constexpr uint32_t IMU_DEFAULT_BUS_CLOCK_HZ = 400000;  // I2C fast mode
+
+// FIFO frame layout with accel, gyro, temperature and sensor time enabled
+static constexpr uint8_t IMU_FIFO_FRAME_WORDS = 8;
+static constexpr uint16_t IMU_FIFO_CAPACITY_WORDS = 1024;  // 2 KiB hardware FIFO
+
+// imu_read_int_status() bits
+static constexpr uint16_t IMU_INT_STATUS_ANY_MOTION = 0x0002;
+static constexpr uint16_t IMU_INT_STATUS_FIFO_WATERMARK = 0x0400;
+static constexpr uint16_t IMU_INT_STATUS_ACC_DRDY = 0x2000;
+
+// imu_sample_t::flags
+static constexpr uint8_t IMU_SAMPLE_ACCEL_VALID = 0x01;
+static constexpr uint8_t IMU_SAMPLE_GYRO_VALID = 0x02;
+static constexpr uint8_t IMU_SAMPLE_TEMP_VALID = 0x04;
+
 typedef struct imu_data {
     float accel_x;
     float accel_y;
@@ -23,11 +40,65 @@ typedef struct imu_data {
     float temp;
 } imu_data_t;
 
+/**
+ * @brief One timestamped sample, as produced by the FIFO drain.
+ */
+typedef struct imu_sample {
+    imu_data_t data;
+    uint32_t timestamp_us;  ///< micros() time reconstructed from sensor_time
+    uint16_t sensor_time;   ///< BMI323 sensor time (39.0625 us ticks, wraps)
+    uint8_t flags;          ///< IMU_SAMPLE_* validity bits
+} imu_sample_t;
+
+/**
+ * @brief Events that can be routed to the IMU interrupt pin (INT1).
+ */
+typedef enum imu_int_source {
+    IMU_INT_NONE = 0,           ///< INT1 disabled
+    IMU_INT_DATA_READY,         ///< New accel data available
+    IMU_INT_FIFO_WATERMARK,     ///< FIFO fill level reached the watermark
+    IMU_INT_ANY_MOTION,         ///< Any-motion detector fired (see imu_any_motion_enable())
+} imu_int_source_t;
+
+/**
+ * @brief Run-time settings of one sensor; the range is fixed by imu_config_t.
+ */
+typedef struct imu_sensor_settings {
+    uint8_t mode;       ///< imu_power_mode_t
+    uint8_t odr;        ///< imu_odr_t
+    uint8_t avg;        ///< imu_avg_t (low-power mode only)
+} imu_sensor_settings_t;
+
+typedef struct imu_settings {
+    imu_sensor_settings_t accel;
+    imu_sensor_settings_t gyro;
+} imu_settings_t;
+
+/**
+ * @brief Incremental FIFO frame parser state.
+ * 
+ * Words that do not yet form a full frame are carried over to the next
+ * imu_fifo_parse() call, so the byte stream may be split anywhere.
+ */
+typedef struct imu_fifo_parser {
+    uint16_t frame[IMU_FIFO_FRAME_WORDS];
+    uint8_t frame_len;       ///< Words of `frame` filled so far
+    uint32_t skipped_frames; ///< Frames carrying no accel or gyro data
+} imu_fifo_parser_t;
+
 typedef struct imu {
     uint8_t i2c_addr;
     pin_t int_pin;
     TwoWire* wire;
+    uint32_t bus_clock_hz;  // I2C SCL frequency applied to `wire`
     bool initialized;
+    imu_settings_t settings;        // last applied by imu_configure()
+    bool any_motion_enabled;
+    // FIFO streaming state
+    bool fifo_enabled;
+    uint16_t fifo_watermark_frames;
+    uint32_t fifo_overflows;        // drains that found the FIFO full
+    imu_fifo_parser_t fifo_parser;
 } imu_t;
 
 /**
@@ -41,15 +112,102 @@ typedef struct imu {
  */
 bool imu_init(imu_t* imu, pin_t int_pin, uint8_t i2c_addr, TwoWire* wire);
 
+/**
+ * @brief Fills `settings` with the imu_config_t defaults imu_init() applies.
+ */
+void imu_default_settings(imu_settings_t* settings);
+
+/**
+ * @brief Applies ODR, averaging and power mode of both sensors.
+ * 
+ * Rejects combinations the BMI323 does not support: low-power mode above
+ * 400 Hz, normal and high-performance mode below 12.5 Hz. Suspending the
+ * accelerometer also stops data-ready interrupts and the any-motion
+ * detector. Nothing is written if either sensor's settings are invalid.
+ * 
+ * @param imu Pointer to imu instance
+ * @param settings New settings (copied into imu->settings)
+ * @return true if applied
+ */
+bool imu_configure(imu_t* imu, const imu_settings_t* settings);
+
+/**
+ * @brief Enables the feature engine's any-motion detector on X, Y and Z.
+ * 
+ * It fires once the accelerometer slope on any axis stays above
+ * `threshold_mg` for `duration_ms`, and keeps working with the gyro
+ * suspended and the accelerometer in low-power mode, which is what makes
+ * it useful as a wake source. Route it with imu_enable_interrupt().
+ * 
+ * @param imu Pointer to imu instance
+ * @param threshold_mg Slope threshold (1..7998 mg, 1.95 mg resolution)
+ * @param duration_ms Time above threshold (0..163820 ms, 20 ms resolution)
+ * @return true if successful, false otherwise
+ */
+bool imu_any_motion_enable(imu_t* imu, uint16_t threshold_mg, uint32_t duration_ms);
+
+/**
+ * @brief Disables the any-motion detector.
+ */
+bool imu_any_motion_disable(imu_t* imu);
+
+/**
+ * @brief Reads (and thereby clears) INT_STATUS_INT1.
+ * 
+ * @param imu Pointer to imu instance
+ * @param status Receives IMU_INT_STATUS_* bits
+ * @return true if read successful, false otherwise
+ */
+bool imu_read_int_status(imu_t* imu, uint16_t* status);
+
+/**
+ * @brief Changes the I2C bus clock used to talk to the IMU.
+ * 
+ * imu_init() starts the bus at IMU_DEFAULT_BUS_CLOCK_HZ; call this afterwards
+ * to override it. The BMI323 supports up to 1 MHz (Fm+).
+ * 
+ * @param imu Pointer to imu instance
+ * @param clock_hz SCL frequency in Hz (1..1000000)
+ * @return true if the clock was applied, false if out of range
+ */
+bool imu_set_bus_clock(imu_t* imu, uint32_t clock_hz);
+
 /**
  * @brief Reads acceleration and gyroscope data from IMU.
  * 
+ * All seven data words (accel XYZ, gyro XYZ, temperature) are fetched in a
+ * single auto-incrementing I2C burst.
+ * 
  * @param imu Pointer to imu instance
  * @param data Pointer to imu_data structure to store results
  * @return true if read successful, false otherwise
  */
 bool imu_read(imu_t* imu, imu_data_t* data);
 
+/**
+ * @brief Reads one timestamped sample (data registers plus sensor time).
+ * 
+ * Like imu_read(), but the burst extends to SENSOR_TIME_0 so the sample
+ * carries the sensor time it was latched at. timestamp_us is set to micros().
+ * 
+ * @param imu Pointer to imu instance
+ * @param sample Pointer to store the sample
+ * @return true if read successful, false otherwise
+ */
+bool imu_read_sample(imu_t* imu, imu_sample_t* sample);
+
+/**
+ * @brief Routes an IMU event to INT1 (active high, push-pull).
+ * 
+ * INT1 is the line wired to `int_pin`. Routing IMU_INT_NONE disables the
+ * output again.
+ * 
+ * @param imu Pointer to imu instance
+ * @param source Event to signal on INT1
+ * @return true if successful, false otherwise
+ */
+bool imu_enable_interrupt(imu_t* imu, imu_int_source_t source);
+
 /**
  * @brief Reads temperature from IMU.
  * 
@@ -81,4 +239,103 @@ bool imu_read_accel(imu_t* imu, float* x, float* y, float* z);
  */
 bool imu_read_gyro(imu_t* imu, float* x, float* y, float* z);
 
+/**
+ * @brief Enables FIFO streaming of accel, gyro, temperature and sensor time.
+ * 
+ * The FIFO is flushed and its watermark set to `watermark_frames` frames.
+ * The watermark is what the FIFO watermark interrupt fires on; drains are
+ * always done with imu_fifo_read().
+ * 
+ * @param imu Pointer to imu instance
+ * @param watermark_frames Frames buffered before the watermark is reached
+ * @return true if the FIFO was configured, false otherwise
+ */
+bool imu_fifo_enable(imu_t* imu, uint16_t watermark_frames);
+
+/**
+ * @brief Disables FIFO streaming and flushes any buffered frames.
+ * 
+ * @param imu Pointer to imu instance
+ * @return true if successful, false otherwise
+ */
+bool imu_fifo_disable(imu_t* imu);
+
+/**
+ * @brief Drains buffered FIFO frames into a caller-provided buffer.
+ * 
+ * Frames are read in as few I2C bursts as the Wire buffer allows. At most
+ * `max_samples` frames are pulled from the sensor; anything beyond that
+ * stays in the FIFO for the next call. Each sample is stamped with a
+ * micros() time reconstructed from its sensor time.
+ * 
+ * @param imu Pointer to imu instance
+ * @param out Buffer receiving samples (oldest first)
+ * @param max_samples Capacity of `out`
+ * @param count Receives the number of samples written
+ * @return true if the drain succeeded (even if no frames were ready)
+ */
+bool imu_fifo_read(imu_t* imu, imu_sample_t* out, size_t max_samples, size_t* count);
+
+/**
+ * @brief Resets a FIFO frame parser.
+ * 
+ * @param parser Pointer to parser instance
+ */
+void imu_fifo_parser_reset(imu_fifo_parser_t* parser);
+
+/**
+ * @brief Decodes raw FIFO words into samples.
+ * 
+ * Every word is taken as frame data, so `words` must hold only words
+ * below the FIFO fill level: reading past it returns padding that is
+ * indistinguishable from a sample of -32768. Frames whose accel and gyro
+ * parts are both dummy are skipped and counted, and a trailing partial
+ * frame is kept in the parser for the next call. Parsing stops once
+ * `max_samples` samples were produced. timestamp_us is left 0.
+ * 
+ * @param parser Pointer to parser instance
+ * @param words Raw little-endian words read from FIFO_DATA
+ * @param count Number of words in `words`
+ * @param out Buffer receiving decoded samples
+ * @param max_samples Capacity of `out`
+ * @param consumed Receives the number of words consumed (may be NULL)
+ * @return Number of samples written to `out`
+ */
+size_t imu_fifo_parse(imu_fifo_parser_t* parser, const uint16_t* words, size_t count,
+                      imu_sample_t* out, size_t max_samples, size_t* consumed);
+
+/**
+ * @brief Converts a burst of raw register triplets in one pass.
+ * 
+ * Uses the same imu_config_t constants as the read paths, so the float
+ * kernels give bit-identical results to converting value by value.
+ * Triplets start `stride` words apart: 3 for packed XYZ arrays,
+ * IMU_FIFO_FRAME_WORDS for raw FIFO frames (offset 0 accel, 3 gyro).
+ * 
+ * @param raw First triplet
+ * @param count Number of triplets
+ * @param stride Words from one triplet to the next (>= 3)
+ * @param out Receives 3 * count values, XYZ packed
+ */
+void imu_convert_accel_batch(const uint16_t* raw, size_t count, size_t stride, float* out);
+void imu_convert_gyro_batch(const uint16_t* raw, size_t count, size_t stride, float* out);
+
+/**
+ * @brief Fixed-point variants: mg and 0.1 deg/s, rounded half up (saturating).
+ */
+void imu_convert_accel_mg_batch(const uint16_t* raw, size_t count, size_t stride, int16_t* out);
+void imu_convert_gyro_ddps_batch(const uint16_t* raw, size_t count, size_t stride, int16_t* out);
+
+#if defined(PIO_UNIT_TESTING)
+/**
+ * @brief Raw-to-physical conversions used by every read path, for the
+ * unit tests and host benchmarks. Not built into the firmware.
+ * 
+ * @param raw Register value
+ * @return Acceleration in g / angular rate in deg/s
+ */
+float imu_bench_convert_accel(uint16_t raw);
+float imu_bench_convert_gyro(uint16_t raw);
+#endif
+
 #endif // __IMU_H__
\ No newline at end of file
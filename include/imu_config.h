@@ -0,0 +1,135 @@
+#ifndef __IMU_CONFIG_H__
+#define __IMU_CONFIG_H__
+
+#include <stdint.h>
+
+/**
+ * @brief BMI323 ACC_CONF / GYR_CONF field values.
+ *
+ * The enumerators are the register codes, so a configuration folds into
+ * the register word and its scale factors at compile time.
+ */
+typedef enum imu_accel_range {
+    IMU_ACCEL_RANGE_2G = 0,
+    IMU_ACCEL_RANGE_4G,
+    IMU_ACCEL_RANGE_8G,
+    IMU_ACCEL_RANGE_16G,
+} imu_accel_range_t;
+
+typedef enum imu_gyro_range {
+    IMU_GYRO_RANGE_125DPS = 0,
+    IMU_GYRO_RANGE_250DPS,
+    IMU_GYRO_RANGE_500DPS,
+    IMU_GYRO_RANGE_1000DPS,
+    IMU_GYRO_RANGE_2000DPS,
+} imu_gyro_range_t;
+
+typedef enum imu_odr {
+    IMU_ODR_0_78HZ = 0x1,
+    IMU_ODR_1_56HZ,
+    IMU_ODR_3_12HZ,
+    IMU_ODR_6_25HZ,
+    IMU_ODR_12_5HZ,
+    IMU_ODR_25HZ,
+    IMU_ODR_50HZ,
+    IMU_ODR_100HZ,
+    IMU_ODR_200HZ,
+    IMU_ODR_400HZ,
+    IMU_ODR_800HZ,
+    IMU_ODR_1600HZ,
+    IMU_ODR_3200HZ,
+    IMU_ODR_6400HZ,
+} imu_odr_t;
+
+typedef enum imu_avg {
+    IMU_AVG_1 = 0,      ///< No averaging
+    IMU_AVG_2,
+    IMU_AVG_4,
+    IMU_AVG_8,
+    IMU_AVG_16,
+    IMU_AVG_32,
+    IMU_AVG_64,
+} imu_avg_t;
+
+typedef enum imu_power_mode {
+    IMU_MODE_SUSPEND = 0,       ///< Sensor off
+    IMU_MODE_LOW_POWER = 3,     ///< Duty-cycled; averaging applies
+    IMU_MODE_NORMAL = 4,
+    IMU_MODE_HIGH_PERF = 7,
+} imu_power_mode_t;
+
+/**
+ * @brief ACC_CONF / GYR_CONF register word for the given fields.
+ */
+static constexpr uint16_t imu_conf_word(uint8_t mode, uint8_t avg, uint8_t range, uint8_t odr) {
+    return (uint16_t)((mode << 12) | (avg << 8) | (range << 4) | odr);
+}
+
+/**
+ * @brief Sample period of an ODR code in microseconds (codes double the rate).
+ */
+static constexpr uint32_t imu_odr_period_us(uint8_t odr) {
+    return (odr >= IMU_ODR_100HZ) ? (10000u >> (odr - IMU_ODR_100HZ)) : (10000u << (IMU_ODR_100HZ - odr));
+}
+
+/**
+ * @brief Sensor configuration fixed at compile time.
+ *
+ * Scale factors are constexpr, so conversions compile to one multiply by
+ * a literal. The ranges cannot change at run time; ODR, averaging and
+ * power mode here are only the defaults imu_init() starts with, and
+ * imu_configure() changes them later.
+ *
+ * Fixed-point conversions produce the telemetry units (mg and 0.1 deg/s)
+ * as exact integer arithmetic: raw * mul >> shift, rounded half up.
+ */
+template <imu_accel_range_t AccelRange, imu_gyro_range_t GyroRange, imu_odr_t Odr,
+          imu_avg_t Avg = IMU_AVG_1, imu_power_mode_t Mode = IMU_MODE_NORMAL>
+struct imu_config {
+    static constexpr imu_accel_range_t accel_range = AccelRange;
+    static constexpr imu_gyro_range_t gyro_range = GyroRange;
+    static constexpr imu_odr_t odr = Odr;
+
+    // 16384 LSB/g at +-2 g, halving per range step
+    static constexpr float accel_lsb_per_g() { return 16384.0f / (float)(1u << AccelRange); }
+    // 262.144 LSB/(deg/s) at +-125 deg/s, halving per range step
+    static constexpr float gyro_lsb_per_dps() { return 262.144f / (float)(1u << GyroRange); }
+    static constexpr float accel_scale() { return 1.0f / accel_lsb_per_g(); }
+    static constexpr float gyro_scale() { return 1.0f / gyro_lsb_per_dps(); }
+
+    // mg = raw * 1000 / (16384 >> range) = raw * (125 << range) / 2^11
+    static constexpr int32_t accel_mg_mul() { return 125 << AccelRange; }
+    static constexpr uint8_t accel_mg_shift() { return 11; }
+    // 0.1 deg/s = raw * 10 / (262.144 >> range) = raw * (625 << range) / 2^14
+    static constexpr int32_t gyro_ddps_mul() { return 625 << GyroRange; }
+    static constexpr uint8_t gyro_ddps_shift() { return 14; }
+
+    static constexpr imu_avg_t avg = Avg;
+    static constexpr imu_power_mode_t mode = Mode;
+
+    static constexpr uint32_t period_us() { return imu_odr_period_us(Odr); }
+
+    static constexpr uint16_t acc_conf() { return imu_conf_word(Mode, Avg, AccelRange, Odr); }
+    static constexpr uint16_t gyr_conf() { return imu_conf_word(Mode, Avg, GyroRange, Odr); }
+};
+
+// Build-time selection, e.g. -DIMU_ACCEL_RANGE=IMU_ACCEL_RANGE_4G
+#ifndef IMU_ACCEL_RANGE
+#define IMU_ACCEL_RANGE IMU_ACCEL_RANGE_8G
+#endif
+#ifndef IMU_GYRO_RANGE
+#define IMU_GYRO_RANGE IMU_GYRO_RANGE_2000DPS
+#endif
+#ifndef IMU_ODR
+#define IMU_ODR IMU_ODR_100HZ
+#endif
+#ifndef IMU_AVG
+#define IMU_AVG IMU_AVG_1
+#endif
+
+/**
+ * @brief The configuration this firmware drives the BMI323 with.
+ */
+typedef imu_config<IMU_ACCEL_RANGE, IMU_GYRO_RANGE, IMU_ODR, IMU_AVG> imu_config_t;
+
+#endif  // __IMU_CONFIG_H__
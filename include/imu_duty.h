@@ -0,0 +1,117 @@
+#ifndef __IMU_DUTY_H__
+#define __IMU_DUTY_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "imu.h"
+
+typedef enum imu_duty_mode {
+    IMU_DUTY_ACTIVE = 0,        ///< Accel + gyro at the stream rate
+    IMU_DUTY_IDLE,              ///< Gyro suspended, low-power accel feeding any-motion
+    IMU_DUTY_MODES,
+} imu_duty_mode_t;
+
+typedef struct imu_duty_config {
+    uint32_t idle_after_ms;     ///< Continuous stillness before dropping to IMU_DUTY_IDLE
+    float still_g;              ///< Largest per-axis accel change between samples that counts as still
+    float still_dps;            ///< Largest angular rate on any axis that counts as still
+    uint16_t wake_threshold_mg; ///< Any-motion slope threshold
+    uint16_t wake_duration_ms;  ///< Time above the threshold before the detector fires
+    imu_settings_t idle;        ///< Sensor settings while idle (gyro suspended)
+} imu_duty_config_t;
+
+/**
+ * @brief Switch counters, latencies and time spent per mode.
+ */
+typedef struct imu_duty_stats {
+    uint8_t mode;               ///< imu_duty_mode_t
+    bool enabled;
+    uint32_t sleeps;            ///< ACTIVE -> IDLE switches
+    uint32_t wakes;             ///< IDLE -> ACTIVE switches on motion
+    uint32_t last_wake_us;      ///< Motion interrupt to first full-rate sample
+    uint32_t max_wake_us;
+    uint32_t last_switch_us;    ///< Bus time of the last reconfiguration, either way
+    uint32_t max_switch_us;
+    uint32_t time_ms[IMU_DUTY_MODES];
+} imu_duty_stats_t;
+
+/**
+ * @brief Automatic IMU duty cycling driven from the acquisition task.
+ *
+ * While active, every sample is checked for stillness; after
+ * `idle_after_ms` of it the gyro is suspended, the accelerometer drops to
+ * low-power mode and the any-motion detector is routed to INT1 instead of
+ * the data interrupt. The next interrupt (or a disable request) restores
+ * the active settings and routing, and the first full-rate sample closes
+ * the wake-latency measurement. All bus access happens in the functions
+ * the stream task calls; other contexts only flip `enabled` and read stats.
+ */
+typedef struct imu_duty {
+    imu_duty_config_t config;
+    volatile bool enabled;
+    volatile uint8_t mode;      ///< imu_duty_mode_t
+    imu_settings_t active;      ///< Restored on wake
+    uint32_t mode_since_us;     ///< Start of the time not yet added to time_ms
+    uint32_t still_since_us;
+    float last_accel[3];
+    bool have_last;
+    bool waking;                ///< Wake latency measurement in progress
+    uint32_t wake_irq_us;
+    imu_duty_stats_t stats;
+} imu_duty_t;
+
+/**
+ * @brief Fills `config` with defaults: idle after 5 s, wake on 40 mg for 20 ms,
+ * idle accel at 50 Hz low power with 2x averaging.
+ */
+void imu_duty_default_config(imu_duty_config_t* config);
+
+/**
+ * @brief Resets the policy; the sensor is assumed active with imu->settings.
+ *
+ * @param duty Pointer to policy instance
+ * @param config Policy parameters (copied)
+ * @param enabled Whether the policy may put the sensor to sleep
+ */
+void imu_duty_init(imu_duty_t* duty, const imu_duty_config_t* config, bool enabled);
+
+/**
+ * @brief Allows or forbids sleeping; an idle sensor wakes on the next stream pass.
+ */
+void imu_duty_set_enabled(imu_duty_t* duty, bool enabled);
+
+/**
+ * @brief Feeds one active-mode sample (stream task).
+ *
+ * @return true if the sensor was just put to sleep; stop reading samples
+ */
+bool imu_duty_on_sample(imu_duty_t* duty, imu_t* imu, const imu_sample_t* sample);
+
+/**
+ * @brief Handles a stream pass while idle (stream task).
+ *
+ * Wakes the sensor if `edge` was an any-motion interrupt or the policy
+ * was disabled; otherwise does nothing, without touching the bus unless
+ * there was an edge.
+ *
+ * @param edge An interrupt arrived since the last pass
+ * @param irq_us micros() of that interrupt
+ */
+void imu_duty_poll(imu_duty_t* duty, imu_t* imu, bool edge, uint32_t irq_us);
+
+/**
+ * @brief Restores the active settings without counting a wake (e.g. before restarting the stream).
+ */
+void imu_duty_resume(imu_duty_t* duty, imu_t* imu);
+
+static inline bool imu_duty_idle(const imu_duty_t* duty) {
+    return duty->mode == IMU_DUTY_IDLE;
+}
+
+/**
+ * @brief Copies the stats, with the time spent in the current mode so far.
+ */
+void imu_duty_get_stats(const imu_duty_t* duty, imu_duty_stats_t* stats);
+
+#endif  // __IMU_DUTY_H__
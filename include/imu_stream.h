@@ -0,0 +1,124 @@
+#ifndef __IMU_STREAM_H__
+#define __IMU_STREAM_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "imu.h"
+#include "imu_duty.h"
+#include "spsc_ring.h"
+
+static constexpr size_t IMU_STREAM_CAPACITY = 64;        // samples buffered for consumers
+static constexpr uint32_t IMU_STREAM_STACK_SIZE = 3072;  // acquisition task stack (bytes)
+
+/**
+ * @brief Interrupt-driven IMU acquisition.
+ *
+ * The IMU interrupt line (data-ready, or FIFO watermark when the FIFO is
+ * enabled) wakes a dedicated FreeRTOS task pinned to one core. That task
+ * does all I2C work and pushes converted samples into a lock-free SPSC ring
+ * that a single consumer (usually loop()) drains with imu_stream_pop().
+ *
+ * With a duty-cycling policy attached (imu_stream_set_duty()) the same
+ * task also puts the sensor to sleep when it is still and wakes it on the
+ * any-motion interrupt.
+ */
+typedef struct imu_stream {
+    imu_t* imu;
+    TaskHandle_t task;
+    spsc_ring<imu_sample_t, IMU_STREAM_CAPACITY> ring;
+    volatile uint32_t interrupts;         ///< IMU_INT edges seen by the ISR
+    volatile uint32_t missed_interrupts;  ///< Edges that arrived while the task was still busy
+    volatile uint32_t read_errors;        ///< Failed I2C reads
+    volatile uint32_t samples;            ///< Samples produced (including dropped ones)
+    volatile uint32_t last_interrupt_us;  ///< micros() of the latest edge
+    uint32_t serviced_interrupts;         ///< `interrupts` as of the last service pass
+    imu_duty_t* duty;                     ///< Optional duty-cycling policy
+    volatile bool stopping;               ///< imu_stream_stop() asked the task to exit
+    volatile bool task_done;              ///< The task left its loop and no longer uses the bus
+    bool running;
+} imu_stream_t;
+
+/**
+ * @brief Snapshot of the acquisition counters.
+ */
+typedef struct imu_stream_stats {
+    uint32_t interrupts;
+    uint32_t missed_interrupts;
+    uint32_t read_errors;
+    uint32_t samples;
+    uint32_t overruns;  ///< Samples dropped because the consumer fell behind
+    size_t queued;      ///< Samples waiting in the ring
+} imu_stream_stats_t;
+
+/**
+ * @brief Routes the IMU interrupt to its pin and starts the acquisition task.
+ *
+ * If the IMU FIFO is enabled the watermark interrupt is used and each wake
+ * drains the FIFO, otherwise every data-ready edge reads one sample.
+ *
+ * @param stream Pointer to stream instance
+ * @param imu Pointer to an initialized imu instance
+ * @param core CPU core the task is pinned to
+ * @param priority FreeRTOS priority of the task
+ * @return true if the task is running, false otherwise
+ */
+bool imu_stream_start(imu_stream_t* stream, imu_t* imu, uint8_t core, uint8_t priority);
+
+/**
+ * @brief Attaches a duty-cycling policy (NULL detaches); call while stopped.
+ *
+ * @param stream Pointer to stream instance
+ * @param duty Policy driven from the acquisition task
+ */
+void imu_stream_set_duty(imu_stream_t* stream, imu_duty_t* duty);
+
+/**
+ * @brief Wakes the task as if INT1 had fired (task context).
+ *
+ * For an interrupt that may have been lost while the pin's interrupt was
+ * disabled (light sleep); a pass without anything pending costs one
+ * status or data read.
+ *
+ * @param stream Pointer to stream instance
+ */
+void imu_stream_kick(imu_stream_t* stream);
+
+/**
+ * @brief Stops the acquisition task and detaches the interrupt.
+ *
+ * The task finishes the pass it is in and exits on its own; this blocks
+ * (in 1-tick delays) until it has, so the bus is free on return. Call
+ * from any task but the acquisition task.
+ *
+ * @param stream Pointer to stream instance
+ */
+void imu_stream_stop(imu_stream_t* stream);
+
+/**
+ * @brief Pops the oldest sample (single consumer only).
+ *
+ * @param stream Pointer to stream instance
+ * @param sample Pointer to store the sample
+ * @return true if a sample was returned, false if none is queued
+ */
+bool imu_stream_pop(imu_stream_t* stream, imu_sample_t* sample);
+
+/**
+ * @brief Runs one acquisition pass (what the task does on every wake).
+ *
+ * @param stream Pointer to stream instance
+ */
+void imu_stream_service(imu_stream_t* stream);
+
+/**
+ * @brief Copies the acquisition counters.
+ *
+ * @param stream Pointer to stream instance
+ * @param stats Pointer to store the snapshot
+ */
+void imu_stream_get_stats(const imu_stream_t* stream, imu_stream_stats_t* stats);
+
+#endif  // __IMU_STREAM_H__
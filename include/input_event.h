@@ -0,0 +1,109 @@
+#ifndef __INPUT_EVENT_H__
+#define __INPUT_EVENT_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "latency.h"
+#include "pin.h"
+#include "spsc_ring.h"
+
+static constexpr size_t INPUT_EVENT_QUEUE_CAPACITY = 32;  // edges buffered per device
+
+/**
+ * @brief One GPIO edge captured in interrupt context.
+ */
+typedef struct input_event {
+    uint32_t timestamp_us;  ///< micros() when the ISR ran
+    uint32_t stamp;         ///< latency_stamp() when the ISR ran (0 if tracing is off)
+    uint8_t pin;            ///< GPIO that changed
+    uint8_t level;          ///< Pin level sampled in the ISR
+    int8_t delta;           ///< Decoded quadrature step (encoders only, 0 otherwise)
+} input_event_t;
+
+/**
+ * @brief Per-device edge queue: ISRs produce, button_process()/encoder_process() consume.
+ *
+ * All GPIO interrupts on the ESP32 are dispatched from one handler on one
+ * core, so several ISRs of the same device never run concurrently and
+ * count as a single producer.
+ */
+typedef spsc_ring<input_event_t, INPUT_EVENT_QUEUE_CAPACITY> input_event_queue_t;
+
+/**
+ * @brief Optional hook run (in ISR context) after every queued edge.
+ *
+ * Lets the consumer be woken as soon as input arrives instead of polling.
+ */
+extern void (*input_event_notify_fn)(void* ctx);
+extern void* input_event_notify_ctx;
+
+/**
+ * @brief Installs the edge notification hook.
+ *
+ * @param notify ISR-safe function to call after each edge, or NULL
+ * @param ctx User data passed to `notify`
+ */
+void input_event_set_notify(void (*notify)(void* ctx), void* ctx);
+
+/**
+ * @brief Optional hook run (in task context) for every edge drained by
+ * button_process_at() and encoder_process(), e.g. to record input traces.
+ */
+extern void (*input_event_trace_fn)(void* ctx, const input_event_t* event);
+extern void* input_event_trace_ctx;
+
+/**
+ * @brief Installs the drained-edge hook.
+ *
+ * Set it only while the consumers are not running.
+ *
+ * @param trace Function to call with each drained edge, or NULL
+ * @param ctx User data passed to `trace`
+ */
+void input_event_set_trace(void (*trace)(void* ctx, const input_event_t* event), void* ctx);
+
+/**
+ * @brief Hands a drained edge to the trace hook, if one is installed.
+ */
+static inline void input_event_drained(const input_event_t* event) {
+    if (input_event_trace_fn) {
+        input_event_trace_fn(input_event_trace_ctx, event);
+    }
+}
+
+/**
+ * @brief Queues an edge captured at `timestamp_us`. Safe to call from an ISR.
+ *
+ * @param queue Destination queue
+ * @param timestamp_us micros() when the edge was sampled
+ * @param pin GPIO that changed
+ * @param level Level sampled for that GPIO
+ * @param delta Decoded step, or 0
+ * @return true if queued, false if the queue was full (counted as overrun)
+ */
+static inline bool input_event_record_at(input_event_queue_t* queue, uint32_t timestamp_us,
+                                         uint8_t pin, uint8_t level, int8_t delta) {
+    input_event_t event;
+    event.timestamp_us = timestamp_us;
+    event.stamp = latency_stamp();
+    event.pin = pin;
+    event.level = level;
+    event.delta = delta;
+    bool queued = spsc_ring_push(queue, event);
+    if (input_event_notify_fn) {
+        input_event_notify_fn(input_event_notify_ctx);
+    }
+    return queued;
+}
+
+/**
+ * @brief Timestamps and queues an edge. Safe to call from an ISR.
+ *
+ * @see input_event_record_at
+ */
+static inline bool input_event_record(input_event_queue_t* queue, uint8_t pin, uint8_t level, int8_t delta) {
+    return input_event_record_at(queue, micros(), pin, level, delta);
+}
+
+#endif  // __INPUT_EVENT_H__
@@ -0,0 +1,75 @@
+#ifndef __INPUT_PIPELINE_H__
+#define __INPUT_PIPELINE_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "button.h"
+#include "encoder.h"
+#include "fusion.h"
+#include "gesture.h"
+#include "imu.h"
+#include "keymap.h"
+
+static constexpr uint8_t INPUT_PIPELINE_UNBOUND = 0xFF;
+
+/**
+ * @brief Keymap inputs the pipeline drives.
+ */
+typedef struct input_pipeline_map {
+    uint8_t button;                     ///< Keymap button of the push button
+    uint8_t encoder_button;             ///< Keymap button of the encoder's push button
+    uint8_t encoder;                    ///< Keymap encoder
+    uint8_t gestures[GESTURE_COUNT];    ///< Keymap button per gesture, or INPUT_PIPELINE_UNBOUND
+} input_pipeline_map_t;
+
+/**
+ * @brief Everything between the edge queues and the keymap.
+ *
+ * The live inputs and a trace replay each run their own copy through the
+ * same code. Tilts hold their button for as long as they last; other
+ * gestures tap it.
+ */
+typedef struct input_pipeline {
+    button_t* button;
+    encoder_t* encoder;
+    keymap_engine_t* keymap;
+    fusion_t* orientation;
+    gesture_t* gesture;
+    const input_pipeline_map_t* map;
+    bool log_gestures;              ///< BINLOG each recognized gesture
+    bool button_was_down;           ///< Button level last handed to the keymap
+    bool encoder_button_was_down;   ///< Encoder button level last handed to the keymap
+} input_pipeline_t;
+
+/**
+ * @brief Wires up a pipeline; nothing has been handed to the keymap yet.
+ *
+ * @param in Pointer to pipeline instance
+ * @param map Keymap inputs to drive; must outlive the pipeline
+ */
+void input_pipeline_init(input_pipeline_t* in, button_t* button, encoder_t* encoder, keymap_engine_t* keymap,
+                         fusion_t* orientation, gesture_t* gesture, const input_pipeline_map_t* map);
+
+/**
+ * @brief Takes the current button levels as already handed to the keymap.
+ *
+ * For after button_reset()/encoder_reset(), which are not edges.
+ */
+void input_pipeline_resync(input_pipeline_t* in);
+
+/**
+ * @brief Drains queued edges and hands changed inputs to the keymap.
+ *
+ * @return The keymap's next deadline in microseconds, 0 if it was not called
+ */
+uint32_t input_pipeline_poll(input_pipeline_t* in, uint32_t now);
+
+/**
+ * @brief Runs one IMU sample through fusion and the gesture recognizer.
+ *
+ * @return The keymap's next deadline in microseconds, 0 if it was not called
+ */
+uint32_t input_pipeline_imu(input_pipeline_t* in, const imu_sample_t* sample, uint32_t now);
+
+#endif  // __INPUT_PIPELINE_H__
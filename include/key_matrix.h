@@ -0,0 +1,144 @@
+#ifndef __KEY_MATRIX_H__
+#define __KEY_MATRIX_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "pin.h"
+
+static constexpr uint8_t KEY_MATRIX_MAX_KEYS = 64;
+static constexpr uint8_t KEY_MATRIX_WORDS = (KEY_MATRIX_MAX_KEYS + 31) / 32;
+static constexpr uint8_t KEY_MATRIX_MAX_ROWS = 8;
+static constexpr uint8_t KEY_MATRIX_MAX_COLS = 16;     ///< Also the most direct pins
+static constexpr uint8_t KEY_MATRIX_DEBOUNCE_SCANS = 4; ///< Scans in a row a new level must last to register
+
+/**
+ * @brief Called once per debounced key change, in key order, from key_matrix_scan().
+ *
+ * @param key row * col_count + col (direct pins: the pin's index)
+ */
+typedef void (*key_matrix_callback_t)(void* ctx, uint8_t key, bool pressed, uint32_t now_us);
+
+typedef struct key_matrix_stats {
+    uint32_t scans;
+    uint32_t events;            ///< Debounced changes emitted
+    uint32_t pressed;           ///< Keys down right now
+} key_matrix_stats_t;
+
+/**
+ * @brief Polled key grid (or bank of direct pins) with bit-parallel debouncing.
+ *
+ * Every scan packs one raw sample per key into 32-bit words, then runs a
+ * two-bit vertical counter per key: bit i of cnt0/cnt1 is key i's
+ * counter, so one word of boolean operations advances 32 counters at
+ * once. A key whose sample differs from its debounced state counts down
+ * on every scan; a sample that agrees resets it. After
+ * KEY_MATRIX_DEBOUNCE_SCANS disagreeing scans in a row the state flips,
+ * so the debounce time is that many scan periods and bounce shorter than
+ * it is never seen. Only the flipped bits are visited to emit events.
+ *
+ * The debounce cost is per word, not per key: 1 and 32 keys cost the
+ * same. Reading the pins costs one digitalRead() per column per row.
+ *
+ * Rows are driven to the active level one at a time, with the others
+ * released to high impedance. Without a diode per key, three keys held
+ * on the corners of a rectangle make the fourth read as closed.
+ */
+typedef struct key_matrix {
+    pin_t rows[KEY_MATRIX_MAX_ROWS];
+    pin_t cols[KEY_MATRIX_MAX_COLS];
+    uint8_t row_count;          ///< 0 for direct pins
+    uint8_t col_count;
+    uint8_t key_count;
+    uint8_t active;             ///< Level a closed key reads on its column (direct pin)
+    uint32_t settle_us;         ///< Row select to column read
+    key_matrix_callback_t callback;
+    void* ctx;
+    uint32_t state[KEY_MATRIX_WORDS];   ///< Debounced, 1 = pressed
+    uint32_t cnt0[KEY_MATRIX_WORDS];    ///< Vertical counter, low bit
+    uint32_t cnt1[KEY_MATRIX_WORDS];    ///< Vertical counter, high bit
+    key_matrix_stats_t stats;
+} key_matrix_t;
+
+/**
+ * @brief Sets up a rows x cols grid: rows as outputs selected one at a
+ * time, columns as inputs pulled to the inactive level.
+ *
+ * @param km Pointer to scanner instance
+ * @param rows Row pins (at most KEY_MATRIX_MAX_ROWS)
+ * @param row_count Number of rows
+ * @param cols Column pins (at most KEY_MATRIX_MAX_COLS)
+ * @param col_count Number of columns
+ * @param active Level a row is driven to, and a closed key reads (LOW with pull-ups)
+ * @return false if the grid has no keys or more than KEY_MATRIX_MAX_KEYS
+ */
+bool key_matrix_init(key_matrix_t* km, const pin_t* rows, uint8_t row_count, const pin_t* cols, uint8_t col_count,
+                     uint8_t active);
+
+/**
+ * @brief Sets up a bank of direct pins, one key each, read without a row select.
+ *
+ * The pins' pulls are left alone (board resistors, or the caller's pinMode()).
+ *
+ * @param active Level a pressed key reads
+ * @return false if there are no pins or more than KEY_MATRIX_MAX_COLS
+ */
+bool key_matrix_init_direct(key_matrix_t* km, const pin_t* pins, uint8_t count, uint8_t active);
+
+/**
+ * @brief Resets the debounce state for `key_count` keys, all released,
+ * without touching any pin.
+ *
+ * Used by the init functions and to feed a detached scanner from
+ * recorded or synthetic samples (see key_matrix_update()).
+ */
+void key_matrix_reset(key_matrix_t* km, uint8_t key_count);
+
+/**
+ * @brief Assigns the key change callback.
+ */
+void key_matrix_set_callback(key_matrix_t* km, key_matrix_callback_t cb, void* ctx);
+
+/**
+ * @brief Samples every key once into `raw` (bit set = closed).
+ *
+ * @param raw KEY_MATRIX_WORDS words; bits past key_count are cleared
+ */
+void key_matrix_read(const key_matrix_t* km, uint32_t* raw);
+
+/**
+ * @brief Debounces one raw sample of every key and emits the changes.
+ *
+ * @param raw KEY_MATRIX_WORDS words as filled by key_matrix_read()
+ * @param now_us Time the sample was taken, passed to the callback
+ * @return Number of keys that changed
+ */
+uint8_t key_matrix_update(key_matrix_t* km, const uint32_t* raw, uint32_t now_us);
+
+/**
+ * @brief key_matrix_read() then key_matrix_update(); call it at a fixed rate.
+ */
+uint8_t key_matrix_scan(key_matrix_t* km, uint32_t now_us);
+
+/**
+ * @brief Debounced state of one key.
+ */
+static inline bool key_matrix_pressed(const key_matrix_t* km, uint8_t key) {
+    return key < km->key_count && ((km->state[key >> 5] >> (key & 31)) & 1);
+}
+
+/**
+ * @brief Drives every row (or releases them again) while scanning is paused.
+ *
+ * With all rows selected any key pulls its column to the active level,
+ * so the columns alone can wake the chip from light sleep. No-op for
+ * direct pins.
+ */
+void key_matrix_select_all(key_matrix_t* km, bool select);
+
+/**
+ * @brief Copies the counters and the number of keys down.
+ */
+void key_matrix_get_stats(const key_matrix_t* km, key_matrix_stats_t* stats);
+
+#endif  // __KEY_MATRIX_H__
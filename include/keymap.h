@@ -0,0 +1,198 @@
+#ifndef __KEYMAP_H__
+#define __KEYMAP_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+static constexpr uint8_t KEYMAP_MAX_LAYERS = 4;
+static constexpr uint8_t KEYMAP_MAX_BUTTONS = 8;
+static constexpr uint8_t KEYMAP_MAX_ENCODERS = 2;
+
+/**
+ * @brief What a button does while a layer is active.
+ */
+typedef enum keymap_action_type {
+    KEYMAP_ACTION_TRANSPARENT = 0,  ///< Use the next lower active layer (zero-initialized entries)
+    KEYMAP_ACTION_NONE,             ///< Do nothing, do not fall through
+    KEYMAP_ACTION_TAP,              ///< Tap `key` on press
+    KEYMAP_ACTION_HOLD,             ///< Hold `key` while pressed
+    KEYMAP_ACTION_REPEAT,           ///< Tap `key` after `delay_us`, then every `interval_us` while pressed
+    KEYMAP_ACTION_TOGGLE_LAYER,     ///< Toggle `layer` on press, ignoring presses within `delay_us`
+    KEYMAP_ACTION_LAYER_HOLD,       ///< `layer` active while pressed
+    KEYMAP_ACTION_TAP_HOLD,         ///< Tap `key` if released within `delay_us`, otherwise hold `alt`
+} keymap_action_type_t;
+
+/**
+ * @brief Kind of input an output was caused by.
+ */
+typedef enum keymap_input {
+    KEYMAP_INPUT_BUTTON = 0,
+    KEYMAP_INPUT_ENCODER,
+} keymap_input_t;
+
+typedef struct keymap_action {
+    uint8_t type;           ///< keymap_action_type_t
+    uint8_t key;            ///< Key code (BleKeyboard/hid_composer codes)
+    uint8_t alt;            ///< Hold key of TAP_HOLD
+    uint8_t layer;          ///< Layer of TOGGLE_LAYER/LAYER_HOLD
+    uint32_t delay_us;      ///< REPEAT first delay, TAP_HOLD term, TOGGLE_LAYER lockout
+    uint32_t interval_us;   ///< REPEAT interval
+} keymap_action_t;
+
+/**
+ * @brief Encoder position thresholds: hold `positive` while the position
+ * counted since the last layer change is >= threshold, `negative` while
+ * it is <= -threshold. A threshold of 0 is transparent.
+ */
+typedef struct keymap_axis {
+    uint8_t positive;
+    uint8_t negative;
+    int32_t threshold;
+} keymap_axis_t;
+
+/**
+ * @brief Action run when every button in `buttons` goes down within the combo term.
+ */
+typedef struct keymap_combo {
+    uint8_t buttons;        ///< Bit per button index
+    keymap_action_t action;
+} keymap_combo_t;
+
+typedef struct keymap_layer {
+    keymap_action_t buttons[KEYMAP_MAX_BUTTONS];
+    keymap_axis_t encoders[KEYMAP_MAX_ENCODERS];
+} keymap_layer_t;
+
+/**
+ * @brief A complete keymap; meant to be a constexpr table in flash.
+ */
+typedef struct keymap {
+    const keymap_layer_t* layers;
+    uint8_t layer_count;
+    const keymap_combo_t* combos;
+    uint8_t combo_count;
+    uint32_t combo_term_us;  ///< Window in which combo members must all go down
+} keymap_t;
+
+// Table builders, usable in constexpr keymaps
+constexpr keymap_action_t keymap_trans() { return keymap_action_t{KEYMAP_ACTION_TRANSPARENT, 0, 0, 0, 0, 0}; }
+constexpr keymap_action_t keymap_none() { return keymap_action_t{KEYMAP_ACTION_NONE, 0, 0, 0, 0, 0}; }
+constexpr keymap_action_t keymap_tap(uint8_t key) { return keymap_action_t{KEYMAP_ACTION_TAP, key, 0, 0, 0, 0}; }
+constexpr keymap_action_t keymap_hold(uint8_t key) { return keymap_action_t{KEYMAP_ACTION_HOLD, key, 0, 0, 0, 0}; }
+constexpr keymap_action_t keymap_repeat(uint8_t key, uint32_t delay_us, uint32_t interval_us) {
+    return keymap_action_t{KEYMAP_ACTION_REPEAT, key, 0, 0, delay_us, interval_us};
+}
+constexpr keymap_action_t keymap_toggle_layer(uint8_t layer, uint32_t lockout_us) {
+    return keymap_action_t{KEYMAP_ACTION_TOGGLE_LAYER, 0, 0, layer, lockout_us, 0};
+}
+constexpr keymap_action_t keymap_layer_hold(uint8_t layer) {
+    return keymap_action_t{KEYMAP_ACTION_LAYER_HOLD, 0, 0, layer, 0, 0};
+}
+constexpr keymap_action_t keymap_tap_hold(uint8_t tap_key, uint8_t hold_key, uint32_t term_us) {
+    return keymap_action_t{KEYMAP_ACTION_TAP_HOLD, tap_key, hold_key, 0, term_us, 0};
+}
+constexpr keymap_axis_t keymap_axis_hold(uint8_t positive, uint8_t negative, int32_t threshold) {
+    return keymap_axis_t{positive, negative, threshold};
+}
+
+/**
+ * @brief Where the engine sends its output.
+ *
+ * `stamp` is the latency stamp of the input that caused the output, or 0
+ * (e.g. for repeats after the first).
+ */
+typedef struct keymap_output {
+    void (*press)(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp);
+    void (*release)(void* ctx, uint8_t key);
+    void (*tap)(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp);
+    void (*layer)(void* ctx, uint8_t layer, bool active);  ///< Optional
+    void* ctx;
+} keymap_output_t;
+
+typedef struct keymap_button_state {
+    bool down;
+    bool pending;           ///< Waiting for the combo term before resolving
+    bool timer;             ///< `due_us` is armed
+    bool tap_hold_decided;  ///< TAP_HOLD turned into a hold
+    int8_t combo;           ///< Combo this button is part of while down, -1 if none
+    keymap_action_t action; ///< Resolved at press time, so layer changes don't strand keys
+    uint32_t due_us;
+    uint32_t stamp;         ///< Latency stamp not yet attached to an output
+} keymap_button_state_t;
+
+typedef struct keymap_encoder_state {
+    int32_t position;       ///< Detents since the last layer change
+    uint8_t held;           ///< Key currently held by the axis, 0 if none
+} keymap_encoder_state_t;
+
+/**
+ * @brief Keymap evaluator. Each input is O(1): a bounded walk over at most
+ * KEYMAP_MAX_LAYERS layers and the combo table, with no allocation.
+ */
+typedef struct keymap_engine {
+    const keymap_t* map;
+    keymap_output_t out;
+    uint8_t layers;         ///< Bit per active layer; layer 0 is always active
+    uint8_t combo_members;  ///< Buttons that take part in any combo
+    uint32_t last_toggle_us; ///< Last TOGGLE_LAYER; 0 (boot) until the first
+    keymap_button_state_t buttons[KEYMAP_MAX_BUTTONS];
+    keymap_encoder_state_t encoders[KEYMAP_MAX_ENCODERS];
+} keymap_engine_t;
+
+/**
+ * @brief Initializes the engine with layer 0 active.
+ *
+ * @param km Pointer to engine instance
+ * @param map Keymap (must outlive the engine)
+ * @param out Output callbacks (copied)
+ * @return false if `map` has no layers or more than KEYMAP_MAX_LAYERS
+ */
+bool keymap_init(keymap_engine_t* km, const keymap_t* map, const keymap_output_t* out);
+
+/**
+ * @brief Feeds a debounced button edge.
+ *
+ * @param km Pointer to engine instance
+ * @param button Button index (< KEYMAP_MAX_BUTTONS)
+ * @param down true on press
+ * @param now_us Time of the edge
+ * @param stamp Latency stamp of the edge, or 0
+ * @return Microseconds until keymap_tick() is due, 0 if no timer is armed
+ */
+uint32_t keymap_button(keymap_engine_t* km, uint8_t button, bool down, uint32_t now_us, uint32_t stamp);
+
+/**
+ * @brief Feeds encoder movement.
+ *
+ * @param km Pointer to engine instance
+ * @param encoder Encoder index (< KEYMAP_MAX_ENCODERS)
+ * @param delta Detents since the previous call
+ * @param now_us Time of the movement
+ * @param stamp Latency stamp of the first detent, or 0
+ * @return Microseconds until keymap_tick() is due, 0 if no timer is armed
+ */
+uint32_t keymap_encoder(keymap_engine_t* km, uint8_t encoder, int32_t delta, uint32_t now_us, uint32_t stamp);
+
+/**
+ * @brief Runs expired timers (repeats, tap-hold terms, combo terms).
+ *
+ * @return Microseconds until the next timer, 0 if none is armed
+ */
+uint32_t keymap_tick(keymap_engine_t* km, uint32_t now_us);
+
+/**
+ * @brief Turns a layer on or off (layer 0 cannot be turned off).
+ */
+void keymap_set_layer(keymap_engine_t* km, uint8_t layer, bool active);
+
+/**
+ * @brief Returns true if `layer` is active.
+ */
+bool keymap_layer_active(const keymap_engine_t* km, uint8_t layer);
+
+/**
+ * @brief Returns the encoder position counted since the last layer change.
+ */
+int32_t keymap_get_position(const keymap_engine_t* km, uint8_t encoder);
+
+#endif  // __KEYMAP_H__
@@ -0,0 +1,99 @@
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#endif
+
+// Build with -DLATENCY_TRACE=0 to compile every stamp and record out.
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE 1
+#endif
+
+/**
+ * @brief Input sources traced from ISR edge to HID report hand-off.
+ */
+typedef enum latency_source {
+    LATENCY_SRC_BUTTON = 0,  ///< BTN_1 edge -> first 'D' report (includes the repeat delay)
+    LATENCY_SRC_ENCODER,     ///< Encoder detent -> W/S report
+    LATENCY_SRC_WAKE,        ///< Light-sleep GPIO wake -> first report after it
+    LATENCY_SRC_COUNT,
+} latency_source_t;
+
+// Log-linear buckets: 4 per power of two, 1 us .. ~1 s, plus one overflow bucket
+static constexpr uint8_t LATENCY_SUB_BUCKET_BITS = 2;
+static constexpr uint8_t LATENCY_OCTAVES = 20;
+static constexpr uint8_t LATENCY_BUCKETS = (LATENCY_OCTAVES << LATENCY_SUB_BUCKET_BITS) + 1;
+
+typedef struct latency_histogram {
+    uint32_t counts[LATENCY_BUCKETS];
+    uint32_t samples;
+    uint32_t max_us;
+} latency_histogram_t;
+
+typedef struct latency_summary {
+    uint32_t samples;
+    uint32_t p50_us;  ///< Upper bound of the bucket holding the median
+    uint32_t p99_us;  ///< Upper bound of the bucket holding the 99th percentile
+    uint32_t max_us;  ///< Exact maximum
+} latency_summary_t;
+
+/**
+ * @brief Returns a start stamp in microseconds.
+ *
+ * Cheap enough for ISRs. Taken from esp_timer rather than the CPU cycle
+ * counter, which stops during light sleep: an input that wakes the chip
+ * is timed across the sleep instead of by cycles that never ran. Returns
+ * 0 when tracing is compiled out; 0 is treated as "no stamp" everywhere.
+ */
+static inline uint32_t latency_stamp(void) {
+#if LATENCY_TRACE
+#if defined(ARDUINO_ARCH_ESP32)
+    uint32_t stamp = (uint32_t)esp_timer_get_time();
+#else
+    uint32_t stamp = micros();
+#endif
+    return stamp ? stamp : 1;
+#else
+    return 0;
+#endif
+}
+
+#if LATENCY_TRACE
+
+/**
+ * @brief Adds one sample (now - start_stamp) to the source's histogram.
+ *
+ * Allocation-free and O(1); stamps of 0 are ignored.
+ */
+void latency_record(latency_source_t source, uint32_t start_stamp);
+
+/**
+ * @brief Summarizes one source's histogram.
+ */
+void latency_get_summary(latency_source_t source, latency_summary_t* summary);
+
+/**
+ * @brief Clears every histogram.
+ */
+void latency_reset(void);
+
+#else
+
+static inline void latency_record(latency_source_t, uint32_t) {}
+static inline void latency_get_summary(latency_source_t, latency_summary_t* summary) {
+    if (summary) memset(summary, 0, sizeof(*summary));
+}
+static inline void latency_reset(void) {}
+
+#endif  // LATENCY_TRACE
+
+/**
+ * @brief Short name of a source for reports.
+ */
+const char* latency_source_name(latency_source_t source);
+
+#endif  // __LATENCY_H__
@@ -0,0 +1,165 @@
+#ifndef __LED_COMPOSITOR_H__
+#define __LED_COMPOSITOR_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+static constexpr uint8_t LED_MAX_LAYERS = 4;
+static constexpr uint16_t LED_MAX_PIXELS = 1024;
+static constexpr uint8_t LED_DEFAULT_BRIGHTNESS = 255;
+
+typedef struct led_rgb {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} led_rgb_t;
+
+/**
+ * @brief What a layer draws over its pixel range.
+ */
+typedef enum led_effect {
+    LED_EFFECT_OFF = 0,
+    LED_EFFECT_SOLID,       ///< Constant color
+    LED_EFFECT_PULSE,       ///< Triangle-wave breathing, one cycle per period
+    LED_EFFECT_BLINK,       ///< On for the first half of each period
+    LED_EFFECT_CHASE,       ///< One lit pixel per period step, with a fading tail
+} led_effect_t;
+
+/**
+ * @brief How a layer combines with the layers below it.
+ */
+typedef enum led_blend {
+    LED_BLEND_OVER = 0,     ///< Cross-fade by coverage x alpha
+    LED_BLEND_ADD,          ///< Saturating add, scaled by coverage x alpha
+} led_blend_t;
+
+typedef struct led_layer {
+    uint8_t effect;         ///< led_effect_t
+    uint8_t blend;          ///< led_blend_t
+    led_rgb_t color;
+    uint16_t first;         ///< First pixel covered
+    uint16_t count;         ///< Pixels covered
+    uint32_t period_ms;     ///< Pulse/blink cycle, chase lap
+    uint8_t tail;           ///< Chase: trailing pixels
+    uint32_t started_ms;    ///< Phase origin of the effect
+
+    uint8_t alpha;          ///< Opacity, 255 = opaque
+    uint8_t fade_from;
+    uint8_t fade_to;
+    uint32_t fade_started_ms;
+    uint32_t fade_ms;       ///< 0 when no fade is running
+} led_layer_t;
+
+typedef struct led_compositor_stats {
+    uint32_t frames;        ///< led_compositor_compose() calls
+    uint32_t composed;      ///< Frames actually recomposited
+    uint32_t changed;       ///< Frames whose output differed from the previous one
+} led_compositor_stats_t;
+
+/**
+ * @brief Layered LED framebuffer.
+ *
+ * Layers are composited bottom (index 0) to top into a linear RGB frame
+ * with 8-bit fixed-point blending. The result goes through a per-brightness
+ * gamma LUT, and only pixels whose output changed are reported through the
+ * dirty range. When no layer is animated and nothing was reconfigured, a
+ * compose is skipped outright. The cost of a frame is linear in the pixel
+ * count: each layer touches only its own range (a chase only its lit pixels).
+ */
+typedef struct led_compositor {
+    led_rgb_t* frame;               ///< Linear composite
+    led_rgb_t* out;                 ///< Gamma- and brightness-corrected output
+    uint16_t count;
+    uint8_t brightness;
+    uint8_t lut[256];               ///< gamma(v * brightness)
+    led_layer_t layers[LED_MAX_LAYERS];
+    bool dirty;                     ///< Layers changed since the last compose
+    bool refresh;                   ///< Report every pixel on the next compose
+    uint16_t dirty_first;           ///< Changed output pixels of the last compose:
+    uint16_t dirty_end;             ///< [dirty_first, dirty_end), empty if equal
+    led_compositor_stats_t stats;
+} led_compositor_t;
+
+/**
+ * @brief Allocates the buffers; every layer starts off.
+ *
+ * @param comp Pointer to compositor instance
+ * @param count Pixels (1..LED_MAX_PIXELS)
+ * @return false if `count` is out of range or memory ran out
+ */
+bool led_compositor_init(led_compositor_t* comp, uint16_t count);
+
+/**
+ * @brief Releases the buffers.
+ */
+void led_compositor_free(led_compositor_t* comp);
+
+/**
+ * @brief Sets the global brightness (rebuilds the LUT if it changed).
+ */
+void led_compositor_set_brightness(led_compositor_t* comp, uint8_t brightness);
+
+/**
+ * @brief Makes the next compose recomposite and report every pixel.
+ */
+void led_compositor_invalidate(led_compositor_t* comp);
+
+/**
+ * @brief Recomposites the frame if anything can have changed.
+ *
+ * @param comp Pointer to compositor instance
+ * @param now_ms Animation clock
+ * @return true if any output pixel changed (see dirty_first/dirty_end)
+ */
+bool led_compositor_compose(led_compositor_t* comp, uint32_t now_ms);
+
+/**
+ * @brief Configures a layer. Setting the configuration it already has is a
+ * no-op, so callers may re-apply it on every tick; a changed effect restarts
+ * its phase at `now_ms`.
+ *
+ * @param comp Pointer to compositor instance
+ * @param index Layer (0 = bottom)
+ * @param effect What to draw
+ * @param color Effect color
+ * @param first First pixel covered (clipped to the strip)
+ * @param count Pixels covered (clipped to the strip)
+ * @param period_ms Pulse/blink cycle or chase lap time (ignored for solid)
+ * @param now_ms Animation clock
+ */
+void led_layer_set(led_compositor_t* comp, uint8_t index, led_effect_t effect, led_rgb_t color,
+                   uint16_t first, uint16_t count, uint32_t period_ms, uint32_t now_ms);
+
+/**
+ * @brief Sets the chase tail length (pixels behind the head, fading out).
+ */
+void led_layer_set_tail(led_compositor_t* comp, uint8_t index, uint8_t tail);
+
+/**
+ * @brief Sets how a layer combines with those below it.
+ */
+void led_layer_set_blend(led_compositor_t* comp, uint8_t index, led_blend_t blend);
+
+/**
+ * @brief Sets a layer's opacity at once, cancelling any fade.
+ */
+void led_layer_set_alpha(led_compositor_t* comp, uint8_t index, uint8_t alpha);
+
+/**
+ * @brief Fades a layer's opacity linearly to `alpha` over `duration_ms`.
+ *
+ * A fade towards the target already being approached keeps running.
+ */
+void led_layer_fade(led_compositor_t* comp, uint8_t index, uint8_t alpha, uint32_t duration_ms, uint32_t now_ms);
+
+/**
+ * @brief Turns a layer off.
+ */
+void led_layer_off(led_compositor_t* comp, uint8_t index);
+
+/**
+ * @brief Output color of a pixel as of the last compose.
+ */
+led_rgb_t led_compositor_get(const led_compositor_t* comp, uint16_t index);
+
+#endif  // __LED_COMPOSITOR_H__
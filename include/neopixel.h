@@ -2,30 +2,108 @@
 #define __NEOPIXEL_H__
 
 #include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
 
+#include "led_compositor.h"
 #include "pin.h"
 
+// Build with -DNEOPIXEL_RMT=0 to fall back to the bit-banged Adafruit_NeoPixel output.
+#ifndef NEOPIXEL_RMT
+#define NEOPIXEL_RMT 1
+#endif
+
+#if NEOPIXEL_RMT
+#include <driver/rmt.h>
+#include "ws2812.h"
+#else
+#include <Adafruit_NeoPixel.h>
+#endif
+
 static constexpr uint32_t NEOPIXEL_DEFAULT_INTERVAL_MS = 200;
 
+#if NEOPIXEL_RMT
+static constexpr rmt_channel_t NEOPIXEL_RMT_CHANNEL = RMT_CHANNEL_0;
+static constexpr uint8_t NEOPIXEL_RMT_CLK_DIV = 2;         // 80 MHz APB / 2 = 25 ns ticks
+static constexpr uint32_t NEOPIXEL_RMT_TICK_NS = 25;
+#endif
+
+/**
+ * @brief Runs once a frame has been latched by the strip: in interrupt
+ * context with the RMT output, right after show() otherwise.
+ */
+typedef void (*neopixel_done_fn)(void* ctx);
+
+/**
+ * @brief NeoPixel strip driven by a layer compositor.
+ *
+ * Effects are configured on `leds` (see led_compositor.h); each step
+ * composes the frame and only pushes it to the strip when an output pixel
+ * changed.
+ *
+ * With NEOPIXEL_RMT the frame is pre-encoded into RMT symbols and sent in
+ * the background, so a step returns as soon as the frame is queued and no
+ * interrupts are masked while it is on the wire. Two symbol buffers
+ * alternate: one is being sent while the next frame is encoded into the
+ * other. Each buffer only re-encodes the pixels that changed since it was
+ * last filled. A frame composed while the previous one is still being
+ * sent waits in its buffer (newer frames replace it) and goes out on the
+ * next step or neopixel_flush() after the transmission ends.
+ */
 typedef struct neopixel {
+#if NEOPIXEL_RMT
+    ws2812_encoder_t encoder;
+    ws2812_symbol_t* symbols[2];    ///< Encoded frames
+    uint16_t stale_first[2];        ///< Pixels changed since each buffer was encoded:
+    uint16_t stale_end[2];          ///< [stale_first, stale_end), empty if equal
+    uint8_t back;                   ///< Buffer the next frame is encoded into
+    bool pending;                   ///< The back buffer holds a frame not yet sent
+    volatile bool busy;             ///< A frame is on the wire
+    bool ready;
+#else
     Adafruit_NeoPixel* strip;
+#endif
     pin_t pin;
     uint16_t count;
     uint32_t interval_ms;
     uint32_t last_update_ms;
-    uint16_t active_pixel;
-    uint8_t color_index;
+    led_compositor_t leds;
+    uint32_t shows;             ///< Frames pushed to the strip
+    uint32_t skipped;           ///< Steps whose frame was unchanged
+    uint32_t deferred;          ///< Frames that had to wait for the previous transmission
+    neopixel_done_fn on_done;
+    void* done_ctx;
 } neopixel_t;
 
+typedef struct neopixel_stats {
+    bool initialized;
+    uint16_t count;
+    uint32_t interval_ms;
+    uint32_t shows;
+    uint32_t skipped;
+    uint32_t deferred;
+    bool busy;
+} neopixel_stats_t;
+
 bool neopixel_init(neopixel_t* neo, pin_t pin, uint16_t count);
 void neopixel_process(neopixel_t* neo);
+void neopixel_step(neopixel_t* neo);  // compose one frame now, ignoring interval_ms
+void neopixel_invalidate(neopixel_t* neo);  // push the next frame even if unchanged
 void neopixel_set_interval(neopixel_t* neo, uint32_t interval_ms);
 void neopixel_shutdown(neopixel_t* neo);
-void neopixel_get_state(const neopixel_t* neo,
-                        uint16_t* active_pixel,
-                        uint8_t* color_index,
-                        uint32_t* interval_ms,
-                        bool* initialized);
+void neopixel_get_stats(const neopixel_t* neo, neopixel_stats_t* stats);
+
+/**
+ * @brief Sends a frame left waiting by a busy transmission, if the line is free now.
+ */
+void neopixel_flush(neopixel_t* neo);
+
+/**
+ * @brief True while a frame is being sent (always false for the bit-banged output).
+ */
+bool neopixel_busy(const neopixel_t* neo);
+
+/**
+ * @brief Sets the callback run after each frame is latched (NULL removes it).
+ */
+void neopixel_set_done_callback(neopixel_t* neo, neopixel_done_fn fn, void* ctx);
 
 #endif // __NEOPIXEL_H__
@@ -0,0 +1,162 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static constexpr uint8_t SCHEDULER_MAX_JOBS = 12;
+
+/**
+ * @brief Per-job timing statistics (all times in microseconds).
+ */
+typedef struct scheduler_job_stats {
+    uint32_t runs;
+    uint32_t last_run_us;   ///< Duration of the latest run
+    uint32_t max_run_us;    ///< Longest run
+    uint32_t total_run_us;  ///< Sum of all runs (wraps after ~71 min of CPU time)
+    uint32_t last_late_us;  ///< Start delay of the latest run
+    uint32_t max_late_us;   ///< Worst start delay (deadline or trigger to start)
+} scheduler_job_stats_t;
+
+typedef struct scheduler_job {
+    const char* name;
+    void (*fn)(void* ctx);
+    void* ctx;
+    uint32_t period_us;          ///< 0 = runs only when triggered or scheduled
+    uint32_t due_us;             ///< Next deadline (valid while armed)
+    bool armed;
+    volatile bool triggered;     ///< Set by scheduler_trigger*()
+    volatile uint32_t trigger_us;///< When the pending trigger was raised
+    scheduler_job_stats_t stats;
+} scheduler_job_t;
+
+/**
+ * @brief Deadline-based cooperative scheduler for loop().
+ *
+ * Jobs run either periodically, at a one-shot deadline, or when triggered
+ * (typically from an ISR). scheduler_run() executes whatever is due and then
+ * sleeps exactly until the next deadline or the next trigger, instead of a
+ * fixed delay.
+ *
+ * The clock and the wait primitive are injectable so the scheduler can run
+ * against a virtual clock off-target; by default they are micros() and a
+ * FreeRTOS task notification on the task that called scheduler_init(),
+ * given at the deadline by a one-shot esp_timer.
+ */
+typedef struct scheduler {
+    scheduler_job_t jobs[SCHEDULER_MAX_JOBS];
+    uint8_t job_count;
+    uint32_t (*now_us)(void);
+    void (*wait_us)(struct scheduler* sched, uint32_t timeout_us);
+    void* wait_ctx;              ///< User data for a custom wait_us
+    TaskHandle_t waiter;         ///< Task woken by triggers
+    esp_timer_handle_t timer;    ///< Wakes the waiter at the deadline (created on first wait)
+    uint32_t idle_us;            ///< Time spent waiting
+} scheduler_t;
+
+/**
+ * @brief Initializes the scheduler.
+ *
+ * @param sched Pointer to scheduler instance
+ * @param now_us Microsecond clock, or NULL for micros()
+ */
+void scheduler_init(scheduler_t* sched, uint32_t (*now_us)(void));
+
+/**
+ * @brief Replaces the wait primitive used between deadlines.
+ *
+ * @param sched Pointer to scheduler instance
+ * @param wait_us Function that blocks for at most `timeout_us` or until
+ *                woken, or NULL for the FreeRTOS default
+ * @param ctx Stored in `sched->wait_ctx` for `wait_us`
+ */
+void scheduler_set_wait(scheduler_t* sched, void (*wait_us)(scheduler_t* sched, uint32_t timeout_us), void* ctx);
+
+/**
+ * @brief The default wait: blocks on a task notification until a trigger
+ * or the deadline, for custom wait functions to fall back on.
+ *
+ * The deadline is an esp_timer one-shot, so waits shorter than an RTOS
+ * tick neither spin nor end a tick late.
+ */
+void scheduler_wait_default(scheduler_t* sched, uint32_t timeout_us);
+
+/**
+ * @brief Registers a job.
+ *
+ * @param sched Pointer to scheduler instance
+ * @param name Short label used in statistics
+ * @param fn Job body
+ * @param ctx User data passed to `fn`
+ * @param period_us Run period, or 0 for trigger/schedule-only jobs
+ * @return Job id (>= 0), or -1 if the table is full
+ */
+int scheduler_add(scheduler_t* sched, const char* name, void (*fn)(void* ctx), void* ctx, uint32_t period_us);
+
+/**
+ * @brief Requests a job to run as soon as possible (task context).
+ */
+void scheduler_trigger(scheduler_t* sched, int job);
+
+/**
+ * @brief Requests a job to run as soon as possible and wakes the waiter (ISR context).
+ */
+void scheduler_trigger_from_isr(scheduler_t* sched, int job);
+
+/**
+ * @brief Requests a job to run as soon as possible and wakes the waiter
+ * (another task, e.g. a protocol stack's callbacks).
+ */
+void scheduler_trigger_from_task(scheduler_t* sched, int job);
+
+/**
+ * @brief Arms a one-shot (or re-phases a periodic) deadline `delay_us` from now.
+ */
+void scheduler_schedule_in(scheduler_t* sched, int job, uint32_t delay_us);
+
+/**
+ * @brief Changes a job's period (0 makes it trigger/schedule-only).
+ *
+ * Takes effect after the pending deadline; a job with no deadline armed
+ * stays disarmed until the next scheduler_schedule_in().
+ */
+void scheduler_set_period(scheduler_t* sched, int job, uint32_t period_us);
+
+/**
+ * @brief Disarms a job's pending deadline and trigger.
+ *
+ * Periodic jobs are re-armed by the next scheduler_schedule_in().
+ */
+void scheduler_cancel(scheduler_t* sched, int job);
+
+/**
+ * @brief Runs every job that is due or triggered, once.
+ *
+ * @param sched Pointer to scheduler instance
+ * @return Microseconds until the next deadline (UINT32_MAX if none)
+ */
+uint32_t scheduler_run_pending(scheduler_t* sched);
+
+/**
+ * @brief Runs due jobs, then waits until the next deadline or trigger.
+ *
+ * Intended to be the whole body of loop().
+ */
+void scheduler_run(scheduler_t* sched);
+
+/**
+ * @brief Returns a job's statistics.
+ *
+ * @return Pointer to the stats, or NULL for an invalid id
+ */
+const scheduler_job_stats_t* scheduler_get_stats(const scheduler_t* sched, int job);
+
+/**
+ * @brief Clears the statistics of every job.
+ */
+void scheduler_reset_stats(scheduler_t* sched);
+
+#endif  // __SCHEDULER_H__
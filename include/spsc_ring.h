@@ -0,0 +1,85 @@
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring.
+ *
+ * One context (typically an ISR or acquisition task) pushes, one context
+ * (typically loop()) pops. Neither side ever blocks: a push into a full
+ * ring is rejected and counted in `overruns`, so producers in interrupt
+ * context stay bounded.
+ *
+ * Head and tail are free-running 32-bit counters; N must be a power of two.
+ */
+template <typename T, size_t N>
+struct spsc_ring {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "spsc_ring capacity must be a power of two");
+
+    T items[N];
+    std::atomic<uint32_t> head;      ///< Next slot to write (producer-owned)
+    std::atomic<uint32_t> tail;      ///< Next slot to read (consumer-owned)
+    std::atomic<uint32_t> overruns;  ///< Pushes rejected because the ring was full
+};
+
+/**
+ * @brief Empties the ring and clears its overrun counter.
+ *
+ * Not safe while a producer or consumer is active.
+ */
+template <typename T, size_t N>
+inline void spsc_ring_reset(spsc_ring<T, N>* ring) {
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->overruns.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Appends an item (producer side).
+ *
+ * @return true if stored, false if the ring was full (counted as overrun)
+ */
+template <typename T, size_t N>
+inline bool spsc_ring_push(spsc_ring<T, N>* ring, const T& item) {
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    if ((uint32_t)(head - tail) >= N) {
+        ring->overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ring->items[head & (N - 1)] = item;
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Removes the oldest item (consumer side).
+ *
+ * @return true if an item was written to `out`, false if the ring was empty
+ */
+template <typename T, size_t N>
+inline bool spsc_ring_pop(spsc_ring<T, N>* ring, T* out) {
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint32_t head = ring->head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *out = ring->items[tail & (N - 1)];
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Returns the number of items currently queued.
+ */
+template <typename T, size_t N>
+inline size_t spsc_ring_size(const spsc_ring<T, N>* ring) {
+    uint32_t head = ring->head.load(std::memory_order_acquire);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    return (size_t)(head - tail);
+}
+
+#endif  // __SPSC_RING_H__
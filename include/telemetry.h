@@ -0,0 +1,132 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "websocket.h"
+
+static constexpr uint8_t TELEMETRY_VERSION = 1;
+static constexpr size_t TELEMETRY_STATUS_SIZE = 40;         // encoded status payload
+static constexpr size_t TELEMETRY_KEY_SIZE = 8;             // encoded key event payload
+static constexpr size_t TELEMETRY_MAX_PAYLOAD = 64;
+static constexpr size_t TELEMETRY_MAX_FRAME = WS_MAX_HEADER + TELEMETRY_MAX_PAYLOAD;
+static constexpr uint8_t TELEMETRY_QUEUE_CAPACITY = 8;      // frames per client
+static constexpr uint16_t TELEMETRY_MAX_RATE_HZ = 100;
+static constexpr uint16_t TELEMETRY_DEFAULT_RATE_HZ = 20;
+
+/**
+ * @brief Frame kinds; the first payload byte of every binary frame.
+ */
+typedef enum telemetry_kind {
+    TELEMETRY_KIND_STATUS = 1,      ///< Periodic snapshot; a newer one replaces an unsent one
+    TELEMETRY_KIND_KEY,             ///< Key event; never coalesced
+    TELEMETRY_KIND_CONTROL,         ///< Text replies, pong and close; never coalesced
+} telemetry_kind_t;
+
+static constexpr uint8_t TELEMETRY_FLAG_GATE = 0x01;
+static constexpr uint8_t TELEMETRY_FLAG_BUTTON = 0x02;
+static constexpr uint8_t TELEMETRY_FLAG_BLE = 0x04;
+
+/**
+ * @brief What the dashboard shows, as sampled by the firmware.
+ */
+typedef struct telemetry_sample {
+    uint32_t time_ms;
+    int32_t encoder;            ///< Encoder position
+    uint8_t flags;              ///< TELEMETRY_FLAG_*
+    float accel_g[3];
+    float gyro_dps[3];
+    float roll;                 ///< Degrees
+    float pitch;
+    float yaw;
+    float temp_c;
+    uint32_t input_late_us;     ///< Input job start delay, latest run
+    uint32_t input_max_late_us; ///< Worst start delay
+    uint32_t input_max_run_us;  ///< Longest input job run
+    uint32_t hid_sent;          ///< HID reports sent
+} telemetry_sample_t;
+
+/**
+ * @brief Encodes a status frame payload (little endian, TELEMETRY_STATUS_SIZE bytes).
+ *
+ *   0 u8  kind (TELEMETRY_KIND_STATUS)   1 u8  flags
+ *   2 u16 sequence                       4 u32 time_ms
+ *   8 i32 encoder                       12 i16 accel x/y/z, mg
+ *  18 i16 gyro x/y/z, 0.1 dps           24 i16 roll/pitch/yaw, 0.01 deg
+ *  30 i16 temperature, 0.01 C           32 u16 input late, max late, max run (us)
+ *  38 u16 HID reports sent (wraps)
+ *
+ * Values that do not fit saturate.
+ *
+ * @return Bytes written
+ */
+size_t telemetry_encode_status(const telemetry_sample_t* sample, uint16_t seq, uint8_t* out);
+
+/**
+ * @brief Encodes a key event payload (TELEMETRY_KEY_SIZE bytes).
+ *
+ *   0 u8 kind (TELEMETRY_KIND_KEY)   1 u8 action (trace_key_action_t)
+ *   2 u8 key                         3 u8 reserved
+ *   4 u32 time_ms
+ *
+ * @return Bytes written
+ */
+size_t telemetry_encode_key(uint8_t key, uint8_t action, uint32_t time_ms, uint8_t* out);
+
+typedef struct telemetry_frame {
+    uint8_t data[TELEMETRY_MAX_FRAME];  ///< WebSocket header + payload
+    uint8_t len;
+    uint8_t kind;                       ///< telemetry_kind_t
+} telemetry_frame_t;
+
+typedef struct telemetry_queue_stats {
+    uint32_t queued;        ///< Frames accepted
+    uint32_t coalesced;     ///< Status frames that replaced an unsent one
+    uint32_t dropped;       ///< Frames evicted to make room (oldest first)
+    uint32_t sent;          ///< Frames fully written to the socket
+    uint32_t bytes;         ///< Bytes written to the socket
+} telemetry_queue_stats_t;
+
+/**
+ * @brief Per-client send queue with coalescing and drop-oldest backpressure.
+ *
+ * Frames are stored complete (WebSocket header included) so a send can
+ * resume mid-frame. A status frame replaces the newest unsent status
+ * frame instead of queueing behind it, so a slow client receives the
+ * latest snapshot rather than a backlog. When the queue is full the oldest
+ * frame that has not started going out is dropped; the frame being sent
+ * is never touched, which keeps the byte stream well formed.
+ */
+typedef struct telemetry_queue {
+    telemetry_frame_t frames[TELEMETRY_QUEUE_CAPACITY];
+    uint8_t head;
+    uint8_t count;
+    uint8_t offset;             ///< Bytes of the head frame already sent
+    telemetry_queue_stats_t stats;
+} telemetry_queue_t;
+
+void telemetry_queue_reset(telemetry_queue_t* queue);
+
+/**
+ * @brief Wraps `payload` in a WebSocket frame and queues it.
+ *
+ * @param opcode WS_OP_BINARY for telemetry, WS_OP_TEXT/PONG/CLOSE for control
+ * @return false if the payload is too long
+ */
+bool telemetry_queue_push(telemetry_queue_t* queue, telemetry_kind_t kind, uint8_t opcode,
+                          const uint8_t* payload, size_t len);
+
+/**
+ * @brief Unsent bytes at the head of the queue.
+ *
+ * @return Length of `*data`, 0 if the queue is empty
+ */
+size_t telemetry_queue_peek(const telemetry_queue_t* queue, const uint8_t** data);
+
+/**
+ * @brief Marks `len` bytes of the head frame as sent (pops it once complete).
+ */
+void telemetry_queue_consume(telemetry_queue_t* queue, size_t len);
+
+#endif  // __TELEMETRY_H__
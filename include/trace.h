@@ -0,0 +1,199 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "imu.h"
+#include "input_event.h"
+
+static constexpr uint32_t TRACE_FILE_MAGIC = 0x31525441;     // "ATR1"
+static constexpr uint32_t TRACE_CHUNK_MAGIC = 0x4B435254;    // "TRCK"
+static constexpr uint16_t TRACE_VERSION = 1;
+static constexpr size_t TRACE_FILE_HEADER_SIZE = 8;          // magic, version, reserved
+static constexpr size_t TRACE_CHUNK_HEADER_SIZE = 16;        // magic, length, count, base time, crc32
+static constexpr size_t TRACE_CHUNK_PAYLOAD = 1024;          // record bytes per chunk
+static constexpr size_t TRACE_CHUNK_SIZE = TRACE_CHUNK_HEADER_SIZE + TRACE_CHUNK_PAYLOAD;
+static constexpr uint8_t TRACE_CHUNK_SLOTS = 4;              // chunks buffered for the writer
+static constexpr size_t TRACE_RECORD_MAX = 32;               // worst-case encoded record
+static constexpr uint32_t TRACE_STACK_SIZE = 3072;           // writer task stack (bytes)
+static constexpr float TRACE_ACCEL_LSB_PER_G = 4096.0f;      // +-8 g range, as configured by imu_init()
+static constexpr float TRACE_GYRO_LSB_PER_DPS = 16.384f;     // +-2000 dps range
+
+/**
+ * @brief Record kinds stored in a trace.
+ */
+typedef enum trace_record_type {
+    TRACE_REC_EDGE = 1,     ///< Button/encoder edge as drained from an input queue
+    TRACE_REC_IMU,          ///< IMU sample (quantized to sensor LSBs, no temperature)
+    TRACE_REC_KEY,          ///< Key event emitted by the keymap
+    TRACE_REC_SYNC,         ///< Pin level when recording started (edge payload)
+} trace_record_type_t;
+
+typedef enum trace_key_action {
+    TRACE_KEY_PRESS = 0,
+    TRACE_KEY_RELEASE,
+    TRACE_KEY_TAP,
+} trace_key_action_t;
+
+typedef struct trace_key {
+    uint8_t key;
+    uint8_t action;         ///< trace_key_action_t
+} trace_key_t;
+
+/**
+ * @brief One decoded record.
+ */
+typedef struct trace_record {
+    uint8_t type;           ///< trace_record_type_t
+    uint32_t timestamp_us;
+    input_event_t edge;     ///< TRACE_REC_EDGE / TRACE_REC_SYNC (stamp is not stored)
+    imu_sample_t imu;       ///< TRACE_REC_IMU
+    trace_key_t key;        ///< TRACE_REC_KEY
+} trace_record_t;
+
+/**
+ * @brief Per-chunk delta state; reset at every chunk so chunks decode on their own.
+ */
+typedef struct trace_codec {
+    uint32_t last_us;
+    int16_t last_imu[6];    ///< ax ay az gx gy gz in sensor LSBs
+} trace_codec_t;
+
+typedef struct trace_recorder_stats {
+    uint32_t records;       ///< Records encoded
+    uint32_t dropped;       ///< Records lost because every chunk buffer was full
+    uint32_t chunks;        ///< Chunks handed to the sink
+    uint32_t bytes;         ///< Bytes handed to the sink
+    uint32_t write_errors;  ///< Sink failures
+} trace_recorder_stats_t;
+
+/**
+ * @brief Buffered trace writer.
+ *
+ * The producer (loop()) encodes records into the active chunk buffer. Full
+ * chunks are sealed with a CRC32 and handed to a writer task that calls
+ * the sink, so a slow flash write never stalls the producer; if all
+ * buffers are waiting for the sink, records are counted as dropped.
+ *
+ * Layout: file header (magic, version), then chunks of
+ * [magic u32][length u16][count u16][base time u32][crc32 u32][records].
+ * A record is [type u8][zig-zag varint time delta][payload]; IMU payloads
+ * are a flags byte plus zig-zag varint deltas of the six raw axes.
+ */
+typedef struct trace_recorder {
+    uint8_t chunks[TRACE_CHUNK_SLOTS][TRACE_CHUNK_SIZE];
+    uint16_t fill;                  ///< Payload bytes in the active chunk
+    uint16_t count;                 ///< Records in the active chunk
+    uint32_t base_us;               ///< Time of the first record in the active chunk
+    trace_codec_t codec;
+    std::atomic<uint32_t> sealed;   ///< Chunks sealed by the producer
+    std::atomic<uint32_t> written;  ///< Chunks consumed by the writer
+    bool header_written;
+    volatile bool active;
+
+    bool (*sink)(void* ctx, const uint8_t* data, size_t len);
+    void* sink_ctx;
+    TaskHandle_t task;
+
+    trace_recorder_stats_t stats;
+} trace_recorder_t;
+
+/**
+ * @brief Sequential trace decoder.
+ *
+ * Chunks with a bad magic, length or CRC are skipped by scanning for the
+ * next chunk magic, so a torn write loses at most one chunk.
+ */
+typedef struct trace_reader {
+    size_t (*read)(void* ctx, uint8_t* data, size_t len);
+    void* read_ctx;
+    uint8_t chunk[TRACE_CHUNK_PAYLOAD];
+    uint16_t length;
+    uint16_t offset;
+    uint16_t remaining;             ///< Records left in the current chunk
+    trace_codec_t codec;
+    uint32_t bad_chunks;            ///< Chunks skipped (bad header, CRC or contents)
+    bool header_checked;
+    bool ended;                     ///< Source exhausted or not a trace
+} trace_reader_t;
+
+/**
+ * @brief Prepares a recorder; no task is started.
+ *
+ * @param rec Pointer to recorder instance
+ * @param sink Called with file bytes in order; returns false on failure
+ * @param ctx User data passed to `sink`
+ */
+void trace_recorder_init(trace_recorder_t* rec, bool (*sink)(void* ctx, const uint8_t* data, size_t len), void* ctx);
+
+/**
+ * @brief Begins accepting records and starts the writer task on first use.
+ *
+ * Check `rec->active` for whether recording started: it does even if the
+ * task cannot be created, in which case trace_recorder_service() has to be
+ * called periodically instead.
+ *
+ * @return true if the writer task is running
+ */
+bool trace_recorder_start(trace_recorder_t* rec, uint8_t core, uint8_t priority);
+
+/**
+ * @brief Stops recording, seals the partial chunk and writes everything out.
+ *
+ * Blocks until the sink has received every sealed chunk.
+ */
+void trace_recorder_stop(trace_recorder_t* rec);
+
+/**
+ * @brief Writes sealed chunks to the sink (writer task, or manual polling).
+ *
+ * @return Number of chunks written
+ */
+size_t trace_recorder_service(trace_recorder_t* rec);
+
+/**
+ * @brief Records an edge drained from an input queue.
+ */
+void trace_record_edge(trace_recorder_t* rec, const input_event_t* event);
+
+/**
+ * @brief Records the level of a pin at the start of a recording.
+ */
+void trace_record_sync(trace_recorder_t* rec, uint32_t timestamp_us, uint8_t pin, uint8_t level);
+
+/**
+ * @brief Records an IMU sample.
+ */
+void trace_record_imu(trace_recorder_t* rec, const imu_sample_t* sample);
+
+/**
+ * @brief Records a key event.
+ */
+void trace_record_key(trace_recorder_t* rec, uint32_t timestamp_us, uint8_t key, trace_key_action_t action);
+
+/**
+ * @brief Prepares a reader over a byte source.
+ *
+ * @param reader Pointer to reader instance
+ * @param read Returns up to `len` bytes, 0 at end of data
+ * @param ctx User data passed to `read`
+ */
+void trace_reader_init(trace_reader_t* reader, size_t (*read)(void* ctx, uint8_t* data, size_t len), void* ctx);
+
+/**
+ * @brief Decodes the next record.
+ *
+ * @return false at the end of the trace (or if it is not a trace)
+ */
+bool trace_reader_next(trace_reader_t* reader, trace_record_t* record);
+
+/**
+ * @brief CRC-32 (IEEE, reflected) used for chunk payloads.
+ */
+uint32_t trace_crc32(const uint8_t* data, size_t len);
+
+#endif  // __TRACE_H__
@@ -0,0 +1,84 @@
+#ifndef __TRACE_REPLAY_H__
+#define __TRACE_REPLAY_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "input_pipeline.h"
+#include "keymap.h"
+#include "pin.h"
+#include "spsc_ring.h"
+#include "trace.h"
+
+static constexpr size_t TRACE_REPLAY_KEY_BACKLOG = 16;   // keys one side may run ahead of the other
+
+/**
+ * @brief What the recorded inputs were wired to.
+ */
+typedef struct trace_replay_config {
+    const keymap_t* keymap;
+    const input_pipeline_map_t* map;
+    pin_t button_pin;
+    pin_t encoder_pin_a;
+    pin_t encoder_pin_b;
+    pin_t encoder_pin_btn;
+    uint32_t poll_interval_us;      ///< Input job period the trace was recorded with
+} trace_replay_config_t;
+
+typedef struct trace_replay_result {
+    uint32_t records;       ///< Records decoded
+    uint32_t keys;          ///< Key events in the trace
+    uint32_t mismatched;    ///< Produced a different key or action
+    uint32_t missing;       ///< Recorded but not produced
+    uint32_t extra;         ///< Produced but not recorded
+    uint32_t bad_chunks;    ///< Chunks the reader skipped
+    uint32_t span_us;       ///< Trace time from the first record to the last
+    uint32_t took_us;       ///< Wall time of the replay
+} trace_replay_result_t;
+
+/**
+ * @brief Offline replay of a recorded trace.
+ *
+ * Recorded edges and IMU samples drive a private copy of the input
+ * pipeline on a virtual clock that advances in input-job periods, as fast
+ * as the trace can be read. Key events it produces are compared with the
+ * ones recorded live instead of being sent. The replay clock can put a
+ * repeat or hold deadline a few microseconds after the live one, so keys
+ * are paired in order but either side may come first.
+ *
+ * Replays start from the levels in the trace's sync records; keymap and
+ * gesture state start from scratch, so record from an idle device.
+ */
+typedef struct trace_replay {
+    button_t button;
+    encoder_t encoder;
+    keymap_engine_t keymap;
+    fusion_t orientation;
+    gesture_t gesture;
+    input_pipeline_t inputs;
+    trace_reader_t reader;
+    spsc_ring<trace_key_t, TRACE_REPLAY_KEY_BACKLOG> produced;   ///< Waiting for their recorded key
+    spsc_ring<trace_key_t, TRACE_REPLAY_KEY_BACKLOG> recorded;   ///< Waiting for their produced key
+    trace_replay_result_t result;
+} trace_replay_t;
+
+/**
+ * @brief Replays a whole trace and compares the keys.
+ *
+ * @param replay Pointer to replay instance (large: keep it static)
+ * @param config What the recorded inputs were wired to
+ * @param read Returns up to `len` trace bytes, 0 at end of data
+ * @param ctx User data passed to `read`
+ * @param result Filled with the comparison
+ * @return false if the keymap could not be loaded
+ */
+bool trace_replay_run(trace_replay_t* replay, const trace_replay_config_t* config,
+                      size_t (*read)(void* ctx, uint8_t* data, size_t len), void* ctx,
+                      trace_replay_result_t* result);
+
+/**
+ * @brief Prints a result as one "replay: ..." line.
+ */
+void trace_replay_print(const trace_replay_result_t* result, Print* out);
+
+#endif  // __TRACE_REPLAY_H__
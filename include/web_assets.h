@@ -0,0 +1,41 @@
+#ifndef __WEB_ASSETS_H__
+#define __WEB_ASSETS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A dashboard file compiled into flash by tools/embed_assets.py.
+ *
+ * `data` is stored gzipped when that is smaller (`gzip`), so it can be
+ * sent as-is with Content-Encoding: gzip straight from flash.
+ */
+typedef struct web_asset {
+    const char* path;           ///< URL path, e.g. "/index.html"
+    const char* content_type;
+    const char* etag;           ///< Quoted content hash, e.g. "\"0123456789abcdef\""
+    const uint8_t* data;
+    uint32_t size;              ///< Bytes in `data`
+    uint32_t raw_size;          ///< Size of the source file in data/
+    bool gzip;
+} web_asset_t;
+
+extern const web_asset_t web_assets[];
+extern const size_t web_asset_count;
+
+/**
+ * @brief Looks up an embedded asset ("/" finds /index.html).
+ *
+ * @return NULL if `path` is not embedded
+ */
+const web_asset_t* web_asset_find(const char* path);
+
+/**
+ * @brief Sums the flash footprint of every embedded asset.
+ *
+ * @param raw_size Receives the summed source size (may be NULL)
+ * @return Bytes linked into the firmware
+ */
+uint32_t web_assets_size(uint32_t* raw_size);
+
+#endif  // __WEB_ASSETS_H__
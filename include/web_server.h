@@ -0,0 +1,139 @@
+#ifndef __WEB_SERVER_H__
+#define __WEB_SERVER_H__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+#include "web_assets.h"
+
+// The native build listens on an unprivileged port (set in platformio.ini)
+#ifndef WEB_SERVER_PORT
+#define WEB_SERVER_PORT 80
+#endif
+
+// 1: serve the gzipped assets compiled in by tools/embed_assets.py;
+// 0: read data/ from LittleFS on every request
+#ifndef WEB_ASSETS_EMBEDDED
+#define WEB_ASSETS_EMBEDDED 1
+#endif
+
+static constexpr uint8_t WEB_MAX_CLIENTS = 4;               // HTTP and WebSocket connections together
+static constexpr size_t WEB_RX_BUFFER = 512;                // request head / inbound WebSocket frames
+static constexpr size_t WEB_TX_CHUNK = 512;                 // response head / file bytes per refill
+static constexpr size_t WEB_SEND_BUDGET = 2048;             // bytes per client per poll
+static constexpr int WEB_SOCKET_SNDBUF = 2920;               // lwIP's default TCP_SND_BUF (2 x MSS)
+static constexpr uint32_t WEB_HTTP_TIMEOUT_MS = 5000;       // idle plain-HTTP connections are closed
+static constexpr const char* WEB_SOCKET_PATH = "/ws";
+
+typedef enum web_client_state {
+    WEB_CLIENT_FREE = 0,
+    WEB_CLIENT_REQUEST,         ///< Reading the request head
+    WEB_CLIENT_RESPONSE,        ///< Sending a response (and file body), then closing
+    WEB_CLIENT_WEBSOCKET,       ///< Upgraded; telemetry flows through `queue`
+    WEB_CLIENT_CLOSING,         ///< WebSocket close queued; closed once it is sent
+} web_client_state_t;
+
+typedef struct web_client {
+    int fd;
+    uint8_t state;              ///< web_client_state_t
+    uint32_t last_active_ms;
+
+    uint8_t rx[WEB_RX_BUFFER];
+    size_t rx_len;
+
+    uint8_t tx[WEB_TX_CHUNK];   ///< Response bytes not yet sent
+    size_t tx_len;
+    size_t tx_off;
+    File file;                  ///< Body still to stream from LittleFS, if any
+    const uint8_t* body;        ///< Embedded body still to send, straight from flash
+    size_t body_len;
+    size_t body_off;
+
+    telemetry_queue_t queue;
+    uint32_t interval_ms;       ///< Status frame period for this client
+    uint32_t last_status_ms;
+    bool status_due;            ///< Send the next status frame regardless of the interval
+    uint16_t seq;               ///< Next status sequence number; a gap means frames were coalesced or dropped
+} web_client_t;
+
+typedef struct web_server_stats {
+    uint32_t accepted;          ///< Connections accepted
+    uint32_t rejected;          ///< Connections refused because every slot was taken
+    uint32_t requests;          ///< HTTP requests answered
+    uint32_t not_found;
+    uint32_t not_modified;      ///< 304s answered from an If-None-Match ETag
+    uint32_t upgrades;          ///< WebSocket handshakes completed
+    uint32_t published;         ///< Status snapshots offered to the server
+    uint8_t websockets;         ///< Open WebSocket clients
+    telemetry_queue_stats_t frames;  ///< Summed over every WebSocket client, past and present
+} web_server_stats_t;
+
+/**
+ * @brief Non-blocking HTTP + WebSocket server for the dashboard in data/.
+ *
+ * Everything happens in web_server_poll() on non-blocking sockets, so a
+ * slow or stalled browser costs a bounded amount of work per poll and
+ * never blocks the caller. Plain GETs are answered from the embedded
+ * assets (or LittleFS, see WEB_ASSETS_EMBEDDED; "/" serves /index.html)
+ * and closed. Embedded assets carry their content hash as ETag, so a
+ * matching If-None-Match gets a 304. GET WEB_SOCKET_PATH upgrades to a
+ * WebSocket that receives binary telemetry frames (see telemetry.h) at
+ * the client's rate through its own coalescing queue.
+ *
+ * Clients may send text commands: "getReadings" asks for a status frame
+ * right away and "rate N" sets the status rate in Hz (1..TELEMETRY_MAX_RATE_HZ).
+ *
+ * Uses BSD sockets, which lwIP provides on the ESP32, so the native build
+ * runs the same code against the host stack.
+ */
+typedef struct web_server {
+    int listen_fd;
+    uint16_t port;
+    uint16_t rate_hz;           ///< Status rate given to new clients
+    telemetry_sample_t latest;
+    bool have_sample;
+    web_client_t clients[WEB_MAX_CLIENTS];
+    web_server_stats_t stats;
+    telemetry_queue_stats_t closed;  ///< Queue stats of clients already gone
+} web_server_t;
+
+/**
+ * @brief Opens the listening socket.
+ *
+ * @param server Pointer to server instance
+ * @param port TCP port (WEB_SERVER_PORT)
+ * @param rate_hz Initial status rate for new clients
+ * @return false if the socket could not be opened
+ */
+bool web_server_begin(web_server_t* server, uint16_t port, uint16_t rate_hz);
+
+/**
+ * @brief Closes every connection and the listening socket.
+ */
+void web_server_end(web_server_t* server);
+
+/**
+ * @brief Accepts, reads and writes whatever the sockets allow right now.
+ */
+void web_server_poll(web_server_t* server, uint32_t now_ms);
+
+/**
+ * @brief Offers a snapshot; each client whose interval elapsed gets a status frame.
+ */
+void web_server_publish(web_server_t* server, const telemetry_sample_t* sample, uint32_t now_ms);
+
+/**
+ * @brief Queues a key event for every WebSocket client.
+ */
+void web_server_publish_key(web_server_t* server, uint8_t key, uint8_t action, uint32_t now_ms);
+
+/**
+ * @brief Sets the status rate of new and existing clients (clamped to 1..TELEMETRY_MAX_RATE_HZ).
+ */
+void web_server_set_rate(web_server_t* server, uint16_t rate_hz);
+
+void web_server_get_stats(const web_server_t* server, web_server_stats_t* stats);
+
+#endif  // __WEB_SERVER_H__
@@ -0,0 +1,72 @@
+#ifndef __WEBSOCKET_H__
+#define __WEBSOCKET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t WS_ACCEPT_KEY_LEN = 28;             // base64 of a SHA-1 digest
+static constexpr size_t WS_MAX_HEADER = 10;                 // server frames are never masked
+static constexpr size_t WS_MAX_CLIENT_HEADER = 14;          // client frames always are
+
+/**
+ * @brief RFC 6455 opcodes.
+ */
+typedef enum ws_opcode {
+    WS_OP_CONTINUATION = 0x0,
+    WS_OP_TEXT = 0x1,
+    WS_OP_BINARY = 0x2,
+    WS_OP_CLOSE = 0x8,
+    WS_OP_PING = 0x9,
+    WS_OP_PONG = 0xA,
+} ws_opcode_t;
+
+/**
+ * @brief One frame found in a receive buffer.
+ */
+typedef struct ws_frame {
+    uint8_t opcode;         ///< ws_opcode_t
+    bool fin;
+    uint8_t* payload;       ///< Unmasked in place, inside the parsed buffer
+    size_t length;
+} ws_frame_t;
+
+typedef enum ws_parse_result {
+    WS_PARSE_INCOMPLETE = 0,    ///< Need more bytes
+    WS_PARSE_FRAME,             ///< `frame` is valid
+    WS_PARSE_ERROR,             ///< Unmasked client frame, reserved bits or an oversized payload
+} ws_parse_result_t;
+
+/**
+ * @brief Computes Sec-WebSocket-Accept for a client's Sec-WebSocket-Key.
+ *
+ * @param key Key as sent by the client (no surrounding whitespace)
+ * @param key_len Length of `key`
+ * @param accept Receives WS_ACCEPT_KEY_LEN characters and a terminating NUL
+ */
+void ws_accept_key(const char* key, size_t key_len, char accept[WS_ACCEPT_KEY_LEN + 1]);
+
+/**
+ * @brief Writes the header of an unmasked, final server frame.
+ *
+ * @param out Room for WS_MAX_HEADER bytes
+ * @return Header length
+ */
+size_t ws_frame_header(uint8_t opcode, size_t payload_len, uint8_t* out);
+
+/**
+ * @brief Parses the first frame of a client-to-server byte stream.
+ *
+ * @param buf Received bytes; the payload is unmasked in place
+ * @param len Bytes in `buf`
+ * @param max_payload Largest payload accepted
+ * @param frame Receives the frame
+ * @param consumed Receives the frame's total length (header and payload)
+ */
+ws_parse_result_t ws_parse(uint8_t* buf, size_t len, size_t max_payload, ws_frame_t* frame, size_t* consumed);
+
+/**
+ * @brief SHA-1 of `len` bytes (used for the handshake only).
+ */
+void ws_sha1(const uint8_t* data, size_t len, uint8_t digest[20]);
+
+#endif  // __WEBSOCKET_H__
@@ -0,0 +1,90 @@
+#ifndef __WS2812_H__
+#define __WS2812_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_compositor.h"
+
+static constexpr uint8_t WS2812_SYMBOLS_PER_PIXEL = 24;     // one per bit, G-R-B, MSB first
+static constexpr uint16_t WS2812_MAX_DURATION = 0x7FFF;     // 15-bit symbol half
+
+/**
+ * @brief One peripheral symbol, laid out like an ESP32 RMT item.
+ *
+ * Bits 0-14 hold the first duration and bit 15 its level, bits 16-30 the
+ * second duration and bit 31 its level. Durations are in peripheral ticks.
+ */
+typedef uint32_t ws2812_symbol_t;
+
+/**
+ * @brief Bit timing of the data line.
+ */
+typedef struct ws2812_timing {
+    uint16_t t0h_ns;        ///< High time of a 0 bit
+    uint16_t t0l_ns;        ///< Low time of a 0 bit
+    uint16_t t1h_ns;        ///< High time of a 1 bit
+    uint16_t t1l_ns;        ///< Low time of a 1 bit
+    uint16_t reset_us;      ///< Low time that latches the frame
+} ws2812_timing_t;
+
+// WS2812B at 800 kHz; the long reset also covers the newer 280 us parts
+static constexpr ws2812_timing_t WS2812_TIMING_DEFAULT = {400, 850, 800, 450, 300};
+
+/**
+ * @brief Pixel-to-symbol encoder.
+ *
+ * Pure code with no peripheral access: a byte expands to eight symbols via
+ * two lookups in a 16-entry nibble table, so a frame can be encoded ahead
+ * of time on any core (or on the host) and handed to the peripheral as is.
+ */
+typedef struct ws2812_encoder {
+    ws2812_symbol_t nibble[16][4];  ///< Symbols for each 4-bit value
+    ws2812_symbol_t latch;          ///< Low for the reset time
+    uint32_t tick_ns;
+} ws2812_encoder_t;
+
+static inline ws2812_symbol_t ws2812_symbol(uint16_t duration0, bool level0, uint16_t duration1, bool level1) {
+    return (ws2812_symbol_t)(duration0 & WS2812_MAX_DURATION) | ((ws2812_symbol_t)level0 << 15) |
+           ((ws2812_symbol_t)(duration1 & WS2812_MAX_DURATION) << 16) | ((ws2812_symbol_t)level1 << 31);
+}
+
+/**
+ * @brief Symbols in an encoded frame of `count` pixels, including the latch.
+ */
+static inline size_t ws2812_frame_symbols(uint16_t count) {
+    return (size_t)count * WS2812_SYMBOLS_PER_PIXEL + 1;
+}
+
+/**
+ * @brief Builds the symbol tables for `timing` at a peripheral tick of `tick_ns`.
+ *
+ * @return false if a duration rounds to zero ticks or does not fit a symbol
+ */
+bool ws2812_encoder_init(ws2812_encoder_t* enc, const ws2812_timing_t* timing, uint32_t tick_ns);
+
+/**
+ * @brief Writes an all-black frame of `count` pixels followed by the latch.
+ *
+ * @param frame Room for ws2812_frame_symbols(count) symbols
+ */
+void ws2812_frame_init(const ws2812_encoder_t* enc, uint16_t count, ws2812_symbol_t* frame);
+
+/**
+ * @brief Encodes pixels [first, end) into their slots of `frame`; other pixels are left alone.
+ */
+void ws2812_encode(const ws2812_encoder_t* enc, const led_rgb_t* pixels, uint16_t first, uint16_t end,
+                   ws2812_symbol_t* frame);
+
+/**
+ * @brief Recovers the G-R-B bytes from symbols, as a receiving pixel would.
+ *
+ * A symbol that starts high is a 1 bit when its high time is longer than
+ * its low time; decoding stops at the first symbol that starts low (the
+ * latch) or after `len` bytes.
+ *
+ * @return Whole bytes decoded
+ */
+size_t ws2812_decode(const ws2812_symbol_t* symbols, size_t count, uint8_t* grb, size_t len);
+
+#endif  // __WS2812_H__
@@ -0,0 +1,48 @@
+#ifndef __SIM_ADAFRUIT_NEOPIXEL_H__
+#define __SIM_ADAFRUIT_NEOPIXEL_H__
+
+#include <Arduino.h>
+
+#define NEO_GRB             ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_RGB             ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_KHZ800          0x0000
+#define NEO_KHZ400          0x0100
+
+/**
+ * @brief Recording NeoPixel strip.
+ *
+ * show() costs the virtual time of the real bit-banged output (interrupts
+ * off for SIM_NEOPIXEL_US_PER_PIXEL per pixel plus the latch) and keeps
+ * the frame for sim_neopixel_get_stats().
+ */
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, uint16_t type = NEO_GRB + NEO_KHZ800);
+    ~Adafruit_NeoPixel();
+
+    void begin(void);
+    void show(void);
+    void clear(void);
+    void setPin(int16_t p) { pin = p; }
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+    void setPixelColor(uint16_t n, uint32_t c);
+    void setBrightness(uint8_t b) { brightness = b; }
+    uint8_t getBrightness(void) const { return brightness; }
+    uint32_t getPixelColor(uint16_t n) const;
+    uint8_t* getPixels(void) const { return pixels; }
+    uint16_t numPixels(void) const { return num_pixels; }
+    bool canShow(void) const { return true; }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+
+private:
+    uint16_t num_pixels;
+    int16_t pin;
+    uint8_t brightness;
+    uint8_t* pixels;            ///< RGB, 3 bytes per pixel
+    bool begun;
+};
+
+#endif  // __SIM_ADAFRUIT_NEOPIXEL_H__
@@ -0,0 +1,23 @@
+#ifndef __SIM_BLE_DEVICE_H__
+#define __SIM_BLE_DEVICE_H__
+
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+
+typedef void (*gap_event_handler)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+typedef void (*gatts_event_handler)(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
+                                    esp_ble_gatts_cb_param_t* param);
+
+/**
+ * @brief The Arduino BLE library's hooks into Bluedroid's raw events.
+ *
+ * The simulated host link calls them from sim_at() events, where the
+ * real ones run in the Bluedroid task.
+ */
+class BLEDevice {
+public:
+    static void setCustomGapHandler(gap_event_handler handler);
+    static void setCustomGattsHandler(gatts_event_handler handler);
+};
+
+#endif  // __SIM_BLE_DEVICE_H__
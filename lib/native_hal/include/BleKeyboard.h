@@ -0,0 +1,45 @@
+#ifndef __SIM_BLE_KEYBOARD_H__
+#define __SIM_BLE_KEYBOARD_H__
+
+#include <Arduino.h>
+#include <string>
+
+typedef struct {
+    uint8_t modifiers;
+    uint8_t reserved;
+    uint8_t keys[6];
+} KeyReport;
+
+/**
+ * @brief Recording BLE keyboard.
+ *
+ * Reports sent while a simulated host is connected are kept for
+ * sim_ble_get_report(). begin() starts general advertising, which the
+ * hosts in range answer (see sim_ble_set_host()).
+ */
+class BleKeyboard : public Print {
+public:
+    BleKeyboard(std::string device_name = "ESP32 Keyboard", std::string device_manufacturer = "Espressif",
+                uint8_t battery_level = 100);
+
+    void begin(void);
+    void end(void);
+    bool isConnected(void);
+    void sendReport(KeyReport* keys);
+    size_t press(uint8_t k);
+    size_t release(uint8_t k);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void releaseAll(void);
+    void setBatteryLevel(uint8_t level) { battery_level = level; }
+    void setName(std::string name) { device_name = name; }
+
+private:
+    std::string device_name;
+    std::string device_manufacturer;
+    uint8_t battery_level;
+    KeyReport report;
+};
+
+#endif  // __SIM_BLE_KEYBOARD_H__
@@ -0,0 +1,55 @@
+#ifndef __SIM_LITTLEFS_H__
+#define __SIM_LITTLEFS_H__
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Open file; copies share the handle, as with the Arduino FS File.
+ */
+class File : public Stream {
+public:
+    File(void) {}
+    explicit File(FILE* file);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available(void) override;
+    int read(void) override;
+    int peek(void) override;
+    size_t read(uint8_t* buffer, size_t size);
+    size_t size(void) const;
+    bool seek(uint32_t pos);
+    size_t position(void) const;
+    void flush(void);
+    void close(void) { handle.reset(); }
+    operator bool() const { return static_cast<bool>(handle); }
+
+private:
+    std::shared_ptr<FILE> handle;
+};
+
+/**
+ * @brief LittleFS backed by a host directory (sim_fs_root()).
+ */
+class LittleFSFS {
+public:
+    bool begin(bool format_on_fail = false, const char* base_path = "/littlefs", uint8_t max_open_files = 10,
+               const char* partition_label = "spiffs");
+    void end(void) { mounted = false; }
+    File open(const char* path, const char* mode = "r");
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool format(void);
+
+private:
+    std::string host_path(const char* path) const;
+
+    bool mounted = false;
+};
+
+extern LittleFSFS LittleFS;
+
+#endif  // __SIM_LITTLEFS_H__
@@ -0,0 +1,49 @@
+#ifndef __SIM_WIFI_H__
+#define __SIM_WIFI_H__
+
+#include <Arduino.h>
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA,
+    WIFI_AP,
+    WIFI_AP_STA,
+} wifi_mode_t;
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+/**
+ * @brief Radio stand-in: the host network is always up, so sockets bound
+ * by the firmware are reachable on the host's interfaces (loopback included).
+ */
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t m) { current_mode = m; return true; }
+    wifi_mode_t getMode(void) const { return current_mode; }
+    bool softAP(const char* ssid, const char* passphrase = NULL) {
+        (void)ssid;
+        (void)passphrase;
+        ap_started = true;
+        return true;
+    }
+    wl_status_t begin(const char* ssid, const char* passphrase = NULL) {
+        (void)ssid;
+        (void)passphrase;
+        return WL_CONNECTED;
+    }
+    wl_status_t status(void) const { return WL_CONNECTED; }
+
+private:
+    wifi_mode_t current_mode = WIFI_OFF;
+    bool ap_started = false;
+};
+
+extern WiFiClass WiFi;
+
+#endif  // __SIM_WIFI_H__
@@ -0,0 +1,60 @@
+#ifndef __SIM_WIRE_H__
+#define __SIM_WIRE_H__
+
+#include <Arduino.h>
+#include "sim.h"
+
+/**
+ * @brief I2C master talking to device models attached with sim_i2c_attach().
+ *
+ * Every transaction charges its bus time (address and data bytes at
+ * SIM_I2C_BYTE_BITS each, at the configured clock) to the virtual clock.
+ * endTransmission() returns 2 (address NACK) when no device answers.
+ */
+class TwoWire : public Stream {
+public:
+    TwoWire(void);
+
+    bool begin(void);
+    bool setClock(uint32_t frequency);
+    uint32_t getClock(void) const { return clock_hz; }
+
+    void beginTransmission(uint16_t address);
+    uint8_t endTransmission(bool send_stop = true);
+    size_t requestFrom(uint16_t address, size_t size, bool send_stop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t size) {
+        return static_cast<uint8_t>(requestFrom(static_cast<uint16_t>(address), static_cast<size_t>(size), true));
+    }
+    uint8_t requestFrom(int address, int size) {
+        return static_cast<uint8_t>(requestFrom(static_cast<uint16_t>(address), static_cast<size_t>(size), true));
+    }
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t size) override;
+    using Print::write;
+    int available(void) override;
+    int read(void) override;
+    int peek(void) override;
+    void flush(void) {}
+
+    bool attach(const sim_i2c_device_t* device);
+
+private:
+    const sim_i2c_device_t* find(uint16_t address) const;
+    void charge(size_t bytes) const;
+
+    const sim_i2c_device_t* devices[SIM_I2C_MAX_DEVICES];
+    uint8_t device_count;
+    uint32_t clock_hz;
+    uint16_t tx_address;
+    uint8_t tx_buffer[SIM_I2C_BUFFER];
+    size_t tx_len;
+    bool tx_active;
+    uint8_t rx_buffer[SIM_I2C_BUFFER];
+    size_t rx_len;
+    size_t rx_pos;
+};
+
+extern TwoWire Wire;
+
+#endif  // __SIM_WIRE_H__
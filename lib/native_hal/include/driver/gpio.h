@@ -0,0 +1,36 @@
+#ifndef __SIM_DRIVER_GPIO_H__
+#define __SIM_DRIVER_GPIO_H__
+
+#include <Arduino.h>
+
+#include "esp_err.h"
+
+// The interrupt and light-sleep wakeup calls of the ESP-IDF GPIO driver.
+// Interrupt types share their values with the Arduino modes (RISING ==
+// GPIO_INTR_POSEDGE, ...), as on the real core. A pin with its interrupt
+// disabled keeps its handler but does not run it; a wakeup level only
+// matters to esp_light_sleep_start().
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+    GPIO_INTR_MAX,
+} gpio_int_type_t;
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
+
+/**
+ * @brief Wakes the chip from light sleep while the pin is at the given level.
+ *
+ * Only GPIO_INTR_LOW_LEVEL and GPIO_INTR_HIGH_LEVEL are accepted.
+ */
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num);
+
+#endif  // __SIM_DRIVER_GPIO_H__
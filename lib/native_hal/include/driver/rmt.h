@@ -0,0 +1,102 @@
+#ifndef __SIM_DRIVER_RMT_H__
+#define __SIM_DRIVER_RMT_H__
+
+#include <Arduino.h>
+
+#include "esp_err.h"
+
+// The transmit half of the ESP-IDF 4.4 legacy RMT driver. A write occupies
+// the channel for the virtual time its items take at 80 MHz / clk_div; the
+// items are read (and decoded as a NeoPixel frame) only when the
+// transmission ends, so a buffer reused too early shows up as a wrong frame.
+
+typedef enum {
+    RMT_CHANNEL_0 = 0,
+    RMT_CHANNEL_1,
+    RMT_CHANNEL_2,
+    RMT_CHANNEL_3,
+    RMT_CHANNEL_4,
+    RMT_CHANNEL_5,
+    RMT_CHANNEL_6,
+    RMT_CHANNEL_7,
+    RMT_CHANNEL_MAX,
+} rmt_channel_t;
+
+typedef enum {
+    RMT_MODE_TX = 0,
+    RMT_MODE_RX,
+} rmt_mode_t;
+
+typedef enum {
+    RMT_IDLE_LEVEL_LOW = 0,
+    RMT_IDLE_LEVEL_HIGH,
+} rmt_idle_level_t;
+
+typedef struct {
+    union {
+        struct {
+            uint32_t duration0 : 15;
+            uint32_t level0 : 1;
+            uint32_t duration1 : 15;
+            uint32_t level1 : 1;
+        };
+        uint32_t val;
+    };
+} rmt_item32_t;
+
+typedef struct {
+    uint32_t carrier_freq_hz;
+    uint8_t carrier_level;
+    rmt_idle_level_t idle_level;
+    uint8_t carrier_duty_percent;
+    uint32_t loop_count;
+    bool carrier_en;
+    bool loop_en;
+    bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    uint32_t flags;
+    rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id)     \
+    {                                               \
+        RMT_MODE_TX, (channel_id), (gpio), 80, 1, 0, \
+        {38000, 1, RMT_IDLE_LEVEL_LOW, 33, 0, false, false, true} \
+    }
+
+typedef void (*rmt_tx_end_fn_t)(rmt_channel_t channel, void* arg);
+
+typedef struct {
+    rmt_tx_end_fn_t function;
+    void* arg;
+} rmt_tx_end_callback_t;
+
+esp_err_t rmt_config(const rmt_config_t* config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+
+/**
+ * @brief Starts sending `items`; waits for a transmission still in progress first.
+ *
+ * `items` must stay untouched until the transmission ends.
+ */
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t* items, int item_num, bool wait_tx_done);
+
+/**
+ * @brief ESP_OK once the channel is idle, ESP_ERR_TIMEOUT if still sending after `wait_time` ticks.
+ */
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time);
+
+/**
+ * @brief Sets the one callback run (in interrupt context) when any channel finishes.
+ */
+rmt_tx_end_callback_t rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void* arg);
+
+#endif  // __SIM_DRIVER_RMT_H__
@@ -0,0 +1,17 @@
+#ifndef __SIM_ESP_BT_DEFS_H__
+#define __SIM_ESP_BT_DEFS_H__
+
+#include <stdint.h>
+
+#define ESP_BD_ADDR_LEN     6
+
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+    BLE_ADDR_TYPE_PUBLIC = 0x00,
+    BLE_ADDR_TYPE_RANDOM = 0x01,
+    BLE_ADDR_TYPE_RPA_PUBLIC = 0x02,
+    BLE_ADDR_TYPE_RPA_RANDOM = 0x03,
+} esp_ble_addr_type_t;
+
+#endif  // __SIM_ESP_BT_DEFS_H__
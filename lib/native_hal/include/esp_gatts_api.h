@@ -0,0 +1,37 @@
+#ifndef __SIM_ESP_GATTS_API_H__
+#define __SIM_ESP_GATTS_API_H__
+
+#include <stdint.h>
+
+#include "esp_bt_defs.h"
+
+// Connection events of Bluedroid's GATT server, as in ESP-IDF 4.4
+
+typedef uint8_t esp_gatt_if_t;
+
+typedef enum {
+    ESP_GATTS_CONNECT_EVT = 14,
+    ESP_GATTS_DISCONNECT_EVT = 15,
+} esp_gatts_cb_event_t;
+
+typedef struct {
+    uint16_t interval;          ///< 1.25 ms units
+    uint16_t latency;
+    uint16_t timeout;           ///< 10 ms units
+} esp_gatt_conn_params_t;
+
+typedef union {
+    struct gatts_connect_evt_param {
+        uint16_t conn_id;
+        uint8_t link_role;
+        esp_bd_addr_t remote_bda;
+        esp_gatt_conn_params_t conn_params;
+    } connect;
+    struct gatts_disconnect_evt_param {
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+        int reason;
+    } disconnect;
+} esp_ble_gatts_cb_param_t;
+
+#endif  // __SIM_ESP_GATTS_API_H__
@@ -0,0 +1,35 @@
+#ifndef __SIM_ESP_SLEEP_H__
+#define __SIM_ESP_SLEEP_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Light sleep as in ESP-IDF 4.4: esp_light_sleep_start() halts the whole
+// chip (every task, and micros() keeps counting) until the timer expires
+// or a pin armed with gpio_wakeup_enable() reads its wakeup level. Events
+// scheduled with sim_at() still run, so inputs can change meanwhile; GPIO
+// interrupts fire only if they are enabled. Waking costs
+// SIM_LIGHT_SLEEP_WAKE_US before the call returns.
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+    ESP_SLEEP_WAKEUP_TOUCHPAD,
+    ESP_SLEEP_WAKEUP_ULP,
+    ESP_SLEEP_WAKEUP_GPIO,
+    ESP_SLEEP_WAKEUP_UART,
+} esp_sleep_source_t;
+
+typedef esp_sleep_source_t esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_sleep_enable_gpio_wakeup(void);
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source);
+esp_err_t esp_light_sleep_start(void);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+
+#endif  // __SIM_ESP_SLEEP_H__
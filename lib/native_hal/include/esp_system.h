@@ -0,0 +1,14 @@
+#ifndef __SIM_ESP_SYSTEM_H__
+#define __SIM_ESP_SYSTEM_H__
+
+#include <stdint.h>
+
+// The host has no heap limit: the free heap reads as the ESP32's after
+// boot, and nothing the simulator models is charged against it
+static constexpr uint32_t SIM_FREE_HEAP = 300 * 1024;
+
+static inline uint32_t esp_get_free_heap_size(void) {
+    return SIM_FREE_HEAP;
+}
+
+#endif  // __SIM_ESP_SYSTEM_H__
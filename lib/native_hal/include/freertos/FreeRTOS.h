@@ -0,0 +1,23 @@
+#ifndef __SIM_FREERTOS_H__
+#define __SIM_FREERTOS_H__
+
+#include <stdint.h>
+
+// Subset of the FreeRTOS API used by the firmware, backed by the
+// simulator's cooperative kernel (see sim.h).
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS      ((TickType_t)1)     // CONFIG_FREERTOS_HZ = 1000, as on the ESP32
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define portYIELD_FROM_ISR()    do {} while (0)
+#define tskNO_AFFINITY          0x7FFFFFFF
+
+#endif  // __SIM_FREERTOS_H__
@@ -0,0 +1,309 @@
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+class TwoWire;
+
+/**
+ * @brief Native-build simulator.
+ *
+ * Time is virtual: it only advances when every task is blocked (to the
+ * next wake-up or scheduled event), when code busy-waits
+ * (delayMicroseconds(), I2C transfers, NeoPixel output), or by
+ * SIM_POLL_STEP_US each time a task polls without blocking. The
+ * unmodified setup()/loop() therefore run as fast as the host allows and
+ * give the same result on every run.
+ *
+ * Events scheduled with sim_at() run in "interrupt context" between task
+ * switches; they typically drive GPIO levels, which fire the handlers
+ * registered with attachInterruptArg().
+ */
+
+static constexpr uint32_t SIM_POLL_STEP_US = 5;           // time charged per non-blocking poll
+static constexpr uint32_t SIM_I2C_BYTE_BITS = 9;          // 8 data bits + ACK
+static constexpr uint32_t SIM_NEOPIXEL_US_PER_PIXEL = 30; // 24 bits at 800 kHz
+static constexpr uint32_t SIM_NEOPIXEL_LATCH_US = 50;
+static constexpr uint8_t SIM_I2C_MAX_DEVICES = 4;
+static constexpr size_t SIM_I2C_BUFFER = 128;             // Arduino-ESP32 Wire buffer
+static constexpr uint32_t SIM_LIGHT_SLEEP_WAKE_US = 500;  // light-sleep exit until code runs again
+
+// ---------------------------------------------------------------------------
+// Clock and events
+
+/**
+ * @brief Current virtual time in microseconds (does not wrap).
+ */
+uint64_t sim_now_us(void);
+
+/**
+ * @brief Runs `fn(ctx)` when virtual time reaches `when_us`.
+ *
+ * Events at the same time run in the order they were scheduled.
+ */
+void sim_at(uint64_t when_us, void (*fn)(void* ctx), void* ctx);
+
+/**
+ * @brief Sets a GPIO level at `when_us` (fires its interrupt handler then).
+ */
+void sim_gpio_set_at(uint64_t when_us, uint8_t pin, uint8_t level);
+
+/**
+ * @brief Advances virtual time by `us` as if the caller spun for that long.
+ *
+ * Due events run; tasks they wake run after the caller next blocks.
+ */
+void sim_busy_us(uint32_t us);
+
+/**
+ * @brief Halts every task while virtual time advances, as in light sleep.
+ *
+ * Events run as usual; returns once `woken(ctx)` holds after one of them
+ * or when time reaches `until_us` (UINT64_MAX: no timer).
+ */
+void sim_halt_until(uint64_t until_us, bool (*woken)(void* ctx), void* ctx);
+
+/**
+ * @brief Paces virtual time to the wall clock (off by default).
+ *
+ * Needed when something outside the simulation talks to the firmware in
+ * real time, e.g. a browser or test client on the web server's socket.
+ */
+void sim_set_realtime(bool enabled);
+
+/**
+ * @brief Ends the run (exit status 0) once virtual time reaches `when_us`; 0 runs forever.
+ */
+void sim_stop_at(uint64_t when_us);
+
+/**
+ * @brief Prints the run summary to stderr, flushes output and exits with `status`.
+ */
+void sim_exit(int status);
+
+// ---------------------------------------------------------------------------
+// GPIO
+
+/**
+ * @brief Drives an input pin from outside (a button, the IMU INT line, ...).
+ *
+ * Runs the pin's interrupt handler immediately if the change matches its mode.
+ */
+void sim_gpio_set(uint8_t pin, uint8_t level);
+
+/**
+ * @brief Stops driving a pin from outside; it falls back to its pull.
+ */
+void sim_gpio_release(uint8_t pin);
+
+/**
+ * @brief Models a board resistor pulling `pin` to `level` (stronger than the internal pulls).
+ */
+void sim_gpio_set_pull(uint8_t pin, uint8_t level);
+
+/**
+ * @brief Level of a pin as the firmware would read it.
+ */
+uint8_t sim_gpio_get(uint8_t pin);
+
+/**
+ * @brief True if a pin armed with gpio_wakeup_enable() is at its wakeup level.
+ */
+bool sim_gpio_wakeup_pending(void);
+
+// ---------------------------------------------------------------------------
+// Light sleep (esp_sleep.h)
+
+typedef struct sim_sleep_stats {
+    uint32_t sleeps;
+    uint32_t gpio_wakes;
+    uint32_t timer_wakes;
+    uint64_t asleep_us;
+} sim_sleep_stats_t;
+
+void sim_sleep_get_stats(sim_sleep_stats_t* stats);
+
+// ---------------------------------------------------------------------------
+// Serial
+
+/**
+ * @brief Queues bytes for Serial.read().
+ */
+void sim_serial_input(const char* text);
+
+/**
+ * @brief Redirects Serial output (stdout by default, NULL discards it).
+ */
+void sim_serial_set_output(FILE* out);
+
+// ---------------------------------------------------------------------------
+// I2C
+
+/**
+ * @brief A device model on a simulated I2C bus.
+ *
+ * `write` receives every byte of one write transaction; `read` fills one
+ * read transaction and returns how many bytes the device sent.
+ */
+typedef struct sim_i2c_device {
+    uint8_t address;
+    void* ctx;
+    void (*write)(void* ctx, const uint8_t* data, size_t len);
+    size_t (*read)(void* ctx, uint8_t* data, size_t len);
+} sim_i2c_device_t;
+
+/**
+ * @brief Connects a device model to a bus; at most SIM_I2C_MAX_DEVICES per bus.
+ */
+bool sim_i2c_attach(TwoWire* bus, const sim_i2c_device_t* device);
+
+// ---------------------------------------------------------------------------
+// BMI323
+
+/**
+ * @brief Motion fed to the BMI323 model: physical values at time `t_us`.
+ */
+typedef void (*sim_bmi323_motion_fn)(void* ctx, uint64_t t_us, float accel_g[3], float gyro_dps[3], float* temp_c);
+
+#define SIM_BMI323_EXT_REGS     16      // extended registers modelled (any-motion lives at 0x05..0x07)
+
+/**
+ * @brief Register-level BMI323 model.
+ *
+ * Implements the registers the driver uses: chip id, data and sensor time,
+ * ACC/GYR_CONF (rate, range, mode), soft reset, INT1 routing of data-ready,
+ * FIFO watermark and any-motion, the FIFO (configurable frame contents,
+ * fill level, watermark, flush, stop-on-full) and the feature engine's
+ * any-motion slope detector (threshold, duration, reference update). Every
+ * read starts with the two dummy bytes of the real part. Samples are
+ * produced at the accelerometer rate (gyro rate if the accelerometer is
+ * off); mode changes take effect at once, without start-up time.
+ */
+typedef struct sim_bmi323 {
+    sim_i2c_device_t device;
+    uint8_t int_pin;
+    uint16_t regs[128];
+    uint8_t reg;                ///< Register address of the current transaction
+    uint16_t fifo[1024];
+    uint16_t fifo_head;
+    uint16_t fifo_len;
+    uint32_t period_us;         ///< 0 while both sensors are off
+    uint64_t next_sample_us;    ///< Sample events for any other time are stale
+    uint32_t samples;           ///< Samples produced
+    uint32_t fifo_dropped;      ///< Frames lost to a full FIFO
+    uint16_t ext[SIM_BMI323_EXT_REGS];  ///< Feature engine extended registers
+    uint8_t ext_addr;           ///< FEATURE_DATA_ADDR, auto-incremented by FEATURE_DATA_TX
+    uint16_t feature_io0;       ///< FEATURE_IO0 as of the last sync
+    int16_t anymo_ref[3];       ///< Any-motion reference sample
+    bool anymo_have_ref;
+    uint32_t anymo_run_us;      ///< Time the slope has stayed above threshold
+    uint32_t any_motion_events;
+    sim_bmi323_motion_fn motion;
+    void* motion_ctx;
+} sim_bmi323_t;
+
+/**
+ * @brief Resets the model and attaches it to `bus`.
+ *
+ * @param imu Model instance (must outlive the run)
+ * @param bus I2C bus, usually &Wire
+ * @param address 7-bit address (0x68 with SDO low)
+ * @param int_pin GPIO wired to INT1
+ */
+void sim_bmi323_init(sim_bmi323_t* imu, TwoWire* bus, uint8_t address, uint8_t int_pin);
+
+/**
+ * @brief Sets the motion source; NULL holds the board flat and still (+1 g on Z).
+ */
+void sim_bmi323_set_motion(sim_bmi323_t* imu, sim_bmi323_motion_fn motion, void* ctx);
+
+// ---------------------------------------------------------------------------
+// NeoPixel (bit-banged or RMT) and BLE keyboard recorders
+
+typedef struct sim_neopixel_stats {
+    uint32_t shows;             ///< Frames latched: strip.show() calls or RMT transmissions
+    uint16_t pixels;
+    uint8_t pin;
+    uint8_t last_rgb[3 * 16];   ///< First 16 pixels of the last frame shown
+} sim_neopixel_stats_t;
+
+/**
+ * @brief Stats of the most recently created strip or RMT-driven line; false if there is none.
+ */
+bool sim_neopixel_get_stats(sim_neopixel_stats_t* stats);
+
+/**
+ * @brief Records a frame latched on a NeoPixel data line.
+ *
+ * Called by the strip model and by the RMT model, which decodes the
+ * frame from the transmitted items.
+ */
+void sim_neopixel_record(uint8_t pin, uint16_t pixels, const uint8_t* rgb);
+
+typedef struct sim_ble_report {
+    uint64_t time_us;
+    uint8_t modifiers;
+    uint8_t keys[6];
+} sim_ble_report_t;
+
+static constexpr uint8_t SIM_BLE_HOSTS = 3;
+static constexpr uint32_t SIM_BLE_DIRECTED_CONNECT_US = 5000;    // first high-duty packets in the host's scan window
+static constexpr uint32_t SIM_BLE_DIRECTED_TIMEOUT_US = 1280000; // the controller ends a high-duty burst
+static constexpr uint32_t SIM_BLE_GENERAL_CONNECT_US = 1280000;  // host background scan finds an undirected advertiser
+static constexpr uint32_t SIM_BLE_ENCRYPT_US = 30000;            // bonded host re-encrypts the link
+static constexpr uint32_t SIM_BLE_PAIR_US = 500000;              // new host pairs and bonds
+
+/**
+ * @brief Brings host `host` into range or takes it out (host 0 is in range from the start).
+ *
+ * Hosts are public addresses 5A:1A:00:00:00:01.. (host 0 first). A host
+ * in range connects to general advertising after
+ * SIM_BLE_GENERAL_CONNECT_US (the lowest-numbered one wins), or to
+ * high-duty directed advertising toward it after
+ * SIM_BLE_DIRECTED_CONNECT_US; the link is up once it has encrypted
+ * (SIM_BLE_ENCRYPT_US with a bond, SIM_BLE_PAIR_US for pairing). Leaving
+ * range drops the link at once, and the keyboard library restarts
+ * general advertising, as BleKeyboard does. The delays are stand-ins,
+ * not measurements.
+ */
+void sim_ble_set_host(uint8_t host, bool present);
+
+/**
+ * @brief sim_ble_set_host() at `when_us`.
+ */
+void sim_ble_set_host_at(uint64_t when_us, uint8_t host, bool present);
+
+/**
+ * @brief Reports sent while connected, oldest first.
+ */
+size_t sim_ble_report_count(void);
+bool sim_ble_get_report(size_t index, sim_ble_report_t* report);
+
+// ---------------------------------------------------------------------------
+// Entry point
+
+/**
+ * @brief Parses simulator options.
+ *
+ * --ms=N stops after N ms of virtual time (default 10000, 0 = forever),
+ * --fs=DIR sets the LittleFS root, --quiet discards Serial output,
+ * --realtime paces virtual time to the wall clock,
+ * --input=[MS:]TEXT queues console input (a literal "\n" ends a command),
+ * --gpio=MS:PIN:LEVEL drives a pin, --shake=MS:LEN_MS wobbles the
+ * board (accel and gyro) for LEN_MS and --ble=MS:HOST:PRESENT moves a
+ * BLE host in or out of range; these four may repeat.
+ */
+void sim_configure(int argc, char** argv);
+
+/**
+ * @brief Writes a one-line run summary (virtual time, IMU samples, BLE reports, LED frames, light sleep).
+ */
+void sim_report(FILE* out);
+
+/**
+ * @brief Directory backing LittleFS.
+ */
+const char* sim_fs_root(void);
+
+#endif  // __SIM_H__
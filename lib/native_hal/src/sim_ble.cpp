@@ -0,0 +1,314 @@
+#include <BLEDevice.h>
+#include <BleKeyboard.h>
+#include <esp_gap_ble_api.h>
+#include <esp_gatts_api.h>
+#include <vector>
+
+#include "sim.h"
+
+#define SIM_BLE_CONN_INTERVAL   24      // 30 ms (1.25 ms units): what hosts pick when left to themselves
+#define SIM_BLE_DROP_REASON     0x08    // supervision timeout
+
+typedef enum sim_ble_adv {
+    SIM_BLE_ADV_OFF = 0,
+    SIM_BLE_ADV_GENERAL,
+    SIM_BLE_ADV_DIRECTED,
+} sim_ble_adv_t;
+
+typedef struct sim_ble_host {
+    bool present;
+    bool bonded;                ///< Paired during this run
+    uint64_t since_us;          ///< Came into range
+} sim_ble_host_t;
+
+static std::vector<sim_ble_report_t> ble_reports;
+static bool ble_started = false;
+static sim_ble_host_t hosts[SIM_BLE_HOSTS] = {{true, false, 0}};
+static int link_host = -1;              // connected host, -1 if none
+static bool link_directed = false;      // connected through directed advertising
+static sim_ble_adv_t adv = SIM_BLE_ADV_OFF;
+static esp_bd_addr_t adv_peer;
+static uint64_t adv_start_us = 0;
+static int pending_host = -1;
+static uint32_t generation = 0;         // bumped whenever pending events become stale
+static gap_event_handler gap_handler = NULL;
+static gatts_event_handler gatts_handler = NULL;
+
+void BLEDevice::setCustomGapHandler(gap_event_handler handler) {
+    gap_handler = handler;
+}
+
+void BLEDevice::setCustomGattsHandler(gatts_event_handler handler) {
+    gatts_handler = handler;
+}
+
+static void __sim_ble_host_addr(uint8_t host, esp_bd_addr_t addr) {
+    static const esp_bd_addr_t base = {0x5A, 0x1A, 0x00, 0x00, 0x00, 0x01};
+    memcpy(addr, base, sizeof(esp_bd_addr_t));
+    addr[5] = (uint8_t)(base[5] + host);
+}
+
+static int __sim_ble_find(const uint8_t* addr) {
+    for (uint8_t i = 0; i < SIM_BLE_HOSTS; i++) {
+        esp_bd_addr_t host_addr;
+        __sim_ble_host_addr(i, host_addr);
+        if (memcmp(host_addr, addr, sizeof(host_addr)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// A directed connection means the host holds a bond, even one made in an
+// earlier run
+static void __sim_ble_encrypted(void* ctx) {
+    if ((uint32_t)(uintptr_t)ctx != generation || link_host < 0) {
+        return;
+    }
+    hosts[link_host].bonded = true;
+    if (gap_handler) {
+        esp_ble_gap_cb_param_t param;
+        memset(&param, 0, sizeof(param));
+        __sim_ble_host_addr((uint8_t)link_host, param.ble_security.auth_cmpl.bd_addr);
+        param.ble_security.auth_cmpl.key_present = true;
+        param.ble_security.auth_cmpl.success = true;
+        param.ble_security.auth_cmpl.addr_type = BLE_ADDR_TYPE_PUBLIC;
+        gap_handler(ESP_GAP_BLE_AUTH_CMPL_EVT, &param);
+    }
+}
+
+static void __sim_ble_connect(void* ctx) {
+    if ((uint32_t)(uintptr_t)ctx != generation || pending_host < 0) {
+        return;
+    }
+    link_host = pending_host;
+    link_directed = (adv == SIM_BLE_ADV_DIRECTED);
+    adv = SIM_BLE_ADV_OFF;
+    pending_host = -1;
+    generation++;
+    if (gatts_handler) {
+        esp_ble_gatts_cb_param_t param;
+        memset(&param, 0, sizeof(param));
+        __sim_ble_host_addr((uint8_t)link_host, param.connect.remote_bda);
+        param.connect.conn_params.interval = SIM_BLE_CONN_INTERVAL;
+        gatts_handler(ESP_GATTS_CONNECT_EVT, 0, &param);
+    }
+    bool bonded = link_directed || hosts[link_host].bonded;
+    sim_at(sim_now_us() + (bonded ? SIM_BLE_ENCRYPT_US : SIM_BLE_PAIR_US), __sim_ble_encrypted,
+           (void*)(uintptr_t)generation);
+}
+
+// Schedules the connection the advertising running now will get, if any
+static void __sim_ble_plan(void) {
+    if (link_host >= 0) {
+        return;
+    }
+    generation++;
+    pending_host = -1;
+    uint64_t when_us = 0;
+    if (adv == SIM_BLE_ADV_DIRECTED) {
+        int host = __sim_ble_find(adv_peer);
+        if (host >= 0 && hosts[host].present) {
+            uint64_t from_us = hosts[host].since_us > adv_start_us ? hosts[host].since_us : adv_start_us;
+            when_us = from_us + SIM_BLE_DIRECTED_CONNECT_US;
+            if (when_us < adv_start_us + SIM_BLE_DIRECTED_TIMEOUT_US) {
+                pending_host = host;
+            }
+        }
+    } else if (adv == SIM_BLE_ADV_GENERAL) {
+        for (uint8_t i = 0; i < SIM_BLE_HOSTS && pending_host < 0; i++) {
+            if (hosts[i].present) {
+                uint64_t from_us = hosts[i].since_us > adv_start_us ? hosts[i].since_us : adv_start_us;
+                when_us = from_us + SIM_BLE_GENERAL_CONNECT_US;
+                pending_host = i;
+            }
+        }
+    }
+    if (pending_host >= 0) {
+        sim_at(when_us, __sim_ble_connect, (void*)(uintptr_t)generation);
+    }
+}
+
+static void __sim_ble_start_advertising(sim_ble_adv_t mode, const uint8_t* peer) {
+    adv = mode;
+    if (peer) {
+        memcpy(adv_peer, peer, sizeof(adv_peer));
+    }
+    adv_start_us = sim_now_us();
+    __sim_ble_plan();
+}
+
+// BleKeyboard restarts general advertising after the stack's callbacks
+static void __sim_ble_drop(void) {
+    if (link_host < 0) {
+        return;
+    }
+    esp_ble_gatts_cb_param_t param;
+    memset(&param, 0, sizeof(param));
+    __sim_ble_host_addr((uint8_t)link_host, param.disconnect.remote_bda);
+    param.disconnect.reason = SIM_BLE_DROP_REASON;
+    link_host = -1;
+    generation++;
+    if (gatts_handler) {
+        gatts_handler(ESP_GATTS_DISCONNECT_EVT, 0, &param);
+    }
+    if (ble_started) {
+        __sim_ble_start_advertising(SIM_BLE_ADV_GENERAL, NULL);
+    }
+}
+
+static void __sim_ble_drop_event(void* ctx) {
+    if ((uint32_t)(uintptr_t)ctx == generation) {
+        __sim_ble_drop();
+    }
+}
+
+void sim_ble_set_host(uint8_t host, bool present) {
+    if (host >= SIM_BLE_HOSTS || hosts[host].present == present) {
+        return;
+    }
+    hosts[host].present = present;
+    hosts[host].since_us = sim_now_us();
+    if (!present && link_host == host) {
+        __sim_ble_drop();
+    } else {
+        __sim_ble_plan();
+    }
+}
+
+static void __sim_ble_host_event(void* ctx) {
+    uintptr_t packed = (uintptr_t)ctx;
+    sim_ble_set_host((uint8_t)(packed >> 1), (packed & 1) != 0);
+}
+
+void sim_ble_set_host_at(uint64_t when_us, uint8_t host, bool present) {
+    sim_at(when_us, __sim_ble_host_event, (void*)(((uintptr_t)host << 1) | (present ? 1 : 0)));
+}
+
+esp_err_t esp_ble_gap_start_advertising(esp_ble_adv_params_t* adv_params) {
+    if (!adv_params || !ble_started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (link_host >= 0) {
+        return ESP_FAIL;    // one connection at a time
+    }
+    bool directed = (adv_params->adv_type == ADV_TYPE_DIRECT_IND_HIGH ||
+                     adv_params->adv_type == ADV_TYPE_DIRECT_IND_LOW);
+    __sim_ble_start_advertising(directed ? SIM_BLE_ADV_DIRECTED : SIM_BLE_ADV_GENERAL,
+                                directed ? adv_params->peer_addr : NULL);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_advertising(void) {
+    adv = SIM_BLE_ADV_OFF;
+    __sim_ble_plan();
+    return ESP_OK;
+}
+
+// The disconnect completes from the stack's task, after the call returns
+esp_err_t esp_ble_gap_disconnect(esp_bd_addr_t remote_device) {
+    if (link_host < 0 || __sim_ble_find(remote_device) != link_host) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim_at(sim_now_us(), __sim_ble_drop_event, (void*)(uintptr_t)generation);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_remove_bond_device(esp_bd_addr_t bd_addr) {
+    int host = __sim_ble_find(bd_addr);
+    if (host < 0) {
+        return ESP_FAIL;
+    }
+    hosts[host].bonded = false;
+    return ESP_OK;
+}
+
+size_t sim_ble_report_count(void) {
+    return ble_reports.size();
+}
+
+bool sim_ble_get_report(size_t index, sim_ble_report_t* report) {
+    if (!report || index >= ble_reports.size()) {
+        return false;
+    }
+    *report = ble_reports[index];
+    return true;
+}
+
+BleKeyboard::BleKeyboard(std::string name, std::string manufacturer, uint8_t battery)
+    : device_name(name), device_manufacturer(manufacturer), battery_level(battery) {
+    memset(&report, 0, sizeof(report));
+}
+
+void BleKeyboard::begin(void) {
+    ble_started = true;
+    __sim_ble_start_advertising(SIM_BLE_ADV_GENERAL, NULL);
+}
+
+void BleKeyboard::end(void) {
+    ble_started = false;
+    __sim_ble_drop();
+    adv = SIM_BLE_ADV_OFF;
+    __sim_ble_plan();
+}
+
+bool BleKeyboard::isConnected(void) {
+    return ble_started && link_host >= 0;
+}
+
+void BleKeyboard::sendReport(KeyReport* keys) {
+    if (!keys || !isConnected()) {
+        return;
+    }
+    sim_ble_report_t entry;
+    entry.time_us = sim_now_us();
+    entry.modifiers = keys->modifiers;
+    memcpy(entry.keys, keys->keys, sizeof(entry.keys));
+    ble_reports.push_back(entry);
+}
+
+// Usage codes only: the ASCII translation table of the real library is not modelled
+size_t BleKeyboard::press(uint8_t k) {
+    for (uint8_t i = 0; i < 6; i++) {
+        if (report.keys[i] == k) {
+            return 1;
+        }
+    }
+    for (uint8_t i = 0; i < 6; i++) {
+        if (report.keys[i] == 0) {
+            report.keys[i] = k;
+            sendReport(&report);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t BleKeyboard::release(uint8_t k) {
+    for (uint8_t i = 0; i < 6; i++) {
+        if (report.keys[i] == k) {
+            report.keys[i] = 0;
+        }
+    }
+    sendReport(&report);
+    return 1;
+}
+
+size_t BleKeyboard::write(uint8_t c) {
+    size_t n = press(c);
+    release(c);
+    return n;
+}
+
+size_t BleKeyboard::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buffer[n])) {
+        n++;
+    }
+    return n;
+}
+
+void BleKeyboard::releaseAll(void) {
+    memset(&report, 0, sizeof(report));
+    sendReport(&report);
+}
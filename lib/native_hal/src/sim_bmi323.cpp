@@ -0,0 +1,453 @@
+#include "sim.h"
+
+#define REG_CHIP_ID             0x00
+#define REG_ERR                 0x01
+#define REG_STATUS              0x02
+#define REG_ACC_DATA_X          0x03
+#define REG_GYR_DATA_X          0x06
+#define REG_TEMP_DATA           0x09
+#define REG_SENSOR_TIME_0       0x0A
+#define REG_SENSOR_TIME_1       0x0B
+#define REG_INT_STATUS_INT1     0x0D
+#define REG_FEATURE_IO0         0x10
+#define REG_FEATURE_IO_STATUS   0x14
+#define REG_FIFO_FILL_LEVEL     0x15
+#define REG_FIFO_DATA           0x16
+#define REG_ACC_CONF            0x20
+#define REG_GYR_CONF            0x21
+#define REG_FIFO_WATERMARK      0x35
+#define REG_FIFO_CONF           0x36
+#define REG_FIFO_CTRL           0x37
+#define REG_IO_INT_CTRL         0x38
+#define REG_INT_MAP1            0x3A
+#define REG_INT_MAP2            0x3B
+#define REG_FEATURE_DATA_ADDR   0x41
+#define REG_FEATURE_DATA_TX     0x42
+#define REG_CMD                 0x7E
+
+#define CHIP_ID                 0x0043
+#define CMD_SOFT_RESET          0xDEAF
+#define DUMMY_BYTES             2
+#define ACC_CONF_DEFAULT        0x0028
+#define GYR_CONF_DEFAULT        0x0048
+#define CONF_ODR_MASK           0x000F
+#define CONF_RANGE_SHIFT        4
+#define CONF_RANGE_MASK         0x0007
+#define CONF_MODE_SHIFT         12
+#define CONF_MODE_MASK          0x0007
+#define ODR_100HZ               8
+#define PERIOD_100HZ_US         10000
+
+#define STATUS_DRDY_TEMP        (1u << 5)
+#define STATUS_DRDY_GYR         (1u << 6)
+#define STATUS_DRDY_ACC         (1u << 7)
+#define INT_STATUS_ANY_MOTION   (1u << 1)
+#define INT_STATUS_FWM          (1u << 10)
+#define INT_STATUS_FFULL        (1u << 11)
+#define INT_STATUS_GYR_DRDY     (1u << 12)
+#define INT_STATUS_ACC_DRDY     (1u << 13)
+#define IO_INT_CTRL_ACTIVE_HIGH (1u << 0)
+#define IO_INT_CTRL_OUTPUT_EN   (1u << 2)
+#define INT_MAP2_FWM_SHIFT      12
+#define INT_MAP2_FFULL_SHIFT    14
+#define INT_MAP2_DRDY_SHIFT     10
+#define INT_MAP2_INT1           1u
+#define INT_MAP1_ANY_MOTION_SHIFT 2
+
+#define FEATURE_IO0_ANY_MOTION_SHIFT 3     // X, Y, Z enable bits
+#define FEATURE_IO_STATUS_SYNC  0x0001
+#define ANYMO_1_EXT             0x05
+#define ANYMO_3_EXT             0x07
+#define ANYMO_THRESHOLD_MASK    0x0FFF      // 1/512 g per LSB
+#define ANYMO_ACC_REF_UP        (1u << 12)
+#define ANYMO_DURATION_MASK     0x1FFF      // 20 ms per LSB
+#define ANYMO_DURATION_UNIT_US  20000
+
+#define FIFO_CONF_STOP_ON_FULL  (1u << 0)
+#define FIFO_CONF_TIME_EN       (1u << 8)
+#define FIFO_CONF_ACC_EN        (1u << 9)
+#define FIFO_CONF_GYR_EN        (1u << 10)
+#define FIFO_CONF_TEMP_EN       (1u << 11)
+#define FIFO_CTRL_FLUSH         0x0001
+#define FIFO_CAPACITY_WORDS     1024
+#define FIFO_EMPTY_WORD         0x8000
+#define FIFO_ACC_DUMMY_WORD     0x7F01
+#define FIFO_GYR_DUMMY_WORD     0x7F02
+#define FIFO_TEMP_DUMMY_WORD    0x8000
+
+#define SENSOR_TIME_TICK_NUM    625     // 39.0625 us per tick
+#define SENSOR_TIME_TICK_DEN    16
+#define INT_PULSE_US            2
+#define ACC_LSB_PER_G_2G        16384.0f
+#define GYR_LSB_PER_DPS_125     262.144f
+#define TEMP_LSB_PER_C          512.0f
+#define TEMP_OFFSET_C           23.0f
+
+static bool __bmi323_enabled(uint16_t conf) {
+    return ((conf >> CONF_MODE_SHIFT) & CONF_MODE_MASK) != 0;
+}
+
+// Output data rate period; codes step by powers of two around 100 Hz
+static uint32_t __bmi323_period_us(uint16_t conf) {
+    uint8_t odr = conf & CONF_ODR_MASK;
+    if (odr == 0) {
+        return 0;
+    }
+    return (odr >= ODR_100HZ) ? (PERIOD_100HZ_US >> (odr - ODR_100HZ)) : (PERIOD_100HZ_US << (ODR_100HZ - odr));
+}
+
+static int16_t __bmi323_saturate(float value) {
+    if (value > 32767.0f) return 32767;
+    if (value < -32768.0f) return -32768;
+    return (int16_t)lroundf(value);
+}
+
+static void __bmi323_int_release(void* ctx) {
+    sim_bmi323_t* imu = static_cast<sim_bmi323_t*>(ctx);
+    uint16_t ctrl = imu->regs[REG_IO_INT_CTRL];
+    if (ctrl & IO_INT_CTRL_OUTPUT_EN) {
+        sim_gpio_set(imu->int_pin, (ctrl & IO_INT_CTRL_ACTIVE_HIGH) ? LOW : HIGH);
+    }
+}
+
+// Latch `status` bits and pulse INT1 if any of them is routed there
+static void __bmi323_raise(sim_bmi323_t* imu, uint16_t status) {
+    imu->regs[REG_INT_STATUS_INT1] |= status;
+
+    uint16_t map = imu->regs[REG_INT_MAP2];
+    bool routed = false;
+    if ((status & INT_STATUS_ACC_DRDY) && ((map >> INT_MAP2_DRDY_SHIFT) & 0x3) == INT_MAP2_INT1) routed = true;
+    if ((status & INT_STATUS_FWM) && ((map >> INT_MAP2_FWM_SHIFT) & 0x3) == INT_MAP2_INT1) routed = true;
+    if ((status & INT_STATUS_FFULL) && ((map >> INT_MAP2_FFULL_SHIFT) & 0x3) == INT_MAP2_INT1) routed = true;
+    if ((status & INT_STATUS_ANY_MOTION) &&
+        ((imu->regs[REG_INT_MAP1] >> INT_MAP1_ANY_MOTION_SHIFT) & 0x3) == INT_MAP2_INT1) routed = true;
+
+    uint16_t ctrl = imu->regs[REG_IO_INT_CTRL];
+    if (!routed || !(ctrl & IO_INT_CTRL_OUTPUT_EN)) {
+        return;
+    }
+    sim_gpio_set(imu->int_pin, (ctrl & IO_INT_CTRL_ACTIVE_HIGH) ? HIGH : LOW);
+    sim_at(sim_now_us() + INT_PULSE_US, __bmi323_int_release, imu);
+}
+
+static void __bmi323_fifo_flush(sim_bmi323_t* imu) {
+    imu->fifo_head = 0;
+    imu->fifo_len = 0;
+}
+
+static uint16_t __bmi323_fifo_pop(sim_bmi323_t* imu) {
+    if (imu->fifo_len == 0) {
+        return FIFO_EMPTY_WORD;
+    }
+    uint16_t word = imu->fifo[imu->fifo_head];
+    imu->fifo_head = (uint16_t)((imu->fifo_head + 1) % FIFO_CAPACITY_WORDS);
+    imu->fifo_len--;
+    return word;
+}
+
+static void __bmi323_fifo_frame(sim_bmi323_t* imu) {
+    uint16_t conf = imu->regs[REG_FIFO_CONF];
+    uint16_t frame[8];
+    uint8_t len = 0;
+    bool acc = __bmi323_enabled(imu->regs[REG_ACC_CONF]);
+    bool gyr = __bmi323_enabled(imu->regs[REG_GYR_CONF]);
+
+    if (conf & FIFO_CONF_ACC_EN) {
+        for (uint8_t i = 0; i < 3; i++) {
+            frame[len++] = acc ? imu->regs[REG_ACC_DATA_X + i] : (i == 0 ? FIFO_ACC_DUMMY_WORD : 0);
+        }
+    }
+    if (conf & FIFO_CONF_GYR_EN) {
+        for (uint8_t i = 0; i < 3; i++) {
+            frame[len++] = gyr ? imu->regs[REG_GYR_DATA_X + i] : (i == 0 ? FIFO_GYR_DUMMY_WORD : 0);
+        }
+    }
+    if (conf & FIFO_CONF_TEMP_EN) {
+        frame[len++] = (acc || gyr) ? imu->regs[REG_TEMP_DATA] : FIFO_TEMP_DUMMY_WORD;
+    }
+    if (conf & FIFO_CONF_TIME_EN) {
+        frame[len++] = imu->regs[REG_SENSOR_TIME_0];
+    }
+    if (len == 0) {
+        return;
+    }
+
+    uint16_t watermark = imu->regs[REG_FIFO_WATERMARK];
+    bool below = imu->fifo_len < watermark;
+    if (imu->fifo_len + len > FIFO_CAPACITY_WORDS) {
+        imu->fifo_dropped++;
+        if (conf & FIFO_CONF_STOP_ON_FULL) {
+            __bmi323_raise(imu, INT_STATUS_FFULL);
+            return;
+        }
+        // Stream mode: the oldest frame makes room
+        for (uint8_t i = 0; i < len; i++) {
+            __bmi323_fifo_pop(imu);
+        }
+    }
+    for (uint8_t i = 0; i < len; i++) {
+        imu->fifo[(imu->fifo_head + imu->fifo_len) % FIFO_CAPACITY_WORDS] = frame[i];
+        imu->fifo_len++;
+    }
+    if (watermark != 0 && below && imu->fifo_len >= watermark) {
+        __bmi323_raise(imu, INT_STATUS_FWM);
+    }
+}
+
+// Slope detector: any enabled axis moving more than the threshold between
+// consecutive samples, for at least the configured duration
+static void __bmi323_any_motion(sim_bmi323_t* imu, float acc_lsb) {
+    uint8_t axes = (imu->feature_io0 >> FEATURE_IO0_ANY_MOTION_SHIFT) & 0x7;
+    int16_t now[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        now[i] = (int16_t)imu->regs[REG_ACC_DATA_X + i];
+    }
+    if (axes == 0 || !imu->anymo_have_ref) {
+        memcpy(imu->anymo_ref, now, sizeof(now));
+        imu->anymo_have_ref = axes != 0;
+        imu->anymo_run_us = 0;
+        return;
+    }
+
+    float threshold = (float)(imu->ext[ANYMO_1_EXT] & ANYMO_THRESHOLD_MASK) * acc_lsb / 512.0f;
+    bool moving = false;
+    for (uint8_t i = 0; i < 3; i++) {
+        if ((axes & (1u << i)) && fabsf((float)now[i] - (float)imu->anymo_ref[i]) > threshold) {
+            moving = true;
+        }
+    }
+    if (imu->ext[ANYMO_1_EXT] & ANYMO_ACC_REF_UP) {
+        memcpy(imu->anymo_ref, now, sizeof(now));
+    }
+    if (!moving) {
+        imu->anymo_run_us = 0;
+        return;
+    }
+    uint32_t duration_us = (uint32_t)(imu->ext[ANYMO_3_EXT] & ANYMO_DURATION_MASK) * ANYMO_DURATION_UNIT_US;
+    imu->anymo_run_us += imu->period_us;
+    if (imu->anymo_run_us >= duration_us) {
+        imu->anymo_run_us = 0;
+        imu->any_motion_events++;
+        __bmi323_raise(imu, INT_STATUS_ANY_MOTION);
+    }
+}
+
+static void __bmi323_schedule(sim_bmi323_t* imu);
+
+static void __bmi323_sample(void* ctx) {
+    sim_bmi323_t* imu = static_cast<sim_bmi323_t*>(ctx);
+    uint64_t now = sim_now_us();
+    if (imu->period_us == 0 || now != imu->next_sample_us) {
+        return;  // superseded by a reconfiguration
+    }
+
+    float accel_g[3] = {0.0f, 0.0f, 1.0f};
+    float gyro_dps[3] = {0.0f, 0.0f, 0.0f};
+    float temp_c = 25.0f;
+    if (imu->motion) {
+        imu->motion(imu->motion_ctx, now, accel_g, gyro_dps, &temp_c);
+    }
+
+    uint16_t acc_conf = imu->regs[REG_ACC_CONF];
+    uint16_t gyr_conf = imu->regs[REG_GYR_CONF];
+    float acc_lsb = ACC_LSB_PER_G_2G / (float)(1u << ((acc_conf >> CONF_RANGE_SHIFT) & CONF_RANGE_MASK));
+    float gyr_lsb = GYR_LSB_PER_DPS_125 / (float)(1u << ((gyr_conf >> CONF_RANGE_SHIFT) & CONF_RANGE_MASK));
+    uint16_t status = 0;
+    if (__bmi323_enabled(acc_conf)) {
+        for (uint8_t i = 0; i < 3; i++) {
+            imu->regs[REG_ACC_DATA_X + i] = (uint16_t)__bmi323_saturate(accel_g[i] * acc_lsb);
+        }
+        status |= STATUS_DRDY_ACC;
+    }
+    if (__bmi323_enabled(gyr_conf)) {
+        for (uint8_t i = 0; i < 3; i++) {
+            imu->regs[REG_GYR_DATA_X + i] = (uint16_t)__bmi323_saturate(gyro_dps[i] * gyr_lsb);
+        }
+        status |= STATUS_DRDY_GYR;
+    }
+    imu->regs[REG_TEMP_DATA] = (uint16_t)__bmi323_saturate((temp_c - TEMP_OFFSET_C) * TEMP_LSB_PER_C);
+    status |= STATUS_DRDY_TEMP;
+
+    uint32_t ticks = (uint32_t)(now * SENSOR_TIME_TICK_DEN / SENSOR_TIME_TICK_NUM);
+    imu->regs[REG_SENSOR_TIME_0] = (uint16_t)(ticks & 0xFFFF);
+    imu->regs[REG_SENSOR_TIME_1] = (uint16_t)(ticks >> 16);
+    imu->regs[REG_STATUS] |= status;
+    imu->samples++;
+
+    __bmi323_fifo_frame(imu);
+    if (status & STATUS_DRDY_ACC) {
+        __bmi323_any_motion(imu, acc_lsb);
+    }
+    if (status & STATUS_DRDY_ACC) {
+        __bmi323_raise(imu, INT_STATUS_ACC_DRDY);
+    } else if (status & STATUS_DRDY_GYR) {
+        __bmi323_raise(imu, INT_STATUS_GYR_DRDY);
+    }
+
+    imu->next_sample_us = now + imu->period_us;
+    sim_at(imu->next_sample_us, __bmi323_sample, imu);
+}
+
+// Restart the sample clock after ACC/GYR_CONF changed
+static void __bmi323_schedule(sim_bmi323_t* imu) {
+    uint16_t acc_conf = imu->regs[REG_ACC_CONF];
+    uint16_t gyr_conf = imu->regs[REG_GYR_CONF];
+    uint32_t period = 0;
+    if (__bmi323_enabled(acc_conf)) {
+        period = __bmi323_period_us(acc_conf);
+    } else if (__bmi323_enabled(gyr_conf)) {
+        period = __bmi323_period_us(gyr_conf);
+    }
+
+    imu->period_us = period;
+    if (period == 0) {
+        imu->next_sample_us = 0;
+        return;
+    }
+    imu->next_sample_us = sim_now_us() + period;
+    sim_at(imu->next_sample_us, __bmi323_sample, imu);
+}
+
+static void __bmi323_reset(sim_bmi323_t* imu) {
+    memset(imu->regs, 0, sizeof(imu->regs));
+    imu->regs[REG_CHIP_ID] = CHIP_ID;
+    imu->regs[REG_ACC_CONF] = ACC_CONF_DEFAULT;
+    imu->regs[REG_GYR_CONF] = GYR_CONF_DEFAULT;
+    imu->regs[REG_TEMP_DATA] = FIFO_TEMP_DUMMY_WORD;
+    imu->reg = 0;
+    memset(imu->ext, 0, sizeof(imu->ext));
+    imu->ext_addr = 0;
+    imu->feature_io0 = 0;
+    imu->anymo_have_ref = false;
+    imu->anymo_run_us = 0;
+    __bmi323_fifo_flush(imu);
+    imu->period_us = 0;
+    imu->next_sample_us = 0;
+}
+
+static void __bmi323_write_reg(sim_bmi323_t* imu, uint8_t reg, uint16_t value) {
+    switch (reg) {
+        case REG_CMD:
+            if (value == CMD_SOFT_RESET) {
+                __bmi323_reset(imu);
+            }
+            return;
+        case REG_FIFO_CTRL:
+            if (value & FIFO_CTRL_FLUSH) {
+                __bmi323_fifo_flush(imu);
+            }
+            return;
+        case REG_ACC_CONF:
+        case REG_GYR_CONF:
+            imu->regs[reg] = value;
+            __bmi323_schedule(imu);
+            return;
+        case REG_FEATURE_IO0:
+            imu->regs[reg] = value;     // takes effect on the next sync
+            return;
+        case REG_FEATURE_IO_STATUS:
+            if (value & FEATURE_IO_STATUS_SYNC) {
+                imu->feature_io0 = imu->regs[REG_FEATURE_IO0];
+                imu->anymo_have_ref = false;
+            }
+            return;
+        case REG_FEATURE_DATA_ADDR:
+            imu->ext_addr = (uint8_t)(value % SIM_BMI323_EXT_REGS);
+            return;
+        case REG_FEATURE_DATA_TX:
+            imu->ext[imu->ext_addr] = value;
+            imu->ext_addr = (uint8_t)((imu->ext_addr + 1) % SIM_BMI323_EXT_REGS);
+            return;
+        case REG_IO_INT_CTRL:
+            imu->regs[reg] = value;
+            if (value & IO_INT_CTRL_OUTPUT_EN) {
+                sim_gpio_set(imu->int_pin, (value & IO_INT_CTRL_ACTIVE_HIGH) ? LOW : HIGH);
+            }
+            return;
+        default:
+            // Data and status registers are read-only
+            if (reg > REG_FIFO_DATA) {
+                imu->regs[reg] = value;
+            }
+            return;
+    }
+}
+
+static uint16_t __bmi323_read_reg(sim_bmi323_t* imu, uint8_t reg) {
+    uint16_t value;
+    switch (reg) {
+        case REG_STATUS:
+        case REG_INT_STATUS_INT1:
+            value = imu->regs[reg];
+            imu->regs[reg] = 0;
+            return value;
+        case REG_FIFO_FILL_LEVEL:
+            return imu->fifo_len;
+        case REG_FIFO_DATA:
+            return __bmi323_fifo_pop(imu);
+        default:
+            return imu->regs[reg];
+    }
+}
+
+static void __bmi323_i2c_write(void* ctx, const uint8_t* data, size_t len) {
+    sim_bmi323_t* imu = static_cast<sim_bmi323_t*>(ctx);
+    if (len == 0) {
+        return;
+    }
+    imu->reg = data[0] & 0x7F;
+    for (size_t i = 1; i + 1 < len; i += 2) {
+        __bmi323_write_reg(imu, imu->reg, (uint16_t)(data[i] | (data[i + 1] << 8)));
+        imu->reg = (uint8_t)((imu->reg + 1) & 0x7F);
+    }
+}
+
+// Reads auto-increment, except FIFO_DATA which streams the FIFO
+static size_t __bmi323_i2c_read(void* ctx, uint8_t* data, size_t len) {
+    sim_bmi323_t* imu = static_cast<sim_bmi323_t*>(ctx);
+    size_t n = 0;
+    for (; n < len && n < DUMMY_BYTES; n++) {
+        data[n] = 0;
+    }
+    uint8_t reg = imu->reg;
+    while (n + 1 < len) {
+        uint16_t value = __bmi323_read_reg(imu, reg);
+        data[n++] = (uint8_t)(value & 0xFF);
+        data[n++] = (uint8_t)(value >> 8);
+        if (reg != REG_FIFO_DATA) {
+            reg = (uint8_t)((reg + 1) & 0x7F);
+        }
+    }
+    if (n < len) {
+        data[n++] = 0;
+    }
+    return n;
+}
+
+void sim_bmi323_init(sim_bmi323_t* imu, TwoWire* bus, uint8_t address, uint8_t int_pin) {
+    if (!imu) {
+        return;
+    }
+    imu->device.address = address;
+    imu->device.ctx = imu;
+    imu->device.write = __bmi323_i2c_write;
+    imu->device.read = __bmi323_i2c_read;
+    imu->int_pin = int_pin;
+    imu->samples = 0;
+    imu->fifo_dropped = 0;
+    imu->any_motion_events = 0;
+    imu->motion = NULL;
+    imu->motion_ctx = NULL;
+    __bmi323_reset(imu);
+    if (bus) {
+        sim_i2c_attach(bus, &imu->device);
+    }
+}
+
+void sim_bmi323_set_motion(sim_bmi323_t* imu, sim_bmi323_motion_fn motion, void* ctx) {
+    if (!imu) {
+        return;
+    }
+    imu->motion = motion;
+    imu->motion_ctx = ctx;
+}
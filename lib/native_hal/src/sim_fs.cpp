@@ -0,0 +1,137 @@
+#include <LittleFS.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "sim.h"
+
+LittleFSFS LittleFS;
+
+File::File(FILE* file) {
+    if (file) {
+        handle.reset(file, fclose);
+    }
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    return handle ? fwrite(buffer, 1, size, handle.get()) : 0;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    return handle ? fread(buffer, 1, size, handle.get()) : 0;
+}
+
+int File::read(void) {
+    uint8_t c;
+    return (read(&c, 1) == 1) ? c : -1;
+}
+
+int File::peek(void) {
+    if (!handle) {
+        return -1;
+    }
+    int c = fgetc(handle.get());
+    if (c != EOF) {
+        ungetc(c, handle.get());
+    }
+    return (c == EOF) ? -1 : c;
+}
+
+int File::available(void) {
+    return handle ? (int)(size() - position()) : 0;
+}
+
+size_t File::size(void) const {
+    if (!handle) {
+        return 0;
+    }
+    struct stat st;
+    fflush(handle.get());
+    return (fstat(fileno(handle.get()), &st) == 0) ? (size_t)st.st_size : 0;
+}
+
+bool File::seek(uint32_t pos) {
+    return handle && fseek(handle.get(), (long)pos, SEEK_SET) == 0;
+}
+
+size_t File::position(void) const {
+    if (!handle) {
+        return 0;
+    }
+    long pos = ftell(handle.get());
+    return (pos < 0) ? 0 : (size_t)pos;
+}
+
+void File::flush(void) {
+    if (handle) {
+        fflush(handle.get());
+    }
+}
+
+// mkdir -p
+static bool __sim_fs_mkdirs(const std::string& dir) {
+    for (size_t i = 1; i <= dir.size(); i++) {
+        if (i == dir.size() || dir[i] == '/') {
+            std::string prefix = dir.substr(0, i);
+            if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool LittleFSFS::begin(bool format_on_fail, const char* base_path, uint8_t max_open_files,
+                       const char* partition_label) {
+    (void)format_on_fail;
+    (void)base_path;
+    (void)max_open_files;
+    (void)partition_label;
+    mounted = __sim_fs_mkdirs(sim_fs_root());
+    return mounted;
+}
+
+std::string LittleFSFS::host_path(const char* path) const {
+    std::string full = sim_fs_root();
+    if (!path || path[0] != '/') {
+        full += '/';
+    }
+    return full + (path ? path : "");
+}
+
+File LittleFSFS::open(const char* path, const char* mode) {
+    if (!mounted || !path || !mode) {
+        return File();
+    }
+    // Binary mode keeps the host from translating bytes
+    std::string host_mode = std::string(mode) + "b";
+    return File(fopen(host_path(path).c_str(), host_mode.c_str()));
+}
+
+bool LittleFSFS::exists(const char* path) {
+    struct stat st;
+    return mounted && path && stat(host_path(path).c_str(), &st) == 0;
+}
+
+bool LittleFSFS::remove(const char* path) {
+    return mounted && path && ::remove(host_path(path).c_str()) == 0;
+}
+
+bool LittleFSFS::format(void) {
+    DIR* dir = opendir(sim_fs_root());
+    if (!dir) {
+        return false;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_type == DT_REG) {
+            ::remove((std::string(sim_fs_root()) + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+    return true;
+}
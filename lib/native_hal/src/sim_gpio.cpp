@@ -0,0 +1,221 @@
+#include "sim.h"
+
+#include <driver/gpio.h>
+
+typedef struct sim_pin {
+    uint8_t mode;
+    uint8_t driven;             ///< Level set by sim_gpio_set() or digitalWrite()
+    bool has_driver;
+    int8_t external;            ///< Board resistor: -1 none, else the level it pulls to
+    uint8_t isr_mode;
+    bool isr_disabled;          ///< gpio_intr_disable(): the handler stays but does not run
+    uint8_t wakeup;             ///< gpio_wakeup_enable() level type, 0 if none
+    void (*isr)(void* arg);
+    void (*isr_plain)(void);
+    void* isr_arg;
+} sim_pin_t;
+
+static sim_pin_t pins[GPIO_NUM_MAX];
+static bool pins_ready = false;
+
+static void __sim_pins_init(void) {
+    if (pins_ready) {
+        return;
+    }
+    for (uint8_t i = 0; i < GPIO_NUM_MAX; i++) {
+        pins[i].external = -1;
+    }
+    pins_ready = true;
+}
+
+// Undriven inputs float to the board resistor, which beats the internal
+// pull; with neither they read LOW
+static uint8_t __sim_pin_level(const sim_pin_t* pin) {
+    if (pin->has_driver) {
+        return pin->driven;
+    }
+    if (pin->external >= 0) {
+        return (uint8_t)pin->external;
+    }
+    return (pin->mode & PULLUP) ? HIGH : LOW;
+}
+
+static void __sim_pin_fire(sim_pin_t* pin, uint8_t before, uint8_t after) {
+    if (pin->isr_disabled) {
+        return;
+    }
+    bool fire;
+    switch (pin->isr_mode) {
+        case RISING:
+            fire = (before == LOW && after == HIGH);
+            break;
+        case FALLING:
+            fire = (before == HIGH && after == LOW);
+            break;
+        case CHANGE:
+            fire = (before != after);
+            break;
+        case ONLOW:
+            fire = (after == LOW);
+            break;
+        case ONHIGH:
+            fire = (after == HIGH);
+            break;
+        default:
+            fire = false;
+            break;
+    }
+    if (!fire) {
+        return;
+    }
+    if (pin->isr) {
+        pin->isr(pin->isr_arg);
+    } else if (pin->isr_plain) {
+        pin->isr_plain();
+    }
+}
+
+static void __sim_pin_update(uint8_t num, bool has_driver, uint8_t level, uint8_t mode) {
+    __sim_pins_init();
+    sim_pin_t* pin = &pins[num];
+    uint8_t before = __sim_pin_level(pin);
+    pin->has_driver = has_driver;
+    pin->driven = level ? HIGH : LOW;
+    pin->mode = mode;
+    __sim_pin_fire(pin, before, __sim_pin_level(pin));
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    __sim_pin_update(pin, pins[pin].has_driver, pins[pin].driven, mode);
+}
+
+int digitalRead(uint8_t pin) {
+    __sim_pins_init();
+    return (pin < GPIO_NUM_MAX) ? __sim_pin_level(&pins[pin]) : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    __sim_pin_update(pin, true, level, pins[pin].mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void* arg), void* arg, int mode) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    pins[pin].isr = handler;
+    pins[pin].isr_plain = NULL;
+    pins[pin].isr_arg = arg;
+    pins[pin].isr_mode = (uint8_t)mode;
+    pins[pin].isr_disabled = false;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    pins[pin].isr = NULL;
+    pins[pin].isr_plain = handler;
+    pins[pin].isr_arg = NULL;
+    pins[pin].isr_mode = (uint8_t)mode;
+    pins[pin].isr_disabled = false;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    pins[pin].isr = NULL;
+    pins[pin].isr_plain = NULL;
+    pins[pin].isr_mode = 0;
+}
+
+void sim_gpio_set(uint8_t pin, uint8_t level) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    __sim_pin_update(pin, true, level, pins[pin].mode);
+}
+
+void sim_gpio_release(uint8_t pin) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    __sim_pin_update(pin, false, LOW, pins[pin].mode);
+}
+
+void sim_gpio_set_pull(uint8_t pin, uint8_t level) {
+    if (pin >= GPIO_NUM_MAX) {
+        return;
+    }
+    __sim_pins_init();
+    uint8_t before = __sim_pin_level(&pins[pin]);
+    pins[pin].external = level ? HIGH : LOW;
+    __sim_pin_fire(&pins[pin], before, __sim_pin_level(&pins[pin]));
+}
+
+uint8_t sim_gpio_get(uint8_t pin) {
+    __sim_pins_init();
+    return (pin < GPIO_NUM_MAX) ? __sim_pin_level(&pins[pin]) : LOW;
+}
+
+bool sim_gpio_wakeup_pending(void) {
+    __sim_pins_init();
+    for (uint8_t i = 0; i < GPIO_NUM_MAX; i++) {
+        uint8_t level = __sim_pin_level(&pins[i]);
+        if ((pins[i].wakeup == GPIO_INTR_LOW_LEVEL && level == LOW) ||
+            (pins[i].wakeup == GPIO_INTR_HIGH_LEVEL && level == HIGH)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ESP-IDF GPIO driver -------------------------------------------------------
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (gpio_num >= GPIO_NUM_MAX || intr_type >= GPIO_INTR_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].isr_mode = (uint8_t)intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+    if (gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].isr_disabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+    if (gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].isr_disabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (gpio_num >= GPIO_NUM_MAX || (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // On the chip this also makes the pin's interrupt level-triggered
+    pins[gpio_num].isr_mode = (uint8_t)intr_type;
+    pins[gpio_num].wakeup = (uint8_t)intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num) {
+    if (gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].wakeup = 0;
+    return ESP_OK;
+}
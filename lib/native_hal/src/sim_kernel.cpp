@@ -0,0 +1,425 @@
+#include "sim.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#define SIM_NO_WAKE         UINT64_MAX
+#define SIM_LOOP_PRIORITY   1       // Arduino loopTask
+
+struct sim_task {
+    TaskFunction_t fn;
+    void* arg;
+    const char* name;
+    UBaseType_t priority;
+    uint32_t order;             ///< Creation order, breaks priority ties
+    uint32_t notify;            ///< Pending task notifications
+    bool waiting_notify;
+    bool blocked;
+    bool deleted;
+    uint64_t wake_us;           ///< Timeout of a blocked task, SIM_NO_WAKE if none
+};
+
+typedef struct sim_event {
+    uint64_t when_us;
+    uint32_t seq;
+    void (*fn)(void* ctx, uint32_t arg);
+    void* ctx;
+    uint32_t arg;
+} sim_event_t;
+
+struct __sim_event_later {
+    bool operator()(const sim_event_t& a, const sim_event_t& b) const {
+        return (a.when_us != b.when_us) ? (a.when_us > b.when_us) : (a.seq > b.seq);
+    }
+};
+
+// Only the running task touches kernel state; the mutex orders the hand-offs
+static std::mutex handoff_lock;
+static std::condition_variable handoff;
+static std::vector<sim_task*> tasks;
+static sim_task* running = NULL;
+static std::priority_queue<sim_event_t, std::vector<sim_event_t>, __sim_event_later> events;
+static uint32_t event_seq = 0;
+static uint64_t now_us = 0;
+static uint64_t stop_us = 0;
+static bool realtime = false;
+static std::chrono::steady_clock::time_point wall_origin;
+
+struct __sim_task_exit {};
+
+// The thread that first calls into the kernel becomes the loop task
+static sim_task* __sim_self(void) {
+    if (!running) {
+        sim_task* task = new sim_task();
+        task->fn = NULL;
+        task->arg = NULL;
+        task->name = "loopTask";
+        task->priority = SIM_LOOP_PRIORITY;
+        task->order = 0;
+        task->notify = 0;
+        task->waiting_notify = false;
+        task->blocked = false;
+        task->deleted = false;
+        task->wake_us = SIM_NO_WAKE;
+        tasks.push_back(task);
+        running = task;
+    }
+    return running;
+}
+
+static void __sim_event_push(uint64_t when_us, void (*fn)(void* ctx, uint32_t arg), void* ctx, uint32_t arg) {
+    sim_event_t event;
+    event.when_us = when_us;
+    event.seq = event_seq++;
+    event.fn = fn;
+    event.ctx = ctx;
+    event.arg = arg;
+    events.push(event);
+}
+
+static uint64_t __sim_next_wake(void) {
+    uint64_t next = SIM_NO_WAKE;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        sim_task* task = tasks[i];
+        if (task->blocked && !task->deleted && task->wake_us < next) {
+            next = task->wake_us;
+        }
+    }
+    return next;
+}
+
+// In real-time mode, hold virtual time `when_us` back until the wall clock gets there
+static void __sim_pace(uint64_t when_us) {
+    if (realtime) {
+        std::this_thread::sleep_until(wall_origin + std::chrono::microseconds(when_us));
+    }
+}
+
+// Move the clock to `target`, running events and timeouts on the way
+static void __sim_advance_to(uint64_t target) {
+    for (;;) {
+        uint64_t next = __sim_next_wake();
+        if (!events.empty() && events.top().when_us < next) {
+            next = events.top().when_us;
+        }
+        if (next > target) {
+            break;
+        }
+        if (next > now_us) {
+            __sim_pace(next);
+            now_us = next;
+        }
+        if (stop_us != 0 && now_us >= stop_us) {
+            sim_exit(0);
+        }
+        while (!events.empty() && events.top().when_us <= now_us) {
+            sim_event_t event = events.top();
+            events.pop();
+            event.fn(event.ctx, event.arg);
+        }
+        for (size_t i = 0; i < tasks.size(); i++) {
+            sim_task* task = tasks[i];
+            if (task->blocked && task->wake_us <= now_us) {
+                task->blocked = false;
+                task->wake_us = SIM_NO_WAKE;
+            }
+        }
+    }
+    if (target > now_us && target != SIM_NO_WAKE) {
+        __sim_pace(target);
+        now_us = target;
+        if (stop_us != 0 && now_us >= stop_us) {
+            sim_exit(0);
+        }
+    }
+}
+
+// Highest priority runnable task; ties go round-robin after `after`
+static sim_task* __sim_pick(const sim_task* after) {
+    sim_task* best = NULL;
+    size_t count = tasks.size();
+    size_t start = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (tasks[i] == after) {
+            start = i + 1;
+            break;
+        }
+    }
+    for (size_t n = 0; n < count; n++) {
+        sim_task* task = tasks[(start + n) % count];
+        if (task->blocked || task->deleted) continue;
+        if (!best || task->priority > best->priority) {
+            best = task;
+        }
+    }
+    return best;
+}
+
+// Hand the CPU to the next runnable task and wait until `self` runs again
+static void __sim_switch(sim_task* self) {
+    sim_task* next;
+    while ((next = __sim_pick(self)) == NULL) {
+        uint64_t wake = __sim_next_wake();
+        if (wake == SIM_NO_WAKE && events.empty()) {
+            if (stop_us != 0) {
+                __sim_advance_to(stop_us);
+            }
+            fprintf(stderr, "sim: every task is blocked forever at %llu us\n", (unsigned long long)now_us);
+            sim_exit(1);
+        }
+        uint64_t target = wake;
+        if (!events.empty() && events.top().when_us < target) {
+            target = events.top().when_us;
+        }
+        __sim_advance_to(target);
+    }
+
+    std::unique_lock<std::mutex> lock(handoff_lock);
+    running = next;
+    if (next == self) {
+        return;
+    }
+    handoff.notify_all();
+    if (self->deleted) {
+        return;
+    }
+    handoff.wait(lock, [self] { return running == self; });
+}
+
+static void __sim_task_main(sim_task* task) {
+    {
+        std::unique_lock<std::mutex> lock(handoff_lock);
+        handoff.wait(lock, [task] { return running == task; });
+    }
+    try {
+        task->fn(task->arg);
+    } catch (const __sim_task_exit&) {
+    }
+    task->deleted = true;
+    __sim_switch(task);
+}
+
+static void __sim_block(sim_task* self, uint64_t wake_us) {
+    self->blocked = true;
+    self->wake_us = wake_us;
+    __sim_switch(self);
+}
+
+static uint64_t __sim_ticks_to_wake(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return SIM_NO_WAKE;
+    }
+    return now_us + (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+// A poll that found nothing: let others run, or let time pass
+static void __sim_poll(sim_task* self) {
+    sim_task* other = __sim_pick(self);
+    if (other && other != self) {
+        __sim_switch(self);
+        return;
+    }
+    __sim_advance_to(now_us + SIM_POLL_STEP_US);
+}
+
+uint64_t sim_now_us(void) {
+    return now_us;
+}
+
+typedef struct sim_callback {
+    void (*fn)(void* ctx);
+    void* ctx;
+} sim_callback_t;
+
+static void __sim_run_callback(void* ctx, uint32_t arg) {
+    sim_callback_t* callback = static_cast<sim_callback_t*>(ctx);
+    void (*fn)(void*) = callback->fn;
+    void* fn_ctx = callback->ctx;
+    delete callback;
+    fn(fn_ctx);
+}
+
+void sim_at(uint64_t when_us, void (*fn)(void* ctx), void* ctx) {
+    if (!fn) {
+        return;
+    }
+    sim_callback_t* callback = new sim_callback_t;
+    callback->fn = fn;
+    callback->ctx = ctx;
+    __sim_event_push(when_us, __sim_run_callback, callback, 0);
+}
+
+static void __sim_gpio_event(void* ctx, uint32_t arg) {
+    sim_gpio_set((uint8_t)(arg >> 8), (uint8_t)(arg & 0xFF));
+}
+
+void sim_gpio_set_at(uint64_t when_us, uint8_t pin, uint8_t level) {
+    __sim_event_push(when_us, __sim_gpio_event, NULL, ((uint32_t)pin << 8) | level);
+}
+
+void sim_busy_us(uint32_t us) {
+    __sim_self();
+    __sim_advance_to(now_us + us);
+}
+
+void sim_halt_until(uint64_t until_us, bool (*woken)(void* ctx), void* ctx) {
+    __sim_self();
+    while (!woken(ctx)) {
+        uint64_t next = events.empty() ? SIM_NO_WAKE : events.top().when_us;
+        if (next >= until_us) {
+            if (until_us == SIM_NO_WAKE) {
+                if (stop_us != 0) {
+                    __sim_advance_to(stop_us);
+                }
+                fprintf(stderr, "sim: halted with nothing to wake it at %llu us\n", (unsigned long long)now_us);
+                sim_exit(1);
+            }
+            __sim_advance_to(until_us);
+            return;
+        }
+        __sim_advance_to(next);
+    }
+}
+
+void sim_set_realtime(bool enabled) {
+    realtime = enabled;
+    wall_origin = std::chrono::steady_clock::now() - std::chrono::microseconds(now_us);
+}
+
+void sim_stop_at(uint64_t when_us) {
+    stop_us = when_us;
+}
+
+void sim_exit(int status) {
+    Serial.flush();
+    sim_report(stderr);
+    fflush(stdout);
+    fflush(stderr);
+    // Parked task threads are never joined; leave without running destructors
+    _Exit(status);
+}
+
+uint32_t micros(void) {
+    return (uint32_t)now_us;
+}
+
+uint32_t millis(void) {
+    return (uint32_t)(now_us / 1000);
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    sim_busy_us(us);
+}
+
+void yield(void) {
+    __sim_poll(__sim_self());
+}
+
+// FreeRTOS ------------------------------------------------------------------
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)stack_depth;
+    (void)core;
+    __sim_self();
+    if (!fn) {
+        return pdFAIL;
+    }
+    sim_task* task = new sim_task();
+    task->fn = fn;
+    task->arg = arg;
+    task->name = name;
+    task->priority = priority;
+    task->order = (uint32_t)tasks.size();
+    task->notify = 0;
+    task->waiting_notify = false;
+    task->blocked = false;
+    task->deleted = false;
+    task->wake_us = SIM_NO_WAKE;
+    tasks.push_back(task);
+    if (handle) {
+        *handle = task;
+    }
+    std::thread(__sim_task_main, task).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    sim_task* self = __sim_self();
+    if (!task || task == self) {
+        throw __sim_task_exit();
+    }
+    // Its thread stays parked; it is never picked again
+    task->deleted = true;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim_task* self = __sim_self();
+    if (ticks == 0) {
+        __sim_poll(self);
+        return;
+    }
+    __sim_block(self, __sim_ticks_to_wake(ticks));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return __sim_self();
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / (portTICK_PERIOD_MS * 1000));
+}
+
+static uint32_t __sim_take(sim_task* self, BaseType_t clear_on_exit) {
+    uint32_t value = self->notify;
+    if (value != 0) {
+        self->notify = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    sim_task* self = __sim_self();
+    if (self->notify == 0) {
+        if (ticks_to_wait == 0) {
+            __sim_poll(self);
+        } else {
+            self->waiting_notify = true;
+            __sim_block(self, __sim_ticks_to_wake(ticks_to_wait));
+            self->waiting_notify = false;
+        }
+    }
+    return __sim_take(self, clear_on_exit);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    vTaskNotifyGiveFromISR(task, NULL);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+    if (!task || task->deleted) {
+        return;
+    }
+    task->notify++;
+    if (task->blocked && task->waiting_notify) {
+        task->blocked = false;
+        task->wake_us = SIM_NO_WAKE;
+        if (higher_priority_task_woken && running && task->priority > running->priority) {
+            *higher_priority_task_woken = pdTRUE;
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include <string>
+
+#include <Wire.h>
+#include <pin.h>
+
+#include "sim.h"
+
+#define SIM_BMI323_ADDRESS      0x68
+#define SIM_DEFAULT_RUN_MS      10000
+#define SIM_DEFAULT_FS_ROOT     ".pio/sim_fs"
+#define SIM_MAX_SHAKES          8
+#define SIM_SHAKE_HZ            4.0f    // hand-held wobble
+#define SIM_SHAKE_ACCEL_G       0.3f
+#define SIM_SHAKE_GYRO_DPS      120.0f
+
+typedef struct sim_shake {
+    uint64_t start_us;
+    uint64_t end_us;
+} sim_shake_t;
+
+static std::string fs_root = SIM_DEFAULT_FS_ROOT;
+static sim_bmi323_t default_imu;
+static bool default_imu_ready = false;
+static sim_shake_t shakes[SIM_MAX_SHAKES];
+static uint8_t shake_count = 0;
+
+const char* sim_fs_root(void) {
+    return fs_root.c_str();
+}
+
+// Splits a leading "MS:" off `arg`; returns false if there is none
+static bool __sim_parse_time(const char** arg, uint64_t* when_us) {
+    char* end = NULL;
+    unsigned long long ms = strtoull(*arg, &end, 10);
+    if (end == *arg || *end != ':') {
+        return false;
+    }
+    *when_us = (uint64_t)ms * 1000;
+    *arg = end + 1;
+    return true;
+}
+
+static void __sim_serial_event(void* ctx) {
+    std::string* text = static_cast<std::string*>(ctx);
+    sim_serial_input(text->c_str());
+    delete text;
+}
+
+// Shell-friendly input: a literal "\n" becomes a newline
+static std::string __sim_unescape(const char* text) {
+    std::string out;
+    for (; *text; text++) {
+        if (text[0] == '\\' && text[1] == 'n') {
+            out += '\n';
+            text++;
+        } else {
+            out += *text;
+        }
+    }
+    return out;
+}
+
+// Flat and still, except while a --shake window is open
+static void __sim_shake_motion(void* ctx, uint64_t t_us, float accel_g[3], float gyro_dps[3], float* temp_c) {
+    (void)ctx;
+    (void)temp_c;
+    for (uint8_t i = 0; i < shake_count; i++) {
+        if (t_us >= shakes[i].start_us && t_us < shakes[i].end_us) {
+            float phase = 2.0f * (float)M_PI * SIM_SHAKE_HZ * (float)(t_us - shakes[i].start_us) / 1e6f;
+            accel_g[0] = SIM_SHAKE_ACCEL_G * sinf(phase);
+            accel_g[1] = SIM_SHAKE_ACCEL_G * cosf(phase);
+            gyro_dps[2] = SIM_SHAKE_GYRO_DPS * sinf(phase);
+            return;
+        }
+    }
+}
+
+void sim_configure(int argc, char** argv) {
+    uint64_t run_ms = SIM_DEFAULT_RUN_MS;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strncmp(arg, "--ms=", 5) == 0) {
+            run_ms = strtoull(arg + 5, NULL, 10);
+        } else if (strncmp(arg, "--fs=", 5) == 0) {
+            fs_root = arg + 5;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            sim_serial_set_output(NULL);
+        } else if (strcmp(arg, "--realtime") == 0) {
+            sim_set_realtime(true);
+        } else if (strncmp(arg, "--input=", 8) == 0) {
+            const char* text = arg + 8;
+            uint64_t when_us = 0;
+            __sim_parse_time(&text, &when_us);
+            sim_at(when_us, __sim_serial_event, new std::string(__sim_unescape(text)));
+        } else if (strncmp(arg, "--gpio=", 7) == 0) {
+            const char* spec = arg + 7;
+            uint64_t when_us = 0;
+            unsigned pin, level;
+            if (!__sim_parse_time(&spec, &when_us) || sscanf(spec, "%u:%u", &pin, &level) != 2) {
+                fprintf(stderr, "sim: bad option %s (expected --gpio=MS:PIN:LEVEL)\n", arg);
+                sim_exit(2);
+            }
+            sim_gpio_set_at(when_us, (uint8_t)pin, (uint8_t)level);
+        } else if (strncmp(arg, "--shake=", 8) == 0) {
+            const char* spec = arg + 8;
+            uint64_t when_us = 0;
+            unsigned long len_ms;
+            if (!__sim_parse_time(&spec, &when_us) || sscanf(spec, "%lu", &len_ms) != 1 ||
+                shake_count == SIM_MAX_SHAKES) {
+                fprintf(stderr, "sim: bad option %s (expected --shake=MS:LEN_MS, at most %u)\n", arg,
+                        SIM_MAX_SHAKES);
+                sim_exit(2);
+            }
+            shakes[shake_count].start_us = when_us;
+            shakes[shake_count].end_us = when_us + (uint64_t)len_ms * 1000;
+            shake_count++;
+            sim_bmi323_set_motion(&default_imu, __sim_shake_motion, NULL);
+        } else if (strncmp(arg, "--ble=", 6) == 0) {
+            const char* spec = arg + 6;
+            uint64_t when_us = 0;
+            unsigned host, present;
+            if (!__sim_parse_time(&spec, &when_us) || sscanf(spec, "%u:%u", &host, &present) != 2 ||
+                host >= SIM_BLE_HOSTS) {
+                fprintf(stderr, "sim: bad option %s (expected --ble=MS:HOST:PRESENT, HOST below %u)\n", arg,
+                        SIM_BLE_HOSTS);
+                sim_exit(2);
+            }
+            sim_ble_set_host_at(when_us, (uint8_t)host, present != 0);
+        } else {
+            fprintf(stderr, "sim: unknown option %s\n", arg);
+            fprintf(stderr, "usage: %s [--ms=N] [--fs=DIR] [--quiet] [--realtime] [--input=[MS:]TEXT] [--gpio=MS:PIN:LEVEL] [--shake=MS:LEN_MS] [--ble=MS:HOST:PRESENT]\n",
+                    argv[0]);
+            sim_exit(2);
+        }
+    }
+    sim_stop_at(run_ms * 1000);
+}
+
+void sim_report(FILE* out) {
+    if (!out) {
+        return;
+    }
+    sim_neopixel_stats_t neopixel;
+    if (!sim_neopixel_get_stats(&neopixel)) {
+        memset(&neopixel, 0, sizeof(neopixel));
+    }
+    sim_sleep_stats_t sleep;
+    sim_sleep_get_stats(&sleep);
+    fprintf(out, "sim: %.3f ms simulated, imu samples: %u (any-motion %u), ble reports: %u, neopixel shows: %u, "
+            "light sleeps: %u (%.3f ms)\n",
+            sim_now_us() / 1000.0, default_imu_ready ? default_imu.samples : 0u,
+            default_imu_ready ? default_imu.any_motion_events : 0u,
+            (unsigned)sim_ble_report_count(), neopixel.shows, sleep.sleeps, sleep.asleep_us / 1000.0);
+}
+
+// Unit tests (`pio test -e native`) bring their own main()
+#if !defined(SIM_NO_MAIN) && !defined(PIO_UNIT_TESTING)
+
+void setup(void);
+void loop(void);
+
+// The Arduino-ESP32 main task on this board: BTN_0 and BTN_1 are active
+// high with pull-downs, the encoder lines idle high on external pull-ups (GPIO34/35
+// have no internal ones) and the BMI323 sits on Wire
+int main(int argc, char** argv) {
+    sim_gpio_set_pull(BTN_0, LOW);
+    sim_gpio_set_pull(BTN_1, LOW);
+    sim_gpio_set_pull(RE_BTN, HIGH);
+    sim_gpio_set_pull(RE_CW, HIGH);
+    sim_gpio_set_pull(RE_CCW, HIGH);
+    sim_bmi323_init(&default_imu, &Wire, SIM_BMI323_ADDRESS, IMU_INT);
+    default_imu_ready = true;
+    sim_configure(argc, argv);
+
+    setup();
+    for (;;) {
+        loop();
+    }
+}
+
+#endif  // !SIM_NO_MAIN && !PIO_UNIT_TESTING
@@ -0,0 +1,97 @@
+#include <Adafruit_NeoPixel.h>
+
+#include "sim.h"
+
+static sim_neopixel_stats_t neopixel_stats;
+static const Adafruit_NeoPixel* neopixel_current = NULL;
+static bool neopixel_seen = false;          ///< A strip was created or a frame recorded
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, uint16_t type)
+    : num_pixels(n), pin(p), brightness(0), begun(false) {
+    (void)type;
+    pixels = static_cast<uint8_t*>(calloc(n ? n : 1, 3));
+    if (!pixels) {
+        num_pixels = 0;
+    }
+    memset(&neopixel_stats, 0, sizeof(neopixel_stats));
+    neopixel_stats.pixels = num_pixels;
+    neopixel_stats.pin = (uint8_t)pin;
+    neopixel_current = this;
+    neopixel_seen = true;
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() {
+    free(pixels);
+    if (neopixel_current == this) {
+        neopixel_current = NULL;
+    }
+}
+
+void Adafruit_NeoPixel::begin(void) {
+    if (pin >= 0) {
+        pinMode((uint8_t)pin, OUTPUT);
+        digitalWrite((uint8_t)pin, LOW);
+    }
+    begun = true;
+}
+
+void Adafruit_NeoPixel::show(void) {
+    if (!begun || !pixels) {
+        return;
+    }
+    sim_busy_us((uint32_t)num_pixels * SIM_NEOPIXEL_US_PER_PIXEL + SIM_NEOPIXEL_LATCH_US);
+    if (neopixel_current == this) {
+        sim_neopixel_record((uint8_t)pin, num_pixels, pixels);
+    }
+}
+
+void Adafruit_NeoPixel::clear(void) {
+    if (pixels) {
+        memset(pixels, 0, (size_t)num_pixels * 3);
+    }
+}
+
+// Brightness scaling is left out: the stored frame is the color as set
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n >= num_pixels) {
+        return;
+    }
+    uint8_t* p = &pixels[n * 3];
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+    setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+    if (n >= num_pixels) {
+        return 0;
+    }
+    const uint8_t* p = &pixels[n * 3];
+    return Color(p[0], p[1], p[2]);
+}
+
+void sim_neopixel_record(uint8_t pin, uint16_t pixels, const uint8_t* rgb) {
+    size_t len = (size_t)pixels * 3;
+    if (len > sizeof(neopixel_stats.last_rgb)) {
+        len = sizeof(neopixel_stats.last_rgb);
+    }
+    if (rgb) {
+        memcpy(neopixel_stats.last_rgb, rgb, len);
+    }
+    neopixel_stats.pixels = pixels;
+    neopixel_stats.pin = pin;
+    neopixel_stats.shows++;
+    neopixel_seen = true;
+}
+
+bool sim_neopixel_get_stats(sim_neopixel_stats_t* stats) {
+    if (!stats || !neopixel_seen) {
+        return false;
+    }
+    *stats = neopixel_stats;
+    return true;
+}
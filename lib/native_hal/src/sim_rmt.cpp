@@ -0,0 +1,149 @@
+#include <driver/rmt.h>
+
+#include "sim.h"
+
+static constexpr uint32_t SIM_RMT_CLOCK_HZ = 80000000;     // APB clock feeding the dividers
+
+typedef struct sim_rmt_channel {
+    bool configured;
+    bool installed;
+    uint8_t pin;
+    uint8_t clk_div;
+    bool busy;
+    const rmt_item32_t* items;      ///< Being sent; read when the transmission ends
+    int item_num;
+    uint64_t done_us;
+} sim_rmt_channel_t;
+
+static sim_rmt_channel_t channels[RMT_CHANNEL_MAX];
+static rmt_tx_end_callback_t tx_end = {NULL, NULL};
+
+// One WS2812 bit per item that starts high; the first item that starts low ends the frame
+static void __sim_rmt_record(const sim_rmt_channel_t* ch) {
+    uint8_t rgb[3 * 16];
+    uint8_t grb[3];
+    size_t pixels = 0;
+    size_t bytes = 0;
+    uint8_t value = 0;
+    uint8_t bits = 0;
+    for (int i = 0; i < ch->item_num && ch->items[i].level0; i++) {
+        value = (uint8_t)((value << 1) | (ch->items[i].duration0 > ch->items[i].duration1 ? 1 : 0));
+        if (++bits < 8) {
+            continue;
+        }
+        grb[bytes++] = value;
+        value = 0;
+        bits = 0;
+        if (bytes == 3) {
+            if (pixels < 16) {
+                rgb[pixels * 3] = grb[1];
+                rgb[pixels * 3 + 1] = grb[0];
+                rgb[pixels * 3 + 2] = grb[2];
+            }
+            pixels++;
+            bytes = 0;
+        }
+    }
+    sim_neopixel_record(ch->pin, (uint16_t)pixels, rgb);
+}
+
+static void __sim_rmt_done(void* ctx) {
+    sim_rmt_channel_t* ch = static_cast<sim_rmt_channel_t*>(ctx);
+    if (!ch->busy || sim_now_us() < ch->done_us) {
+        return;
+    }
+    __sim_rmt_record(ch);
+    ch->busy = false;
+    ch->items = NULL;
+    if (tx_end.function) {
+        tx_end.function(static_cast<rmt_channel_t>(ch - channels), tx_end.arg);
+    }
+}
+
+esp_err_t rmt_config(const rmt_config_t* config) {
+    if (!config || config->channel >= RMT_CHANNEL_MAX || config->rmt_mode != RMT_MODE_TX ||
+        config->clk_div == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_rmt_channel_t* ch = &channels[config->channel];
+    ch->configured = true;
+    ch->pin = (uint8_t)config->gpio_num;
+    ch->clk_div = config->clk_div;
+    pinMode(ch->pin, OUTPUT);
+    digitalWrite(ch->pin, config->tx_config.idle_level == RMT_IDLE_LEVEL_HIGH ? HIGH : LOW);
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags) {
+    if (channel >= RMT_CHANNEL_MAX || !channels[channel].configured) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channels[channel].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channels[channel].installed = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel) {
+    if (channel >= RMT_CHANNEL_MAX || !channels[channel].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+    channels[channel].installed = false;
+    channels[channel].configured = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t* items, int item_num, bool wait_tx_done) {
+    if (channel >= RMT_CHANNEL_MAX || !items || item_num <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_rmt_channel_t* ch = &channels[channel];
+    if (!ch->installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+
+    uint64_t ticks = 0;
+    for (int i = 0; i < item_num; i++) {
+        ticks += items[i].duration0 + items[i].duration1;
+    }
+    uint64_t tick_hz = SIM_RMT_CLOCK_HZ / ch->clk_div;
+    ch->busy = true;
+    ch->items = items;
+    ch->item_num = item_num;
+    ch->done_us = sim_now_us() + (ticks * 1000000 + tick_hz - 1) / tick_hz;
+    sim_at(ch->done_us, __sim_rmt_done, ch);
+
+    if (wait_tx_done) {
+        rmt_wait_tx_done(channel, portMAX_DELAY);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time) {
+    if (channel >= RMT_CHANNEL_MAX || !channels[channel].installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim_rmt_channel_t* ch = &channels[channel];
+    if (!ch->busy) {
+        return ESP_OK;
+    }
+    uint64_t remaining = ch->done_us - sim_now_us();
+    if (wait_time != portMAX_DELAY && remaining > (uint64_t)wait_time * 1000) {
+        if (wait_time > 0) {
+            sim_busy_us(wait_time * 1000);
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+    sim_busy_us((uint32_t)remaining);
+    return ch->busy ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+rmt_tx_end_callback_t rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void* arg) {
+    rmt_tx_end_callback_t previous = tx_end;
+    tx_end.function = function;
+    tx_end.arg = arg;
+    return previous;
+}
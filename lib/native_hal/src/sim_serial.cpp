@@ -0,0 +1,100 @@
+#include <stdarg.h>
+#include <deque>
+
+#include "sim.h"
+
+#define PRINTF_STACK_BUFFER     128
+
+HardwareSerial Serial;
+
+static FILE* serial_out = stdout;
+static bool serial_out_set = false;
+static std::deque<uint8_t> serial_rx;
+
+static FILE* __sim_serial_out(void) {
+    return serial_out_set ? serial_out : stdout;
+}
+
+void sim_serial_input(const char* text) {
+    if (!text) {
+        return;
+    }
+    for (; *text; text++) {
+        serial_rx.push_back((uint8_t)*text);
+    }
+}
+
+void sim_serial_set_output(FILE* out) {
+    serial_out = out;
+    serial_out_set = true;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buffer[n])) {
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char stack_buffer[PRINTF_STACK_BUFFER];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(stack_buffer, sizeof(stack_buffer), format, args);
+    va_end(args);
+    if (len < 0) {
+        return 0;
+    }
+    if ((size_t)len < sizeof(stack_buffer)) {
+        return write(reinterpret_cast<const uint8_t*>(stack_buffer), (size_t)len);
+    }
+
+    char* heap_buffer = static_cast<char*>(malloc((size_t)len + 1));
+    if (!heap_buffer) {
+        return 0;
+    }
+    va_start(args, format);
+    vsnprintf(heap_buffer, (size_t)len + 1, format, args);
+    va_end(args);
+    size_t n = write(reinterpret_cast<const uint8_t*>(heap_buffer), (size_t)len);
+    free(heap_buffer);
+    return n;
+}
+
+int HardwareSerial::available(void) {
+    return (int)serial_rx.size();
+}
+
+int HardwareSerial::read(void) {
+    if (serial_rx.empty()) {
+        return -1;
+    }
+    uint8_t c = serial_rx.front();
+    serial_rx.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek(void) {
+    return serial_rx.empty() ? -1 : serial_rx.front();
+}
+
+void HardwareSerial::flush(void) {
+    FILE* out = __sim_serial_out();
+    if (out) {
+        fflush(out);
+    }
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+// Output is free in virtual time, as if the UART FIFO never fills
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    FILE* out = __sim_serial_out();
+    if (out && size) {
+        fwrite(buffer, 1, size, out);
+    }
+    return size;
+}
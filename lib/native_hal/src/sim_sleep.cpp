@@ -0,0 +1,60 @@
+#include "sim.h"
+
+#include <esp_sleep.h>
+
+static uint64_t timer_wakeup_us = 0;
+static bool timer_wakeup = false;
+static bool gpio_wakeup = false;
+static esp_sleep_wakeup_cause_t cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static sim_sleep_stats_t stats;
+
+static bool __sim_sleep_woken(void* ctx) {
+    return gpio_wakeup && sim_gpio_wakeup_pending();
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    timer_wakeup_us = time_in_us;
+    timer_wakeup = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) {
+    gpio_wakeup = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+    if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL) {
+        timer_wakeup = false;
+    }
+    if (source == ESP_SLEEP_WAKEUP_GPIO || source == ESP_SLEEP_WAKEUP_ALL) {
+        gpio_wakeup = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start(void) {
+    uint64_t start_us = sim_now_us();
+    sim_halt_until(timer_wakeup ? start_us + timer_wakeup_us : UINT64_MAX, __sim_sleep_woken, NULL);
+    cause = __sim_sleep_woken(NULL) ? ESP_SLEEP_WAKEUP_GPIO : ESP_SLEEP_WAKEUP_TIMER;
+
+    stats.sleeps++;
+    stats.asleep_us += sim_now_us() - start_us;
+    if (cause == ESP_SLEEP_WAKEUP_GPIO) {
+        stats.gpio_wakes++;
+    } else {
+        stats.timer_wakes++;
+    }
+    sim_busy_us(SIM_LIGHT_SLEEP_WAKE_US);
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void) {
+    return cause;
+}
+
+void sim_sleep_get_stats(sim_sleep_stats_t* out) {
+    if (out) {
+        *out = stats;
+    }
+}
@@ -0,0 +1,81 @@
+#include "sim.h"
+
+#include <esp_timer.h>
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint32_t generation;        ///< Bumped by every start and stop; stale expiries are ignored
+    bool armed;
+};
+
+typedef struct sim_timer_expiry {
+    esp_timer_handle_t timer;
+    uint32_t generation;
+} sim_timer_expiry_t;
+
+static void __sim_timer_expire(void* ctx) {
+    sim_timer_expiry_t* expiry = static_cast<sim_timer_expiry_t*>(ctx);
+    esp_timer_handle_t timer = expiry->timer;
+    bool current = (expiry->generation == timer->generation) && timer->armed;
+    delete expiry;
+    if (current) {
+        timer->armed = false;
+        timer->callback(timer->arg);
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    if (!create_args || !create_args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_timer_handle_t timer = new esp_timer();
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->generation = 0;
+    timer->armed = false;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim_timer_expiry_t* expiry = new sim_timer_expiry_t;
+    expiry->timer = timer;
+    expiry->generation = ++timer->generation;
+    timer->armed = true;
+    sim_at(sim_now_us() + timeout_us, __sim_timer_expire, expiry);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    timer->generation++;
+    return ESP_OK;
+}
+
+// Pending expiries still point at the timer; keep it (a handful per run)
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)sim_now_us();
+}
@@ -0,0 +1,125 @@
+#include <Wire.h>
+
+#define WIRE_DEFAULT_CLOCK_HZ   100000
+#define WIRE_START_STOP_BITS    2       // start + stop condition, roughly a bit time each
+
+TwoWire Wire;
+
+TwoWire::TwoWire(void)
+    : device_count(0), clock_hz(WIRE_DEFAULT_CLOCK_HZ), tx_address(0), tx_len(0), tx_active(false), rx_len(0),
+      rx_pos(0) {
+    memset(devices, 0, sizeof(devices));
+}
+
+bool TwoWire::begin(void) {
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    if (frequency == 0) {
+        return false;
+    }
+    clock_hz = frequency;
+    return true;
+}
+
+bool TwoWire::attach(const sim_i2c_device_t* device) {
+    if (!device || device_count >= SIM_I2C_MAX_DEVICES || find(device->address)) {
+        return false;
+    }
+    devices[device_count++] = device;
+    return true;
+}
+
+bool sim_i2c_attach(TwoWire* bus, const sim_i2c_device_t* device) {
+    return bus && bus->attach(device);
+}
+
+const sim_i2c_device_t* TwoWire::find(uint16_t address) const {
+    for (uint8_t i = 0; i < device_count; i++) {
+        if (devices[i]->address == address) {
+            return devices[i];
+        }
+    }
+    return NULL;
+}
+
+// Bus time of a transaction carrying `bytes` after the address byte
+void TwoWire::charge(size_t bytes) const {
+    uint64_t bits = (uint64_t)(bytes + 1) * SIM_I2C_BYTE_BITS + WIRE_START_STOP_BITS;
+    sim_busy_us((uint32_t)((bits * 1000000ULL + clock_hz - 1) / clock_hz));
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+    tx_address = address;
+    tx_len = 0;
+    tx_active = true;
+}
+
+uint8_t TwoWire::endTransmission(bool send_stop) {
+    (void)send_stop;
+    if (!tx_active) {
+        return 4;
+    }
+    tx_active = false;
+
+    const sim_i2c_device_t* device = find(tx_address);
+    if (!device) {
+        charge(0);
+        return 2;
+    }
+    charge(tx_len);
+    if (device->write) {
+        device->write(device->ctx, tx_buffer, tx_len);
+    }
+    return 0;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool send_stop) {
+    (void)send_stop;
+    rx_len = 0;
+    rx_pos = 0;
+    if (size > SIM_I2C_BUFFER) {
+        size = SIM_I2C_BUFFER;
+    }
+
+    const sim_i2c_device_t* device = find(address);
+    if (!device || !device->read) {
+        charge(0);
+        return 0;
+    }
+    charge(size);
+    rx_len = device->read(device->ctx, rx_buffer, size);
+    if (rx_len > size) {
+        rx_len = size;
+    }
+    return rx_len;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (!tx_active || tx_len >= SIM_I2C_BUFFER) {
+        return 0;
+    }
+    tx_buffer[tx_len++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t size) {
+    size_t n = 0;
+    while (n < size && write(data[n])) {
+        n++;
+    }
+    return n;
+}
+
+int TwoWire::available(void) {
+    return (int)(rx_len - rx_pos);
+}
+
+int TwoWire::read(void) {
+    return (rx_pos < rx_len) ? rx_buffer[rx_pos++] : -1;
+}
+
+int TwoWire::peek(void) {
+    return (rx_pos < rx_len) ? rx_buffer[rx_pos] : -1;
+}
@@ -0,0 +1,222 @@
+#include "binlog.h"
+
+#define BINLOG_IDLE_DELAY_MS    10      // output task poll period when the ring is empty
+#define BINLOG_TASK_BATCH       16      // records emitted per wake
+#define BINLOG_LINE_SIZE        160     // longest formatted record
+#define BINLOG_SPEC_SIZE        16      // longest single conversion spec
+
+static const char* const kFormats[BINLOG_MSG_COUNT] = {
+#define BINLOG_MESSAGE(name, format) format,
+#include "binlog_messages.h"
+#undef BINLOG_MESSAGE
+};
+
+static binlog_ring_t ring;
+static Print* output = NULL;
+static volatile binlog_mode_t output_mode = BINLOG_MODE_TEXT;
+static TaskHandle_t task = NULL;
+static uint32_t written = 0;
+static volatile uint32_t emitted = 0;
+static uint32_t drops_reported = 0;
+
+static float __binlog_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// printf one conversion spec ("%-5.1f") with a raw argument of matching type
+static int __binlog_format_arg(char* out, size_t size, const char* spec, size_t spec_len, uint32_t arg) {
+    char conversion = spec[spec_len - 1];
+    char fmt[BINLOG_SPEC_SIZE + 2];
+
+    // drop length modifiers, the argument width is fixed at 32 bits
+    size_t n = 0;
+    for (size_t i = 0; i + 1 < spec_len && n < BINLOG_SPEC_SIZE - 1; i++) {
+        if (spec[i] != 'l' && spec[i] != 'h' && spec[i] != 'z') {
+            fmt[n++] = spec[i];
+        }
+    }
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+            fmt[n++] = 'l';
+            fmt[n++] = conversion;
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, static_cast<long>(static_cast<int32_t>(arg)));
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            fmt[n++] = 'l';
+            fmt[n++] = conversion;
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, static_cast<unsigned long>(arg));
+        case 'c':
+            fmt[n++] = conversion;
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, static_cast<int>(arg));
+        case 'f':
+        case 'e':
+        case 'g':
+            fmt[n++] = conversion;
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, static_cast<double>(__binlog_float(arg)));
+        default:
+            return 0;
+    }
+}
+
+static size_t __binlog_format_text(char* out, size_t size, const char* format, const uint32_t* args, uint8_t argc) {
+    size_t len = 0;
+    uint8_t arg = 0;
+    while (*format && len + 1 < size) {
+        if (*format != '%') {
+            out[len++] = *format++;
+            continue;
+        }
+        if (format[1] == '%') {
+            out[len++] = '%';
+            format += 2;
+            continue;
+        }
+
+        const char* spec = format++;
+        while (*format && strchr("diuxXocfeg", *format) == NULL) format++;
+        if (!*format) break;
+        format++;
+
+        if (arg < argc) {
+            int n = __binlog_format_arg(out + len, size - len, spec, format - spec, args[arg]);
+            if (n > 0) {
+                len += ((size_t)n < size - len) ? (size_t)n : size - len - 1;
+            }
+        }
+        arg++;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static size_t __binlog_format_record(char* out, size_t size, uint8_t id, const uint32_t* args, uint8_t argc) {
+    const char* format = binlog_format(id);
+    if (!format) {
+        return snprintf(out, size, "[binlog] unknown message %u\n", id);
+    }
+    return __binlog_format_text(out, size, format, args, argc);
+}
+
+static void __binlog_emit_frame(uint8_t id, uint32_t timestamp_us, const uint32_t* args, uint8_t argc) {
+    uint8_t frame[4 + 4 + 4 * BINLOG_MAX_ARGS];
+    size_t len = 0;
+    frame[len++] = BINLOG_FRAME_SYNC;
+    frame[len++] = id;
+    frame[len++] = argc;
+    memcpy(&frame[len], &timestamp_us, 4);  // the ESP32 is little endian
+    len += 4;
+    memcpy(&frame[len], args, 4 * argc);
+    len += 4 * argc;
+
+    uint8_t sum = 0;
+    for (size_t i = 1; i < len; i++) {
+        sum += frame[i];
+    }
+    frame[len++] = sum;
+    output->write(frame, len);
+}
+
+static void __binlog_emit(uint8_t id, uint32_t timestamp_us, const uint32_t* args, uint8_t argc) {
+    if (output_mode == BINLOG_MODE_RAW) {
+        __binlog_emit_frame(id, timestamp_us, args, argc);
+        return;
+    }
+    char line[BINLOG_LINE_SIZE];
+    size_t len = __binlog_format_record(line, sizeof(line), id, args, argc);
+    output->write(reinterpret_cast<const uint8_t*>(line), len);
+}
+
+static void __binlog_task(void* ctx) {
+    for (;;) {
+        if (binlog_service(BINLOG_TASK_BATCH) == 0) {
+            vTaskDelay(pdMS_TO_TICKS(BINLOG_IDLE_DELAY_MS));
+        }
+    }
+}
+
+void binlog_write_raw(binlog_msg_t id, const uint32_t* args, uint8_t argc) {
+    binlog_record_t record;
+    record.timestamp_us = micros();
+    record.id = static_cast<uint8_t>(id);
+    record.argc = (argc > BINLOG_MAX_ARGS) ? BINLOG_MAX_ARGS : argc;
+    memcpy(record.args, args, record.argc * sizeof(uint32_t));
+    if (spsc_ring_push(&ring, record)) {
+        written++;
+    }
+}
+
+void binlog_init(Print* out, binlog_mode_t mode) {
+    output = out;
+    output_mode = mode;
+}
+
+void binlog_set_mode(binlog_mode_t mode) {
+    output_mode = mode;
+}
+
+bool binlog_start(uint8_t core, uint8_t priority) {
+    if (task) {
+        return true;
+    }
+    if (xTaskCreatePinnedToCore(__binlog_task, "binlog", BINLOG_STACK_SIZE, NULL,
+                                priority, &task, core) != pdPASS) {
+        task = NULL;
+        return false;
+    }
+    return true;
+}
+
+size_t binlog_service(size_t max_records) {
+    if (!output) {
+        return 0;
+    }
+
+    // report losses in-band so the reader knows the stream has a gap
+    uint32_t dropped = ring.overruns.load(std::memory_order_relaxed);
+    if (dropped != drops_reported) {
+        uint32_t lost = dropped - drops_reported;
+        drops_reported = dropped;
+        __binlog_emit(BINLOG_MSG_DROPPED, micros(), &lost, 1);
+    }
+
+    size_t count = 0;
+    binlog_record_t record;
+    while (count < max_records && spsc_ring_pop(&ring, &record)) {
+        __binlog_emit(record.id, record.timestamp_us, record.args, record.argc);
+        count++;
+    }
+    emitted += count;
+    return count;
+}
+
+void binlog_get_stats(binlog_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    stats->written = written;
+    stats->dropped = ring.overruns.load(std::memory_order_relaxed);
+    stats->emitted = emitted;
+}
+
+const char* binlog_format(uint8_t id) {
+    if (id >= BINLOG_MSG_COUNT) {
+        return NULL;
+    }
+    return kFormats[id];
+}
+
+#if defined(PIO_UNIT_TESTING)
+size_t binlog_test_format(char* out, size_t size, const char* format, const uint32_t* args, uint8_t argc) {
+    return __binlog_format_text(out, size, format, args, argc);
+}
+#endif
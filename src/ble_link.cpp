@@ -0,0 +1,300 @@
+#include "ble_link.h"
+
+#include <string.h>
+
+#define BLE_LINK_DIRECTED_MS    1280    // one high-duty burst; the controller stops it after this
+
+static uint32_t __ble_link_millis(void) {
+    return millis();
+}
+
+void ble_link_default_config(ble_link_config_t* config) {
+    if (!config) {
+        return;
+    }
+    config->directed_ms = BLE_LINK_DIRECTED_MS;
+}
+
+// Stack's task: stamp and queue, the service does the rest
+static void __ble_link_changed(void* ctx, bool up, const hid_transport_addr_t* peer) {
+    ble_link_t* link = static_cast<ble_link_t*>(ctx);
+    ble_link_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.up = up;
+    if (peer) {
+        event.peer = *peer;
+    }
+    event.ms = link->now_ms();
+    spsc_ring_push(&link->events, event);
+    if (link->hooks.notify) {
+        link->hooks.notify(link->hooks.ctx);
+    }
+}
+
+static void __ble_link_clear(ble_link_record_t* record) {
+    memset(record, 0, sizeof(*record));
+    record->magic = BLE_LINK_RECORD_MAGIC;
+    record->last = BLE_LINK_NO_HOST;
+}
+
+static bool __ble_link_valid(const ble_link_record_t* record) {
+    if (record->magic != BLE_LINK_RECORD_MAGIC) {
+        return false;
+    }
+    if (record->last == BLE_LINK_NO_HOST) {
+        return true;
+    }
+    return record->last < BLE_LINK_MAX_HOSTS && record->hosts[record->last].used != 0;
+}
+
+void ble_link_init(ble_link_t* link, hid_transport_t* transport, const ble_link_config_t* config,
+                   const ble_link_hooks_t* hooks) {
+    if (!link || !transport || !config) {
+        return;
+    }
+    link->transport = transport;
+    link->config = *config;
+    if (hooks) {
+        link->hooks = *hooks;
+    } else {
+        memset(&link->hooks, 0, sizeof(link->hooks));
+    }
+    link->now_ms = __ble_link_millis;
+    link->state = BLE_LINK_STOPPED;
+    link->peer = BLE_LINK_NO_HOST;
+    link->target = BLE_LINK_NO_HOST;
+    link->down_pending = false;
+    link->booting = false;
+    link->down_ms = 0;
+    link->burst_ms = 0;
+    spsc_ring_reset(&link->events);
+    memset(&link->stats, 0, sizeof(link->stats));
+
+    __ble_link_clear(&link->record);
+    ble_link_record_t loaded;
+    if (link->hooks.load && link->hooks.load(link->hooks.ctx, &loaded) && __ble_link_valid(&loaded)) {
+        link->record = loaded;
+    }
+    hid_transport_set_link_callback(transport, __ble_link_changed, link);
+}
+
+static void __ble_link_save(ble_link_t* link) {
+    if (!link->hooks.save) {
+        return;
+    }
+    if (link->hooks.save(link->hooks.ctx, &link->record)) {
+        link->stats.saves++;
+    } else {
+        link->stats.save_errors++;
+    }
+}
+
+// Directed to `slot` if it holds a host, general otherwise
+static void __ble_link_advertise(ble_link_t* link, uint8_t slot) {
+    link->target = slot;
+    if (slot != BLE_LINK_NO_HOST &&
+        hid_transport_advertise(link->transport, &link->record.hosts[slot].addr)) {
+        link->state = BLE_LINK_DIRECTED;
+        link->burst_ms = link->now_ms();
+        link->stats.directed++;
+        return;
+    }
+    hid_transport_advertise(link->transport, NULL);
+    link->state = BLE_LINK_GENERAL;
+}
+
+void ble_link_start(ble_link_t* link) {
+    if (!link || !link->transport) {
+        return;
+    }
+    link->down_pending = true;
+    link->booting = true;
+    link->down_ms = link->now_ms();
+    __ble_link_advertise(link, link->record.last);
+}
+
+static uint8_t __ble_link_find(const ble_link_t* link, const hid_transport_addr_t* addr) {
+    for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+        const ble_link_host_t* host = &link->record.hosts[i];
+        if (host->used && host->addr.type == addr->type &&
+            memcmp(host->addr.addr, addr->addr, sizeof(addr->addr)) == 0) {
+            return i;
+        }
+    }
+    return BLE_LINK_NO_HOST;
+}
+
+// Known hosts keep their slot; a new one takes a free slot or the least
+// recently used one, whose bond goes with it
+static uint8_t __ble_link_remember(ble_link_t* link, const hid_transport_addr_t* addr) {
+    uint8_t slot = __ble_link_find(link, addr);
+    if (slot == BLE_LINK_NO_HOST) {
+        slot = 0;
+        for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+            if (link->record.hosts[i].used < link->record.hosts[slot].used) {
+                slot = i;
+            }
+        }
+        if (link->record.hosts[slot].used) {
+            hid_transport_forget(link->transport, &link->record.hosts[slot].addr);
+        }
+        link->record.hosts[slot].addr = *addr;
+    }
+    link->record.hosts[slot].used = ++link->record.seq;
+    link->record.last = slot;
+    __ble_link_save(link);
+    return slot;
+}
+
+static void __ble_link_up(ble_link_t* link, const ble_link_event_t* event) {
+    if (link->state == BLE_LINK_CONNECTED && link->peer == __ble_link_find(link, &event->peer)) {
+        return;     // re-encrypted without a drop
+    }
+    uint8_t slot = __ble_link_remember(link, &event->peer);
+    if (link->state == BLE_LINK_DIRECTED && slot == link->target) {
+        link->stats.directed_hits++;
+    }
+    link->state = BLE_LINK_CONNECTED;
+    link->peer = slot;
+    link->target = slot;
+    link->stats.connects++;
+    if (!link->down_pending) {
+        return;
+    }
+    uint32_t elapsed_ms = event->ms - link->down_ms;
+    if (link->booting) {
+        link->stats.boot_ms = elapsed_ms;
+    } else {
+        link->stats.reconnects++;
+        link->stats.last_reconnect_ms = elapsed_ms;
+        link->stats.total_reconnect_ms += elapsed_ms;
+        if (elapsed_ms > link->stats.max_reconnect_ms) {
+            link->stats.max_reconnect_ms = elapsed_ms;
+        }
+    }
+    link->down_pending = false;
+    link->booting = false;
+}
+
+// Back to the host that just left (or the one being switched to)
+static void __ble_link_down(ble_link_t* link, const ble_link_event_t* event) {
+    link->stats.disconnects++;
+    link->peer = BLE_LINK_NO_HOST;
+    if (!link->down_pending) {
+        link->down_pending = true;
+        link->down_ms = event->ms;
+    }
+    __ble_link_advertise(link, link->target);
+}
+
+uint32_t ble_link_service(ble_link_t* link) {
+    if (!link || !link->transport) {
+        return UINT32_MAX;
+    }
+    ble_link_event_t event;
+    while (spsc_ring_pop(&link->events, &event)) {
+        if (event.up) {
+            __ble_link_up(link, &event);
+        } else {
+            __ble_link_down(link, &event);
+        }
+    }
+    if (link->state != BLE_LINK_DIRECTED) {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed_ms = link->now_ms() - link->burst_ms;
+    if (elapsed_ms < link->config.directed_ms) {
+        return link->config.directed_ms - elapsed_ms;
+    }
+    if (hid_transport_connected(link->transport)) {
+        return UINT32_MAX;  // connected, not encrypted yet: the link change decides
+    }
+    link->stats.fallbacks++;
+    hid_transport_advertise(link->transport, NULL);
+    link->state = BLE_LINK_GENERAL;
+    return UINT32_MAX;
+}
+
+bool ble_link_select(ble_link_t* link, uint8_t slot) {
+    if (!ble_link_host(link, slot)) {
+        return false;
+    }
+    if (link->state == BLE_LINK_CONNECTED && link->peer == slot) {
+        return true;
+    }
+    link->stats.switches++;
+    if (hid_transport_connected(link->transport)) {
+        link->target = slot;
+        hid_transport_disconnect(link->transport);
+    } else {
+        __ble_link_advertise(link, slot);
+    }
+    return true;
+}
+
+void ble_link_pair(ble_link_t* link) {
+    if (!link || !link->transport) {
+        return;
+    }
+    if (hid_transport_connected(link->transport)) {
+        link->target = BLE_LINK_NO_HOST;
+        hid_transport_disconnect(link->transport);
+    } else {
+        __ble_link_advertise(link, BLE_LINK_NO_HOST);
+    }
+}
+
+bool ble_link_forget(ble_link_t* link, uint8_t slot) {
+    if (!ble_link_host(link, slot)) {
+        return false;
+    }
+    hid_transport_addr_t addr = link->record.hosts[slot].addr;
+    bool was_target = (link->target == slot);
+    if (link->peer == slot && hid_transport_connected(link->transport)) {
+        link->target = BLE_LINK_NO_HOST;
+        hid_transport_disconnect(link->transport);
+    } else if (was_target && link->state == BLE_LINK_DIRECTED) {
+        __ble_link_advertise(link, BLE_LINK_NO_HOST);
+    } else if (was_target) {
+        link->target = BLE_LINK_NO_HOST;
+    }
+    hid_transport_forget(link->transport, &addr);
+
+    memset(&link->record.hosts[slot], 0, sizeof(link->record.hosts[slot]));
+    if (link->record.last == slot) {
+        link->record.last = BLE_LINK_NO_HOST;
+        for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+            uint32_t used = link->record.hosts[i].used;
+            if (used && (link->record.last == BLE_LINK_NO_HOST ||
+                         used > link->record.hosts[link->record.last].used)) {
+                link->record.last = i;
+            }
+        }
+    }
+    __ble_link_save(link);
+    return true;
+}
+
+const ble_link_host_t* ble_link_host(const ble_link_t* link, uint8_t slot) {
+    if (!link || slot >= BLE_LINK_MAX_HOSTS || link->record.hosts[slot].used == 0) {
+        return NULL;
+    }
+    return &link->record.hosts[slot];
+}
+
+void ble_link_get_stats(const ble_link_t* link, ble_link_stats_t* stats) {
+    if (!link || !stats) {
+        return;
+    }
+    *stats = link->stats;
+    stats->state = link->state;
+    stats->peer = link->peer;
+    stats->target = link->target;
+    stats->hosts = 0;
+    for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+        if (link->record.hosts[i].used) {
+            stats->hosts++;
+        }
+    }
+    stats->overruns = link->events.overruns.load(std::memory_order_relaxed);
+}
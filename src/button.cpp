@@ -1,18 +1,24 @@
 #include "button.h"
 
 void button_init(button_t* btn, pin_t pin) {
+    pinMode(pin, INPUT_PULLUP);
+    button_reset(btn, pin, digitalRead(pin), micros());
+    attach_button_interrupt(btn, pin);
+}
+
+void button_reset(button_t* btn, pin_t pin, uint8_t level, uint32_t now_us) {
     btn->pin = pin;
     btn->callback = NULL;
     btn->ctx = NULL;
-    btn->event_pending = false;
-    btn->last_raw = digitalRead(pin);
-    btn->last_debounce_ms = 0;
     btn->debounce_ms = 20; // default debounce 20 ms
-    btn->stable_state = (btn->last_raw == HIGH); // assume pressed if LOW
 
-    pinMode(pin, INPUT_PULLUP);
-
-    attach_button_interrupt(btn, pin);
+    spsc_ring_reset(&btn->events);
+    btn->overruns_seen = 0;
+    btn->raw_level = level;
+    btn->raw_change_us = now_us;
+    btn->raw_change_stamp = 0;
+    btn->press_stamp = 0;
+    btn->stable_state = (btn->raw_level == HIGH); // assume pressed if LOW
 }
 
 void button_set_callback(button_t* btn, void (*cb)(button_t* ctx), void* ctx) {
@@ -28,39 +34,89 @@ static void __button_callback(void *ctx) {
     button_t *btn = (button_t *)(ctx);
 
     if (!btn) return;
-    btn->last_raw = digitalRead(btn->pin);
-    btn->event_pending = true;
+    input_event_record(&btn->events, btn->pin, digitalRead(btn->pin), 0);
 }
 
 void attach_button_interrupt(button_t *btn, pin_t pin) {
     attachInterruptArg(digitalPinToInterrupt(pin), __button_callback, btn, CHANGE);
 }
 
+// Accept a debounced level and fire the press callback on a rising edge
+static void __button_commit(button_t* btn, uint8_t level, uint32_t stamp) {
+    bool pressed = (level == HIGH);
+    if (pressed != btn->stable_state) {
+        btn->stable_state = pressed;
+        btn->press_stamp = pressed ? stamp : 0;
+        if (pressed && btn->callback) {
+            btn->callback(btn);
+        }
+    }
+}
+
 void button_process(button_t* btn) {
+    button_process_at(btn, micros());
+}
+
+void button_process_at(button_t* btn, uint32_t now_us) {
     // Should be called from loop() or a task
     if (!btn) return;
 
-    if (!btn->event_pending) return;
+    uint32_t debounce_us = btn->debounce_ms * 1000;
+
+    // Replay queued edges: a level that lasted the debounce interval
+    // before the next edge was a real transition
+    input_event_t event;
+    while (spsc_ring_pop(&btn->events, &event)) {
+        input_event_drained(&event);
+        if ((uint32_t)(event.timestamp_us - btn->raw_change_us) >= debounce_us) {
+            __button_commit(btn, btn->raw_level, btn->raw_change_stamp);
+        }
+        btn->raw_level = event.level;
+        btn->raw_change_us = event.timestamp_us;
+        btn->raw_change_stamp = event.stamp;
+    }
 
-    // Start debounce timer
-    uint32_t now = millis();
-    if (btn->last_debounce_ms == 0) {
-        btn->last_debounce_ms = now;
-        return;
+    // Edges were lost — trust the pin itself from here on
+    uint32_t overruns = btn->events.overruns.load(std::memory_order_relaxed);
+    if (overruns != btn->overruns_seen) {
+        btn->overruns_seen = overruns;
+        uint8_t level = digitalRead(btn->pin);
+        if (level != btn->raw_level) {
+            btn->raw_level = level;
+            btn->raw_change_us = now_us;
+            btn->raw_change_stamp = 0;  // real edge time unknown
+        }
     }
 
-    // Wait until stable interval has passed
-    if ((now - btn->last_debounce_ms) < btn->debounce_ms) return;
+    // Current level has been stable long enough
+    if ((uint32_t)(now_us - btn->raw_change_us) >= debounce_us) {
+        __button_commit(btn, btn->raw_level, btn->raw_change_stamp);
+    }
+}
 
-    // debounce period passed — accept sampled level
-    btn->last_debounce_ms = 0;
-    btn->event_pending = false;
+bool button_inject(button_t* btn, const input_event_t* event) {
+    if (!btn || !event) return false;
+    return spsc_ring_push(&btn->events, *event);
+}
 
-    bool pressed = (btn->last_raw == HIGH);
-    if (pressed != btn->stable_state) {
-        btn->stable_state = pressed;
-        if (pressed && btn->callback) {
-            btn->callback(btn);
-        }
-    }
+uint32_t button_get_overruns(const button_t* btn) {
+    if (!btn) return 0;
+    return btn->events.overruns.load(std::memory_order_relaxed);
+}
+
+uint32_t button_get_press_stamp(const button_t* btn) {
+    if (!btn) return 0;
+    return btn->press_stamp;
+}
+
+bool button_resync(button_t* btn) {
+    if (!btn || digitalRead(btn->pin) == btn->raw_level) return false;
+    __button_callback(btn);
+    return true;
+}
+
+#if defined(PIO_UNIT_TESTING)
+void button_bench_isr(button_t* btn) {
+    __button_callback(btn);
 }
+#endif
@@ -0,0 +1,235 @@
+#include "console.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "binlog.h"
+#include "latency.h"
+
+static const char* const kBleLinkStates[] = {"stopped", "directed", "general", "connected"};
+
+static void __console_print_latency(console_t* con) {
+    for (uint8_t i = 0; i < LATENCY_SRC_COUNT; i++) {
+        latency_source_t source = static_cast<latency_source_t>(i);
+        latency_summary_t summary;
+        latency_get_summary(source, &summary);
+        con->io->printf("lat %s n:%lu p50:%luus p99:%luus max:%luus\n",
+                        latency_source_name(source),
+                        static_cast<unsigned long>(summary.samples),
+                        static_cast<unsigned long>(summary.p50_us),
+                        static_cast<unsigned long>(summary.p99_us),
+                        static_cast<unsigned long>(summary.max_us));
+    }
+}
+
+static void __console_print_log(console_t* con) {
+    binlog_stats_t stats;
+    binlog_get_stats(&stats);
+    con->io->printf("log written:%lu dropped:%lu emitted:%lu\n",
+                    static_cast<unsigned long>(stats.written),
+                    static_cast<unsigned long>(stats.dropped),
+                    static_cast<unsigned long>(stats.emitted));
+}
+
+static void __console_print_idle(console_t* con) {
+    idle_stats_t stats;
+    idle_get_stats(con->targets.idle, &stats);
+    con->io->printf("idle %s %s entries:%lu sleeps:%lu gpio:%lu timer:%lu resynced:%lu asleep:%lums idle:%lums "
+                    "wake->report n:%lu last:%luus max:%luus\n",
+                    stats.idle ? "idle" : "active",
+                    stats.enabled ? "on" : "off",
+                    static_cast<unsigned long>(stats.entries),
+                    static_cast<unsigned long>(stats.sleeps),
+                    static_cast<unsigned long>(stats.gpio_wakes),
+                    static_cast<unsigned long>(stats.timer_wakes),
+                    static_cast<unsigned long>(stats.resynced),
+                    static_cast<unsigned long>(stats.asleep_ms),
+                    static_cast<unsigned long>(stats.idle_ms),
+                    static_cast<unsigned long>(stats.wake_reports),
+                    static_cast<unsigned long>(stats.last_wake_report_us),
+                    static_cast<unsigned long>(stats.max_wake_report_us));
+}
+
+static void __console_print_ble(console_t* con) {
+    hid_transport_stats_t stats;
+    hid_transport_get_stats(con->targets.ble, &stats);
+    con->io->printf("ble %s %s heap free:%lu used:%lu begin:%luus boot->adv:%luus interval:%luus "
+                    "sent:%lu refused:%lu rate:%lu/s\n",
+                    stats.backend,
+                    stats.connected ? "connected" : "offline",
+                    static_cast<unsigned long>(stats.heap_after),
+                    static_cast<unsigned long>(stats.heap_before - stats.heap_after),
+                    static_cast<unsigned long>(stats.begin_us),
+                    static_cast<unsigned long>(stats.advertising_us),
+                    static_cast<unsigned long>(stats.conn_interval_us),
+                    static_cast<unsigned long>(stats.sent),
+                    static_cast<unsigned long>(stats.refused),
+                    static_cast<unsigned long>(stats.rate));
+}
+
+static void __console_print_ble_link(console_t* con) {
+    ble_link_stats_t stats;
+    ble_link_get_stats(con->targets.ble_link, &stats);
+    con->io->printf("link %s host:%d target:%d hosts:%u boot:%lums reconnect n:%lu last:%lums max:%lums avg:%lums "
+                    "directed:%lu hits:%lu fallbacks:%lu switches:%lu saves:%lu/%lu\n",
+                    kBleLinkStates[stats.state],
+                    stats.peer == BLE_LINK_NO_HOST ? -1 : stats.peer,
+                    stats.target == BLE_LINK_NO_HOST ? -1 : stats.target,
+                    stats.hosts,
+                    static_cast<unsigned long>(stats.boot_ms),
+                    static_cast<unsigned long>(stats.reconnects),
+                    static_cast<unsigned long>(stats.last_reconnect_ms),
+                    static_cast<unsigned long>(stats.max_reconnect_ms),
+                    static_cast<unsigned long>(stats.reconnects ? stats.total_reconnect_ms / stats.reconnects : 0),
+                    static_cast<unsigned long>(stats.directed),
+                    static_cast<unsigned long>(stats.directed_hits),
+                    static_cast<unsigned long>(stats.fallbacks),
+                    static_cast<unsigned long>(stats.switches),
+                    static_cast<unsigned long>(stats.saves),
+                    static_cast<unsigned long>(stats.saves + stats.save_errors));
+}
+
+static void __console_print_ble_hosts(console_t* con) {
+    const ble_link_t* link = con->targets.ble_link;
+    for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+        const ble_link_host_t* host = ble_link_host(link, i);
+        if (!host) {
+            con->io->printf("host %u -\n", i);
+            continue;
+        }
+        const uint8_t* a = host->addr.addr;
+        con->io->printf("host %u %02X:%02X:%02X:%02X:%02X:%02X %s%s%s\n", i, a[0], a[1], a[2], a[3], a[4], a[5],
+                        host->addr.type == HID_TRANSPORT_ADDR_PUBLIC ? "public" : "random",
+                        link->record.last == i ? " last" : "",
+                        link->peer == i ? " connected" : "");
+    }
+}
+
+static void __console_print_keys(console_t* con) {
+    key_matrix_stats_t stats;
+    key_matrix_get_stats(con->targets.keys, &stats);
+    con->io->printf("keys %u scans:%lu events:%lu pressed:%lu\n", con->targets.keys->key_count,
+                    static_cast<unsigned long>(stats.scans),
+                    static_cast<unsigned long>(stats.events),
+                    static_cast<unsigned long>(stats.pressed));
+}
+
+static void __console_print_imu_duty(console_t* con) {
+    imu_duty_stats_t stats;
+    imu_duty_get_stats(con->targets.imu_duty, &stats);
+    con->io->printf("imu %s duty:%s sleeps:%lu wakes:%lu wake:%lu/%luus switch:%lu/%luus "
+                    "active:%lums idle:%lums\n",
+                    stats.mode == IMU_DUTY_IDLE ? "idle" : "active",
+                    stats.enabled ? "on" : "off",
+                    static_cast<unsigned long>(stats.sleeps),
+                    static_cast<unsigned long>(stats.wakes),
+                    static_cast<unsigned long>(stats.last_wake_us),
+                    static_cast<unsigned long>(stats.max_wake_us),
+                    static_cast<unsigned long>(stats.last_switch_us),
+                    static_cast<unsigned long>(stats.max_switch_us),
+                    static_cast<unsigned long>(stats.time_ms[IMU_DUTY_ACTIVE]),
+                    static_cast<unsigned long>(stats.time_ms[IMU_DUTY_IDLE]));
+}
+
+static void __console_print_web(console_t* con) {
+    web_server_t* web = con->targets.web;
+    web_server_stats_t stats;
+    web_server_get_stats(web, &stats);
+    con->io->printf("web clients:%u rate:%uHz requests:%lu 304:%lu 404:%lu rejected:%lu frames:%lu sent:%lu coalesced:%lu dropped:%lu bytes:%lu\n",
+                    stats.websockets, web->rate_hz,
+                    static_cast<unsigned long>(stats.requests),
+                    static_cast<unsigned long>(stats.not_modified),
+                    static_cast<unsigned long>(stats.not_found),
+                    static_cast<unsigned long>(stats.rejected),
+                    static_cast<unsigned long>(stats.frames.queued),
+                    static_cast<unsigned long>(stats.frames.sent),
+                    static_cast<unsigned long>(stats.frames.coalesced),
+                    static_cast<unsigned long>(stats.frames.dropped),
+                    static_cast<unsigned long>(stats.frames.bytes));
+}
+
+void console_init(console_t* con, Stream* io, const console_targets_t* targets, const console_hooks_t* hooks) {
+    con->io = io;
+    con->targets = *targets;
+    con->hooks = *hooks;
+    con->length = 0;
+}
+
+void console_poll(console_t* con) {
+    while (con->io->available() > 0) {
+        char c = static_cast<char>(con->io->read());
+        if (c == '\r' || c == '\n') {
+            con->line[con->length] = '\0';
+            console_execute(con, con->line);
+            con->length = 0;
+        } else if (con->length < sizeof(con->line) - 1) {
+            con->line[con->length++] = c;
+        }
+    }
+}
+
+void console_execute(console_t* con, const char* line) {
+    const console_targets_t* t = &con->targets;
+    const console_hooks_t* h = &con->hooks;
+    if (strcmp(line, "lat") == 0) {
+        __console_print_latency(con);
+    } else if (strcmp(line, "lat reset") == 0) {
+        latency_reset();
+        con->io->println("lat reset");
+    } else if (strcmp(line, "log raw") == 0) {
+        binlog_set_mode(BINLOG_MODE_RAW);
+    } else if (strcmp(line, "log text") == 0) {
+        binlog_set_mode(BINLOG_MODE_TEXT);
+    } else if (strcmp(line, "log") == 0) {
+        __console_print_log(con);
+    } else if (strcmp(line, "idle") == 0) {
+        __console_print_idle(con);
+    } else if (strcmp(line, "idle on") == 0 || strcmp(line, "idle off") == 0) {
+        idle_set_enabled(t->idle, strcmp(line + 5, "on") == 0);
+        __console_print_idle(con);
+    } else if (strcmp(line, "ble") == 0) {
+        __console_print_ble(con);
+        __console_print_ble_link(con);
+    } else if (strcmp(line, "ble hosts") == 0) {
+        __console_print_ble_hosts(con);
+    } else if (strncmp(line, "ble host ", 9) == 0) {
+        if (!ble_link_select(t->ble_link, static_cast<uint8_t>(atoi(line + 9)))) {
+            con->io->println("ble: no such host");
+        }
+        __console_print_ble_link(con);
+    } else if (strncmp(line, "ble forget ", 11) == 0) {
+        if (!ble_link_forget(t->ble_link, static_cast<uint8_t>(atoi(line + 11)))) {
+            con->io->println("ble: no such host");
+        }
+        __console_print_ble_hosts(con);
+    } else if (strcmp(line, "ble pair") == 0) {
+        ble_link_pair(t->ble_link);
+        __console_print_ble_link(con);
+    } else if (strcmp(line, "ble rate") == 0) {
+        hid_transport_measure_rate(t->ble);
+        hid_transport_send(t->ble, &t->hid->published);  // the flood released any held keys on the host
+        __console_print_ble(con);
+    } else if (strcmp(line, "keys") == 0) {
+        __console_print_keys(con);
+    } else if (strcmp(line, "imu") == 0) {
+        __console_print_imu_duty(con);
+    } else if (strcmp(line, "imu duty on") == 0 || strcmp(line, "imu duty off") == 0) {
+        imu_duty_set_enabled(t->imu_duty, strcmp(line + 9, "on") == 0);
+        __console_print_imu_duty(con);
+    } else if (strcmp(line, "web") == 0) {
+        __console_print_web(con);
+    } else if (strncmp(line, "web rate ", 9) == 0) {
+        web_server_set_rate(t->web, static_cast<uint16_t>(atoi(line + 9)));
+        __console_print_web(con);
+    } else if (strcmp(line, "trace start") == 0) {
+        h->trace_start(h->ctx);
+    } else if (strcmp(line, "trace stop") == 0) {
+        h->trace_stop(h->ctx);
+    } else if (strcmp(line, "trace replay") == 0) {
+        h->trace_replay(h->ctx);
+    } else if (strcmp(line, "fs format") == 0) {
+        h->fs_format(h->ctx);
+    } else if (line[0] != '\0') {
+        con->io->printf("unknown command: %s\n", line);
+    }
+}
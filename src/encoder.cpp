@@ -1,68 +1,111 @@
 #include "encoder.h"
 
-static void __encoder_isr_a(void* ctx) {
-    encoder_t* enc = (encoder_t*)ctx;
-
-    uint8_t a = digitalRead(enc->pin_a);
-    uint8_t b = digitalRead(enc->pin_b);
-    uint8_t curr = (a << 1) | b;
+// Quadrature transition table, indexed by (previous AB << 2) | current AB
+static const int8_t kQuadratureTable[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
 
-    uint8_t idx = (enc->last_state << 2) | curr;
-    static const int8_t tbl[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
-    int8_t delta = tbl[idx];
-    if (delta) {
-        enc->position += delta;
-        enc->last_state = curr;
-        if (enc->spin_cb) enc->spin_cb(enc, delta);
+static void __encoder_track_detent(encoder_t* enc, uint32_t now, int8_t dir) {
+    uint32_t interval = now - enc->last_detent_us;
+    if (dir != enc->last_dir || interval >= ENCODER_VELOCITY_TIMEOUT_US) {
+        // first detent of a movement: assume slow until the next one arrives
+        enc->detent_interval_us = ENCODER_VELOCITY_TIMEOUT_US;
+    } else if (enc->detent_interval_us >= ENCODER_VELOCITY_TIMEOUT_US) {
+        enc->detent_interval_us = interval;  // second detent: first real measurement
     } else {
-        enc->last_state = curr;
+        enc->detent_interval_us = (enc->detent_interval_us * 3 + interval) / 4;
     }
+    enc->last_dir = dir;
+    enc->last_detent_us = now;
 }
 
-static void __encoder_isr_b(void* ctx) {
+// Rest positions: every state in quarter-step mode
+static inline bool __encoder_at_detent(uint8_t ab) {
+#if ENCODER_STEP_MODE == ENCODER_QUARTER_STEP
+    return true;
+#elif ENCODER_STEP_MODE == ENCODER_HALF_STEP
+    return ab == ENCODER_DETENT_STATE || ab == (ENCODER_DETENT_STATE ^ 0x3);
+#else
+    return ab == ENCODER_DETENT_STATE;
+#endif
+}
+
+// Shared by channel A and B
+static void __encoder_isr_ab(void* ctx) {
     encoder_t* enc = (encoder_t*)ctx;
+    uint32_t now = micros();
+    uint32_t stamp = latency_stamp();
 
     uint8_t a = digitalRead(enc->pin_a);
     uint8_t b = digitalRead(enc->pin_b);
     uint8_t curr = (a << 1) | b;
+    uint8_t prev = enc->last_state;
+    enc->last_state = curr;
 
-    uint8_t idx = (enc->last_state << 2) | curr;
-    static const int8_t tbl[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
-    int8_t delta = tbl[idx];
-    if (delta) {
-        enc->position += delta;
-        enc->last_state = curr;
-        if (enc->spin_cb) enc->spin_cb(enc, delta);
-    } else {
-        enc->last_state = curr;
+    // Count transitions between rest positions; on reaching one, report a
+    // detent if at least half of one was travelled and start over from 0
+    int8_t detent = 0;
+    int8_t substep = enc->substep + kQuadratureTable[(prev << 2) | curr];
+    if (__encoder_at_detent(curr)) {
+        if (substep * 2 >= ENCODER_STEP_MODE) {
+            detent = 1;
+        } else if (substep * 2 <= -ENCODER_STEP_MODE) {
+            detent = -1;
+        }
+        substep = 0;
     }
+    enc->substep = substep;
+
+    if (detent) {
+        enc->position.fetch_add(detent, std::memory_order_relaxed);
+        if (enc->pending.fetch_add(detent, std::memory_order_relaxed) == 0) {
+            enc->pending_stamp = stamp;
+        }
+        __encoder_track_detent(enc, now, detent);
+    }
+
+    bool a_changed = ((prev ^ curr) & 0x2) != 0;
+    input_event_record_at(&enc->events, now,
+                          a_changed ? enc->pin_a : enc->pin_b,
+                          a_changed ? a : b,
+                          detent);
 }
 
 static void __encoder_isr_btn(void* ctx) {
     encoder_t* enc = (encoder_t*)ctx;
-    // how to call the callback
-    if (enc->button_cb) enc->button_cb(enc);
+    // callback runs later from encoder_process(), never in interrupt context
+    input_event_record(&enc->events, enc->pin_btn, digitalRead(enc->pin_btn), 0);
 }
 
 void encoder_init(encoder_t* enc, pin_t pin_a, pin_t pin_b, pin_t pin_btn) {
+    pinMode(pin_a, INPUT_PULLUP);
+    pinMode(pin_b, INPUT_PULLUP);
+    pinMode(pin_btn, INPUT_PULLUP);
+
+    // read initial state
+    uint8_t a = digitalRead(pin_a);
+    uint8_t b = digitalRead(pin_b);
+    encoder_reset(enc, pin_a, pin_b, pin_btn, (a << 1) | b, digitalRead(pin_btn));
+
+    attach_encoder_interrupts(enc);
+}
+
+void encoder_reset(encoder_t* enc, pin_t pin_a, pin_t pin_b, pin_t pin_btn, uint8_t ab_state, uint8_t btn_level) {
     enc->pin_a = pin_a;
     enc->pin_b = pin_b;
     enc->pin_btn = pin_btn;
-    enc->position = 0;
-    enc->last_state = 0;
+    enc->position.store(0);
+    enc->pending.store(0);
+    enc->last_state = ab_state & 0x3;
+    enc->substep = 0;
+    enc->last_detent_us = 0;
+    enc->detent_interval_us = ENCODER_VELOCITY_TIMEOUT_US;
+    enc->last_dir = 0;
+    enc->pending_stamp = 0;
+    enc->btn_level = btn_level;
+    enc->overruns_seen = 0;
+    encoder_set_accel(enc, NULL);
     enc->spin_cb = NULL;
     enc->button_cb = NULL;
-
-    pinMode(enc->pin_a, INPUT_PULLUP);
-    pinMode(enc->pin_b, INPUT_PULLUP);
-    pinMode(enc->pin_btn, INPUT_PULLUP);
-
-    // read initial state
-    uint8_t a = digitalRead(enc->pin_a);
-    uint8_t b = digitalRead(enc->pin_b);
-    enc->last_state = (a << 1) | b;
-
-    attach_encoder_interrupts(enc);
+    spsc_ring_reset(&enc->events);
 }
 
 void encoder_set_spin_callback(encoder_t* enc, void (*cb)(encoder_t* enc, int32_t delta)) {
@@ -74,15 +117,155 @@ void encoder_set_button_callback(encoder_t* enc, void (*cb)(encoder_t* enc)) {
 }
 
 int32_t encoder_get_position(const encoder_t* enc) {
-    return enc->position;
+    return enc->position.load(std::memory_order_relaxed);
 }
 
 void encoder_set_position(encoder_t* enc, int32_t pos) {
-    enc->position = pos;
+    enc->position.store(pos, std::memory_order_relaxed);
+}
+
+int32_t encoder_take_delta(encoder_t* enc) {
+    if (!enc) return 0;
+    return enc->pending.exchange(0, std::memory_order_relaxed);
+}
+
+uint32_t encoder_get_pending_stamp(const encoder_t* enc) {
+    if (!enc) return 0;
+    return enc->pending_stamp;
+}
+
+int32_t encoder_take_accel_delta(encoder_t* enc) {
+    if (!enc) return 0;
+
+    int32_t delta = encoder_take_delta(enc);
+    if (delta == 0) return 0;
+
+    float gain = 1.0f;
+    const encoder_accel_t* accel = &enc->accel;
+    if (accel->max_gain > 1.0f) {
+        float speed = fabsf(encoder_get_velocity(enc));
+        if (speed >= accel->max_speed) {
+            gain = accel->max_gain;
+        } else if (speed > accel->min_speed) {
+            float t = (speed - accel->min_speed) / (accel->max_speed - accel->min_speed);
+            gain = 1.0f + t * (accel->max_gain - 1.0f);
+        }
+    }
+
+    // drop carried fractions when the direction reverses
+    if ((delta > 0) != (enc->accel_residual > 0.0f)) {
+        enc->accel_residual = 0.0f;
+    }
+    float scaled = delta * gain + enc->accel_residual;
+    int32_t out = (int32_t)scaled;
+    enc->accel_residual = scaled - out;
+    return out;
+}
+
+float encoder_get_velocity(const encoder_t* enc) {
+    if (!enc) return 0.0f;
+
+    // the ISR may update the fields under us; retry until we get a consistent set
+    uint32_t last_us;
+    uint32_t interval_us;
+    int8_t dir;
+    do {
+        last_us = enc->last_detent_us;
+        interval_us = enc->detent_interval_us;
+        dir = enc->last_dir;
+    } while (last_us != enc->last_detent_us);
+
+    if (dir == 0) return 0.0f;
+
+    uint32_t since_us = micros() - last_us;
+    if (since_us >= ENCODER_VELOCITY_TIMEOUT_US) return 0.0f;
+    if (since_us > interval_us) interval_us = since_us;  // slowing down
+    if (interval_us == 0) interval_us = 1;
+
+    return dir * (1000000.0f / interval_us);
+}
+
+void encoder_set_accel(encoder_t* enc, const encoder_accel_t* accel) {
+    if (!enc) return;
+    if (accel && accel->max_speed > accel->min_speed) {
+        enc->accel = *accel;
+    } else {
+        enc->accel.min_speed = 0.0f;
+        enc->accel.max_speed = 1.0f;
+        enc->accel.max_gain = 1.0f;
+    }
+    enc->accel_residual = 0.0f;
+}
+
+void encoder_process(encoder_t* enc) {
+    if (!enc) return;
+
+    input_event_t event;
+    while (spsc_ring_pop(&enc->events, &event)) {
+        input_event_drained(&event);
+        if (event.delta != 0) {
+            if (enc->spin_cb) enc->spin_cb(enc, event.delta);
+        } else if (event.pin == enc->pin_btn) {
+            enc->btn_level = event.level;
+            if (event.level == HIGH && enc->button_cb) enc->button_cb(enc);
+        }
+    }
+
+    // Button edges may have been lost — trust the pin itself
+    uint32_t overruns = enc->events.overruns.load(std::memory_order_relaxed);
+    if (overruns != enc->overruns_seen) {
+        enc->overruns_seen = overruns;
+        enc->btn_level = digitalRead(enc->pin_btn);
+    }
+}
+
+bool encoder_inject(encoder_t* enc, const input_event_t* event) {
+    if (!enc || !event) return false;
+
+    if (event->delta != 0) {
+        enc->position.fetch_add(event->delta, std::memory_order_relaxed);
+        if (enc->pending.fetch_add(event->delta, std::memory_order_relaxed) == 0) {
+            enc->pending_stamp = event->stamp;
+        }
+        __encoder_track_detent(enc, event->timestamp_us, event->delta);
+    }
+    return spsc_ring_push(&enc->events, *event);
+}
+
+bool encoder_button_pressed(const encoder_t* enc) {
+    if (!enc) return false;
+    return enc->btn_level == LOW;
+}
+
+uint32_t encoder_get_overruns(const encoder_t* enc) {
+    if (!enc) return 0;
+    return enc->events.overruns.load(std::memory_order_relaxed);
 }
 
 void attach_encoder_interrupts(encoder_t* enc) {
-    attachInterruptArg(digitalPinToInterrupt(enc->pin_a), __encoder_isr_a, enc, CHANGE);
-    attachInterruptArg(digitalPinToInterrupt(enc->pin_b), __encoder_isr_b, enc, CHANGE);
-    attachInterruptArg(digitalPinToInterrupt(enc->pin_btn), __encoder_isr_btn, enc, RISING);
-}
\ No newline at end of file
+    attachInterruptArg(digitalPinToInterrupt(enc->pin_a), __encoder_isr_ab, enc, CHANGE);
+    attachInterruptArg(digitalPinToInterrupt(enc->pin_b), __encoder_isr_ab, enc, CHANGE);
+    attachInterruptArg(digitalPinToInterrupt(enc->pin_btn), __encoder_isr_btn, enc, CHANGE);
+}
+
+bool encoder_resync(encoder_t* enc) {
+    if (!enc) return false;
+
+    bool moved = false;
+    uint8_t ab = (digitalRead(enc->pin_a) << 1) | digitalRead(enc->pin_b);
+    if (ab != enc->last_state) {
+        __encoder_isr_ab(enc);
+        moved = true;
+    }
+    if (digitalRead(enc->pin_btn) != enc->btn_level) {
+        __encoder_isr_btn(enc);
+        moved = true;
+    }
+    return moved;
+}
+
+#if defined(PIO_UNIT_TESTING)
+void encoder_bench_isr(encoder_t* enc) {
+    __encoder_isr_ab(enc);
+}
+#endif
@@ -0,0 +1,177 @@
+#include "fusion.h"
+
+#include <math.h>
+
+#define DEG_TO_RAD_F    0.017453292519943295f
+#define RAD_TO_DEG_F    57.29577951308232f
+
+static inline float invSqrt(float x) {
+    return 1.0f / sqrtf(x);
+}
+
+// Seed roll/pitch from the gravity vector (yaw is unobservable without a magnetometer)
+static void alignToGravity(fusion_t* fusion, float ax, float ay, float az) {
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+
+    float cr = cosf(roll * 0.5f);
+    float sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f);
+    float sp = sinf(pitch * 0.5f);
+
+    fusion->q0 = cr * cp;
+    fusion->q1 = sr * cp;
+    fusion->q2 = cr * sp;
+    fusion->q3 = -sr * sp;
+    fusion->aligned = true;
+}
+
+void fusion_init(fusion_t* fusion, float beta) {
+    if (!fusion) {
+        return;
+    }
+    fusion->q0 = 1.0f;
+    fusion->q1 = 0.0f;
+    fusion->q2 = 0.0f;
+    fusion->q3 = 0.0f;
+    fusion->beta = beta;
+    fusion->last_us = 0;
+    fusion->has_time = false;
+    fusion->aligned = false;
+    fusion->updates = 0;
+}
+
+bool fusion_update(fusion_t* fusion, const imu_sample_t* sample) {
+    if (!fusion || !sample || !(sample->flags & IMU_SAMPLE_GYRO_VALID)) {
+        return false;
+    }
+
+    float dt = 0.0f;
+    if (fusion->has_time) {
+        dt = (uint32_t)(sample->timestamp_us - fusion->last_us) * 1e-6f;
+        if (dt > FUSION_MAX_DT_S) {
+            dt = FUSION_MAX_DT_S;
+        }
+    }
+    fusion->last_us = sample->timestamp_us;
+    fusion->has_time = true;
+
+    imu_data_t data = sample->data;
+    if (!(sample->flags & IMU_SAMPLE_ACCEL_VALID)) {
+        data.accel_x = data.accel_y = data.accel_z = 0.0f;
+    }
+    fusion_update_dt(fusion, &data, dt);
+    return true;
+}
+
+void fusion_update_dt(fusion_t* fusion, const imu_data_t* data, float dt_s) {
+    if (!fusion || !data) {
+        return;
+    }
+
+    float ax = data->accel_x;
+    float ay = data->accel_y;
+    float az = data->accel_z;
+    bool have_accel = !((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f));
+
+    if (!fusion->aligned && have_accel) {
+        alignToGravity(fusion, ax, ay, az);
+    }
+
+    float gx = data->gyro_x * DEG_TO_RAD_F;
+    float gy = data->gyro_y * DEG_TO_RAD_F;
+    float gz = data->gyro_z * DEG_TO_RAD_F;
+
+    float q0 = fusion->q0;
+    float q1 = fusion->q1;
+    float q2 = fusion->q2;
+    float q3 = fusion->q3;
+
+    // Rate of change of quaternion from gyroscope
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    if (have_accel) {
+        float recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+
+        float _2q0 = 2.0f * q0;
+        float _2q1 = 2.0f * q1;
+        float _2q2 = 2.0f * q2;
+        float _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0;
+        float _4q1 = 4.0f * q1;
+        float _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1;
+        float _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0;
+        float q1q1 = q1 * q1;
+        float q2q2 = q2 * q2;
+        float q3q3 = q3 * q3;
+
+        // Gradient descent corrective step towards measured gravity
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+        float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sNorm > 0.0f) {
+            recipNorm = invSqrt(sNorm);
+            qDot0 -= fusion->beta * s0 * recipNorm;
+            qDot1 -= fusion->beta * s1 * recipNorm;
+            qDot2 -= fusion->beta * s2 * recipNorm;
+            qDot3 -= fusion->beta * s3 * recipNorm;
+        }
+    }
+
+    q0 += qDot0 * dt_s;
+    q1 += qDot1 * dt_s;
+    q2 += qDot2 * dt_s;
+    q3 += qDot3 * dt_s;
+
+    float recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    fusion->q0 = q0 * recipNorm;
+    fusion->q1 = q1 * recipNorm;
+    fusion->q2 = q2 * recipNorm;
+    fusion->q3 = q3 * recipNorm;
+    fusion->updates++;
+}
+
+void fusion_get_quaternion(const fusion_t* fusion, float q[4]) {
+    if (!fusion || !q) {
+        return;
+    }
+    q[0] = fusion->q0;
+    q[1] = fusion->q1;
+    q[2] = fusion->q2;
+    q[3] = fusion->q3;
+}
+
+void fusion_get_euler(const fusion_t* fusion, float* roll, float* pitch, float* yaw) {
+    if (!fusion) {
+        return;
+    }
+
+    float q0 = fusion->q0;
+    float q1 = fusion->q1;
+    float q2 = fusion->q2;
+    float q3 = fusion->q3;
+
+    if (roll) {
+        *roll = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2) * RAD_TO_DEG_F;
+    }
+    if (pitch) {
+        float s = -2.0f * (q1 * q3 - q0 * q2);
+        if (s > 1.0f) s = 1.0f;
+        if (s < -1.0f) s = -1.0f;
+        *pitch = asinf(s) * RAD_TO_DEG_F;
+    }
+    if (yaw) {
+        *yaw = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3) * RAD_TO_DEG_F;
+    }
+}
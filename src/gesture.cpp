@@ -0,0 +1,266 @@
+#include "gesture.h"
+
+#include <math.h>
+#include <string.h>
+
+#define GESTURE_MASK            (GESTURE_WINDOW - 1)
+#define GESTURE_GRAVITY_TAU_S   0.5f    // gravity low-pass time constant
+#define GESTURE_RATE_DEADBAND   30.0f   // dps; slower rotation never counts as a zero crossing
+#define GESTURE_FLICK_STOP      0.25f   // a flick ends once the rate falls below this share of its peak
+#define GESTURE_MAX_DT_S        0.1f    // longer gaps are clamped
+#define GESTURE_DEG_TO_RAD      0.017453292f
+
+enum { AXIS_X = 0, AXIS_Y = 1, AXIS_Z = 2 };
+
+static void __gesture_crossing_push(gesture_t* g, uint8_t axis, uint32_t now_us) {
+    g->crossing_head[axis] = (g->crossing_head[axis] + 1) % GESTURE_MAX_CROSSINGS;
+    g->crossing_us[axis][g->crossing_head[axis]] = now_us;
+    if (g->crossing_len[axis] < GESTURE_MAX_CROSSINGS) g->crossing_len[axis]++;
+}
+
+// Crossings within the window, newest first; at most GESTURE_MAX_CROSSINGS steps
+static uint8_t __gesture_crossings(const gesture_t* g, uint8_t axis, uint32_t now_us) {
+    uint8_t count = 0;
+    uint8_t slot = g->crossing_head[axis];
+    while (count < g->crossing_len[axis]
+           && (uint32_t)(now_us - g->crossing_us[axis][slot]) < g->config.crossing_window_us) {
+        count++;
+        slot = (slot + GESTURE_MAX_CROSSINGS - 1) % GESTURE_MAX_CROSSINGS;
+    }
+    return count;
+}
+
+// Monotonic queue: front holds the largest |rate| still inside the window
+static void __gesture_peak_push(gesture_t* g, uint8_t axis, uint32_t index, float rate) {
+    uint8_t* head = &g->peak_head[axis];
+    uint8_t* len = &g->peak_len[axis];
+
+    // expire the front once it has left the window
+    if (*len > 0 && (uint8_t)((uint8_t)index - g->peak_queue[axis][*head]) >= GESTURE_WINDOW) {
+        *head = (*head + 1) & GESTURE_MASK;
+        (*len)--;
+    }
+    // drop smaller entries from the back; they can never be the peak again
+    float magnitude = fabsf(rate);
+    while (*len > 0) {
+        uint8_t back = (*head + *len - 1) & GESTURE_MASK;
+        if (fabsf(g->peak_rate[axis][back]) > magnitude) break;
+        (*len)--;
+    }
+    uint8_t tail = (*head + *len) & GESTURE_MASK;
+    g->peak_queue[axis][tail] = (uint8_t)index;
+    g->peak_rate[axis][tail] = rate;
+    (*len)++;
+}
+
+static float __gesture_peak(const gesture_t* g, uint8_t axis) {
+    return g->peak_len[axis] ? g->peak_rate[axis][g->peak_head[axis]] : 0.0f;
+}
+
+// Re-add the window from scratch once per wrap so float sums never drift
+static void __gesture_resum(gesture_t* g) {
+    g->energy_sum = 0.0f;
+    for (uint8_t axis = 0; axis < GESTURE_AXES; axis++) g->swept_sum[axis] = 0.0f;
+    for (uint8_t i = 0; i < GESTURE_WINDOW; i++) {
+        g->energy_sum += g->energy[i];
+        for (uint8_t axis = 0; axis < GESTURE_AXES; axis++) {
+            g->swept_sum[axis] += g->swept[axis][i];
+        }
+    }
+}
+
+static bool __gesture_emit(gesture_event_t* event, gesture_type_t type, bool active, float strength, uint32_t now_us) {
+    if (event) {
+        event->type = type;
+        event->active = active;
+        event->strength = strength;
+        event->timestamp_us = now_us;
+    }
+    return true;
+}
+
+static bool __gesture_classify_motion(gesture_t* g, uint32_t now_us, gesture_event_t* event) {
+    const gesture_config_t* cfg = &g->config;
+    uint8_t filled = (g->count < GESTURE_WINDOW) ? (uint8_t)g->count : GESTURE_WINDOW;
+
+    uint8_t crossings[GESTURE_AXES];
+    uint8_t max_crossings = 0;
+    for (uint8_t axis = 0; axis < GESTURE_AXES; axis++) {
+        crossings[axis] = __gesture_crossings(g, axis, now_us);
+        if (crossings[axis] > max_crossings) max_crossings = crossings[axis];
+    }
+
+    // Shake: lots of linear energy while the rotation keeps reversing
+    float mean_energy = g->energy_sum / filled;
+    if (mean_energy >= cfg->shake_energy_g2 && max_crossings >= cfg->shake_min_crossings) {
+        return __gesture_emit(event, GESTURE_SHAKE, true, mean_energy, now_us);
+    }
+
+    // Flick: one fast rotation about Z (left/right) or X (up/down) that has stopped again
+    uint8_t axis = (fabsf(g->swept_sum[AXIS_Z]) >= fabsf(g->swept_sum[AXIS_X])) ? AXIS_Z : AXIS_X;
+    float peak = __gesture_peak(g, axis);
+    float swept = g->swept_sum[axis];
+    bool stopped = fabsf(g->last_rate[axis]) < fabsf(peak) * GESTURE_FLICK_STOP;
+    if (fabsf(peak) >= cfg->flick_peak_dps && fabsf(swept) >= cfg->flick_min_deg
+        && crossings[axis] <= cfg->flick_max_crossings && stopped && (peak > 0.0f) == (swept > 0.0f)) {
+        gesture_type_t type;
+        if (axis == AXIS_Z) {
+            type = (swept > 0.0f) ? GESTURE_FLICK_RIGHT : GESTURE_FLICK_LEFT;
+        } else {
+            type = (swept > 0.0f) ? GESTURE_FLICK_DOWN : GESTURE_FLICK_UP;
+        }
+        return __gesture_emit(event, type, true, fabsf(peak), now_us);
+    }
+    return false;
+}
+
+static bool __gesture_classify_tilt(gesture_t* g, uint32_t now_us, gesture_event_t* event) {
+    float norm_sq = g->gravity[AXIS_X] * g->gravity[AXIS_X] + g->gravity[AXIS_Y] * g->gravity[AXIS_Y]
+                    + g->gravity[AXIS_Z] * g->gravity[AXIS_Z];
+    if (norm_sq < 0.25f) {
+        return false;  // free fall or garbage: no usable gravity direction
+    }
+    float inv = 1.0f / sqrtf(norm_sq);
+    float side = g->gravity[AXIS_Y] * inv;     // sin(roll)
+    float forward = g->gravity[AXIS_X] * inv;  // sin(pitch)
+
+    if (g->tilt != GESTURE_NONE) {
+        float component;
+        switch (g->tilt) {
+            case GESTURE_TILT_RIGHT: component = side; break;
+            case GESTURE_TILT_LEFT: component = -side; break;
+            case GESTURE_TILT_FORWARD: component = forward; break;
+            default: component = -forward; break;
+        }
+        if (component < g->tilt_exit_sin) {
+            gesture_type_t ended = g->tilt;
+            g->tilt = GESTURE_NONE;
+            g->tilt_candidate = GESTURE_NONE;
+            return __gesture_emit(event, ended, false, 0.0f, now_us);
+        }
+        return false;
+    }
+
+    gesture_type_t candidate = GESTURE_NONE;
+    float angle_sin = 0.0f;
+    if (fabsf(side) >= fabsf(forward)) {
+        if (fabsf(side) >= g->tilt_enter_sin) {
+            candidate = (side > 0.0f) ? GESTURE_TILT_RIGHT : GESTURE_TILT_LEFT;
+            angle_sin = fabsf(side);
+        }
+    } else if (fabsf(forward) >= g->tilt_enter_sin) {
+        candidate = (forward > 0.0f) ? GESTURE_TILT_FORWARD : GESTURE_TILT_BACK;
+        angle_sin = fabsf(forward);
+    }
+
+    if (candidate != g->tilt_candidate) {
+        g->tilt_candidate = candidate;
+        g->tilt_since_us = now_us;
+        return false;
+    }
+    if (candidate != GESTURE_NONE && (uint32_t)(now_us - g->tilt_since_us) >= g->config.tilt_hold_us) {
+        g->tilt = candidate;
+        return __gesture_emit(event, candidate, true, asinf(angle_sin) / GESTURE_DEG_TO_RAD, now_us);
+    }
+    return false;
+}
+
+void gesture_init(gesture_t* g, const gesture_config_t* config) {
+    if (!g) {
+        return;
+    }
+    memset(g, 0, sizeof(*g));
+    g->config = config ? *config : GESTURE_DEFAULT_CONFIG;
+    g->tilt_enter_sin = sinf(g->config.tilt_enter_deg * GESTURE_DEG_TO_RAD);
+    g->tilt_exit_sin = sinf(g->config.tilt_exit_deg * GESTURE_DEG_TO_RAD);
+    g->tilt = GESTURE_NONE;
+    g->tilt_candidate = GESTURE_NONE;
+}
+
+bool gesture_update(gesture_t* g, const imu_sample_t* sample, gesture_event_t* event) {
+    if (!g || !sample) {
+        return false;
+    }
+    uint8_t needed = IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID;
+    if ((sample->flags & needed) != needed) {
+        return false;
+    }
+
+    uint32_t now_us = sample->timestamp_us;
+    float dt = 0.0f;
+    if (g->has_time) {
+        dt = (uint32_t)(now_us - g->last_us) * 1e-6f;
+        if (dt > GESTURE_MAX_DT_S) dt = GESTURE_MAX_DT_S;
+    }
+    g->last_us = now_us;
+    g->has_time = true;
+
+    const float accel[GESTURE_AXES] = {sample->data.accel_x, sample->data.accel_y, sample->data.accel_z};
+    const float rate[GESTURE_AXES] = {sample->data.gyro_x, sample->data.gyro_y, sample->data.gyro_z};
+
+    // Gravity by exponential smoothing; the remainder is linear acceleration
+    float energy = 0.0f;
+    if (!g->gravity_valid) {
+        for (uint8_t axis = 0; axis < GESTURE_AXES; axis++) g->gravity[axis] = accel[axis];
+        g->gravity_valid = true;
+    } else {
+        float alpha = dt / (GESTURE_GRAVITY_TAU_S + dt);
+        for (uint8_t axis = 0; axis < GESTURE_AXES; axis++) {
+            g->gravity[axis] += alpha * (accel[axis] - g->gravity[axis]);
+            float linear = accel[axis] - g->gravity[axis];
+            energy += linear * linear;
+        }
+    }
+
+    // Slide the window: the slot being overwritten leaves every running sum
+    uint8_t slot = g->count & GESTURE_MASK;
+    g->energy_sum += energy - g->energy[slot];
+    g->energy[slot] = energy;
+    for (uint8_t axis = 0; axis < GESTURE_AXES; axis++) {
+        float step = rate[axis] * dt;
+        g->swept_sum[axis] += step - g->swept[axis][slot];
+        g->swept[axis][slot] = step;
+
+        int8_t sign = (rate[axis] > GESTURE_RATE_DEADBAND) ? 1 : (rate[axis] < -GESTURE_RATE_DEADBAND) ? -1 : 0;
+        bool crossing = sign != 0 && g->last_sign[axis] != 0 && sign != g->last_sign[axis];
+        if (sign != 0) g->last_sign[axis] = sign;
+        if (crossing) __gesture_crossing_push(g, axis, now_us);
+
+        __gesture_peak_push(g, axis, g->count, rate[axis]);
+        g->last_rate[axis] = rate[axis];
+    }
+    g->count++;
+    if (slot == GESTURE_MASK) {
+        __gesture_resum(g);
+    }
+
+    if (g->quiet && (int32_t)(now_us - g->quiet_until_us) >= 0) {
+        g->quiet = false;
+    }
+    if (!g->quiet && __gesture_classify_motion(g, now_us, event)) {
+        // Forget the motion so its tail cannot trigger again
+        g->quiet = true;
+        g->quiet_until_us = now_us + g->config.refractory_us;
+        memset(g->crossing_len, 0, sizeof(g->crossing_len));
+        memset(g->swept, 0, sizeof(g->swept));
+        memset(g->swept_sum, 0, sizeof(g->swept_sum));
+        memset(g->peak_len, 0, sizeof(g->peak_len));
+        return true;
+    }
+    return __gesture_classify_tilt(g, now_us, event);
+}
+
+const char* gesture_name(gesture_type_t type) {
+    switch (type) {
+        case GESTURE_FLICK_LEFT: return "flick-left";
+        case GESTURE_FLICK_RIGHT: return "flick-right";
+        case GESTURE_FLICK_UP: return "flick-up";
+        case GESTURE_FLICK_DOWN: return "flick-down";
+        case GESTURE_SHAKE: return "shake";
+        case GESTURE_TILT_LEFT: return "tilt-left";
+        case GESTURE_TILT_RIGHT: return "tilt-right";
+        case GESTURE_TILT_FORWARD: return "tilt-forward";
+        case GESTURE_TILT_BACK: return "tilt-back";
+        default: return "none";
+    }
+}
@@ -0,0 +1,315 @@
+#include "hid_report.h"
+
+#include <string.h>
+
+#define HID_SHIFT               0x80    // ascii map flag: needs left shift
+#define HID_MOD_LEFT_SHIFT      0x02
+#define HID_KEY_MODIFIER_BASE   0x80    // KEY_LEFT_CTRL..KEY_RIGHT_GUI
+#define HID_KEY_RAW_BASE        0x88    // KEY_UP_ARROW etc. are usage + 0x88
+
+// US layout usage codes for printable ASCII 0x20..0x7E (same table as BleKeyboard)
+static const uint8_t kAsciiMap[95] = {
+    0x2c,             0x1e | HID_SHIFT, 0x34 | HID_SHIFT, 0x20 | HID_SHIFT,  //   ! " #
+    0x21 | HID_SHIFT, 0x22 | HID_SHIFT, 0x24 | HID_SHIFT, 0x34,              // $ % & '
+    0x26 | HID_SHIFT, 0x27 | HID_SHIFT, 0x25 | HID_SHIFT, 0x2e | HID_SHIFT,  // ( ) * +
+    0x36, 0x2d, 0x37, 0x38,                                                  // , - . /
+    0x27, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,              // 0-9
+    0x33 | HID_SHIFT, 0x33, 0x36 | HID_SHIFT, 0x2e,                          // : ; < =
+    0x37 | HID_SHIFT, 0x38 | HID_SHIFT, 0x1f | HID_SHIFT,                    // > ? @
+    0x04 | HID_SHIFT, 0x05 | HID_SHIFT, 0x06 | HID_SHIFT, 0x07 | HID_SHIFT,  // A-Z
+    0x08 | HID_SHIFT, 0x09 | HID_SHIFT, 0x0a | HID_SHIFT, 0x0b | HID_SHIFT,
+    0x0c | HID_SHIFT, 0x0d | HID_SHIFT, 0x0e | HID_SHIFT, 0x0f | HID_SHIFT,
+    0x10 | HID_SHIFT, 0x11 | HID_SHIFT, 0x12 | HID_SHIFT, 0x13 | HID_SHIFT,
+    0x14 | HID_SHIFT, 0x15 | HID_SHIFT, 0x16 | HID_SHIFT, 0x17 | HID_SHIFT,
+    0x18 | HID_SHIFT, 0x19 | HID_SHIFT, 0x1a | HID_SHIFT, 0x1b | HID_SHIFT,
+    0x1c | HID_SHIFT, 0x1d | HID_SHIFT,
+    0x2f, 0x31, 0x30, 0x23 | HID_SHIFT, 0x2d | HID_SHIFT, 0x35,              // [ \ ] ^ _ `
+    0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,  // a-z
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b,
+    0x1c, 0x1d,
+    0x2f | HID_SHIFT, 0x31 | HID_SHIFT, 0x30 | HID_SHIFT, 0x35 | HID_SHIFT,  // { | } ~
+};
+
+static uint32_t __hid_micros(void) {
+    return micros();
+}
+
+// Translate a BleKeyboard-style key code into (usage, modifier bits)
+static bool __hid_translate(uint8_t key, uint8_t* usage, uint8_t* modifiers, bool* shifted) {
+    *usage = 0;
+    *modifiers = 0;
+    *shifted = false;
+
+    if (key >= HID_KEY_RAW_BASE) {
+        *usage = key - HID_KEY_RAW_BASE;
+        return true;
+    }
+    if (key >= HID_KEY_MODIFIER_BASE) {
+        *modifiers = (uint8_t)(1u << (key - HID_KEY_MODIFIER_BASE));
+        return true;
+    }
+
+    uint8_t code = 0;
+    switch (key) {
+        case '\b': code = 0x2a; break;
+        case '\t': code = 0x2b; break;
+        case '\n': code = 0x28; break;
+        default:
+            if (key >= 0x20 && key <= 0x7e) {
+                code = kAsciiMap[key - 0x20];
+            }
+            break;
+    }
+    if (code == 0) {
+        return false;
+    }
+    if (code & HID_SHIFT) {
+        *shifted = true;
+        code &= ~HID_SHIFT;
+    }
+    *usage = code;
+    return true;
+}
+
+static bool __hid_has_usage(const hid_key_report_t* report, uint8_t usage) {
+    for (uint8_t i = 0; i < HID_REPORT_MAX_KEYS; i++) {
+        if (report->keys[i] == usage) return true;
+    }
+    return false;
+}
+
+static bool __hid_differs(const hid_key_report_t* a, const hid_key_report_t* b) {
+    return memcmp(a, b, sizeof(hid_key_report_t)) != 0;
+}
+
+// Shift stays down while any shifted character is still held
+static void __hid_update_modifiers(hid_composer_t* hid) {
+    hid->state.modifiers = hid->held_modifiers | (hid->shifted_slots ? HID_MOD_LEFT_SHIFT : 0);
+}
+
+static void __hid_mark_changed(hid_composer_t* hid) {
+    hid->stats.changes++;
+    if (hid->dirty) {
+        hid->stats.merged++;  // joins a report that has not been queued yet
+    }
+    hid->dirty = __hid_differs(&hid->state, &hid->published);
+    if (!hid->dirty) {
+        hid->origin_stamp = 0;  // nothing will be sent for it
+    }
+}
+
+// Append the current state to the transmit queue, applying backpressure
+static bool __hid_commit(hid_composer_t* hid, uint32_t now) {
+    if (hid->queue_count >= HID_REPORT_QUEUE_CAPACITY) {
+        switch (hid->policy) {
+            case HID_BACKPRESSURE_MERGE: {
+                uint8_t newest = (hid->queue_head + hid->queue_count - 1) % HID_REPORT_QUEUE_CAPACITY;
+                hid->queue[newest] = hid->state;
+                if (hid->queue_origin[newest] == 0) {
+                    hid->queue_origin[newest] = hid->origin_stamp;
+                    hid->queue_source[newest] = hid->origin_source;
+                }
+                hid->stats.merged++;
+                break;
+            }
+            case HID_BACKPRESSURE_DROP:
+                hid->stats.dropped++;
+                hid->resync = true;
+                break;
+            case HID_BACKPRESSURE_REPEAT:
+            default:
+                return false;  // stays dirty, retried on the next poll
+        }
+    } else {
+        uint8_t tail = (hid->queue_head + hid->queue_count) % HID_REPORT_QUEUE_CAPACITY;
+        hid->queue[tail] = hid->state;
+        hid->queue_origin[tail] = hid->origin_stamp;
+        hid->queue_source[tail] = hid->origin_source;
+        hid->queue_count++;
+        hid->stats.composed++;
+    }
+
+    hid->origin_stamp = 0;
+    hid->published = hid->state;
+    hid->dirty = false;
+    hid->last_queued_us = now;
+    return true;
+}
+
+void hid_composer_init(hid_composer_t* hid, hid_send_result_t (*send)(void* ctx, const hid_key_report_t* report),
+                       void* ctx) {
+    if (!hid) {
+        return;
+    }
+    memset(hid, 0, sizeof(*hid));
+    hid->send = send;
+    hid->send_ctx = ctx;
+    hid->now_us = __hid_micros;
+    hid->window_us = HID_COMPOSER_DEFAULT_WINDOW_US;
+    hid->max_per_poll = 1;
+    hid->policy = HID_BACKPRESSURE_MERGE;
+    hid->last_queued_us = hid->now_us() - hid->window_us;
+}
+
+void hid_composer_set_clock(hid_composer_t* hid, uint32_t (*now_us)(void)) {
+    if (!hid) {
+        return;
+    }
+    hid->now_us = now_us ? now_us : __hid_micros;
+    hid->last_queued_us = hid->now_us() - hid->window_us;
+}
+
+void hid_composer_set_window(hid_composer_t* hid, uint32_t window_us) {
+    if (!hid) {
+        return;
+    }
+    hid->window_us = window_us;
+}
+
+void hid_composer_set_backpressure(hid_composer_t* hid, hid_backpressure_t policy, uint8_t max_per_poll) {
+    if (!hid) {
+        return;
+    }
+    hid->policy = policy;
+    hid->max_per_poll = max_per_poll ? max_per_poll : 1;
+}
+
+void hid_composer_set_origin(hid_composer_t* hid, latency_source_t source, uint32_t stamp) {
+    if (!hid || stamp == 0 || hid->origin_stamp != 0) {
+        return;
+    }
+    hid->origin_stamp = stamp;
+    hid->origin_source = (uint8_t)source;
+}
+
+bool hid_composer_press(hid_composer_t* hid, uint8_t key) {
+    uint8_t usage;
+    uint8_t modifiers;
+    bool shifted;
+    if (!hid || !__hid_translate(key, &usage, &modifiers, &shifted)) {
+        return false;
+    }
+
+    hid->held_modifiers |= modifiers;
+    if (usage != 0 && !__hid_has_usage(&hid->state, usage)) {
+        uint8_t i = 0;
+        while (i < HID_REPORT_MAX_KEYS && hid->state.keys[i] != 0) i++;
+        if (i == HID_REPORT_MAX_KEYS) {
+            return false;  // rollover exhausted
+        }
+        hid->state.keys[i] = usage;
+        if (shifted) {
+            hid->shifted_slots |= (uint8_t)(1u << i);
+        }
+    }
+    __hid_update_modifiers(hid);
+    __hid_mark_changed(hid);
+    return true;
+}
+
+bool hid_composer_release(hid_composer_t* hid, uint8_t key) {
+    uint8_t usage;
+    uint8_t modifiers;
+    bool shifted;
+    if (!hid || !__hid_translate(key, &usage, &modifiers, &shifted)) {
+        return false;
+    }
+
+    // Never let a release cancel a press the host has not seen yet
+    bool unpublished = (usage != 0 && __hid_has_usage(&hid->state, usage) && !__hid_has_usage(&hid->published, usage))
+                       || ((hid->held_modifiers & modifiers) & ~hid->published.modifiers);
+    if (unpublished && !__hid_commit(hid, hid->now_us())) {
+        hid->stats.dropped++;
+    }
+
+    hid->held_modifiers &= ~modifiers;
+    if (usage != 0) {
+        for (uint8_t i = 0; i < HID_REPORT_MAX_KEYS; i++) {
+            if (hid->state.keys[i] == usage) {
+                hid->state.keys[i] = 0;
+                hid->shifted_slots &= (uint8_t)~(1u << i);
+            }
+        }
+    }
+    __hid_update_modifiers(hid);
+    __hid_mark_changed(hid);
+    return true;
+}
+
+bool hid_composer_tap(hid_composer_t* hid, uint8_t key) {
+    if (!hid_composer_press(hid, key)) {
+        return false;
+    }
+    return hid_composer_release(hid, key);
+}
+
+void hid_composer_release_all(hid_composer_t* hid) {
+    if (!hid) {
+        return;
+    }
+    memset(&hid->state, 0, sizeof(hid->state));
+    hid->held_modifiers = 0;
+    hid->shifted_slots = 0;
+    __hid_mark_changed(hid);
+}
+
+uint32_t hid_composer_poll(hid_composer_t* hid) {
+    if (!hid) {
+        return 0;
+    }
+
+    uint32_t now = hid->now_us();
+    uint32_t wait = 0;
+
+    if (hid->dirty) {
+        uint32_t elapsed = now - hid->last_queued_us;
+        if (elapsed >= hid->window_us) {
+            __hid_commit(hid, now);
+        } else {
+            wait = hid->window_us - elapsed;
+        }
+    }
+
+    // Something was dropped: make sure the host ends up with the real state
+    if (hid->resync && hid->queue_count == 0) {
+        hid->resync = false;
+        if (__hid_differs(&hid->state, &hid->queue[(hid->queue_head + HID_REPORT_QUEUE_CAPACITY - 1) % HID_REPORT_QUEUE_CAPACITY])) {
+            uint8_t tail = hid->queue_head;
+            hid->queue[tail] = hid->state;
+            hid->queue_origin[tail] = 0;
+            hid->queue_count = 1;
+            hid->stats.composed++;
+        }
+    }
+
+    uint8_t budget = hid->max_per_poll;
+    while (budget > 0 && hid->queue_count > 0) {
+        hid_send_result_t result = hid->send ? hid->send(hid->send_ctx, &hid->queue[hid->queue_head]) : HID_SEND_BUSY;
+        if (result == HID_SEND_BUSY) {
+            hid->stats.congested++;
+            break;
+        }
+        if (result == HID_SEND_OK) {
+            latency_record((latency_source_t)hid->queue_source[hid->queue_head], hid->queue_origin[hid->queue_head]);
+            hid->stats.sent++;
+        } else {
+            hid->stats.discarded++;
+        }
+        hid->queue_head = (hid->queue_head + 1) % HID_REPORT_QUEUE_CAPACITY;
+        hid->queue_count--;
+        budget--;
+    }
+
+    if (hid->queue_count > 0 || hid->resync) {
+        // more to send: come back after one connection interval
+        if (wait == 0 || wait > hid->window_us) wait = hid->window_us;
+    }
+    return wait;
+}
+
+bool hid_composer_busy(const hid_composer_t* hid) {
+    if (!hid) {
+        return false;
+    }
+    return hid->dirty || hid->queue_count > 0 || hid->resync;
+}
@@ -0,0 +1,221 @@
+#include "hid_transport.h"
+
+#include <esp_system.h>
+#include <string.h>
+
+#define HID_TRANSPORT_BATTERY_LEVEL     100
+#define HID_TRANSPORT_FAKE_INTERVAL_US  7500
+#define HID_TRANSPORT_FAKE_PER_EVENT    4
+
+void hid_transport_default_config(hid_transport_config_t* config, const char* name, const char* manufacturer) {
+    if (!config) {
+        return;
+    }
+    config->name = name;
+    config->manufacturer = manufacturer;
+    config->battery_level = HID_TRANSPORT_BATTERY_LEVEL;
+    config->min_interval_us = HID_TRANSPORT_MIN_INTERVAL_US;
+    config->max_interval_us = HID_TRANSPORT_MAX_INTERVAL_US;
+    config->supervision_ms = HID_TRANSPORT_SUPERVISION_MS;
+}
+
+void hid_transport_bind(hid_transport_t* transport, const hid_transport_ops_t* ops, void* impl) {
+    if (!transport) {
+        return;
+    }
+    memset(transport, 0, sizeof(*transport));
+    transport->ops = ops;
+    transport->impl = impl;
+    transport->stats.backend = ops ? ops->name : "none";
+}
+
+bool hid_transport_begin(hid_transport_t* transport, const hid_transport_config_t* config) {
+    if (!transport || !transport->ops || !config) {
+        return false;
+    }
+    transport->stats.heap_before = esp_get_free_heap_size();
+    uint32_t start_us = micros();
+    bool ok = transport->ops->begin(transport->impl, config);
+    transport->stats.advertising_us = micros();
+    transport->stats.begin_us = transport->stats.advertising_us - start_us;
+    transport->stats.heap_after = esp_get_free_heap_size();
+    return ok;
+}
+
+void hid_transport_set_link_callback(hid_transport_t* transport, hid_transport_link_fn fn, void* ctx) {
+    if (transport) {
+        transport->link_fn = fn;
+        transport->link_ctx = ctx;
+    }
+}
+
+void hid_transport_link_event(hid_transport_t* transport, bool up, const hid_transport_addr_t* peer) {
+    if (transport && transport->link_fn) {
+        transport->link_fn(transport->link_ctx, up, up ? peer : NULL);
+    }
+}
+
+bool hid_transport_advertise(hid_transport_t* transport, const hid_transport_addr_t* peer) {
+    if (!transport || !transport->ops) {
+        return false;
+    }
+    return transport->ops->advertise(transport->impl, peer);
+}
+
+void hid_transport_disconnect(hid_transport_t* transport) {
+    if (transport && transport->ops) {
+        transport->ops->disconnect(transport->impl);
+    }
+}
+
+void hid_transport_forget(hid_transport_t* transport, const hid_transport_addr_t* peer) {
+    if (transport && transport->ops && peer) {
+        transport->ops->forget(transport->impl, peer);
+    }
+}
+
+bool hid_transport_send(hid_transport_t* transport, const hid_key_report_t* report) {
+    if (!transport || !transport->ops || !report) {
+        return false;
+    }
+    if (!transport->ops->send(transport->impl, report)) {
+        transport->stats.refused++;
+        return false;
+    }
+    transport->stats.sent++;
+    return true;
+}
+
+uint32_t hid_transport_measure_rate(hid_transport_t* transport) {
+    if (!transport || !hid_transport_connected(transport)) {
+        return 0;
+    }
+    hid_key_report_t empty;
+    memset(&empty, 0, sizeof(empty));
+    uint32_t start_us = micros();
+    for (uint16_t sent = 0; sent < HID_TRANSPORT_RATE_REPORTS;) {
+        if (hid_transport_send(transport, &empty)) {
+            sent++;
+        } else if (!hid_transport_connected(transport)) {
+            return 0;
+        } else {
+            delay(1);  // let the stack drain its buffers
+        }
+    }
+    uint32_t elapsed_us = micros() - start_us;
+    transport->stats.rate = (uint32_t)((uint64_t)HID_TRANSPORT_RATE_REPORTS * 1000000 / (elapsed_us ? elapsed_us : 1));
+    return transport->stats.rate;
+}
+
+void hid_transport_get_stats(hid_transport_t* transport, hid_transport_stats_t* stats) {
+    if (!transport || !stats) {
+        return;
+    }
+    *stats = transport->stats;
+    stats->connected = hid_transport_connected(transport);
+    stats->conn_interval_us = (transport->ops && stats->connected) ? transport->ops->conn_interval_us(transport->impl)
+                                                                   : 0;
+}
+
+// Fake -----------------------------------------------------------------------
+
+static uint32_t __hid_fake_micros(void) {
+    return micros();
+}
+
+static bool __hid_fake_begin(void* impl, const hid_transport_config_t* config) {
+    return true;
+}
+
+static bool __hid_fake_connected(void* impl) {
+    return static_cast<hid_transport_fake_t*>(impl)->connected;
+}
+
+static bool __hid_fake_send(void* impl, const hid_key_report_t* report) {
+    hid_transport_fake_t* fake = static_cast<hid_transport_fake_t*>(impl);
+    if (!fake->connected) {
+        return false;
+    }
+    uint32_t now_us = fake->now_us();
+    uint32_t since_us = now_us - fake->event_start_us;
+    if (since_us >= fake->interval_us) {
+        fake->event_start_us = now_us - since_us % fake->interval_us;
+        fake->event_sent = 0;
+    }
+    if (fake->event_sent >= fake->per_event) {
+        return false;
+    }
+    fake->event_sent++;
+    fake->log[fake->received % HID_TRANSPORT_FAKE_LOG] = *report;
+    fake->received++;
+    return true;
+}
+
+static uint32_t __hid_fake_interval(void* impl) {
+    return static_cast<hid_transport_fake_t*>(impl)->interval_us;
+}
+
+static bool __hid_fake_advertise(void* impl, const hid_transport_addr_t* peer) {
+    hid_transport_fake_t* fake = static_cast<hid_transport_fake_t*>(impl);
+    if (fake->connected) {
+        return false;
+    }
+    fake->advertising = true;
+    fake->directed = (peer != NULL);
+    if (peer) {
+        fake->target = *peer;
+    }
+    fake->advertised++;
+    return true;
+}
+
+static void __hid_fake_disconnect(void* impl) {
+    hid_transport_fake_t* fake = static_cast<hid_transport_fake_t*>(impl);
+    if (fake->connected) {
+        hid_transport_fake_link(fake, false, NULL);
+    }
+}
+
+static void __hid_fake_forget(void* impl, const hid_transport_addr_t* peer) {
+    hid_transport_fake_t* fake = static_cast<hid_transport_fake_t*>(impl);
+    fake->last_forgotten = *peer;
+    fake->forgotten++;
+}
+
+static const hid_transport_ops_t kFakeOps = {
+    "fake", __hid_fake_begin, __hid_fake_connected, __hid_fake_send, __hid_fake_interval,
+    __hid_fake_advertise, __hid_fake_disconnect, __hid_fake_forget,
+};
+
+void hid_transport_fake_init(hid_transport_t* transport, hid_transport_fake_t* fake) {
+    if (!transport || !fake) {
+        return;
+    }
+    memset(fake, 0, sizeof(*fake));
+    fake->connected = true;
+    fake->interval_us = HID_TRANSPORT_FAKE_INTERVAL_US;
+    fake->per_event = HID_TRANSPORT_FAKE_PER_EVENT;
+    fake->now_us = __hid_fake_micros;
+    fake->event_start_us = fake->now_us();
+    fake->transport = transport;
+    hid_transport_bind(transport, &kFakeOps, fake);
+}
+
+// Connecting ends advertising, as on a single-connection stack
+void hid_transport_fake_link(hid_transport_fake_t* fake, bool up, const hid_transport_addr_t* peer) {
+    if (!fake) {
+        return;
+    }
+    fake->connected = up;
+    if (up) {
+        fake->advertising = false;
+    }
+    hid_transport_link_event(fake->transport, up, peer);
+}
+
+const hid_key_report_t* hid_transport_fake_report(const hid_transport_fake_t* fake, uint32_t index) {
+    if (!fake || index >= fake->received || fake->received - index > HID_TRANSPORT_FAKE_LOG) {
+        return NULL;
+    }
+    return &fake->log[index % HID_TRANSPORT_FAKE_LOG];
+}
@@ -0,0 +1,118 @@
+#include "hid_transport.h"
+
+#if !HID_TRANSPORT_NIMBLE
+
+#include <BLEDevice.h>
+#include <BleKeyboard.h>
+#include <esp_gap_ble_api.h>
+#include <esp_gatts_api.h>
+#include <string.h>
+
+#define BLUEDROID_ADV_INTERVAL_MIN  0x20    // 20 ms, BLEAdvertising's default (0.625 ms units)
+#define BLUEDROID_ADV_INTERVAL_MAX  0x40
+
+static_assert(sizeof(KeyReport) == sizeof(hid_key_report_t), "BleKeyboard reports must match the composer's");
+
+// Created in begin() so its share of the heap is counted
+static BleKeyboard* keyboard = nullptr;
+static hid_transport_t* owner = nullptr;
+static esp_bd_addr_t peer_bda;         // host of the current connection
+
+// The link is up for the keyboard once the host has encrypted it, which
+// Bluedroid reports with the host's bonded (identity) address
+static void __bluedroid_gap_event(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    if (event != ESP_GAP_BLE_AUTH_CMPL_EVT || !param->ble_security.auth_cmpl.success) {
+        return;
+    }
+    hid_transport_addr_t peer;
+    peer.type = (param->ble_security.auth_cmpl.addr_type == BLE_ADDR_TYPE_PUBLIC) ? HID_TRANSPORT_ADDR_PUBLIC
+                                                                                   : HID_TRANSPORT_ADDR_RANDOM;
+    memcpy(peer.addr, param->ble_security.auth_cmpl.bd_addr, sizeof(peer.addr));
+    hid_transport_link_event(owner, true, &peer);
+}
+
+// BleKeyboard restarts general advertising itself on disconnect
+static void __bluedroid_gatts_event(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
+                                    esp_ble_gatts_cb_param_t* param) {
+    if (event == ESP_GATTS_CONNECT_EVT) {
+        memcpy(peer_bda, param->connect.remote_bda, sizeof(peer_bda));
+    } else if (event == ESP_GATTS_DISCONNECT_EVT) {
+        hid_transport_link_event(owner, false, NULL);
+    }
+}
+
+// BleKeyboard keeps its server to itself, so the connection interval is
+// the host's choice and stays unknown here
+static bool __bluedroid_begin(void* impl, const hid_transport_config_t* config) {
+    if (!keyboard) {
+        keyboard = new BleKeyboard(config->name, config->manufacturer, config->battery_level);
+    }
+    BLEDevice::setCustomGapHandler(__bluedroid_gap_event);
+    BLEDevice::setCustomGattsHandler(__bluedroid_gatts_event);
+    keyboard->begin();
+    return true;
+}
+
+static bool __bluedroid_connected(void* impl) {
+    return keyboard && keyboard->isConnected();
+}
+
+// notify() has no result: a report is lost, not refused, when the stack is congested
+static bool __bluedroid_send(void* impl, const hid_key_report_t* report) {
+    if (!__bluedroid_connected(impl)) {
+        return false;
+    }
+    KeyReport key_report;
+    memcpy(&key_report, report, sizeof(key_report));
+    keyboard->sendReport(&key_report);
+    return true;
+}
+
+static uint32_t __bluedroid_interval(void* impl) {
+    return 0;
+}
+
+// Raw GAP calls: BLEAdvertising only does undirected advertising. The
+// advertising data set up by BleKeyboard stays in the controller.
+static bool __bluedroid_advertise(void* impl, const hid_transport_addr_t* peer) {
+    esp_ble_adv_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.adv_int_min = BLUEDROID_ADV_INTERVAL_MIN;     // ignored by high-duty directed advertising
+    params.adv_int_max = BLUEDROID_ADV_INTERVAL_MAX;
+    params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    params.channel_map = ADV_CHNL_ALL;
+    params.adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY;
+    if (peer) {
+        params.adv_type = ADV_TYPE_DIRECT_IND_HIGH;
+        memcpy(params.peer_addr, peer->addr, sizeof(params.peer_addr));
+        params.peer_addr_type = (peer->type == HID_TRANSPORT_ADDR_PUBLIC) ? BLE_ADDR_TYPE_PUBLIC : BLE_ADDR_TYPE_RANDOM;
+    } else {
+        params.adv_type = ADV_TYPE_IND;
+    }
+    esp_ble_gap_stop_advertising();
+    return esp_ble_gap_start_advertising(&params) == ESP_OK;
+}
+
+static void __bluedroid_disconnect(void* impl) {
+    if (__bluedroid_connected(impl)) {
+        esp_ble_gap_disconnect(peer_bda);
+    }
+}
+
+static void __bluedroid_forget(void* impl, const hid_transport_addr_t* peer) {
+    esp_bd_addr_t bda;
+    memcpy(bda, peer->addr, sizeof(bda));
+    esp_ble_remove_bond_device(bda);
+}
+
+static const hid_transport_ops_t kBluedroidOps = {
+    "bluedroid", __bluedroid_begin, __bluedroid_connected, __bluedroid_send, __bluedroid_interval,
+    __bluedroid_advertise, __bluedroid_disconnect, __bluedroid_forget,
+};
+
+void hid_transport_init(hid_transport_t* transport) {
+    owner = transport;
+    hid_transport_bind(transport, &kBluedroidOps, NULL);
+}
+
+#endif  // !HID_TRANSPORT_NIMBLE
@@ -0,0 +1,202 @@
+#include "hid_transport.h"
+
+#if HID_TRANSPORT_NIMBLE
+
+#include <NimBLEDevice.h>
+#include <NimBLEHIDDevice.h>
+
+#define NIMBLE_APPEARANCE_KEYBOARD  0x03C1
+#define NIMBLE_REPORT_ID            1
+#define NIMBLE_INTERVAL_UNIT_US     1250    // connection interval unit
+#define NIMBLE_TIMEOUT_UNIT_MS      10      // supervision timeout unit
+#define NIMBLE_DIRECTED_INTERVAL    0x20    // 20 ms, the shortest connectable interval (0.625 ms units)
+#define NIMBLE_DIRECTED_MS          1280    // as long as a high-duty burst
+#define NIMBLE_GENERAL_INTERVAL_MIN 0x20    // NimBLEAdvertising's defaults
+#define NIMBLE_GENERAL_INTERVAL_MAX 0x40
+
+// Boot keyboard: modifiers, reserved byte, six keys; LED output report
+static const uint8_t kReportMap[] = {
+    0x05, 0x01,                 // Usage Page (Generic Desktop)
+    0x09, 0x06,                 // Usage (Keyboard)
+    0xA1, 0x01,                 // Collection (Application)
+    0x85, NIMBLE_REPORT_ID,     //   Report ID
+    0x05, 0x07,                 //   Usage Page (Keyboard/Keypad)
+    0x19, 0xE0,                 //   Usage Minimum (Left Control)
+    0x29, 0xE7,                 //   Usage Maximum (Right GUI)
+    0x15, 0x00,                 //   Logical Minimum (0)
+    0x25, 0x01,                 //   Logical Maximum (1)
+    0x75, 0x01,                 //   Report Size (1)
+    0x95, 0x08,                 //   Report Count (8)
+    0x81, 0x02,                 //   Input (Data, Variable, Absolute): modifiers
+    0x95, 0x01,                 //   Report Count (1)
+    0x75, 0x08,                 //   Report Size (8)
+    0x81, 0x01,                 //   Input (Constant): reserved
+    0x95, 0x05,                 //   Report Count (5)
+    0x75, 0x01,                 //   Report Size (1)
+    0x05, 0x08,                 //   Usage Page (LEDs)
+    0x19, 0x01,                 //   Usage Minimum (Num Lock)
+    0x29, 0x05,                 //   Usage Maximum (Kana)
+    0x91, 0x02,                 //   Output (Data, Variable, Absolute): LEDs
+    0x95, 0x01,                 //   Report Count (1)
+    0x75, 0x03,                 //   Report Size (3)
+    0x91, 0x01,                 //   Output (Constant): padding
+    0x95, 0x06,                 //   Report Count (6)
+    0x75, 0x08,                 //   Report Size (8)
+    0x15, 0x00,                 //   Logical Minimum (0)
+    0x25, 0x65,                 //   Logical Maximum (101)
+    0x05, 0x07,                 //   Usage Page (Keyboard/Keypad)
+    0x19, 0x00,                 //   Usage Minimum (0)
+    0x29, 0x65,                 //   Usage Maximum (101)
+    0x81, 0x00,                 //   Input (Data, Array): keys
+    0xC0,                       // End Collection
+};
+
+typedef struct nimble_keyboard {
+    NimBLEServer* server;
+    NimBLEHIDDevice* hid;
+    NimBLECharacteristic* input;
+    uint16_t min_interval;      ///< Requested, in NIMBLE_INTERVAL_UNIT_US
+    uint16_t max_interval;
+    uint16_t timeout;           ///< In NIMBLE_TIMEOUT_UNIT_MS
+    bool notified;              ///< Outcome of the last notify()
+} nimble_keyboard_t;
+
+static nimble_keyboard_t nimble;
+static hid_transport_t* owner = nullptr;
+
+// NimBLE addresses are stored least significant byte first
+static void __nimble_from_native(const ble_addr_t* native, hid_transport_addr_t* addr) {
+    addr->type = (native->type == BLE_ADDR_PUBLIC) ? HID_TRANSPORT_ADDR_PUBLIC : HID_TRANSPORT_ADDR_RANDOM;
+    for (uint8_t i = 0; i < sizeof(addr->addr); i++) {
+        addr->addr[i] = native->val[sizeof(addr->addr) - 1 - i];
+    }
+}
+
+static NimBLEAddress __nimble_to_native(const hid_transport_addr_t* addr) {
+    ble_addr_t native;
+    native.type = (addr->type == HID_TRANSPORT_ADDR_PUBLIC) ? BLE_ADDR_PUBLIC : BLE_ADDR_RANDOM;
+    for (uint8_t i = 0; i < sizeof(addr->addr); i++) {
+        native.val[i] = addr->addr[sizeof(addr->addr) - 1 - i];
+    }
+    return NimBLEAddress(native);
+}
+
+// All run in the NimBLE host task, except onStatus(), which notify() calls
+class NimbleCallbacks : public NimBLEServerCallbacks, public NimBLECharacteristicCallbacks {
+    // Ask for a short interval as soon as the host connects
+    void onConnect(NimBLEServer* server, ble_gap_conn_desc* desc) override {
+        server->updateConnParams(desc->conn_handle, nimble.min_interval, nimble.max_interval, 0, nimble.timeout);
+    }
+
+    // Advertising is left to the caller (advertiseOnDisconnect is off)
+    void onDisconnect(NimBLEServer* server, ble_gap_conn_desc* desc) override {
+        hid_transport_link_event(owner, false, NULL);
+    }
+
+    // Reconnecting hosts re-encrypt with their bond; new ones have just paired
+    void onAuthenticationComplete(ble_gap_conn_desc* desc) override {
+        if (!desc->sec_state.encrypted) {
+            return;
+        }
+        hid_transport_addr_t peer;
+        __nimble_from_native(&desc->peer_id_addr, &peer);
+        hid_transport_link_event(owner, true, &peer);
+    }
+
+    // Out of transmit buffers (or not subscribed yet): the report was not queued
+    void onStatus(NimBLECharacteristic* characteristic, Status status, int code) override {
+        nimble.notified = (status == SUCCESS_NOTIFY);
+    }
+};
+
+static NimbleCallbacks callbacks;
+
+static bool __nimble_begin(void* impl, const hid_transport_config_t* config) {
+    nimble.min_interval = (uint16_t)(config->min_interval_us / NIMBLE_INTERVAL_UNIT_US);
+    nimble.max_interval = (uint16_t)(config->max_interval_us / NIMBLE_INTERVAL_UNIT_US);
+    nimble.timeout = (uint16_t)(config->supervision_ms / NIMBLE_TIMEOUT_UNIT_MS);
+
+    NimBLEDevice::init(config->name);
+    NimBLEDevice::setSecurityAuth(true, false, true);  // bond, no MITM, secure connections
+    nimble.server = NimBLEDevice::createServer();
+    nimble.server->setCallbacks(&callbacks, false);
+    nimble.server->advertiseOnDisconnect(false);
+
+    nimble.hid = new NimBLEHIDDevice(nimble.server);
+    nimble.input = nimble.hid->inputReport(NIMBLE_REPORT_ID);
+    nimble.input->setCallbacks(&callbacks);
+    nimble.hid->outputReport(NIMBLE_REPORT_ID);
+    nimble.hid->manufacturer()->setValue(std::string(config->manufacturer));  // a const char* would store the pointer
+    nimble.hid->pnp(0x02, 0xe502, 0xa111, 0x0210);
+    nimble.hid->hidInfo(0x00, 0x01);
+    nimble.hid->reportMap((uint8_t*)kReportMap, sizeof(kReportMap));
+    nimble.hid->setBatteryLevel(config->battery_level);
+    nimble.hid->startServices();
+
+    NimBLEAdvertising* advertising = nimble.server->getAdvertising();
+    advertising->setAppearance(NIMBLE_APPEARANCE_KEYBOARD);
+    advertising->addServiceUUID(nimble.hid->hidService()->getUUID());
+    advertising->setScanResponse(true);
+    return advertising->start();
+}
+
+static bool __nimble_connected(void* impl) {
+    return nimble.server && nimble.server->getConnectedCount() > 0;
+}
+
+static bool __nimble_send(void* impl, const hid_key_report_t* report) {
+    if (!__nimble_connected(impl)) {
+        return false;
+    }
+    nimble.notified = false;
+    nimble.input->setValue((const uint8_t*)report, sizeof(*report));
+    nimble.input->notify();
+    return nimble.notified;
+}
+
+static uint32_t __nimble_interval(void* impl) {
+    if (!__nimble_connected(impl)) {
+        return 0;
+    }
+    return nimble.server->getPeerInfo(0).getConnInterval() * NIMBLE_INTERVAL_UNIT_US;
+}
+
+// NimBLEAdvertising has no high-duty switch: directed advertising runs at
+// the fastest interval it allows for NIMBLE_DIRECTED_MS instead
+static bool __nimble_advertise(void* impl, const hid_transport_addr_t* peer) {
+    NimBLEAdvertising* advertising = nimble.server->getAdvertising();
+    advertising->stop();
+    if (!peer) {
+        advertising->setAdvertisementType(BLE_GAP_CONN_MODE_UND);
+        advertising->setMinInterval(NIMBLE_GENERAL_INTERVAL_MIN);
+        advertising->setMaxInterval(NIMBLE_GENERAL_INTERVAL_MAX);
+        return advertising->start();
+    }
+    NimBLEAddress address = __nimble_to_native(peer);
+    advertising->setAdvertisementType(BLE_GAP_CONN_MODE_DIR);
+    advertising->setMinInterval(NIMBLE_DIRECTED_INTERVAL);
+    advertising->setMaxInterval(NIMBLE_DIRECTED_INTERVAL);
+    return advertising->start(NIMBLE_DIRECTED_MS, nullptr, &address);
+}
+
+static void __nimble_disconnect(void* impl) {
+    if (__nimble_connected(impl)) {
+        nimble.server->disconnect(nimble.server->getPeerInfo(0).getConnHandle());
+    }
+}
+
+static void __nimble_forget(void* impl, const hid_transport_addr_t* peer) {
+    NimBLEDevice::deleteBond(__nimble_to_native(peer));
+}
+
+static const hid_transport_ops_t kNimbleOps = {
+    "nimble", __nimble_begin, __nimble_connected, __nimble_send, __nimble_interval,
+    __nimble_advertise, __nimble_disconnect, __nimble_forget,
+};
+
+void hid_transport_init(hid_transport_t* transport) {
+    owner = transport;
+    hid_transport_bind(transport, &kNimbleOps, NULL);
+}
+
+#endif  // HID_TRANSPORT_NIMBLE
@@ -0,0 +1,167 @@
+#include "idle.h"
+
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <string.h>
+
+#define IDLE_AFTER_MS           2000
+#define IDLE_MIN_SLEEP_US       5000
+#define IDLE_MAX_SLEEP_MS       1000
+#define IDLE_REPORT_WINDOW_MS   1000
+
+void idle_default_config(idle_config_t* config) {
+    if (!config) {
+        return;
+    }
+    config->idle_after_ms = IDLE_AFTER_MS;
+    config->min_sleep_us = IDLE_MIN_SLEEP_US;
+    config->max_sleep_ms = IDLE_MAX_SLEEP_MS;
+    config->report_window_ms = IDLE_REPORT_WINDOW_MS;
+}
+
+static void __idle_switch(idle_manager_t* idle, bool to_idle, uint32_t now_us) {
+    if (to_idle) {
+        idle->stats.entries++;
+        idle->idle_since_us = now_us;
+        idle->wake_pending = false;
+    } else {
+        idle->stats.idle_ms += (now_us - idle->idle_since_us) / 1000;
+    }
+    idle->idle = to_idle;
+    if (idle->hooks.on_idle) {
+        idle->hooks.on_idle(idle->hooks.ctx, to_idle);
+    }
+}
+
+static void __idle_sleep(idle_manager_t* idle, uint32_t timeout_us) {
+    uint32_t max_us = idle->config.max_sleep_ms * 1000;
+    if (timeout_us > max_us) {
+        timeout_us = max_us;
+    }
+
+    // Wake on whichever level each pin is not at now
+    for (uint8_t i = 0; i < idle->pin_count; i++) {
+        gpio_num_t pin = (gpio_num_t)idle->pins[i].pin;
+        gpio_intr_disable(pin);
+        gpio_wakeup_enable(pin, digitalRead(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    esp_sleep_enable_timer_wakeup(timeout_us);
+
+    uint32_t start_us = micros();
+    esp_light_sleep_start();
+    uint32_t now_us = micros();
+    bool gpio = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO);
+
+    for (uint8_t i = 0; i < idle->pin_count; i++) {
+        gpio_wakeup_disable((gpio_num_t)idle->pins[i].pin);
+    }
+    if (gpio && idle->hooks.on_wake && idle->hooks.on_wake(idle->hooks.ctx)) {
+        idle->stats.resynced++;
+    }
+    for (uint8_t i = 0; i < idle->pin_count; i++) {
+        gpio_num_t pin = (gpio_num_t)idle->pins[i].pin;
+        gpio_set_intr_type(pin, (gpio_int_type_t)idle->pins[i].mode);
+        gpio_intr_enable(pin);
+    }
+
+    idle->stats.sleeps++;
+    uint32_t asleep_us = (now_us - start_us) + idle->asleep_carry_us;
+    idle->stats.asleep_ms += asleep_us / 1000;
+    idle->asleep_carry_us = asleep_us % 1000;
+    if (gpio) {
+        idle->stats.gpio_wakes++;
+        idle->wake_pending = true;
+        idle->wake_us = now_us;
+        idle->wake_stamp = latency_stamp();
+        idle_activity(idle);
+    } else {
+        idle->stats.timer_wakes++;
+    }
+}
+
+static void __idle_wait(scheduler_t* sched, uint32_t timeout_us) {
+    idle_manager_t* idle = static_cast<idle_manager_t*>(sched->wait_ctx);
+    uint32_t now_us = micros();
+    bool quiet = idle->enabled &&
+                 (uint32_t)(now_us - idle->last_activity_us) >= idle->config.idle_after_ms * 1000;
+    if (quiet != idle->idle) {
+        // The hooks re-armed or cancelled jobs; let the scheduler recompute its deadline
+        __idle_switch(idle, quiet, now_us);
+        return;
+    }
+    if (!quiet || timeout_us < idle->config.min_sleep_us) {
+        scheduler_wait_default(sched, timeout_us);
+        return;
+    }
+    if (idle->hooks.can_sleep && !idle->hooks.can_sleep(idle->hooks.ctx)) {
+        scheduler_wait_default(sched, idle->config.min_sleep_us);
+        return;
+    }
+    __idle_sleep(idle, timeout_us);
+}
+
+void idle_init(idle_manager_t* idle, scheduler_t* sched, const idle_config_t* config,
+               const idle_hooks_t* hooks, bool enabled) {
+    if (!idle || !sched || !config) {
+        return;
+    }
+    memset(idle, 0, sizeof(*idle));
+    idle->sched = sched;
+    idle->config = *config;
+    if (hooks) {
+        idle->hooks = *hooks;
+    }
+    idle->enabled = enabled;
+    idle->last_activity_us = micros();
+    esp_sleep_enable_gpio_wakeup();
+    scheduler_set_wait(sched, __idle_wait, idle);
+}
+
+bool idle_add_wake_pin(idle_manager_t* idle, pin_t pin, uint8_t mode) {
+    if (!idle || idle->pin_count >= IDLE_MAX_WAKE_PINS) {
+        return false;
+    }
+    idle->pins[idle->pin_count].pin = pin;
+    idle->pins[idle->pin_count].mode = mode;
+    idle->pin_count++;
+    return true;
+}
+
+void idle_report_sent(idle_manager_t* idle) {
+    if (!idle) {
+        return;
+    }
+    idle_activity(idle);
+    if (!idle->wake_pending) {
+        return;
+    }
+    idle->wake_pending = false;
+    uint32_t elapsed_us = micros() - idle->wake_us;
+    if (elapsed_us > idle->config.report_window_ms * 1000) {
+        return;
+    }
+    idle->stats.wake_reports++;
+    idle->stats.last_wake_report_us = elapsed_us;
+    if (elapsed_us > idle->stats.max_wake_report_us) {
+        idle->stats.max_wake_report_us = elapsed_us;
+    }
+    latency_record(LATENCY_SRC_WAKE, idle->wake_stamp);
+}
+
+void idle_set_enabled(idle_manager_t* idle, bool enabled) {
+    if (idle) {
+        idle->enabled = enabled;
+    }
+}
+
+void idle_get_stats(const idle_manager_t* idle, idle_stats_t* stats) {
+    if (!idle || !stats) {
+        return;
+    }
+    *stats = idle->stats;
+    stats->enabled = idle->enabled;
+    stats->idle = idle->idle;
+    if (idle->idle) {
+        stats->idle_ms += (micros() - idle->idle_since_us) / 1000;
+    }
+}
@@ -20,19 +20,61 @@
 #define FEATURE_IO2_REG         0x12
 #define FEATURE_IO_STATUS_REG   0x14
 #define FEATURE_CTRL_REG        0x40
+#define SENSOR_TIME_0_REG       0x0A
+#define INT_STATUS_INT1_REG     0x0D
+#define FIFO_FILL_LEVEL_REG     0x15
+#define FIFO_DATA_REG           0x16
+#define FIFO_WATERMARK_REG      0x35
+#define FIFO_CONF_REG           0x36
+#define FIFO_CTRL_REG           0x37
+#define IO_INT_CTRL_REG         0x38
+#define INT_MAP1_REG            0x3A
+#define INT_MAP2_REG            0x3B
+#define FEATURE_DATA_ADDR_REG   0x41
+#define FEATURE_DATA_TX_REG     0x42
+#define BMI323_DUMMY_BYTES      2     // every I2C read is prefixed by two dummy bytes
+#define IMU_DATA_WORDS          7     // ACC_DATA_X..TEMP_DATA
+#define IMU_SAMPLE_WORDS        8     // ACC_DATA_X..SENSOR_TIME_0
+#define IMU_MAX_BUS_CLOCK_HZ    1000000 // Fm+
 
 // Configuration constants
 #define BMI323_CHIP_ID              0x00
-#define OUTPUT_RATE_HZ              20     // 20Hz data output
-#define ACC_ANGLE_LSB_PER_G         4096.0    // deg/s range
-#define GYRO_ANGLE_LSB_PER_DPS      16.384  // ~2000 deg/s range
 #define SOFT_RESET_CMD              0xDEAF    // soft reset command
-#define ACC_CONF_NORMAL_100HZ_8G    0x4028    // accel: 100Hz, +- 8g
-#define GYR_CONF_NORMAL_100HZ_2000DPS 0x4048  // gyro: 100Hz, +-2000 deg/s
 
-// Scale factors
-static float accel_scale = 1.0f / ACC_ANGLE_LSB_PER_G;
-static float gyro_scale = 1.0f / GYRO_ANGLE_LSB_PER_DPS;
+// Interrupt constants
+#define IO_INT_CTRL_INT1_ACTIVE_HIGH (1u << 0)
+#define IO_INT_CTRL_INT1_OUTPUT_EN   (1u << 2)
+#define INT_MAP1_ANY_MOTION_INT1     (1u << 2)
+#define INT_MAP2_ACC_DRDY_INT1       (1u << 10)
+#define INT_MAP2_FIFO_WM_INT1        (1u << 12)
+
+// FIFO constants
+// Feature engine: any-motion (extended registers written through FEATURE_DATA_*)
+#define FEATURE_IO0_ANY_MOTION_XYZ  (7u << 3)
+#define FEATURE_IO_STATUS_SYNC      0x0001
+#define ANYMO_1_EXT_REG             0x05      // slope threshold [11:0], acc_ref_up [12]
+#define ANYMO_3_EXT_REG             0x07      // duration [12:0], wait time [15:13]
+#define ANYMO_ACC_REF_UP            (1u << 12)
+#define ANYMO_THRESHOLD_MAX         0x0FFF    // 1/512 g per LSB
+#define ANYMO_DURATION_MAX          0x1FFF    // 20 ms per LSB
+#define ANYMO_DURATION_UNIT_MS      20
+
+#define FIFO_CONF_TIME_EN           (1u << 8)
+#define FIFO_CONF_ACC_EN            (1u << 9)
+#define FIFO_CONF_GYR_EN            (1u << 10)
+#define FIFO_CONF_TEMP_EN           (1u << 11)
+#define FIFO_CTRL_FLUSH             0x0001
+#define FIFO_FILL_LEVEL_MASK        0x07FF
+#define FIFO_ACC_DUMMY_WORD         0x7F01    // accel slot without new data
+#define FIFO_GYR_DUMMY_WORD         0x7F02    // gyro slot without new data
+#define FIFO_TEMP_DUMMY_WORD        0x8000    // temperature slot without new data
+#define FIFO_BURST_FRAMES           7         // 2 + 7*16 bytes fits the 128-byte Wire buffer
+#define SENSOR_TIME_TICK_NUM        625       // sensor time tick = 625/16 us
+#define SENSOR_TIME_TICK_DEN        16
+
+// Scale factors, fixed by the build configuration (imu_config.h)
+static constexpr float accel_scale = imu_config_t::accel_scale();
+static constexpr float gyro_scale = imu_config_t::gyro_scale();
 
 static void writeRegister16(imu_t* imu, uint8_t reg, uint16_t data) {
     imu->wire->beginTransmission(imu->i2c_addr);
@@ -42,21 +84,39 @@ static void writeRegister16(imu_t* imu, uint8_t reg, uint16_t data) {
     imu->wire->endTransmission();
 }
 
-// Helper function to read 16-bit register
-static uint16_t readRegister16(imu_t* imu, uint8_t reg) {
+// Burst-read `count` consecutive 16-bit registers starting at `reg`.
+// The BMI323 auto-increments the register address, so the whole block comes
+// back in one transaction (after the two dummy bytes it sends on every read).
+static bool readRegisterBurst(imu_t* imu, uint8_t reg, uint16_t* out, uint8_t count) {
     imu->wire->beginTransmission(imu->i2c_addr);
     imu->wire->write(reg);
     if (imu->wire->endTransmission(false) != 0) {
-        return 0;
+        return false;
     }
-    
-    if (imu->wire->requestFrom(imu->i2c_addr, (uint8_t)2) != 2) {
+
+    uint8_t len = BMI323_DUMMY_BYTES + (count * 2);
+    if (imu->wire->requestFrom(imu->i2c_addr, len) != len) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < BMI323_DUMMY_BYTES; i++) {
+        imu->wire->read();
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t lsb = imu->wire->read();
+        uint8_t msb = imu->wire->read();
+        out[i] = (uint16_t)((msb << 8) | lsb);
+    }
+    return true;
+}
+
+// Helper function to read 16-bit register
+static uint16_t readRegister16(imu_t* imu, uint8_t reg) {
+    uint16_t value = 0;
+    if (!readRegisterBurst(imu, reg, &value, 1)) {
         return 0;
     }
-    
-    uint8_t lsb = imu->wire->read();
-    uint8_t msb = imu->wire->read();
-    return (uint16_t)((msb << 8) | lsb);
+    return value;
 }
 
 // Convert raw accelerometer data to g
@@ -77,6 +137,32 @@ static float convertTempData(uint16_t rawData) {
     return (signedData / 512.0f) + 23.0f;
 }
 
+// Decode one complete FIFO frame (accel, gyro, temp, sensor time)
+static bool decodeFifoFrame(const uint16_t* frame, imu_sample_t* sample) {
+    sample->flags = 0;
+    sample->timestamp_us = 0;
+    sample->sensor_time = frame[7];
+
+    if (frame[0] != FIFO_ACC_DUMMY_WORD) {
+        sample->data.accel_x = convertAccelData(frame[0]);
+        sample->data.accel_y = convertAccelData(frame[1]);
+        sample->data.accel_z = convertAccelData(frame[2]);
+        sample->flags |= IMU_SAMPLE_ACCEL_VALID;
+    }
+    if (frame[3] != FIFO_GYR_DUMMY_WORD) {
+        sample->data.gyro_x = convertGyroData(frame[3]);
+        sample->data.gyro_y = convertGyroData(frame[4]);
+        sample->data.gyro_z = convertGyroData(frame[5]);
+        sample->flags |= IMU_SAMPLE_GYRO_VALID;
+    }
+    if (frame[6] != FIFO_TEMP_DUMMY_WORD) {
+        sample->data.temp = convertTempData(frame[6]);
+        sample->flags |= IMU_SAMPLE_TEMP_VALID;
+    }
+
+    return (sample->flags & (IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID)) != 0;
+}
+
 // Initialize feature engine
 static bool initializeFeatureEngine(imu_t* imu) {
     // Enable feature engine if needed
@@ -93,10 +179,16 @@ bool imu_init(imu_t* imu, pin_t int_pin, uint8_t i2c_addr, TwoWire* wire) {
     imu->i2c_addr = i2c_addr;
     imu->int_pin = int_pin;
     imu->wire = wire;
+    imu->bus_clock_hz = IMU_DEFAULT_BUS_CLOCK_HZ;
     imu->initialized = false;
+    imu->fifo_enabled = false;
+    imu->fifo_watermark_frames = 0;
+    imu->fifo_overflows = 0;
+    imu_fifo_parser_reset(&imu->fifo_parser);
     
-    // Initialize I2C
+    // Initialize I2C (Wire.begin() alone leaves the bus at 100 kHz)
     imu->wire->begin();
+    imu->wire->setClock(imu->bus_clock_hz);
     
     // Setup interrupt pin
     pinMode(int_pin, INPUT);
@@ -114,13 +206,13 @@ bool imu_init(imu_t* imu, pin_t int_pin, uint8_t i2c_addr, TwoWire* wire) {
     writeRegister16(imu, CMD_REG, SOFT_RESET_CMD);
     delay(50);  // Wait for reset to complete
     
-    // Configure accelerometer: 100Hz, normal mode
-    writeRegister16(imu, ACC_CONF_REG, ACC_CONF_NORMAL_100HZ_8G);
+    // Configure accelerometer and gyroscope: range, ODR and averaging from imu_config_t
+    writeRegister16(imu, ACC_CONF_REG, imu_config_t::acc_conf());
     delay(10);
     
-    // Configure gyroscope: 100Hz, ±2000 deg/s
-    writeRegister16(imu, ACC_CONF_REG + 1, GYR_CONF_NORMAL_100HZ_2000DPS);
+    writeRegister16(imu, GYR_CONF_REG, imu_config_t::gyr_conf());
     delay(10);
+    imu_default_settings(&imu->settings);
     
     // Initialize feature engine
     if (!initializeFeatureEngine(imu)) {
@@ -139,13 +231,14 @@ bool imu_read_accel(imu_t* imu, float* x, float* y, float* z) {
         return false;
     }
     
-    uint16_t raw_x = readRegister16(imu, ACC_DATA_X_REG);
-    uint16_t raw_y = readRegister16(imu, ACC_DATA_Y_REG);
-    uint16_t raw_z = readRegister16(imu, ACC_DATA_Z_REG);
+    uint16_t raw[3];
+    if (!readRegisterBurst(imu, ACC_DATA_X_REG, raw, 3)) {
+        return false;
+    }
     
-    if (x) *x = convertAccelData(raw_x);
-    if (y) *y = convertAccelData(raw_y);
-    if (z) *z = convertAccelData(raw_z);
+    if (x) *x = convertAccelData(raw[0]);
+    if (y) *y = convertAccelData(raw[1]);
+    if (z) *z = convertAccelData(raw[2]);
     
     return true;
 }
@@ -155,13 +248,14 @@ bool imu_read_gyro(imu_t* imu, float* x, float* y, float* z) {
         return false;
     }
     
-    uint16_t raw_x = readRegister16(imu, GYR_DATA_X_REG);
-    uint16_t raw_y = readRegister16(imu, GYR_DATA_Y_REG);
-    uint16_t raw_z = readRegister16(imu, GYR_DATA_Z_REG);
+    uint16_t raw[3];
+    if (!readRegisterBurst(imu, GYR_DATA_X_REG, raw, 3)) {
+        return false;
+    }
     
-    if (x) *x = convertGyroData(raw_x);
-    if (y) *y = convertGyroData(raw_y);
-    if (z) *z = convertGyroData(raw_z);
+    if (x) *x = convertGyroData(raw[0]);
+    if (y) *y = convertGyroData(raw[1]);
+    if (z) *z = convertGyroData(raw[2]);
     
     return true;
 }
@@ -171,7 +265,10 @@ bool imu_read_temp(imu_t* imu, float* temp) {
         return false;
     }
     
-    uint16_t raw_temp = readRegister16(imu, TEMP_DATA_REG);
+    uint16_t raw_temp;
+    if (!readRegisterBurst(imu, TEMP_DATA_REG, &raw_temp, 1)) {
+        return false;
+    }
     *temp = convertTempData(raw_temp);
     
     return true;
@@ -182,23 +279,355 @@ bool imu_read(imu_t* imu, imu_data_t* data) {
         return false;
     }
     
-    // Read sensor data
-    uint16_t accX = readRegister16(imu, ACC_DATA_X_REG);
-    uint16_t accY = readRegister16(imu, ACC_DATA_Y_REG);
-    uint16_t accZ = readRegister16(imu, ACC_DATA_Z_REG);
-    uint16_t gyrX = readRegister16(imu, GYR_DATA_X_REG);
-    uint16_t gyrY = readRegister16(imu, GYR_DATA_Y_REG);
-    uint16_t gyrZ = readRegister16(imu, GYR_DATA_Z_REG);
-    uint16_t tempRaw = readRegister16(imu, TEMP_DATA_REG);
+    // Read ACC_DATA_X..TEMP_DATA in a single auto-incrementing transaction
+    uint16_t raw[IMU_DATA_WORDS];
+    if (!readRegisterBurst(imu, ACC_DATA_X_REG, raw, IMU_DATA_WORDS)) {
+        return false;
+    }
     
     // Convert to physical units
-    data->accel_x = convertAccelData(accX);
-    data->accel_y = convertAccelData(accY);
-    data->accel_z = convertAccelData(accZ);
-    data->gyro_x = convertGyroData(gyrX);
-    data->gyro_y = convertGyroData(gyrY);
-    data->gyro_z = convertGyroData(gyrZ);
-    data->temp = convertTempData(tempRaw);
+    data->accel_x = convertAccelData(raw[0]);
+    data->accel_y = convertAccelData(raw[1]);
+    data->accel_z = convertAccelData(raw[2]);
+    data->gyro_x = convertGyroData(raw[3]);
+    data->gyro_y = convertGyroData(raw[4]);
+    data->gyro_z = convertGyroData(raw[5]);
+    data->temp = convertTempData(raw[6]);
     
     return true;
 }
+
+bool imu_read_sample(imu_t* imu, imu_sample_t* sample) {
+    if (!imu || !imu->initialized || !sample) {
+        return false;
+    }
+
+    uint16_t raw[IMU_SAMPLE_WORDS];
+    if (!readRegisterBurst(imu, ACC_DATA_X_REG, raw, IMU_SAMPLE_WORDS)) {
+        return false;
+    }
+
+    sample->data.accel_x = convertAccelData(raw[0]);
+    sample->data.accel_y = convertAccelData(raw[1]);
+    sample->data.accel_z = convertAccelData(raw[2]);
+    sample->data.gyro_x = convertGyroData(raw[3]);
+    sample->data.gyro_y = convertGyroData(raw[4]);
+    sample->data.gyro_z = convertGyroData(raw[5]);
+    sample->data.temp = convertTempData(raw[6]);
+    sample->sensor_time = raw[7];
+    sample->timestamp_us = micros();
+    sample->flags = IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID | IMU_SAMPLE_TEMP_VALID;
+
+    return true;
+}
+
+bool imu_enable_interrupt(imu_t* imu, imu_int_source_t source) {
+    if (!imu || !imu->initialized) {
+        return false;
+    }
+
+    uint16_t map = 0;
+    switch (source) {
+        case IMU_INT_DATA_READY:
+            map = INT_MAP2_ACC_DRDY_INT1;
+            break;
+        case IMU_INT_FIFO_WATERMARK:
+            map = INT_MAP2_FIFO_WM_INT1;
+            break;
+        case IMU_INT_NONE:
+        default:
+            break;
+    }
+    uint16_t feature_map = (source == IMU_INT_ANY_MOTION) ? INT_MAP1_ANY_MOTION_INT1 : 0;
+
+    writeRegister16(imu, INT_MAP1_REG, feature_map);
+    writeRegister16(imu, INT_MAP2_REG, map);
+    writeRegister16(imu, IO_INT_CTRL_REG,
+                    (map | feature_map) ? (IO_INT_CTRL_INT1_ACTIVE_HIGH | IO_INT_CTRL_INT1_OUTPUT_EN) : 0x0000);
+
+    // Reading the status register clears anything latched while reconfiguring
+    readRegister16(imu, INT_STATUS_INT1_REG);
+    return true;
+}
+
+void imu_default_settings(imu_settings_t* settings) {
+    if (!settings) {
+        return;
+    }
+    settings->accel.mode = imu_config_t::mode;
+    settings->accel.odr = imu_config_t::odr;
+    settings->accel.avg = imu_config_t::avg;
+    settings->gyro = settings->accel;
+}
+
+static bool validSensorSettings(const imu_sensor_settings_t* sensor) {
+    switch (sensor->mode) {
+        case IMU_MODE_SUSPEND:
+            return true;
+        case IMU_MODE_LOW_POWER:
+            return sensor->odr >= IMU_ODR_0_78HZ && sensor->odr <= IMU_ODR_400HZ && sensor->avg <= IMU_AVG_64;
+        case IMU_MODE_NORMAL:
+        case IMU_MODE_HIGH_PERF:
+            return sensor->odr >= IMU_ODR_12_5HZ && sensor->odr <= IMU_ODR_6400HZ && sensor->avg <= IMU_AVG_64;
+        default:
+            return false;
+    }
+}
+
+bool imu_configure(imu_t* imu, const imu_settings_t* settings) {
+    if (!imu || !imu->initialized || !settings) {
+        return false;
+    }
+    if (!validSensorSettings(&settings->accel) || !validSensorSettings(&settings->gyro)) {
+        return false;
+    }
+
+    // A suspended sensor keeps a valid ODR code so the word stays well-formed
+    const imu_sensor_settings_t* acc = &settings->accel;
+    const imu_sensor_settings_t* gyr = &settings->gyro;
+    writeRegister16(imu, ACC_CONF_REG, imu_conf_word(acc->mode, acc->avg, imu_config_t::accel_range,
+                                                      acc->mode ? acc->odr : static_cast<uint8_t>(imu_config_t::odr)));
+    writeRegister16(imu, GYR_CONF_REG, imu_conf_word(gyr->mode, gyr->avg, imu_config_t::gyro_range,
+                                                      gyr->mode ? gyr->odr : static_cast<uint8_t>(imu_config_t::odr)));
+    imu->settings = *settings;
+    return true;
+}
+
+bool imu_any_motion_enable(imu_t* imu, uint16_t threshold_mg, uint32_t duration_ms) {
+    if (!imu || !imu->initialized) {
+        return false;
+    }
+
+    uint32_t threshold = ((uint32_t)threshold_mg * 512 + 500) / 1000;
+    if (threshold == 0) threshold = 1;
+    if (threshold > ANYMO_THRESHOLD_MAX) threshold = ANYMO_THRESHOLD_MAX;
+    uint32_t duration = (duration_ms + ANYMO_DURATION_UNIT_MS / 2) / ANYMO_DURATION_UNIT_MS;
+    if (duration > ANYMO_DURATION_MAX) duration = ANYMO_DURATION_MAX;
+
+    // Compare against the previous sample (slope), not a latched reference
+    writeRegister16(imu, FEATURE_DATA_ADDR_REG, ANYMO_1_EXT_REG);
+    writeRegister16(imu, FEATURE_DATA_TX_REG, (uint16_t)(threshold | ANYMO_ACC_REF_UP));
+    writeRegister16(imu, FEATURE_DATA_ADDR_REG, ANYMO_3_EXT_REG);
+    writeRegister16(imu, FEATURE_DATA_TX_REG, (uint16_t)duration);
+
+    writeRegister16(imu, FEATURE_IO0_REG, FEATURE_IO0_ANY_MOTION_XYZ);
+    writeRegister16(imu, FEATURE_IO_STATUS_REG, FEATURE_IO_STATUS_SYNC);
+    imu->any_motion_enabled = true;
+    return true;
+}
+
+bool imu_any_motion_disable(imu_t* imu) {
+    if (!imu || !imu->initialized) {
+        return false;
+    }
+
+    writeRegister16(imu, FEATURE_IO0_REG, 0x0000);
+    writeRegister16(imu, FEATURE_IO_STATUS_REG, FEATURE_IO_STATUS_SYNC);
+    imu->any_motion_enabled = false;
+    return true;
+}
+
+bool imu_read_int_status(imu_t* imu, uint16_t* status) {
+    if (!imu || !imu->initialized || !status) {
+        return false;
+    }
+    return readRegisterBurst(imu, INT_STATUS_INT1_REG, status, 1);
+}
+
+bool imu_set_bus_clock(imu_t* imu, uint32_t clock_hz) {
+    if (!imu || !imu->wire || clock_hz == 0 || clock_hz > IMU_MAX_BUS_CLOCK_HZ) {
+        return false;
+    }
+
+    imu->bus_clock_hz = clock_hz;
+    imu->wire->setClock(clock_hz);
+    return true;
+}
+
+bool imu_fifo_enable(imu_t* imu, uint16_t watermark_frames) {
+    if (!imu || !imu->initialized || watermark_frames == 0) {
+        return false;
+    }
+
+    uint16_t max_frames = (IMU_FIFO_CAPACITY_WORDS - 1) / IMU_FIFO_FRAME_WORDS;
+    if (watermark_frames > max_frames) {
+        watermark_frames = max_frames;
+    }
+
+    // Keep streaming when full (oldest frames are dropped), then start clean
+    writeRegister16(imu, FIFO_CONF_REG,
+                    FIFO_CONF_TIME_EN | FIFO_CONF_ACC_EN | FIFO_CONF_GYR_EN | FIFO_CONF_TEMP_EN);
+    writeRegister16(imu, FIFO_WATERMARK_REG, watermark_frames * IMU_FIFO_FRAME_WORDS);
+    writeRegister16(imu, FIFO_CTRL_REG, FIFO_CTRL_FLUSH);
+
+    imu->fifo_watermark_frames = watermark_frames;
+    imu->fifo_overflows = 0;
+    imu_fifo_parser_reset(&imu->fifo_parser);
+    imu->fifo_enabled = true;
+    return true;
+}
+
+bool imu_fifo_disable(imu_t* imu) {
+    if (!imu || !imu->initialized) {
+        return false;
+    }
+
+    writeRegister16(imu, FIFO_CONF_REG, 0x0000);
+    writeRegister16(imu, FIFO_CTRL_REG, FIFO_CTRL_FLUSH);
+    imu->fifo_enabled = false;
+    return true;
+}
+
+bool imu_fifo_read(imu_t* imu, imu_sample_t* out, size_t max_samples, size_t* count) {
+    if (count) *count = 0;
+    if (!imu || !imu->initialized || !imu->fifo_enabled || !out) {
+        return false;
+    }
+
+    uint16_t fill;
+    if (!readRegisterBurst(imu, FIFO_FILL_LEVEL_REG, &fill, 1)) {
+        return false;
+    }
+    fill &= FIFO_FILL_LEVEL_MASK;
+    if (fill >= IMU_FIFO_CAPACITY_WORDS) {
+        imu->fifo_overflows++;
+    }
+
+    // Only pull whole frames that fit in `out`; the rest stays in the FIFO
+    size_t frames = (imu->fifo_parser.frame_len + fill) / IMU_FIFO_FRAME_WORDS;
+    if (frames > max_samples) {
+        frames = max_samples;
+    }
+    size_t words_left = (frames == 0) ? 0 : frames * IMU_FIFO_FRAME_WORDS - imu->fifo_parser.frame_len;
+
+    size_t produced = 0;
+    uint16_t burst[FIFO_BURST_FRAMES * IMU_FIFO_FRAME_WORDS];
+    while (words_left > 0) {
+        uint8_t n = (words_left > sizeof(burst) / sizeof(burst[0]))
+                        ? (uint8_t)(sizeof(burst) / sizeof(burst[0]))
+                        : (uint8_t)words_left;
+        if (!readRegisterBurst(imu, FIFO_DATA_REG, burst, n)) {
+            break;
+        }
+        produced += imu_fifo_parse(&imu->fifo_parser, burst, n,
+                                   out + produced, max_samples - produced, NULL);
+        words_left -= n;
+    }
+
+    // Anchor the newest frame at "now" and walk back along sensor time
+    if (produced > 0) {
+        uint32_t now_us = micros();
+        uint16_t newest = out[produced - 1].sensor_time;
+        for (size_t i = 0; i < produced; i++) {
+            uint16_t age_ticks = (uint16_t)(newest - out[i].sensor_time);
+            out[i].timestamp_us = now_us - ((uint32_t)age_ticks * SENSOR_TIME_TICK_NUM) / SENSOR_TIME_TICK_DEN;
+        }
+    }
+
+    if (count) *count = produced;
+    return words_left == 0;
+}
+
+void imu_fifo_parser_reset(imu_fifo_parser_t* parser) {
+    if (!parser) {
+        return;
+    }
+    parser->frame_len = 0;
+    parser->skipped_frames = 0;
+}
+
+size_t imu_fifo_parse(imu_fifo_parser_t* parser, const uint16_t* words, size_t count,
+                      imu_sample_t* out, size_t max_samples, size_t* consumed) {
+    size_t produced = 0;
+    size_t i = 0;
+
+    if (!parser || !words || !out) {
+        if (consumed) *consumed = 0;
+        return 0;
+    }
+
+    while (i < count && produced < max_samples) {
+        // Every word is data: imu_fifo_read() never reads past the fill level
+        parser->frame[parser->frame_len++] = words[i++];
+        if (parser->frame_len < IMU_FIFO_FRAME_WORDS) {
+            continue;
+        }
+        parser->frame_len = 0;
+
+        if (decodeFifoFrame(parser->frame, &out[produced])) {
+            produced++;
+        } else {
+            parser->skipped_frames++;
+        }
+    }
+
+    if (consumed) *consumed = i;
+    return produced;
+}
+
+// Converts `count` triplets spaced `stride` words apart; x, y and z of one
+// triplet are independent, so the unrolled body keeps all three in flight
+template <typename T, typename Op>
+static inline void convertTriplets(const uint16_t* raw, size_t count, size_t stride, T* out, Op op) {
+    for (size_t i = 0; i < count; i++, raw += stride, out += 3) {
+        T x = op((int16_t)raw[0]);
+        T y = op((int16_t)raw[1]);
+        T z = op((int16_t)raw[2]);
+        out[0] = x;
+        out[1] = y;
+        out[2] = z;
+    }
+}
+
+struct ScaleAccel {
+    float operator()(int16_t value) const { return value * accel_scale; }
+};
+
+struct ScaleGyro {
+    float operator()(int16_t value) const { return value * gyro_scale; }
+};
+
+// raw * mul / 2^shift rounded half up; the arithmetic shift floors
+template <int32_t Mul, uint8_t Shift>
+struct FixedScale {
+    int16_t operator()(int16_t value) const {
+        int32_t scaled = ((int32_t)value * Mul + (1 << (Shift - 1))) >> Shift;
+        return (int16_t)(scaled > 32767 ? 32767 : (scaled < -32768 ? -32768 : scaled));
+    }
+};
+
+void imu_convert_accel_batch(const uint16_t* raw, size_t count, size_t stride, float* out) {
+    if (raw && out) {
+        convertTriplets(raw, count, stride, out, ScaleAccel());
+    }
+}
+
+void imu_convert_gyro_batch(const uint16_t* raw, size_t count, size_t stride, float* out) {
+    if (raw && out) {
+        convertTriplets(raw, count, stride, out, ScaleGyro());
+    }
+}
+
+void imu_convert_accel_mg_batch(const uint16_t* raw, size_t count, size_t stride, int16_t* out) {
+    if (raw && out) {
+        convertTriplets(raw, count, stride, out,
+                        FixedScale<imu_config_t::accel_mg_mul(), imu_config_t::accel_mg_shift()>());
+    }
+}
+
+void imu_convert_gyro_ddps_batch(const uint16_t* raw, size_t count, size_t stride, int16_t* out) {
+    if (raw && out) {
+        convertTriplets(raw, count, stride, out,
+                        FixedScale<imu_config_t::gyro_ddps_mul(), imu_config_t::gyro_ddps_shift()>());
+    }
+}
+
+#if defined(PIO_UNIT_TESTING)
+float imu_bench_convert_accel(uint16_t raw) {
+    return convertAccelData(raw);
+}
+
+float imu_bench_convert_gyro(uint16_t raw) {
+    return convertGyroData(raw);
+}
+#endif
@@ -0,0 +1,173 @@
+#include "imu_duty.h"
+
+#include <math.h>
+#include <string.h>
+
+#define IMU_DUTY_IDLE_AFTER_MS      5000
+#define IMU_DUTY_STILL_G            0.02f   // 20 mg between consecutive samples
+#define IMU_DUTY_STILL_DPS          3.0f
+#define IMU_DUTY_WAKE_THRESHOLD_MG  40
+#define IMU_DUTY_WAKE_DURATION_MS   20      // one low-power sample at 50 Hz
+
+void imu_duty_default_config(imu_duty_config_t* config) {
+    if (!config) {
+        return;
+    }
+    config->idle_after_ms = IMU_DUTY_IDLE_AFTER_MS;
+    config->still_g = IMU_DUTY_STILL_G;
+    config->still_dps = IMU_DUTY_STILL_DPS;
+    config->wake_threshold_mg = IMU_DUTY_WAKE_THRESHOLD_MG;
+    config->wake_duration_ms = IMU_DUTY_WAKE_DURATION_MS;
+    config->idle.accel.mode = IMU_MODE_LOW_POWER;
+    config->idle.accel.odr = IMU_ODR_50HZ;
+    config->idle.accel.avg = IMU_AVG_2;
+    config->idle.gyro.mode = IMU_MODE_SUSPEND;
+    config->idle.gyro.odr = IMU_ODR_50HZ;
+    config->idle.gyro.avg = IMU_AVG_1;
+}
+
+void imu_duty_init(imu_duty_t* duty, const imu_duty_config_t* config, bool enabled) {
+    if (!duty || !config) {
+        return;
+    }
+    memset(duty, 0, sizeof(*duty));
+    duty->config = *config;
+    duty->enabled = enabled;
+    duty->mode = IMU_DUTY_ACTIVE;
+    duty->mode_since_us = micros();
+    duty->still_since_us = duty->mode_since_us;
+}
+
+void imu_duty_set_enabled(imu_duty_t* duty, bool enabled) {
+    if (duty) {
+        duty->enabled = enabled;
+    }
+}
+
+// Whole milliseconds move into time_ms; the remainder stays in mode_since_us
+static void __imu_duty_account(imu_duty_t* duty, uint32_t now_us) {
+    uint32_t elapsed_ms = (now_us - duty->mode_since_us) / 1000;
+    duty->stats.time_ms[duty->mode] += elapsed_ms;
+    duty->mode_since_us += elapsed_ms * 1000;
+}
+
+static void __imu_duty_switched(imu_duty_t* duty, uint8_t mode, uint32_t start_us) {
+    uint32_t now_us = micros();
+    __imu_duty_account(duty, now_us);
+    duty->mode = mode;
+    duty->stats.last_switch_us = now_us - start_us;
+    if (duty->stats.last_switch_us > duty->stats.max_switch_us) {
+        duty->stats.max_switch_us = duty->stats.last_switch_us;
+    }
+}
+
+static bool __imu_duty_sleep(imu_duty_t* duty, imu_t* imu) {
+    uint32_t start_us = micros();
+    duty->active = imu->settings;
+    if (!imu_configure(imu, &duty->config.idle) ||
+        !imu_any_motion_enable(imu, duty->config.wake_threshold_mg, duty->config.wake_duration_ms) ||
+        !imu_enable_interrupt(imu, IMU_INT_ANY_MOTION)) {
+        // Leave the sensor streaming rather than half asleep
+        imu_configure(imu, &duty->active);
+        imu_enable_interrupt(imu, imu->fifo_enabled ? IMU_INT_FIFO_WATERMARK : IMU_INT_DATA_READY);
+        duty->still_since_us = micros();
+        return false;
+    }
+    duty->stats.sleeps++;
+    duty->have_last = false;
+    __imu_duty_switched(duty, IMU_DUTY_IDLE, start_us);
+    return true;
+}
+
+static void __imu_duty_wake(imu_duty_t* duty, imu_t* imu, bool measure, uint32_t irq_us) {
+    uint32_t start_us = micros();
+    imu_configure(imu, &duty->active);
+    imu_any_motion_disable(imu);
+    if (imu->fifo_enabled) {
+        // Drop the low-power accel-only frames buffered while idle
+        imu_fifo_enable(imu, imu->fifo_watermark_frames);
+    }
+    imu_enable_interrupt(imu, imu->fifo_enabled ? IMU_INT_FIFO_WATERMARK : IMU_INT_DATA_READY);
+    duty->waking = measure;
+    if (measure) {
+        duty->stats.wakes++;
+        duty->wake_irq_us = irq_us;
+    }
+    duty->still_since_us = micros();
+    __imu_duty_switched(duty, IMU_DUTY_ACTIVE, start_us);
+}
+
+bool imu_duty_on_sample(imu_duty_t* duty, imu_t* imu, const imu_sample_t* sample) {
+    if (!duty || !imu || !sample || duty->mode != IMU_DUTY_ACTIVE) {
+        return false;
+    }
+
+    if (duty->waking) {
+        duty->waking = false;
+        duty->stats.last_wake_us = sample->timestamp_us - duty->wake_irq_us;
+        if (duty->stats.last_wake_us > duty->stats.max_wake_us) {
+            duty->stats.max_wake_us = duty->stats.last_wake_us;
+        }
+    }
+
+    const imu_data_t* data = &sample->data;
+    bool still = true;
+    if (sample->flags & IMU_SAMPLE_ACCEL_VALID) {
+        float accel[3] = {data->accel_x, data->accel_y, data->accel_z};
+        for (uint8_t i = 0; i < 3 && duty->have_last; i++) {
+            if (fabsf(accel[i] - duty->last_accel[i]) > duty->config.still_g) {
+                still = false;
+            }
+        }
+        memcpy(duty->last_accel, accel, sizeof(accel));
+        duty->have_last = true;
+    }
+    if ((sample->flags & IMU_SAMPLE_GYRO_VALID) &&
+        (fabsf(data->gyro_x) > duty->config.still_dps || fabsf(data->gyro_y) > duty->config.still_dps ||
+         fabsf(data->gyro_z) > duty->config.still_dps)) {
+        still = false;
+    }
+
+    uint32_t now_us = sample->timestamp_us;
+    if (!still || !duty->enabled) {
+        duty->still_since_us = now_us;
+        return false;
+    }
+    if ((uint32_t)(now_us - duty->still_since_us) < duty->config.idle_after_ms * 1000) {
+        return false;
+    }
+    return __imu_duty_sleep(duty, imu);
+}
+
+void imu_duty_poll(imu_duty_t* duty, imu_t* imu, bool edge, uint32_t irq_us) {
+    if (!duty || !imu || duty->mode != IMU_DUTY_IDLE) {
+        return;
+    }
+    if (!duty->enabled) {
+        __imu_duty_wake(duty, imu, false, 0);
+        return;
+    }
+    if (!edge) {
+        return;
+    }
+    uint16_t status;
+    if (imu_read_int_status(imu, &status) && (status & IMU_INT_STATUS_ANY_MOTION)) {
+        __imu_duty_wake(duty, imu, true, irq_us);
+    }
+}
+
+void imu_duty_resume(imu_duty_t* duty, imu_t* imu) {
+    if (duty && imu && duty->mode == IMU_DUTY_IDLE) {
+        __imu_duty_wake(duty, imu, false, 0);
+    }
+}
+
+void imu_duty_get_stats(const imu_duty_t* duty, imu_duty_stats_t* stats) {
+    if (!duty || !stats) {
+        return;
+    }
+    *stats = duty->stats;
+    stats->mode = duty->mode;
+    stats->enabled = duty->enabled;
+    stats->time_ms[duty->mode] += (micros() - duty->mode_since_us) / 1000;
+}
@@ -0,0 +1,180 @@
+#include "imu_stream.h"
+
+#define IMU_STREAM_IDLE_TIMEOUT_MS  100  // re-poll if an edge was missed
+#define IMU_STREAM_DRAIN_BATCH      16   // FIFO frames pulled per drain pass
+#define IMU_STREAM_STOP_POLL_TICKS  1    // imu_stream_stop() re-checks the task this often
+
+static void IRAM_ATTR __imu_stream_isr(void* ctx) {
+    imu_stream_t* stream = (imu_stream_t*)ctx;
+    BaseType_t woken = pdFALSE;
+
+    stream->interrupts++;
+    stream->last_interrupt_us = micros();
+    vTaskNotifyGiveFromISR(stream->task, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void __imu_stream_task(void* ctx) {
+    imu_stream_t* stream = (imu_stream_t*)ctx;
+
+    for (;;) {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_STREAM_IDLE_TIMEOUT_MS));
+        if (stream->stopping) {
+            break;
+        }
+        // In data-ready mode each extra edge is a sample that was overwritten
+        if (pending > 1 && !stream->imu->fifo_enabled) {
+            stream->missed_interrupts += pending - 1;
+        }
+        imu_stream_service(stream);
+    }
+
+    // Between transfers: the bus is free and nothing below touches the stream
+    stream->task_done = true;
+    vTaskDelete(NULL);
+}
+
+bool imu_stream_start(imu_stream_t* stream, imu_t* imu, uint8_t core, uint8_t priority) {
+    if (!stream || !imu || !imu->initialized) {
+        return false;
+    }
+
+    imu_stream_stop(stream);
+
+    stream->imu = imu;
+    stream->task = NULL;
+    stream->stopping = false;
+    stream->task_done = false;
+    stream->interrupts = 0;
+    stream->missed_interrupts = 0;
+    stream->read_errors = 0;
+    stream->samples = 0;
+    stream->serviced_interrupts = 0;
+    spsc_ring_reset(&stream->ring);
+
+    // A sensor left asleep would have its interrupt routed to any-motion
+    imu_duty_resume(stream->duty, imu);
+
+    imu_int_source_t source = imu->fifo_enabled ? IMU_INT_FIFO_WATERMARK : IMU_INT_DATA_READY;
+    if (!imu_enable_interrupt(imu, source)) {
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(__imu_stream_task, "imu_stream", IMU_STREAM_STACK_SIZE, stream,
+                                priority, &stream->task, core) != pdPASS) {
+        stream->task = NULL;
+        imu_enable_interrupt(imu, IMU_INT_NONE);
+        return false;
+    }
+
+    attachInterruptArg(digitalPinToInterrupt(imu->int_pin), __imu_stream_isr, stream, RISING);
+    stream->running = true;
+    return true;
+}
+
+void imu_stream_set_duty(imu_stream_t* stream, imu_duty_t* duty) {
+    if (stream && !stream->running) {
+        stream->duty = duty;
+    }
+}
+
+void imu_stream_kick(imu_stream_t* stream) {
+    if (!stream || !stream->running) {
+        return;
+    }
+    stream->interrupts++;
+    stream->last_interrupt_us = micros();
+    xTaskNotifyGive(stream->task);
+}
+
+void imu_stream_stop(imu_stream_t* stream) {
+    if (!stream || !stream->running) {
+        return;
+    }
+
+    // Ask the task to leave at its next wake and wait until it has: deleting
+    // it from here could cut an I2C transfer short with the bus lock held
+    detachInterrupt(digitalPinToInterrupt(stream->imu->int_pin));
+    if (stream->task) {
+        stream->stopping = true;
+        xTaskNotifyGive(stream->task);
+        while (!stream->task_done) {
+            vTaskDelay(IMU_STREAM_STOP_POLL_TICKS);
+        }
+        stream->task = NULL;
+    }
+    imu_enable_interrupt(stream->imu, IMU_INT_NONE);
+    stream->running = false;
+}
+
+bool imu_stream_pop(imu_stream_t* stream, imu_sample_t* sample) {
+    if (!stream || !sample) {
+        return false;
+    }
+    return spsc_ring_pop(&stream->ring, sample);
+}
+
+void imu_stream_service(imu_stream_t* stream) {
+    if (!stream || !stream->imu) {
+        return;
+    }
+
+    imu_t* imu = stream->imu;
+    imu_duty_t* duty = stream->duty;
+    uint32_t interrupts = stream->interrupts;
+    bool edge = interrupts != stream->serviced_interrupts;
+    stream->serviced_interrupts = interrupts;
+    if (duty && imu_duty_idle(duty)) {
+        imu_duty_poll(duty, imu, edge, stream->last_interrupt_us);
+        return;
+    }
+
+    if (!imu->fifo_enabled) {
+        imu_sample_t sample;
+        if (!imu_read_sample(imu, &sample)) {
+            stream->read_errors++;
+            return;
+        }
+        stream->samples++;
+        spsc_ring_push(&stream->ring, sample);
+        if (duty) {
+            imu_duty_on_sample(duty, imu, &sample);
+        }
+        return;
+    }
+
+    // Drain the FIFO completely; a full batch means more may be waiting
+    imu_sample_t batch[IMU_STREAM_DRAIN_BATCH];
+    size_t count;
+    do {
+        if (!imu_fifo_read(imu, batch, IMU_STREAM_DRAIN_BATCH, &count)) {
+            stream->read_errors++;
+            return;
+        }
+        bool slept = false;
+        for (size_t i = 0; i < count; i++) {
+            spsc_ring_push(&stream->ring, batch[i]);
+            if (duty && !slept) {
+                slept = imu_duty_on_sample(duty, imu, &batch[i]);
+            }
+        }
+        stream->samples += count;
+        if (slept) {
+            return;
+        }
+    } while (count == IMU_STREAM_DRAIN_BATCH);
+}
+
+void imu_stream_get_stats(const imu_stream_t* stream, imu_stream_stats_t* stats) {
+    if (!stream || !stats) {
+        return;
+    }
+    stats->interrupts = stream->interrupts;
+    stats->missed_interrupts = stream->missed_interrupts;
+    stats->read_errors = stream->read_errors;
+    stats->samples = stream->samples;
+    stats->overruns = stream->ring.overruns.load(std::memory_order_relaxed);
+    stats->queued = spsc_ring_size(&stream->ring);
+}
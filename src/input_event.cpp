@@ -0,0 +1,19 @@
+#include "input_event.h"
+
+void (*input_event_notify_fn)(void* ctx) = NULL;
+void* input_event_notify_ctx = NULL;
+void (*input_event_trace_fn)(void* ctx, const input_event_t* event) = NULL;
+void* input_event_trace_ctx = NULL;
+
+void input_event_set_notify(void (*notify)(void* ctx), void* ctx) {
+    // clear first so an ISR never sees the new function with the old context
+    input_event_notify_fn = NULL;
+    input_event_notify_ctx = ctx;
+    input_event_notify_fn = notify;
+}
+
+void input_event_set_trace(void (*trace)(void* ctx, const input_event_t* event), void* ctx) {
+    input_event_trace_fn = NULL;
+    input_event_trace_ctx = ctx;
+    input_event_trace_fn = trace;
+}
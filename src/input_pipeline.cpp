@@ -0,0 +1,72 @@
+#include "input_pipeline.h"
+
+#include "binlog.h"
+
+static uint32_t __input_pipeline_gesture(input_pipeline_t* in, const gesture_event_t* event, uint32_t now) {
+    uint8_t key = in->map->gestures[event->type];
+    if (key == INPUT_PIPELINE_UNBOUND) {
+        return 0;
+    }
+    uint32_t wait_us = keymap_button(in->keymap, key, event->active, now, 0);
+    bool held = (event->type >= GESTURE_TILT_LEFT);
+    if (!held && event->active) {
+        wait_us = keymap_button(in->keymap, key, false, now, 0);
+    }
+    return wait_us;
+}
+
+void input_pipeline_init(input_pipeline_t* in, button_t* button, encoder_t* encoder, keymap_engine_t* keymap,
+                         fusion_t* orientation, gesture_t* gesture, const input_pipeline_map_t* map) {
+    in->button = button;
+    in->encoder = encoder;
+    in->keymap = keymap;
+    in->orientation = orientation;
+    in->gesture = gesture;
+    in->map = map;
+    in->log_gestures = false;
+    in->button_was_down = false;
+    in->encoder_button_was_down = false;
+}
+
+void input_pipeline_resync(input_pipeline_t* in) {
+    in->button_was_down = button_read(in->button);
+    in->encoder_button_was_down = encoder_button_pressed(in->encoder);
+}
+
+uint32_t input_pipeline_poll(input_pipeline_t* in, uint32_t now) {
+    button_process_at(in->button, now);
+    encoder_process(in->encoder);
+
+    uint32_t wait_us = 0;
+    bool button_down = button_read(in->button);
+    if (button_down != in->button_was_down) {
+        uint32_t stamp = button_down ? button_get_press_stamp(in->button) : 0;
+        wait_us = keymap_button(in->keymap, in->map->button, button_down, now, stamp);
+    }
+    in->button_was_down = button_down;
+
+    bool encoder_button_down = encoder_button_pressed(in->encoder);
+    if (encoder_button_down != in->encoder_button_was_down) {
+        wait_us = keymap_button(in->keymap, in->map->encoder_button, encoder_button_down, now, 0);
+    }
+    in->encoder_button_was_down = encoder_button_down;
+
+    uint32_t detent_stamp = encoder_get_pending_stamp(in->encoder);
+    int32_t delta = encoder_take_delta(in->encoder);
+    if (delta != 0) {
+        wait_us = keymap_encoder(in->keymap, in->map->encoder, delta, now, detent_stamp);
+    }
+    return wait_us;
+}
+
+uint32_t input_pipeline_imu(input_pipeline_t* in, const imu_sample_t* sample, uint32_t now) {
+    fusion_update(in->orientation, sample);
+    gesture_event_t event;
+    if (!gesture_update(in->gesture, sample, &event)) {
+        return 0;
+    }
+    if (in->log_gestures) {
+        BINLOG_INFO(GESTURE, event.type, event.active, event.strength);
+    }
+    return __input_pipeline_gesture(in, &event, now);
+}
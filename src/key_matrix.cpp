@@ -0,0 +1,169 @@
+#include "key_matrix.h"
+
+#include <string.h>
+
+#define KEY_MATRIX_SETTLE_US    2       // row line capacitance through the column pull
+
+static_assert(KEY_MATRIX_DEBOUNCE_SCANS == 4, "the vertical counter has two bits");
+static_assert(KEY_MATRIX_MAX_ROWS * KEY_MATRIX_MAX_COLS >= KEY_MATRIX_MAX_KEYS, "grid limits below the key limit");
+
+static inline uint8_t __key_matrix_words(const key_matrix_t* km) {
+    return (uint8_t)((km->key_count + 31) / 32);
+}
+
+void key_matrix_reset(key_matrix_t* km, uint8_t key_count) {
+    if (!km) {
+        return;
+    }
+    km->key_count = (key_count > KEY_MATRIX_MAX_KEYS) ? KEY_MATRIX_MAX_KEYS : key_count;
+    for (uint8_t w = 0; w < KEY_MATRIX_WORDS; w++) {
+        km->state[w] = 0;
+        km->cnt0[w] = UINT32_MAX;   // counters idle at 3, counting down to the flip
+        km->cnt1[w] = UINT32_MAX;
+    }
+    memset(&km->stats, 0, sizeof(km->stats));
+}
+
+bool key_matrix_init(key_matrix_t* km, const pin_t* rows, uint8_t row_count, const pin_t* cols, uint8_t col_count,
+                     uint8_t active) {
+    if (!km || !rows || !cols || row_count == 0 || col_count == 0 || row_count > KEY_MATRIX_MAX_ROWS ||
+        col_count > KEY_MATRIX_MAX_COLS || row_count * col_count > KEY_MATRIX_MAX_KEYS) {
+        return false;
+    }
+    memset(km, 0, sizeof(*km));
+    memcpy(km->rows, rows, row_count * sizeof(pin_t));
+    memcpy(km->cols, cols, col_count * sizeof(pin_t));
+    km->row_count = row_count;
+    km->col_count = col_count;
+    km->active = active;
+    km->settle_us = KEY_MATRIX_SETTLE_US;
+    for (uint8_t r = 0; r < row_count; r++) {
+        pinMode(rows[r], INPUT);    // released until selected
+    }
+    for (uint8_t c = 0; c < col_count; c++) {
+        pinMode(cols[c], active == LOW ? INPUT_PULLUP : INPUT_PULLDOWN);
+    }
+    key_matrix_reset(km, row_count * col_count);
+    return true;
+}
+
+bool key_matrix_init_direct(key_matrix_t* km, const pin_t* pins, uint8_t count, uint8_t active) {
+    if (!km || !pins || count == 0 || count > KEY_MATRIX_MAX_COLS) {
+        return false;
+    }
+    memset(km, 0, sizeof(*km));
+    memcpy(km->cols, pins, count * sizeof(pin_t));
+    km->col_count = count;
+    km->active = active;
+    key_matrix_reset(km, count);
+    return true;
+}
+
+void key_matrix_set_callback(key_matrix_t* km, key_matrix_callback_t cb, void* ctx) {
+    if (km) {
+        km->callback = cb;
+        km->ctx = ctx;
+    }
+}
+
+// Columns of the selected row (or the direct pins), bit c set if closed
+static inline uint32_t __key_matrix_read_cols(const key_matrix_t* km) {
+    uint32_t bits = 0;
+    for (uint8_t c = 0; c < km->col_count; c++) {
+        bits |= (uint32_t)(digitalRead(km->cols[c]) == km->active) << c;
+    }
+    return bits;
+}
+
+void key_matrix_read(const key_matrix_t* km, uint32_t* raw) {
+    if (!km || !raw) {
+        return;
+    }
+    memset(raw, 0, KEY_MATRIX_WORDS * sizeof(uint32_t));
+    if (km->row_count == 0) {
+        raw[0] = __key_matrix_read_cols(km);
+        return;
+    }
+    for (uint8_t r = 0; r < km->row_count; r++) {
+        pinMode(km->rows[r], OUTPUT);
+        digitalWrite(km->rows[r], km->active);
+        if (km->settle_us) {
+            delayMicroseconds(km->settle_us);
+        }
+        uint32_t bits = __key_matrix_read_cols(km);
+        pinMode(km->rows[r], INPUT);
+
+        // Row r occupies bits [r * cols, (r + 1) * cols), possibly across two words
+        uint8_t first = (uint8_t)(r * km->col_count);
+        raw[first >> 5] |= bits << (first & 31);
+        if ((first & 31) + km->col_count > 32) {
+            raw[(first >> 5) + 1] |= bits >> (32 - (first & 31));
+        }
+    }
+}
+
+uint8_t key_matrix_update(key_matrix_t* km, const uint32_t* raw, uint32_t now_us) {
+    if (!km || !raw) {
+        return 0;
+    }
+    km->stats.scans++;
+    uint8_t changed = 0;
+    uint8_t words = __key_matrix_words(km);
+    for (uint8_t w = 0; w < words; w++) {
+        // Disagreeing keys count 3 -> 2 -> 1 -> 0 and flip on the fourth
+        // scan; an agreeing sample puts the counter back at 3
+        uint32_t delta = raw[w] ^ km->state[w];
+        uint32_t cnt0 = ~(km->cnt0[w] & delta);
+        uint32_t cnt1 = cnt0 ^ (km->cnt1[w] & delta);
+        uint32_t toggle = delta & cnt0 & cnt1;
+        km->cnt0[w] = cnt0;
+        km->cnt1[w] = cnt1;
+        if (!toggle) {
+            continue;
+        }
+        km->state[w] ^= toggle;
+
+        uint32_t state = km->state[w];
+        while (toggle) {
+            uint8_t bit = (uint8_t)__builtin_ctz(toggle);
+            toggle &= toggle - 1;
+            changed++;
+            if (km->callback) {
+                km->callback(km->ctx, (uint8_t)(w * 32 + bit), (state >> bit) & 1, now_us);
+            }
+        }
+    }
+    km->stats.events += changed;
+    return changed;
+}
+
+uint8_t key_matrix_scan(key_matrix_t* km, uint32_t now_us) {
+    uint32_t raw[KEY_MATRIX_WORDS];
+    key_matrix_read(km, raw);
+    return key_matrix_update(km, raw, now_us);
+}
+
+void key_matrix_select_all(key_matrix_t* km, bool select) {
+    if (!km) {
+        return;
+    }
+    for (uint8_t r = 0; r < km->row_count; r++) {
+        if (select) {
+            pinMode(km->rows[r], OUTPUT);
+            digitalWrite(km->rows[r], km->active);
+        } else {
+            pinMode(km->rows[r], INPUT);
+        }
+    }
+}
+
+void key_matrix_get_stats(const key_matrix_t* km, key_matrix_stats_t* stats) {
+    if (!km || !stats) {
+        return;
+    }
+    *stats = km->stats;
+    stats->pressed = 0;
+    for (uint8_t w = 0; w < __key_matrix_words(km); w++) {
+        stats->pressed += __builtin_popcount(km->state[w]);
+    }
+}
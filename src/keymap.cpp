@@ -0,0 +1,328 @@
+#include "keymap.h"
+
+#include <string.h>
+
+#define KEYMAP_NO_COMBO     (-1)
+
+// Highest active layer that defines the button wins
+static keymap_action_t __keymap_resolve(const keymap_engine_t* km, uint8_t button) {
+    for (int8_t layer = km->map->layer_count - 1; layer >= 0; layer--) {
+        if (!(km->layers & (1u << layer))) continue;
+        const keymap_action_t* action = &km->map->layers[layer].buttons[button];
+        if (action->type != KEYMAP_ACTION_TRANSPARENT) {
+            return *action;
+        }
+    }
+    return keymap_none();
+}
+
+static const keymap_axis_t* __keymap_resolve_axis(const keymap_engine_t* km, uint8_t encoder) {
+    for (int8_t layer = km->map->layer_count - 1; layer >= 0; layer--) {
+        if (!(km->layers & (1u << layer))) continue;
+        const keymap_axis_t* axis = &km->map->layers[layer].encoders[encoder];
+        if (axis->threshold != 0) {
+            return axis;
+        }
+    }
+    return NULL;
+}
+
+// Stamp for the next output of a button; only the first output gets one
+static uint32_t __keymap_take_stamp(keymap_button_state_t* state) {
+    uint32_t stamp = state->stamp;
+    state->stamp = 0;
+    return stamp;
+}
+
+static void __keymap_axis_set(keymap_engine_t* km, keymap_encoder_state_t* enc, uint8_t key, uint32_t stamp) {
+    if (enc->held == key) {
+        return;
+    }
+    if (enc->held != 0) {
+        km->out.release(km->out.ctx, enc->held);
+    }
+    enc->held = key;
+    if (key != 0) {
+        km->out.press(km->out.ctx, key, KEYMAP_INPUT_ENCODER, stamp);
+    }
+}
+
+static void __keymap_set_layers(keymap_engine_t* km, uint8_t layers) {
+    layers |= 1u;
+    uint8_t changed = km->layers ^ layers;
+    if (!changed) {
+        return;
+    }
+    km->layers = layers;
+
+    // Axes count from zero on every layer change and let go of their keys
+    for (uint8_t i = 0; i < KEYMAP_MAX_ENCODERS; i++) {
+        km->encoders[i].position = 0;
+        __keymap_axis_set(km, &km->encoders[i], 0, 0);
+    }
+
+    if (km->out.layer) {
+        for (uint8_t layer = 0; layer < KEYMAP_MAX_LAYERS; layer++) {
+            if (changed & (1u << layer)) {
+                km->out.layer(km->out.ctx, layer, (layers >> layer) & 1u);
+            }
+        }
+    }
+}
+
+static void __keymap_begin(keymap_engine_t* km, keymap_button_state_t* state, uint32_t now_us) {
+    const keymap_action_t* action = &state->action;
+    switch (action->type) {
+        case KEYMAP_ACTION_TAP:
+            km->out.tap(km->out.ctx, action->key, KEYMAP_INPUT_BUTTON, __keymap_take_stamp(state));
+            break;
+        case KEYMAP_ACTION_HOLD:
+            km->out.press(km->out.ctx, action->key, KEYMAP_INPUT_BUTTON, __keymap_take_stamp(state));
+            break;
+        case KEYMAP_ACTION_REPEAT:
+            if (action->delay_us == 0) {
+                km->out.tap(km->out.ctx, action->key, KEYMAP_INPUT_BUTTON, __keymap_take_stamp(state));
+                state->due_us = now_us + action->interval_us;
+            } else {
+                state->due_us = now_us + action->delay_us;
+            }
+            state->timer = (action->interval_us != 0 || action->delay_us != 0);
+            break;
+        case KEYMAP_ACTION_TOGGLE_LAYER:
+            // last_toggle_us starts at 0: the lockout also covers the first delay_us after boot
+            if ((uint32_t)(now_us - km->last_toggle_us) >= action->delay_us) {
+                km->last_toggle_us = now_us;
+                __keymap_set_layers(km, km->layers ^ (uint8_t)(1u << action->layer));
+            }
+            break;
+        case KEYMAP_ACTION_LAYER_HOLD:
+            __keymap_set_layers(km, km->layers | (uint8_t)(1u << action->layer));
+            break;
+        case KEYMAP_ACTION_TAP_HOLD:
+            state->tap_hold_decided = false;
+            state->due_us = now_us + action->delay_us;
+            state->timer = true;
+            break;
+        default:
+            break;
+    }
+}
+
+static void __keymap_end(keymap_engine_t* km, keymap_button_state_t* state) {
+    const keymap_action_t* action = &state->action;
+    state->timer = false;
+    switch (action->type) {
+        case KEYMAP_ACTION_HOLD:
+            km->out.release(km->out.ctx, action->key);
+            break;
+        case KEYMAP_ACTION_LAYER_HOLD:
+            __keymap_set_layers(km, km->layers & (uint8_t)~(1u << action->layer));
+            break;
+        case KEYMAP_ACTION_TAP_HOLD:
+            if (state->tap_hold_decided) {
+                km->out.release(km->out.ctx, action->alt);
+            } else {
+                km->out.tap(km->out.ctx, action->key, KEYMAP_INPUT_BUTTON, __keymap_take_stamp(state));
+            }
+            break;
+        default:
+            break;
+    }
+    state->stamp = 0;
+}
+
+// Fire a combo if `button` completes one whose other members are still undecided
+static bool __keymap_try_combo(keymap_engine_t* km, uint8_t button, uint32_t now_us) {
+    for (uint8_t c = 0; c < km->map->combo_count; c++) {
+        const keymap_combo_t* combo = &km->map->combos[c];
+        if (!(combo->buttons & (1u << button))) continue;
+
+        bool complete = true;
+        for (uint8_t b = 0; b < KEYMAP_MAX_BUTTONS && complete; b++) {
+            if (b == button || !(combo->buttons & (1u << b))) continue;
+            complete = km->buttons[b].down && km->buttons[b].pending;
+        }
+        if (!complete) continue;
+
+        // The combo's owner is the member that completed it
+        keymap_button_state_t* owner = &km->buttons[button];
+        for (uint8_t b = 0; b < KEYMAP_MAX_BUTTONS; b++) {
+            if (!(combo->buttons & (1u << b))) continue;
+            km->buttons[b].pending = false;
+            km->buttons[b].timer = false;
+            km->buttons[b].combo = (int8_t)c;
+            km->buttons[b].action = keymap_none();
+            if (b != button && km->buttons[b].stamp != 0 && owner->stamp == 0) {
+                owner->stamp = km->buttons[b].stamp;
+            }
+        }
+        owner->action = combo->action;
+        __keymap_begin(km, owner, now_us);
+        return true;
+    }
+    return false;
+}
+
+static uint32_t __keymap_next_timer(const keymap_engine_t* km, uint32_t now_us) {
+    uint32_t next = 0;
+    for (uint8_t b = 0; b < KEYMAP_MAX_BUTTONS; b++) {
+        const keymap_button_state_t* state = &km->buttons[b];
+        if (!state->timer) continue;
+        int32_t remaining = (int32_t)(state->due_us - now_us);
+        uint32_t wait = (remaining <= 0) ? 1 : (uint32_t)remaining;
+        if (next == 0 || wait < next) {
+            next = wait;
+        }
+    }
+    return next;
+}
+
+bool keymap_init(keymap_engine_t* km, const keymap_t* map, const keymap_output_t* out) {
+    if (!km) {
+        return false;
+    }
+    memset(km, 0, sizeof(*km));
+    if (!map || !out || !map->layers || map->layer_count == 0 || map->layer_count > KEYMAP_MAX_LAYERS) {
+        return false;   // map stays NULL: every other call is a no-op
+    }
+    km->map = map;
+    km->out = *out;
+    km->layers = 1u;
+    for (uint8_t b = 0; b < KEYMAP_MAX_BUTTONS; b++) {
+        km->buttons[b].combo = KEYMAP_NO_COMBO;
+    }
+    for (uint8_t c = 0; c < map->combo_count; c++) {
+        km->combo_members |= map->combos[c].buttons;
+    }
+    return true;
+}
+
+uint32_t keymap_button(keymap_engine_t* km, uint8_t button, bool down, uint32_t now_us, uint32_t stamp) {
+    if (!km || !km->map || button >= KEYMAP_MAX_BUTTONS) {
+        return 0;
+    }
+
+    keymap_button_state_t* state = &km->buttons[button];
+    if (state->down == down) {
+        return __keymap_next_timer(km, now_us);
+    }
+    state->down = down;
+
+    if (down) {
+        state->stamp = stamp;
+        state->action = __keymap_resolve(km, button);
+        if (km->combo_members & (1u << button)) {
+            if (!__keymap_try_combo(km, button, now_us)) {
+                // Hold the decision until the combo term runs out
+                state->pending = true;
+                state->due_us = now_us + km->map->combo_term_us;
+                state->timer = true;
+            }
+        } else {
+            __keymap_begin(km, state, now_us);
+        }
+        return __keymap_next_timer(km, now_us);
+    }
+
+    if (state->pending) {
+        // Released before the combo term: behave like a quick press
+        state->pending = false;
+        state->timer = false;
+        __keymap_begin(km, state, now_us);
+        __keymap_end(km, state);
+    } else if (state->combo != KEYMAP_NO_COMBO) {
+        // First member up ends the combo; the others are consumed
+        int8_t combo = state->combo;
+        for (uint8_t b = 0; b < KEYMAP_MAX_BUTTONS; b++) {
+            keymap_button_state_t* member = &km->buttons[b];
+            if (member->combo != combo) continue;
+            if (member->action.type != KEYMAP_ACTION_NONE) {
+                __keymap_end(km, member);
+                member->action = keymap_none();
+            }
+            if (!member->down) {
+                member->combo = KEYMAP_NO_COMBO;
+            }
+        }
+    } else {
+        __keymap_end(km, state);
+    }
+    return __keymap_next_timer(km, now_us);
+}
+
+uint32_t keymap_encoder(keymap_engine_t* km, uint8_t encoder, int32_t delta, uint32_t now_us, uint32_t stamp) {
+    if (!km || !km->map || encoder >= KEYMAP_MAX_ENCODERS) {
+        return 0;
+    }
+
+    keymap_encoder_state_t* enc = &km->encoders[encoder];
+    enc->position += delta;
+
+    uint8_t key = 0;
+    const keymap_axis_t* axis = __keymap_resolve_axis(km, encoder);
+    if (axis) {
+        if (enc->position >= axis->threshold) {
+            key = axis->positive;
+        } else if (enc->position <= -axis->threshold) {
+            key = axis->negative;
+        }
+    }
+    __keymap_axis_set(km, enc, key, stamp);
+    return __keymap_next_timer(km, now_us);
+}
+
+uint32_t keymap_tick(keymap_engine_t* km, uint32_t now_us) {
+    if (!km || !km->map) {
+        return 0;
+    }
+
+    for (uint8_t b = 0; b < KEYMAP_MAX_BUTTONS; b++) {
+        keymap_button_state_t* state = &km->buttons[b];
+        if (!state->timer || (int32_t)(now_us - state->due_us) < 0) continue;
+        state->timer = false;
+
+        if (state->pending) {
+            state->pending = false;
+            __keymap_begin(km, state, now_us);
+            continue;
+        }
+
+        const keymap_action_t* action = &state->action;
+        if (action->type == KEYMAP_ACTION_REPEAT) {
+            km->out.tap(km->out.ctx, action->key, KEYMAP_INPUT_BUTTON, __keymap_take_stamp(state));
+            if (action->interval_us != 0) {
+                state->due_us += action->interval_us;
+                if ((int32_t)(now_us - state->due_us) >= 0) {
+                    state->due_us = now_us + action->interval_us;  // fell behind: skip missed repeats
+                }
+                state->timer = true;
+            }
+        } else if (action->type == KEYMAP_ACTION_TAP_HOLD) {
+            state->tap_hold_decided = true;
+            km->out.press(km->out.ctx, action->alt, KEYMAP_INPUT_BUTTON, __keymap_take_stamp(state));
+        }
+    }
+    return __keymap_next_timer(km, now_us);
+}
+
+void keymap_set_layer(keymap_engine_t* km, uint8_t layer, bool active) {
+    if (!km || layer >= KEYMAP_MAX_LAYERS) {
+        return;
+    }
+    uint8_t bit = (uint8_t)(1u << layer);
+    __keymap_set_layers(km, active ? (km->layers | bit) : (km->layers & (uint8_t)~bit));
+}
+
+bool keymap_layer_active(const keymap_engine_t* km, uint8_t layer) {
+    if (!km || layer >= KEYMAP_MAX_LAYERS) {
+        return false;
+    }
+    return (km->layers >> layer) & 1u;
+}
+
+int32_t keymap_get_position(const keymap_engine_t* km, uint8_t encoder) {
+    if (!km || encoder >= KEYMAP_MAX_ENCODERS) {
+        return 0;
+    }
+    return km->encoders[encoder].position;
+}
@@ -0,0 +1,94 @@
+#include "latency.h"
+
+const char* latency_source_name(latency_source_t source) {
+    switch (source) {
+        case LATENCY_SRC_BUTTON:
+            return "button";
+        case LATENCY_SRC_ENCODER:
+            return "encoder";
+        case LATENCY_SRC_WAKE:
+            return "wake";
+        default:
+            return "unknown";
+    }
+}
+
+#if LATENCY_TRACE
+
+static latency_histogram_t histograms[LATENCY_SRC_COUNT];
+
+// Bucket index: octave of the value, then the next two bits below the MSB
+static uint8_t __latency_bucket(uint32_t us) {
+    if (us < (1u << LATENCY_SUB_BUCKET_BITS)) {
+        return (uint8_t)us;
+    }
+    uint8_t msb = 31 - __builtin_clz(us);
+    uint8_t sub = (us >> (msb - LATENCY_SUB_BUCKET_BITS)) & ((1u << LATENCY_SUB_BUCKET_BITS) - 1);
+    uint32_t index = ((uint32_t)(msb - LATENCY_SUB_BUCKET_BITS + 1) << LATENCY_SUB_BUCKET_BITS) + sub;
+    return (index >= LATENCY_BUCKETS - 1) ? (LATENCY_BUCKETS - 1) : (uint8_t)index;
+}
+
+// Largest value that still falls in `index`
+static uint32_t __latency_bucket_upper(uint8_t index) {
+    if (index < (1u << LATENCY_SUB_BUCKET_BITS)) {
+        return index;
+    }
+    if (index >= LATENCY_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+    uint8_t octave = (index >> LATENCY_SUB_BUCKET_BITS) + LATENCY_SUB_BUCKET_BITS - 1;
+    uint32_t sub = index & ((1u << LATENCY_SUB_BUCKET_BITS) - 1);
+    uint32_t width = 1u << (octave - LATENCY_SUB_BUCKET_BITS);
+    return (1u << octave) + (sub + 1) * width - 1;
+}
+
+static uint32_t __latency_percentile(const latency_histogram_t* hist, uint32_t permille) {
+    uint32_t rank = (uint32_t)(((uint64_t)hist->samples * permille + 999) / 1000);
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank && seen > 0) {
+            uint32_t upper = __latency_bucket_upper(i);
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+void latency_record(latency_source_t source, uint32_t start_stamp) {
+    if (start_stamp == 0 || source >= LATENCY_SRC_COUNT) {
+        return;
+    }
+
+    uint32_t us = latency_stamp() - start_stamp;
+    latency_histogram_t* hist = &histograms[source];
+    hist->counts[__latency_bucket(us)]++;
+    hist->samples++;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+}
+
+void latency_get_summary(latency_source_t source, latency_summary_t* summary) {
+    if (!summary) {
+        return;
+    }
+    memset(summary, 0, sizeof(*summary));
+    if (source >= LATENCY_SRC_COUNT) {
+        return;
+    }
+
+    const latency_histogram_t* hist = &histograms[source];
+    summary->samples = hist->samples;
+    summary->max_us = hist->max_us;
+    if (hist->samples > 0) {
+        summary->p50_us = __latency_percentile(hist, 500);
+        summary->p99_us = __latency_percentile(hist, 990);
+    }
+}
+
+void latency_reset(void) {
+    memset(histograms, 0, sizeof(histograms));
+}
+
+#endif  // LATENCY_TRACE
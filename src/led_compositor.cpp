@@ -0,0 +1,324 @@
+#include "led_compositor.h"
+
+#include <new>
+
+// Perceptual correction, gamma 2.6
+static const uint8_t kGamma8[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+      3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+      7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,  12,  12,
+     13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,
+     20,  21,  21,  22,  22,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+     30,  31,  31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,
+     42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,
+     58,  59,  60,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  75,
+     76,  77,  78,  80,  81,  82,  84,  85,  86,  88,  89,  90,  92,  93,  94,  96,
+     97,  99, 100, 102, 103, 105, 106, 108, 109, 111, 112, 114, 115, 117, 119, 120,
+    122, 124, 125, 127, 129, 130, 132, 134, 136, 137, 139, 141, 143, 145, 146, 148,
+    150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180,
+    182, 184, 186, 188, 191, 193, 195, 197, 199, 202, 204, 206, 209, 211, 213, 215,
+    218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252, 255,
+};
+
+// 0..255 -> 0..256, so full scale multiplies out exactly
+static inline uint16_t __led_unit(uint8_t value) {
+    return value + (value >> 7);
+}
+
+static inline uint8_t __led_over(uint8_t dst, uint8_t src, uint16_t weight) {
+    return (uint8_t)((dst * (256 - weight) + src * weight) >> 8);
+}
+
+static inline uint8_t __led_add(uint8_t dst, uint8_t src, uint16_t weight) {
+    uint16_t sum = dst + ((src * weight) >> 8);
+    return (sum > 255) ? 255 : (uint8_t)sum;
+}
+
+static void __led_blend(led_rgb_t* dst, const led_layer_t* layer, uint8_t coverage) {
+    uint16_t weight = __led_unit((uint8_t)((coverage * __led_unit(layer->alpha)) >> 8));
+    if (weight == 0) {
+        return;
+    }
+    if (layer->blend == LED_BLEND_ADD) {
+        dst->r = __led_add(dst->r, layer->color.r, weight);
+        dst->g = __led_add(dst->g, layer->color.g, weight);
+        dst->b = __led_add(dst->b, layer->color.b, weight);
+    } else {
+        dst->r = __led_over(dst->r, layer->color.r, weight);
+        dst->g = __led_over(dst->g, layer->color.g, weight);
+        dst->b = __led_over(dst->b, layer->color.b, weight);
+    }
+}
+
+static void __led_build_lut(led_compositor_t* comp) {
+    for (uint16_t v = 0; v < 256; v++) {
+        comp->lut[v] = kGamma8[(v * (comp->brightness + 1)) >> 8];
+    }
+}
+
+static bool __led_animated(const led_layer_t* layer) {
+    if (layer->fade_ms != 0) {
+        return true;
+    }
+    if (layer->alpha == 0) {
+        return false;
+    }
+    return layer->effect == LED_EFFECT_PULSE || layer->effect == LED_EFFECT_BLINK ||
+           layer->effect == LED_EFFECT_CHASE;
+}
+
+// Advance a running fade to `now_ms`
+static void __led_update_alpha(led_layer_t* layer, uint32_t now_ms) {
+    if (layer->fade_ms == 0) {
+        return;
+    }
+    uint32_t elapsed = now_ms - layer->fade_started_ms;
+    if (elapsed >= layer->fade_ms) {
+        layer->alpha = layer->fade_to;
+        layer->fade_ms = 0;
+        return;
+    }
+    int32_t span = (int32_t)layer->fade_to - (int32_t)layer->fade_from;
+    layer->alpha = (uint8_t)(layer->fade_from + span * (int32_t)elapsed / (int32_t)layer->fade_ms);
+}
+
+static void __led_draw(led_compositor_t* comp, const led_layer_t* layer, uint32_t now_ms) {
+    led_rgb_t* pixels = comp->frame + layer->first;
+    uint32_t phase = (layer->period_ms != 0) ? (now_ms - layer->started_ms) % layer->period_ms : 0;
+    uint8_t coverage = 255;
+
+    switch (layer->effect) {
+        case LED_EFFECT_PULSE:
+            if (layer->period_ms >= 2) {
+                uint32_t half = layer->period_ms / 2;
+                coverage = (phase < half) ? (uint8_t)(phase * 255 / half)
+                                          : (uint8_t)((layer->period_ms - phase) * 255 / (layer->period_ms - half));
+            }
+            break;
+        case LED_EFFECT_BLINK:
+            if (layer->period_ms != 0 && phase >= layer->period_ms / 2) {
+                return;
+            }
+            break;
+        case LED_EFFECT_CHASE: {
+            uint16_t count = layer->count;
+            uint16_t head = (layer->period_ms != 0) ? (uint16_t)((uint64_t)phase * count / layer->period_ms) : 0;
+            uint16_t tail = (layer->tail < count) ? layer->tail : (uint16_t)(count - 1);
+            for (uint16_t d = 0; d <= tail; d++) {
+                uint8_t fade = (uint8_t)(255 * (tail + 1 - d) / (tail + 1));
+                __led_blend(&pixels[(head + count - d) % count], layer, fade);
+            }
+            return;
+        }
+        case LED_EFFECT_SOLID:
+            break;
+        default:
+            return;
+    }
+
+    for (uint16_t i = 0; i < layer->count; i++) {
+        __led_blend(&pixels[i], layer, coverage);
+    }
+}
+
+bool led_compositor_init(led_compositor_t* comp, uint16_t count) {
+    if (!comp || count == 0 || count > LED_MAX_PIXELS) {
+        return false;
+    }
+    comp->frame = new (std::nothrow) led_rgb_t[count];
+    comp->out = new (std::nothrow) led_rgb_t[count];
+    if (!comp->frame || !comp->out) {
+        led_compositor_free(comp);
+        return false;
+    }
+    memset(comp->frame, 0, count * sizeof(led_rgb_t));
+    memset(comp->out, 0, count * sizeof(led_rgb_t));
+    comp->count = count;
+    comp->brightness = LED_DEFAULT_BRIGHTNESS;
+    __led_build_lut(comp);
+
+    memset(comp->layers, 0, sizeof(comp->layers));
+    for (uint8_t i = 0; i < LED_MAX_LAYERS; i++) {
+        comp->layers[i].alpha = 255;
+    }
+    comp->dirty = true;
+    comp->refresh = true;
+    comp->dirty_first = 0;
+    comp->dirty_end = 0;
+    memset(&comp->stats, 0, sizeof(comp->stats));
+    return true;
+}
+
+void led_compositor_free(led_compositor_t* comp) {
+    if (!comp) {
+        return;
+    }
+    delete[] comp->frame;
+    delete[] comp->out;
+    comp->frame = nullptr;
+    comp->out = nullptr;
+    comp->count = 0;
+}
+
+void led_compositor_set_brightness(led_compositor_t* comp, uint8_t brightness) {
+    if (!comp || comp->brightness == brightness) {
+        return;
+    }
+    comp->brightness = brightness;
+    __led_build_lut(comp);
+    comp->dirty = true;
+}
+
+void led_compositor_invalidate(led_compositor_t* comp) {
+    if (!comp) {
+        return;
+    }
+    comp->dirty = true;
+    comp->refresh = true;
+}
+
+bool led_compositor_compose(led_compositor_t* comp, uint32_t now_ms) {
+    if (!comp || !comp->frame) {
+        return false;
+    }
+    comp->stats.frames++;
+    comp->dirty_first = 0;
+    comp->dirty_end = 0;
+
+    bool animated = false;
+    for (uint8_t i = 0; i < LED_MAX_LAYERS && !animated; i++) {
+        animated = __led_animated(&comp->layers[i]);
+    }
+    if (!animated && !comp->dirty) {
+        return false;
+    }
+    comp->dirty = false;
+    comp->stats.composed++;
+
+    memset(comp->frame, 0, comp->count * sizeof(led_rgb_t));
+    for (uint8_t i = 0; i < LED_MAX_LAYERS; i++) {
+        led_layer_t* layer = &comp->layers[i];
+        __led_update_alpha(layer, now_ms);
+        if (layer->effect != LED_EFFECT_OFF && layer->alpha != 0 && layer->count != 0) {
+            __led_draw(comp, layer, now_ms);
+        }
+    }
+
+    uint16_t first = comp->count;
+    uint16_t end = 0;
+    for (uint16_t i = 0; i < comp->count; i++) {
+        led_rgb_t value = {comp->lut[comp->frame[i].r], comp->lut[comp->frame[i].g], comp->lut[comp->frame[i].b]};
+        led_rgb_t* out = &comp->out[i];
+        if (comp->refresh || value.r != out->r || value.g != out->g || value.b != out->b) {
+            *out = value;
+            if (first == comp->count) {
+                first = i;
+            }
+            end = i + 1;
+        }
+    }
+    comp->refresh = false;
+    if (end == 0) {
+        return false;
+    }
+    comp->dirty_first = first;
+    comp->dirty_end = end;
+    comp->stats.changed++;
+    return true;
+}
+
+void led_layer_set(led_compositor_t* comp, uint8_t index, led_effect_t effect, led_rgb_t color,
+                   uint16_t first, uint16_t count, uint32_t period_ms, uint32_t now_ms) {
+    if (!comp || index >= LED_MAX_LAYERS) {
+        return;
+    }
+    if (first >= comp->count) {
+        count = 0;
+    } else if (count > comp->count - first) {
+        count = comp->count - first;
+    }
+    if (effect == LED_EFFECT_SOLID || effect == LED_EFFECT_OFF) {
+        period_ms = 0;
+    }
+
+    led_layer_t* layer = &comp->layers[index];
+    if (layer->effect == effect && layer->color.r == color.r && layer->color.g == color.g &&
+        layer->color.b == color.b && layer->first == first && layer->count == count &&
+        layer->period_ms == period_ms) {
+        return;
+    }
+    layer->effect = effect;
+    layer->color = color;
+    layer->first = first;
+    layer->count = count;
+    layer->period_ms = period_ms;
+    layer->started_ms = now_ms;
+    comp->dirty = true;
+}
+
+void led_layer_set_tail(led_compositor_t* comp, uint8_t index, uint8_t tail) {
+    if (!comp || index >= LED_MAX_LAYERS || comp->layers[index].tail == tail) {
+        return;
+    }
+    comp->layers[index].tail = tail;
+    comp->dirty = true;
+}
+
+void led_layer_set_blend(led_compositor_t* comp, uint8_t index, led_blend_t blend) {
+    if (!comp || index >= LED_MAX_LAYERS || comp->layers[index].blend == blend) {
+        return;
+    }
+    comp->layers[index].blend = blend;
+    comp->dirty = true;
+}
+
+void led_layer_set_alpha(led_compositor_t* comp, uint8_t index, uint8_t alpha) {
+    if (!comp || index >= LED_MAX_LAYERS) {
+        return;
+    }
+    led_layer_t* layer = &comp->layers[index];
+    if (layer->alpha == alpha && layer->fade_ms == 0) {
+        return;
+    }
+    layer->alpha = alpha;
+    layer->fade_ms = 0;
+    comp->dirty = true;
+}
+
+void led_layer_fade(led_compositor_t* comp, uint8_t index, uint8_t alpha, uint32_t duration_ms, uint32_t now_ms) {
+    if (!comp || index >= LED_MAX_LAYERS) {
+        return;
+    }
+    led_layer_t* layer = &comp->layers[index];
+    if (layer->fade_ms != 0 && layer->fade_to == alpha) {
+        return;
+    }
+    __led_update_alpha(layer, now_ms);
+    if (duration_ms == 0 || layer->alpha == alpha) {
+        led_layer_set_alpha(comp, index, alpha);
+        return;
+    }
+    layer->fade_from = layer->alpha;
+    layer->fade_to = alpha;
+    layer->fade_started_ms = now_ms;
+    layer->fade_ms = duration_ms;
+    comp->dirty = true;
+}
+
+void led_layer_off(led_compositor_t* comp, uint8_t index) {
+    if (!comp || index >= LED_MAX_LAYERS || comp->layers[index].effect == LED_EFFECT_OFF) {
+        return;
+    }
+    comp->layers[index].effect = LED_EFFECT_OFF;
+    comp->dirty = true;
+}
+
+led_rgb_t led_compositor_get(const led_compositor_t* comp, uint16_t index) {
+    led_rgb_t off = {0, 0, 0};
+    if (!comp || !comp->out || index >= comp->count) {
+        return off;
+    }
+    return comp->out[index];
+}
@@ -1,153 +1,772 @@
+// Unit tests on the board bring their own setup() and loop()
+#if !defined(PIO_UNIT_TESTING)
+
 #include <Arduino.h>
 #include <button.h>
 #include <encoder.h>
 #include <imu.h>
+#include <imu_stream.h>
+#include <fusion.h>
 #include <neopixel.h>
-#include <BleKeyboard.h>
+#include <scheduler.h>
+#include <hid_report.h>
+#include <hid_transport.h>
+#include <ble_link.h>
+#include <latency.h>
+#include <binlog.h>
+#include <keymap.h>
+#include <gesture.h>
+#include <trace.h>
+#include <trace_replay.h>
+#include <console.h>
+#include <input_pipeline.h>
+#include <web_server.h>
+#include <idle.h>
+#include <key_matrix.h>
+#include <LittleFS.h>
+#include <WiFi.h>
 
 static constexpr int32_t kEncoderDeadband = 1;
 static constexpr uint32_t kGateToggleDebounceMs = 750;
 static constexpr uint32_t kButtonRepeatIntervalMs = 80;
+static constexpr uint8_t kKeyActionButton = 0;   // BTN_1
+static constexpr uint8_t kKeyGateButton = 1;     // RE_BTN
+static constexpr uint8_t kKeyTiltLeft = 2;       // gesture buttons: held while tilted / tapped on shake
+static constexpr uint8_t kKeyTiltRight = 3;
+static constexpr uint8_t kKeyShake = 4;
+static constexpr uint8_t kKeyAuxButton = 5;      // BTN_0, through the key scanner
+static constexpr uint8_t kKeyEncoder = 0;
+static constexpr uint8_t kLayerGate = 1;         // encoder drives W/S while active
+static constexpr uint8_t kImuTaskCore = 0;      // keep I2C off the loop() core
+static constexpr uint8_t kImuTaskPriority = 5;
+static constexpr uint8_t kLogTaskCore = 0;
+static constexpr uint8_t kLogTaskPriority = 1;      // below everything on the input path
+static constexpr uint8_t kTraceTaskCore = 0;
+static constexpr uint8_t kTraceTaskPriority = 1;
+static constexpr uint32_t kInputPollIntervalUs = 2000;   // debounce expiry; also the replay clock step
+static constexpr uint32_t kKeyScanIntervalUs = 5000;     // KEY_MATRIX_DEBOUNCE_SCANS scans: 20 ms, as button_t
+static constexpr uint32_t kStatusIntervalUs = 1000000;
+static constexpr uint32_t kConsolePollIntervalUs = 50000;
+static constexpr uint32_t kIdlePollIntervalUs = 250000;   // console, trace and web while idle
+static constexpr uint32_t kLogPollIntervalUs = 10000;     // only used without the log task
+static constexpr uint32_t kTracePollIntervalUs = 100000;  // only used without the trace task
+static constexpr const char* kTracePath = "/trace.bin";
+static constexpr uint32_t kWebPollIntervalUs = 10000;     // also the fastest telemetry rate
+static constexpr const char* kBleDeviceName = "EEducation Keyboard";
+static constexpr const char* kBleManufacturer = "Benson and Sabil";
+static constexpr const char* kBleHostsPath = "/ble_hosts.bin";
+static constexpr const char* kWifiApSsid = "EEducation Keyboard";  // with WIFI_AP_PASSWORD
+static constexpr uint16_t kNeoPixelCount = 3;
+static constexpr uint32_t kNeoPixelFrameMs = 20;
+static constexpr uint8_t kLedLayerIdle = 0;      // dim chase under the indicators
+static constexpr uint8_t kLedLayerLink = 1;      // pixel 0: BLE link
+static constexpr uint8_t kLedLayerGate = 2;      // pixel 2: keyboard gate
+static constexpr uint16_t kLedLinkPixel = 0;
+static constexpr uint16_t kLedGatePixel = 2;
+static constexpr uint32_t kLedIdleLapMs = 1500;
+static constexpr uint8_t kLedIdleAlpha = 48;
+static constexpr uint32_t kLedLinkDownBlinkMs = 600;
+static constexpr uint32_t kLedGateFadeMs = 250;
+static constexpr led_rgb_t kLedIdleColor = {255, 96, 0};
+static constexpr led_rgb_t kLedLinkUpColor = {0, 0, 255};
+static constexpr led_rgb_t kLedLinkDownColor = {255, 0, 0};
+static constexpr led_rgb_t kLedGateColor = {0, 255, 0};
 
 button_t button;
 encoder_t encoder;
 imu_t imu;
+imu_stream_t imu_stream;
+static imu_duty_t imu_duty;
+static key_matrix_t keys;
+static imu_sample_t imu_latest = {};
+fusion_t orientation;
+gesture_t gesture;
 neopixel_t neopixel = {};
-BleKeyboard bleKeyboard("EEducation Keyboard", "Benson and Sabil", 100);
-static bool keyboard_gate_active = false;
-static bool keyboard_gate_last_state = false;
-static uint32_t last_gate_toggle_ms = 0;
-static bool encoder_button_was_pressed = false;
-static uint32_t last_button_a_emit_ms = 0;
-static bool w_hold_active = false;
-static bool s_hold_active = false;
+scheduler_t scheduler;
+hid_composer_t hid;
+static int input_job = -1;
+static int keymap_job = -1;
+static int hid_job = -1;
+static int neopixel_job = -1;
+static int console_job = -1;
+static int trace_job = -1;
+static int web_job = -1;
+static int keys_job = -1;
+static idle_manager_t idle_manager;
+static hid_transport_t ble;
+static ble_link_t ble_link;
+static int ble_job = -1;
+static trace_recorder_t recorder;
+static File trace_file;
+static bool fs_ready = false;
+static bool fs_failed = false;     // mount failed: not retried until "fs format"
+static web_server_t web;
+static bool web_ready = false;
+static trace_replay_t replay;
+static console_t console;
+
+// 'D' repeats while BTN_1 is held (first one after one interval), 'A'
+// while BTN_0 is; the encoder button toggles the gate layer, in which the encoder holds W/S,
+// tilting left/right holds A/D and a shake taps space
+static constexpr keymap_layer_t kLayers[] = {
+    // layer 0: base
+    {
+        {
+            keymap_repeat('D', kButtonRepeatIntervalMs * 1000, kButtonRepeatIntervalMs * 1000),  // kKeyActionButton
+            keymap_toggle_layer(kLayerGate, kGateToggleDebounceMs * 1000),                     // kKeyGateButton
+            keymap_none(),  // kKeyTiltLeft
+            keymap_none(),  // kKeyTiltRight
+            keymap_none(),  // kKeyShake
+            keymap_repeat('A', kButtonRepeatIntervalMs * 1000, kButtonRepeatIntervalMs * 1000),  // kKeyAuxButton
+        },
+        {},
+    },
+    // kLayerGate
+    {
+        {
+            keymap_trans(),      // kKeyActionButton
+            keymap_trans(),      // kKeyGateButton
+            keymap_hold('A'),    // kKeyTiltLeft
+            keymap_hold('D'),    // kKeyTiltRight
+            keymap_tap(' '),     // kKeyShake
+            keymap_trans(),      // kKeyAuxButton
+        },
+        {
+            keymap_axis_hold('W', 'S', kEncoderDeadband),  // kKeyEncoder
+        },
+    },
+};
+static constexpr keymap_t kKeymap = {kLayers, sizeof(kLayers) / sizeof(kLayers[0]), NULL, 0, 0};
+static_assert(sizeof(kLayers) / sizeof(kLayers[0]) <= KEYMAP_MAX_LAYERS, "too many keymap layers");
+keymap_engine_t keymap;
+static input_pipeline_t live_inputs;
+
+// Keymap button driven by each key scanner key (kScanPins order)
+static constexpr pin_t kScanPins[] = {BTN_0};
+static constexpr uint8_t kScanButtons[] = {kKeyAuxButton};
 
-static const char* neopixel_color_name(uint8_t color_index) {
-    switch (color_index) {
-        case 0:
-            return "Red";
-        case 1:
-            return "Green";
-        case 2:
-            return "Blue";
-        default:
-            return "Unknown";
+// Keymap inputs of the button, the encoder and each gesture
+static constexpr input_pipeline_map_t kInputMap = {
+    kKeyActionButton,
+    kKeyGateButton,
+    kKeyEncoder,
+    {
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_NONE
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_FLICK_LEFT
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_FLICK_RIGHT
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_FLICK_UP
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_FLICK_DOWN
+        kKeyShake,                  // GESTURE_SHAKE
+        kKeyTiltLeft,               // GESTURE_TILT_LEFT
+        kKeyTiltRight,              // GESTURE_TILT_RIGHT
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_TILT_FORWARD
+        INPUT_PIPELINE_UNBOUND,     // GESTURE_TILT_BACK
+    },
+};
+
+// Report sink for the composer; reports produced while offline are discarded
+static hid_send_result_t ble_send_report(void* ctx, const hid_key_report_t* report) {
+    if (!hid_transport_connected(&ble)) {
+        return HID_SEND_DISCARDED;
+    }
+    if (!hid_transport_send(&ble, report)) {
+        return HID_SEND_BUSY;  // out of transmit buffers: the composer retries next interval
     }
+    idle_report_sent(&idle_manager);
+    return HID_SEND_OK;
 }
 
-static void send_key_press(char key_code) {
-    Serial.write(static_cast<uint8_t>(key_code));
-    if (bleKeyboard.isConnected()) {
-        bleKeyboard.write(static_cast<uint8_t>(key_code));
-    }
+static latency_source_t latency_source_of(keymap_input_t input) {
+    return (input == KEYMAP_INPUT_ENCODER) ? LATENCY_SRC_ENCODER : LATENCY_SRC_BUTTON;
 }
 
-static void apply_key_hold(char key_code, bool desired_state, bool& cached_state) {
-    if (cached_state == desired_state) {
+static void keymap_tap_fn(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp) {
+    BINLOG_INFO(KEY_ECHO, key);
+    trace_record_key(&recorder, micros(), key, TRACE_KEY_TAP);
+    web_server_publish_key(&web, key, TRACE_KEY_TAP, millis());
+    hid_composer_set_origin(&hid, latency_source_of(input), stamp);
+    hid_composer_tap(&hid, key);
+    scheduler_trigger(&scheduler, hid_job);
+}
+
+static void keymap_press_fn(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp) {
+    trace_record_key(&recorder, micros(), key, TRACE_KEY_PRESS);
+    web_server_publish_key(&web, key, TRACE_KEY_PRESS, millis());
+    hid_composer_set_origin(&hid, latency_source_of(input), stamp);
+    hid_composer_press(&hid, key);
+    scheduler_trigger(&scheduler, hid_job);
+    BINLOG_INFO(KEY_DOWN, key);
+}
+
+static void keymap_release_fn(void* ctx, uint8_t key) {
+    trace_record_key(&recorder, micros(), key, TRACE_KEY_RELEASE);
+    web_server_publish_key(&web, key, TRACE_KEY_RELEASE, millis());
+    hid_composer_release(&hid, key);
+    scheduler_trigger(&scheduler, hid_job);
+    BINLOG_INFO(KEY_UP, key);
+}
+
+static void keymap_layer_fn(void* ctx, uint8_t layer, bool active) {
+    if (layer != kLayerGate) {
         return;
     }
-    cached_state = desired_state;
-    if (bleKeyboard.isConnected()) {
-        if (desired_state) {
-            bleKeyboard.press(static_cast<uint8_t>(key_code));
-        } else {
-            bleKeyboard.release(static_cast<uint8_t>(key_code));
+    if (active) {
+        BINLOG_INFO(GATE_ENABLED);
+    } else {
+        BINLOG_INFO(GATE_DISABLED);
+    }
+}
+
+static void schedule_keymap(uint32_t wait_us) {
+    if (wait_us != 0) {
+        scheduler_schedule_in(&scheduler, keymap_job, wait_us);
+    }
+}
+
+// Any button/encoder edge: run the input job right away
+static void wake_input_job(void* ctx) {
+    idle_activity(&idle_manager);
+    scheduler_trigger_from_isr(static_cast<scheduler_t*>(ctx), input_job);
+}
+
+static void input_job_fn(void* ctx) {
+    uint32_t now = micros();
+    uint32_t wait_us = 0;
+
+    imu_sample_t sample;
+    while (imu_stream_pop(&imu_stream, &sample)) {
+        idle_activity(&idle_manager);  // a streaming IMU needs the input poll
+        imu_latest = sample;
+        trace_record_imu(&recorder, &sample);
+        uint32_t imu_wait_us = input_pipeline_imu(&live_inputs, &sample, now);
+        if (imu_wait_us != 0) {
+            wait_us = imu_wait_us;
         }
     }
-    Serial.printf("%c %s\n", key_code, desired_state ? "DOWN" : "UP");
+
+    uint32_t poll_wait_us = input_pipeline_poll(&live_inputs, now);
+    if (poll_wait_us != 0) {
+        wait_us = poll_wait_us;
+    }
+    schedule_keymap(wait_us);
+}
+
+// Debounced scanner changes straight into the keymap
+static void keys_event(void* ctx, uint8_t key, bool pressed, uint32_t now_us) {
+    idle_activity(&idle_manager);
+    schedule_keymap(keymap_button(&keymap, kScanButtons[key], pressed, now_us, 0));
+}
+
+static void keys_job_fn(void* ctx) {
+    key_matrix_scan(&keys, micros());
+}
+
+static void keymap_job_fn(void* ctx) {
+    schedule_keymap(keymap_tick(&keymap, micros()));
+}
+
+static void hid_job_fn(void* ctx) {
+    uint32_t wait_us = hid_composer_poll(&hid);
+    if (wait_us != 0) {
+        scheduler_schedule_in(&scheduler, hid_job, wait_us);
+    }
+}
+
+// Re-applied every frame; unchanged layers cost nothing and an idle strip is not re-sent
+static void update_indicators(uint32_t now_ms) {
+    led_compositor_t* leds = &neopixel.leds;
+    if (hid_transport_connected(&ble)) {
+        led_layer_set(leds, kLedLayerLink, LED_EFFECT_SOLID, kLedLinkUpColor, kLedLinkPixel, 1, 0, now_ms);
+    } else {
+        led_layer_set(leds, kLedLayerLink, LED_EFFECT_BLINK, kLedLinkDownColor, kLedLinkPixel, 1,
+                      kLedLinkDownBlinkMs, now_ms);
+    }
+    bool gate = keymap_layer_active(&keymap, kLayerGate);
+    led_layer_fade(leds, kLedLayerGate, gate ? 255 : 0, kLedGateFadeMs, now_ms);
+}
+
+static void neopixel_setup(void) {
+    led_compositor_t* leds = &neopixel.leds;
+    uint32_t now_ms = millis();
+    led_layer_set(leds, kLedLayerIdle, LED_EFFECT_CHASE, kLedIdleColor, 0, kNeoPixelCount, kLedIdleLapMs, now_ms);
+    led_layer_set_tail(leds, kLedLayerIdle, 1);
+    led_layer_set_alpha(leds, kLedLayerIdle, kLedIdleAlpha);
+    led_layer_set(leds, kLedLayerGate, LED_EFFECT_SOLID, kLedGateColor, kLedGatePixel, 1, 0, now_ms);
+    led_layer_set_alpha(leds, kLedLayerGate, 0);
+    update_indicators(now_ms);
+}
+
+static void neopixel_job_fn(void* ctx) {
+    update_indicators(millis());
+    neopixel_step(&neopixel);
+}
+
+static void status_job_fn(void* ctx) {
+    int32_t pos = keymap_get_position(&keymap, kKeyEncoder);
+    bool keyboard_gate_active = keymap_layer_active(&keymap, kLayerGate);
+    bool buttonStatus = button_read(&button);
+    bool ble_connected = hid_transport_connected(&ble);
+    imu_stream_stats_t imu_stats = {};
+    imu_stream_get_stats(&imu_stream, &imu_stats);
+    float roll = 0.0f;
+    float pitch = 0.0f;
+    float yaw = 0.0f;
+    fusion_get_euler(&orientation, &roll, &pitch, &yaw);
+    const scheduler_job_stats_t* input_stats = scheduler_get_stats(&scheduler, input_job);
+    const hid_composer_stats_t* hid_stats = &hid.stats;
+
+    BINLOG_INFO(STATUS_INPUT, pos, buttonStatus, keyboard_gate_active,
+                imu_stats.samples, imu_stats.overruns, imu_stats.missed_interrupts);
+    BINLOG_INFO(STATUS_TIMING, roll, pitch, yaw,
+                input_stats->last_late_us, input_stats->max_late_us, input_stats->max_run_us);
+    if (ble_connected) {
+        BINLOG_INFO(STATUS_LINK_UP, hid_stats->sent, hid_stats->merged, hid_stats->dropped);
+    } else if (ble_link.state == BLE_LINK_DIRECTED) {
+        BINLOG_INFO(STATUS_LINK_DIRECTED, hid_stats->sent, hid_stats->merged, hid_stats->dropped,
+                    hid_stats->discarded, ble_link.target);
+    } else {
+        BINLOG_INFO(STATUS_LINK_DOWN, hid_stats->sent, hid_stats->merged, hid_stats->dropped,
+                    hid_stats->discarded);
+    }
+}
+
+// Stored hosts, trace files, and the dashboard assets when they are not
+// embedded. Never formats on its own: a mount failure leaves the partition
+// (and whatever is on it) alone until "fs format" is typed.
+static bool fs_mount(void) {
+    if (fs_ready || fs_failed) {
+        return fs_ready;
+    }
+    fs_ready = LittleFS.begin(false);
+    if (!fs_ready) {
+        fs_failed = true;
+        Serial.println("LittleFS mount failed: 'fs format' erases the partition and formats it");
+    }
+    return fs_ready;
+}
+
+static void fs_format(void* ctx) {
+    if (recorder.active) {
+        Serial.println("fs: stop the trace first");
+        return;
+    }
+    Serial.println("fs: formatting");
+    if (!LittleFS.format()) {
+        Serial.println("fs: format failed");
+        return;
+    }
+    fs_ready = false;
+    fs_failed = false;
+    if (fs_mount()) {
+        Serial.println("fs: formatted and mounted");
+    }
+}
+
+// BLE link -------------------------------------------------------------------
+
+static bool ble_hosts_load(void* ctx, ble_link_record_t* record) {
+    if (!fs_mount() || !LittleFS.exists(kBleHostsPath)) {
+        return false;
+    }
+    File file = LittleFS.open(kBleHostsPath, "r");
+    bool ok = file && file.read(reinterpret_cast<uint8_t*>(record), sizeof(*record)) == sizeof(*record);
+    file.close();
+    return ok;
+}
+
+static bool ble_hosts_save(void* ctx, const ble_link_record_t* record) {
+    if (!fs_mount()) {
+        return false;
+    }
+    File file = LittleFS.open(kBleHostsPath, "w");
+    bool ok = file && file.write(reinterpret_cast<const uint8_t*>(record), sizeof(*record)) == sizeof(*record);
+    file.close();
+    return ok;
+}
+
+// From the BLE stack's task
+static void ble_link_notify(void* ctx) {
+    scheduler_trigger_from_task(&scheduler, ble_job);
+}
+
+static void ble_job_fn(void* ctx) {
+    static uint32_t reconnects = 0;
+    uint32_t wait_ms = ble_link_service(&ble_link);
+    if (wait_ms != UINT32_MAX) {
+        scheduler_schedule_in(&scheduler, ble_job, wait_ms * 1000);
+    }
+    if (ble_link.stats.reconnects != reconnects) {
+        reconnects = ble_link.stats.reconnects;
+        BINLOG_INFO(BLE_RECONNECTED, ble_link.peer, ble_link.stats.last_reconnect_ms);
+    }
+}
+
+// Before the stack starts, so the first connection is seen. The stored
+// hosts are loaded here, so LittleFS is mounted at boot after all: the
+// directed burst to the last host needs its address before the first
+// advertisement, and the mount time is printed to keep that cost in view.
+static void ble_link_setup(void) {
+    ble_link_config_t config;
+    ble_link_default_config(&config);
+    ble_link_hooks_t hooks = {ble_hosts_load, ble_hosts_save, ble_link_notify, NULL};
+    uint32_t start_us = micros();
+    ble_link_init(&ble_link, &ble, &config, &hooks);
+    Serial.printf("ble: hosts loaded in %lu us (fs mount included)\n",
+                  static_cast<unsigned long>(micros() - start_us));
+}
+
+// Dashboard ------------------------------------------------------------------
+
+static void telemetry_sample(telemetry_sample_t* sample) {
+    const imu_data_t* data = &imu_latest.data;
+    const scheduler_job_stats_t* input_stats = scheduler_get_stats(&scheduler, input_job);
+    sample->time_ms = millis();
+    sample->encoder = keymap_get_position(&keymap, kKeyEncoder);
+    sample->flags = 0;
+    if (keymap_layer_active(&keymap, kLayerGate)) {
+        sample->flags |= TELEMETRY_FLAG_GATE;
+    }
+    if (button_read(&button)) {
+        sample->flags |= TELEMETRY_FLAG_BUTTON;
+    }
+    if (hid_transport_connected(&ble)) {
+        sample->flags |= TELEMETRY_FLAG_BLE;
+    }
+    sample->accel_g[0] = data->accel_x;
+    sample->accel_g[1] = data->accel_y;
+    sample->accel_g[2] = data->accel_z;
+    sample->gyro_dps[0] = data->gyro_x;
+    sample->gyro_dps[1] = data->gyro_y;
+    sample->gyro_dps[2] = data->gyro_z;
+    sample->temp_c = data->temp;
+    fusion_get_euler(&orientation, &sample->roll, &sample->pitch, &sample->yaw);
+    sample->input_late_us = input_stats->last_late_us;
+    sample->input_max_late_us = input_stats->max_late_us;
+    sample->input_max_run_us = input_stats->max_run_us;
+    sample->hid_sent = hid.stats.sent;
+}
+
+static void web_job_fn(void* ctx) {
+    uint32_t now_ms = millis();
+    telemetry_sample_t sample;
+    telemetry_sample(&sample);
+    web_server_publish(&web, &sample, now_ms);
+    web_server_poll(&web, now_ms);
+    if (web.stats.websockets > 0) {
+        idle_activity(&idle_manager);  // keep the telemetry rate up for an open dashboard
+    }
+}
+
+// The radio stays off unless the build joins a network (WIFI_SSID and
+// WIFI_PASSWORD) or opens a WPA2 access point (WIFI_AP_PASSWORD); there
+// is no open AP
+#if defined(WIFI_AP_PASSWORD)
+static_assert(sizeof(WIFI_AP_PASSWORD) - 1 >= 8 && sizeof(WIFI_AP_PASSWORD) - 1 <= 63,
+              "WIFI_AP_PASSWORD must be a WPA2 passphrase of 8 to 63 characters");
+#endif
+
+static bool wifi_setup(void) {
+#if defined(WIFI_SSID) && defined(WIFI_PASSWORD)
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    return true;
+#elif defined(WIFI_AP_PASSWORD)
+    WiFi.mode(WIFI_AP);
+    if (!WiFi.softAP(kWifiApSsid, WIFI_AP_PASSWORD)) {
+        Serial.println("web: access point start failed");
+        WiFi.mode(WIFI_OFF);
+        return false;
+    }
+    return true;
+#else
+    Serial.println("web: WiFi off (build with WIFI_SSID and WIFI_PASSWORD, or WIFI_AP_PASSWORD)");
+    return false;
+#endif
+}
+
+static void web_setup(void) {
+    if (!wifi_setup()) {
+        return;
+    }
+    uint32_t start_us = micros();
+#if !WEB_ASSETS_EMBEDDED
+    fs_mount();     // assets are read from LittleFS per request (mounted already if the hosts loaded)
+#endif
+    uint32_t mount_us = micros() - start_us;
+    web_ready = web_server_begin(&web, WEB_SERVER_PORT, TELEMETRY_DEFAULT_RATE_HZ);
+    uint32_t ready_us = micros() - start_us;
+    if (!web_ready) {
+        Serial.println("web: server start failed");
+        return;
+    }
+    Serial.printf("web: listening on port %u, ready in %lu us (fs mount %lu us)\n", WEB_SERVER_PORT,
+                  static_cast<unsigned long>(ready_us), static_cast<unsigned long>(mount_us));
+#if WEB_ASSETS_EMBEDDED
+    uint32_t raw_size;
+    uint32_t size = web_assets_size(&raw_size);
+    Serial.printf("web: %u embedded assets, %lu bytes in flash (%lu source)\n",
+                  static_cast<unsigned>(web_asset_count), static_cast<unsigned long>(size),
+                  static_cast<unsigned long>(raw_size));
+#endif
+}
+
+// Light sleep ----------------------------------------------------------------
+
+// An RMT frame or a HID report on its way out would be cut off
+// The directed burst is short, and its outcome must not wait for a timer wake
+// A connected host is dropped unless the controller has modem sleep and a
+// low-power clock, which this build does not configure: while connected the
+// jobs idle but the chip stays awake
+static bool idle_can_sleep(void* ctx) {
+    return !neopixel_busy(&neopixel) && !hid_composer_busy(&hid) && ble_link.state != BLE_LINK_DIRECTED &&
+           !hid_transport_connected(&ble);
+}
+
+// Re-phased together so they share one timer wake
+static void idle_set_polls(uint32_t delay_us, uint32_t console_us, uint32_t trace_us, uint32_t web_us) {
+    scheduler_set_period(&scheduler, console_job, console_us);
+    scheduler_set_period(&scheduler, trace_job, trace_us);
+    scheduler_set_period(&scheduler, web_job, web_us);
+    scheduler_schedule_in(&scheduler, console_job, delay_us);
+    scheduler_schedule_in(&scheduler, trace_job, delay_us);
+    if (web_job >= 0) {
+        scheduler_schedule_in(&scheduler, web_job, delay_us);
+    }
+}
+
+// Only the slow jobs keep running while idle; edges still trigger the input job
+static void idle_changed(void* ctx, bool idle) {
+    led_compositor_t* leds = &neopixel.leds;
+    if (idle) {
+        scheduler_cancel(&scheduler, input_job);
+        scheduler_cancel(&scheduler, keys_job);
+        key_matrix_select_all(&keys, true);
+        led_compositor_set_brightness(leds, 0);
+        neopixel_step(&neopixel);
+        scheduler_cancel(&scheduler, neopixel_job);
+        idle_set_polls(kIdlePollIntervalUs, kIdlePollIntervalUs, kIdlePollIntervalUs, kIdlePollIntervalUs);
+    } else {
+        scheduler_schedule_in(&scheduler, input_job, 0);
+        key_matrix_select_all(&keys, false);
+        scheduler_schedule_in(&scheduler, keys_job, 0);
+        led_compositor_set_brightness(leds, LED_DEFAULT_BRIGHTNESS);
+        scheduler_schedule_in(&scheduler, neopixel_job, 0);
+        idle_set_polls(0, kConsolePollIntervalUs, kTracePollIntervalUs, kWebPollIntervalUs);
+    }
+}
+
+// The edge that woke the chip never reached the ISRs
+static bool idle_woke(void* ctx) {
+    bool moved = button_resync(&button);
+    if (encoder_resync(&encoder)) {
+        moved = true;
+    }
+    if (imu_duty_idle(&imu_duty)) {
+        imu_stream_kick(&imu_stream);  // INT1 pulses are too short to read back
+    }
+    return moved;
+}
+
+// Inputs that wake the chip, with the interrupt mode their drivers attached;
+// the key scanner's columns come on top
+static constexpr idle_wake_pin_t kWakePins[] = {
+    {BTN_1, CHANGE}, {RE_CW, CHANGE}, {RE_CCW, CHANGE}, {RE_BTN, CHANGE}, {IMU_INT, RISING},
+};
+static constexpr uint8_t kWakePinCount = sizeof(kWakePins) / sizeof(kWakePins[0]);
+static_assert(kWakePinCount + sizeof(kScanPins) / sizeof(kScanPins[0]) <= IDLE_MAX_WAKE_PINS,
+              "more wake pins than IDLE_MAX_WAKE_PINS");
+
+static void idle_setup(void) {
+    idle_config_t config;
+    idle_default_config(&config);
+    idle_hooks_t hooks = {idle_can_sleep, idle_changed, idle_woke, NULL};
+    idle_init(&idle_manager, &scheduler, &config, &hooks, true);
+    bool pins_ok = true;
+    for (uint8_t i = 0; i < kWakePinCount; i++) {
+        pins_ok = idle_add_wake_pin(&idle_manager, kWakePins[i].pin, kWakePins[i].mode) && pins_ok;
+    }
+    for (uint8_t i = 0; i < keys.col_count; i++) {
+        pins_ok = idle_add_wake_pin(&idle_manager, keys.cols[i], DISABLED) && pins_ok;  // polled, no interrupt to restore
+    }
+    if (!pins_ok) {
+        // An input that cannot wake the chip would lose its presses in light sleep
+        Serial.println("idle: wake pin table full, idling off");
+        idle_set_enabled(&idle_manager, false);
+    }
+}
+
+// Trace recording ----------------------------------------------------------
+
+static bool trace_file_write(void* ctx, const uint8_t* data, size_t len) {
+    return static_cast<File*>(ctx)->write(data, len) == len;
+}
+
+static size_t trace_file_read(void* ctx, uint8_t* data, size_t len) {
+    return static_cast<File*>(ctx)->read(data, len);
+}
+
+static void trace_edge_fn(void* ctx, const input_event_t* event) {
+    trace_record_edge(static_cast<trace_recorder_t*>(ctx), event);
+}
+
+static void trace_job_fn(void* ctx) {
+    if (!recorder.task) {
+        trace_recorder_service(&recorder);
+    }
+}
+
+// Replays start from the levels captured here; keymap and gesture state
+// start from scratch, so record from an idle device
+static void trace_start(void* ctx) {
+    if (recorder.active || !fs_mount()) {
+        return;
+    }
+    trace_file = LittleFS.open(kTracePath, "w");
+    if (!trace_file) {
+        Serial.println("trace: open failed");
+        return;
+    }
+    trace_recorder_start(&recorder, kTraceTaskCore, kTraceTaskPriority);
+    if (!recorder.active) {
+        trace_file.close();
+        return;
+    }
+    uint32_t now = micros();
+    trace_record_sync(&recorder, now, button.pin, button.raw_level);
+    trace_record_sync(&recorder, now, encoder.pin_btn, encoder.btn_level);
+    input_event_set_trace(trace_edge_fn, &recorder);
+    Serial.printf("trace: recording to %s\n", kTracePath);
+}
+
+static void trace_stop(void* ctx) {
+    if (!recorder.active) {
+        return;
+    }
+    input_event_set_trace(NULL, NULL);
+    trace_recorder_stop(&recorder);
+    trace_file.close();
+    const trace_recorder_stats_t* stats = &recorder.stats;
+    Serial.printf("trace: records:%lu dropped:%lu chunks:%lu bytes:%lu errors:%lu\n",
+                  static_cast<unsigned long>(stats->records),
+                  static_cast<unsigned long>(stats->dropped),
+                  static_cast<unsigned long>(stats->chunks),
+                  static_cast<unsigned long>(stats->bytes),
+                  static_cast<unsigned long>(stats->write_errors));
+}
+
+static void trace_replay_file(void* ctx) {
+    if (recorder.active) {
+        Serial.println("trace: stop recording first");
+        return;
+    }
+    if (!fs_mount()) {
+        return;
+    }
+    File file = LittleFS.open(kTracePath, "r");
+    if (!file) {
+        Serial.println("trace: nothing recorded");
+        return;
+    }
+    trace_replay_config_t config = {&kKeymap, &kInputMap, button.pin, encoder.pin_a, encoder.pin_b, encoder.pin_btn,
+                                    kInputPollIntervalUs};
+    trace_replay_result_t result;
+    bool ok = trace_replay_run(&replay, &config, trace_file_read, &file, &result);
+    file.close();
+    if (!ok) {
+        Serial.println("trace: replay keymap init failed");
+        return;
+    }
+    trace_replay_print(&result, &Serial);
+}
+
+static void log_job_fn(void* ctx) {
+    binlog_service(BINLOG_CAPACITY);
+}
+
+static void console_job_fn(void* ctx) {
+    console_poll(&console);
 }
 
 void setup() {
     Serial.begin(115200);
-    bleKeyboard.begin();
+    binlog_init(&Serial, BINLOG_MODE_TEXT);
+    hid_transport_config_t ble_config;
+    hid_transport_default_config(&ble_config, kBleDeviceName, kBleManufacturer);
+    hid_transport_init(&ble);
+    ble_link_setup();
+    if (!hid_transport_begin(&ble, &ble_config)) {
+        Serial.println("BLE init failed");
+    }
 
     button_init(&button, BTN_1);
     button_set_callback(&button, nullptr, NULL);
 
     encoder_init(&encoder, RE_CW, RE_CCW, RE_BTN);
 
+    key_matrix_init_direct(&keys, kScanPins, sizeof(kScanPins) / sizeof(kScanPins[0]), HIGH);
+    key_matrix_set_callback(&keys, keys_event, NULL);
+
+    fusion_init(&orientation, FUSION_DEFAULT_BETA);
+    gesture_init(&gesture, NULL);
+
     if (!imu_init(&imu, IMU_INT, 0x68, &Wire)) { // gonna be so honest, idk how the wire shit works; gonna pray it does
         Serial.println("IMU initialization failed!"); // if this shows, we fucked.
+    } else {
+        imu_duty_config_t duty_config;
+        imu_duty_default_config(&duty_config);
+        imu_duty_init(&imu_duty, &duty_config, true);
+        imu_stream_set_duty(&imu_stream, &imu_duty);
+        if (!imu_stream_start(&imu_stream, &imu, kImuTaskCore, kImuTaskPriority)) {
+            Serial.println("IMU stream start failed");
+        }
     }
 
-    if (!neopixel_init(&neopixel, NEO_DATA, 3)) {
+    if (!neopixel_init(&neopixel, NEO_DATA, kNeoPixelCount)) {
         Serial.println("NeoPixel init failed");
     } else {
-        neopixel_set_interval(&neopixel, 150);
+        neopixel_set_interval(&neopixel, kNeoPixelFrameMs);
+    }
+
+    hid_composer_init(&hid, ble_send_report, NULL);
+
+    keymap_output_t keymap_out = {keymap_press_fn, keymap_release_fn, keymap_tap_fn, keymap_layer_fn, NULL};
+    if (!keymap_init(&keymap, &kKeymap, &keymap_out)) {
+        Serial.println("Keymap init failed");
+    }
+    neopixel_setup();
+    input_pipeline_init(&live_inputs, &button, &encoder, &keymap, &orientation, &gesture, &kInputMap);
+    live_inputs.log_gestures = true;
+
+    trace_recorder_init(&recorder, trace_file_write, &trace_file);
+    web_setup();
+    console_targets_t console_targets = {&ble, &ble_link, &hid, &keys, &imu_duty, &idle_manager, &web};
+    console_hooks_t console_hooks = {trace_start, trace_stop, trace_replay_file, fs_format, NULL};
+    console_init(&console, &Serial, &console_targets, &console_hooks);
+
+    scheduler_init(&scheduler, NULL);
+    input_job = scheduler_add(&scheduler, "input", input_job_fn, NULL, kInputPollIntervalUs);
+    keys_job = scheduler_add(&scheduler, "keys", keys_job_fn, NULL, kKeyScanIntervalUs);
+    keymap_job = scheduler_add(&scheduler, "keymap", keymap_job_fn, NULL, 0);
+    hid_job = scheduler_add(&scheduler, "hid", hid_job_fn, NULL, 0);
+    neopixel_job = scheduler_add(&scheduler, "neopixel", neopixel_job_fn, NULL, neopixel.interval_ms * 1000);
+    scheduler_add(&scheduler, "status", status_job_fn, NULL, kStatusIntervalUs);
+    console_job = scheduler_add(&scheduler, "console", console_job_fn, NULL, kConsolePollIntervalUs);
+    if (!binlog_start(kLogTaskCore, kLogTaskPriority)) {
+        scheduler_add(&scheduler, "log", log_job_fn, NULL, kLogPollIntervalUs);
     }
+    trace_job = scheduler_add(&scheduler, "trace", trace_job_fn, NULL, kTracePollIntervalUs);
+    if (web_ready) {
+        web_job = scheduler_add(&scheduler, "web", web_job_fn, NULL, kWebPollIntervalUs);
+    }
+    ble_job = scheduler_add(&scheduler, "ble", ble_job_fn, NULL, 0);
+    ble_link_start(&ble_link);
+    scheduler_schedule_in(&scheduler, ble_job, 0);
+    input_event_set_notify(wake_input_job, &scheduler);
+    idle_setup();
 }
 
 void loop() {
-    button_process(&button);
-
-    uint32_t now = millis();
-    bool encoder_button_pressed = (digitalRead(static_cast<int>(encoder.pin_btn)) == LOW);
-    if (encoder_button_pressed && !encoder_button_was_pressed && (now - last_gate_toggle_ms) >= kGateToggleDebounceMs) {
-        bool next_state = !keyboard_gate_last_state;
-        keyboard_gate_active = next_state;
-        keyboard_gate_last_state = next_state;
-        encoder_set_position(&encoder, 0);
-        last_gate_toggle_ms = now;
-        apply_key_hold('W', false, w_hold_active);
-        apply_key_hold('S', false, s_hold_active);
-        Serial.printf("Keyboard gate %s\n", keyboard_gate_active ? "ENABLED" : "DISABLED");
-    }
-    encoder_button_was_pressed = encoder_button_pressed;
-
-    int32_t encoder_pos = encoder_get_position(&encoder);
-    bool want_w = keyboard_gate_active && (encoder_pos >= kEncoderDeadband);
-    bool want_s = keyboard_gate_active && (encoder_pos <= -kEncoderDeadband);
-    if (want_w && want_s) {
-        want_w = false;
-        want_s = false;
-    }
-    apply_key_hold('W', want_w, w_hold_active);
-    apply_key_hold('S', want_s, s_hold_active);
-
-    bool action_button_down = button_read(&button);
-    if (action_button_down) {
-        if ((now - last_button_a_emit_ms) >= kButtonRepeatIntervalMs) {
-            send_key_press('D');
-            last_button_a_emit_ms = now;
-        }
-    } else {
-        last_button_a_emit_ms = now;
-    }
-
-    static uint32_t last_print = 0;
-    if (millis() - last_print > 1000) { // 500 ms intervals
-        int32_t pos = encoder_pos;
-        bool buttonStatus = action_button_down;
-        // imu_data_t data;
-        // uint16_t neo_pixel = 0;
-        // uint8_t neo_color_index = 0;
-        // uint32_t neo_interval_ms = 0;
-        // bool neo_ready = false;
-        // neopixel_get_state(&neopixel, &neo_pixel, &neo_color_index, &neo_interval_ms, &neo_ready);
-        // const char* neo_color_name = neopixel_color_name(neo_color_index);
-        bool ble_connected = bleKeyboard.isConnected();
-
-        // if (imu_read(&imu, &data)) {
-            Serial.printf(
-                "Enc:%ld | Btn:%d | KeyGate:%d | BLE:%s\n",
-                pos, buttonStatus,
-                // "Enc:%ld | Btn:%d | KeyGate:%d | Accel: X=%.2fg Y=%.2fg Z=%.2fg | Gyro: X=%.2f°/s Y=%.2f°/s Z=%.2f°/s | Temp:%.1f°C | Neo:%s Pix:%u Color:%s(%u) Interval:%lums | BLE:%s\n",
-                // pos, down,
-                keyboard_gate_active,
-                // data.accel_x, data.accel_y, data.accel_z,
-                // data.gyro_x, data.gyro_y, data.gyro_z,
-                // data.temp,
-                // neo_ready ? "OK" : "ERR",
-                // neo_ready ? neo_pixel : 0,
-                // neo_color_name,
-                // neo_color_index,
-                // static_cast<unsigned long>(neo_interval_ms),
-                ble_connected ? "CONNECTED" : "OFFLINE");
-        // }
-        last_print = millis();
-    }
-
-    neopixel_process(&neopixel);
-
-    delay(5);
-}
\ No newline at end of file
+    scheduler_run(&scheduler);
+}
+
+#endif  // !PIO_UNIT_TESTING
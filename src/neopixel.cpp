@@ -2,21 +2,185 @@
 
 #include <new>
 
-namespace {
-struct rgb_color {
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-};
+#if NEOPIXEL_RMT
 
-static const rgb_color kRgbSequence[] = {
-    {255, 0, 0},  // Red
-    {0, 255, 0},  // Green
-    {0, 0, 255}   // Blue
-};
-static constexpr uint8_t kColorCount = sizeof(kRgbSequence) / sizeof(kRgbSequence[0]);
+static_assert(sizeof(rmt_item32_t) == sizeof(ws2812_symbol_t), "RMT items must match ws2812 symbols");
+
+// The tx-end callback is shared by all RMT channels; one strip drives it
+static neopixel_t* rmt_owner = nullptr;
+
+static void IRAM_ATTR __neopixel_tx_end(rmt_channel_t channel, void* arg) {
+    neopixel_t* neo = static_cast<neopixel_t*>(arg);
+    if (neo == nullptr || channel != NEOPIXEL_RMT_CHANNEL) {
+        return;
+    }
+    neo->busy = false;
+    if (neo->on_done != nullptr) {
+        neo->on_done(neo->done_ctx);
+    }
+}
+
+static void __neopixel_mark_stale(neopixel_t* neo, uint16_t first, uint16_t end) {
+    for (uint8_t i = 0; i < 2; i++) {
+        if (neo->stale_first[i] == neo->stale_end[i]) {
+            neo->stale_first[i] = first;
+            neo->stale_end[i] = end;
+            continue;
+        }
+        if (first < neo->stale_first[i]) {
+            neo->stale_first[i] = first;
+        }
+        if (end > neo->stale_end[i]) {
+            neo->stale_end[i] = end;
+        }
+    }
+}
+
+// Brings the back buffer up to date with the compositor output
+static void __neopixel_encode(neopixel_t* neo) {
+    uint8_t back = neo->back;
+    ws2812_encode(&neo->encoder, neo->leds.out, neo->stale_first[back], neo->stale_end[back], neo->symbols[back]);
+    neo->stale_first[back] = 0;
+    neo->stale_end[back] = 0;
+}
+
+// Hands the back buffer to the RMT and swaps; false if the line is still busy
+static bool __neopixel_send(neopixel_t* neo) {
+    if (neo->busy) {
+        return false;
+    }
+    uint8_t back = neo->back;
+    neo->busy = true;
+    esp_err_t err = rmt_write_items(NEOPIXEL_RMT_CHANNEL, reinterpret_cast<const rmt_item32_t*>(neo->symbols[back]),
+                                    (int)ws2812_frame_symbols(neo->count), false);
+    if (err != ESP_OK) {
+        neo->busy = false;
+        return false;
+    }
+    neo->back = back ^ 1;
+    neo->pending = false;
+    neo->shows++;
+    return true;
+}
+
+static void __neopixel_free(neopixel_t* neo) {
+    for (uint8_t i = 0; i < 2; i++) {
+        free(neo->symbols[i]);
+        neo->symbols[i] = nullptr;
+    }
+}
+
+static bool __neopixel_start(neopixel_t* neo) {
+    if (rmt_owner != nullptr && rmt_owner != neo) {
+        return false;
+    }
+    if (!ws2812_encoder_init(&neo->encoder, &WS2812_TIMING_DEFAULT, NEOPIXEL_RMT_TICK_NS)) {
+        return false;
+    }
+
+    size_t symbols = ws2812_frame_symbols(neo->count);
+    for (uint8_t i = 0; i < 2; i++) {
+        neo->symbols[i] = static_cast<ws2812_symbol_t*>(malloc(symbols * sizeof(ws2812_symbol_t)));
+        if (neo->symbols[i] == nullptr) {
+            __neopixel_free(neo);
+            return false;
+        }
+        ws2812_frame_init(&neo->encoder, neo->count, neo->symbols[i]);
+        neo->stale_first[i] = 0;
+        neo->stale_end[i] = 0;
+    }
+    neo->back = 0;
+    neo->pending = false;
+    neo->busy = false;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX(static_cast<gpio_num_t>(neo->pin), NEOPIXEL_RMT_CHANNEL);
+    config.clk_div = NEOPIXEL_RMT_CLK_DIV;
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(NEOPIXEL_RMT_CHANNEL, 0, 0) != ESP_OK) {
+        __neopixel_free(neo);
+        return false;
+    }
+    rmt_owner = neo;
+    rmt_register_tx_end_callback(__neopixel_tx_end, neo);
+
+    // Blank the strip, as the bit-banged output does with clear() + show()
+    neo->ready = true;
+    __neopixel_send(neo);
+    return true;
+}
+
+static void __neopixel_stop(neopixel_t* neo) {
+    if (!neo->ready) {
+        return;
+    }
+    rmt_wait_tx_done(NEOPIXEL_RMT_CHANNEL, portMAX_DELAY);
+    neo->busy = false;
+    ws2812_frame_init(&neo->encoder, neo->count, neo->symbols[neo->back]);
+    rmt_write_items(NEOPIXEL_RMT_CHANNEL, reinterpret_cast<const rmt_item32_t*>(neo->symbols[neo->back]),
+                    (int)ws2812_frame_symbols(neo->count), true);
+    rmt_register_tx_end_callback(nullptr, nullptr);
+    rmt_driver_uninstall(NEOPIXEL_RMT_CHANNEL);
+    rmt_owner = nullptr;
+    neo->ready = false;
+    __neopixel_free(neo);
+}
+
+static inline bool __neopixel_ready(const neopixel_t* neo) {
+    return neo->ready;
 }
 
+static void __neopixel_show(neopixel_t* neo) {
+    led_compositor_t* leds = &neo->leds;
+    __neopixel_mark_stale(neo, leds->dirty_first, leds->dirty_end);
+    __neopixel_encode(neo);
+    neo->pending = true;
+    if (!__neopixel_send(neo)) {
+        neo->deferred++;
+    }
+}
+
+#else
+
+static bool __neopixel_start(neopixel_t* neo) {
+    neo->strip = new (std::nothrow) Adafruit_NeoPixel(neo->count, static_cast<int16_t>(neo->pin), NEO_GRB + NEO_KHZ800);
+    if (neo->strip == nullptr) {
+        return false;
+    }
+
+    neo->strip->begin();
+    neo->strip->clear();
+    neo->strip->show();
+    return true;
+}
+
+static void __neopixel_stop(neopixel_t* neo) {
+    if (neo->strip == nullptr) {
+        return;
+    }
+    neo->strip->clear();
+    neo->strip->show();
+    delete neo->strip;
+    neo->strip = nullptr;
+}
+
+static inline bool __neopixel_ready(const neopixel_t* neo) {
+    return neo->strip != nullptr;
+}
+
+static void __neopixel_show(neopixel_t* neo) {
+    led_compositor_t* leds = &neo->leds;
+    for (uint16_t i = leds->dirty_first; i < leds->dirty_end; i++) {
+        const led_rgb_t& color = leds->out[i];
+        neo->strip->setPixelColor(i, color.r, color.g, color.b);
+    }
+    neo->strip->show();
+    neo->shows++;
+    if (neo->on_done != nullptr) {
+        neo->on_done(neo->done_ctx);
+    }
+}
+
+#endif  // NEOPIXEL_RMT
+
 bool neopixel_init(neopixel_t* neo, pin_t pin, uint16_t count) {
     if (neo == nullptr || count == 0) {
         return false;
@@ -28,18 +192,20 @@ bool neopixel_init(neopixel_t* neo, pin_t pin, uint16_t count) {
     neo->count = count;
     neo->interval_ms = NEOPIXEL_DEFAULT_INTERVAL_MS;
     neo->last_update_ms = 0;
-    neo->active_pixel = 0;
-    neo->color_index = 0;
 
-    neo->strip = new (std::nothrow) Adafruit_NeoPixel(count, static_cast<int16_t>(pin), NEO_GRB + NEO_KHZ800);
-    if (neo->strip == nullptr) {
+    if (!led_compositor_init(&neo->leds, count)) {
         return false;
     }
 
-    neo->strip->begin();
-    neo->strip->clear();
-    neo->strip->show();
+    if (!__neopixel_start(neo)) {
+        led_compositor_free(&neo->leds);
+        return false;
+    }
 
+    // The blanking frame sent by the start does not count
+    neo->shows = 0;
+    neo->skipped = 0;
+    neo->deferred = 0;
     return true;
 }
 
@@ -54,58 +220,91 @@ void neopixel_set_interval(neopixel_t* neo, uint32_t interval_ms) {
 }
 
 void neopixel_process(neopixel_t* neo) {
-    if (neo == nullptr || neo->strip == nullptr) {
+    if (neo == nullptr || !__neopixel_ready(neo)) {
         return;
     }
 
+    neopixel_flush(neo);
+
     uint32_t now = millis();
     if (now - neo->last_update_ms < neo->interval_ms) {
         return;
     }
-    neo->last_update_ms = now;
 
-    const rgb_color& color = kRgbSequence[neo->color_index];
-    neo->strip->clear();
-    neo->strip->setPixelColor(neo->active_pixel, color.r, color.g, color.b);
-    neo->strip->show();
+    neopixel_step(neo);
+}
 
-    neo->active_pixel = (neo->active_pixel + 1) % neo->count;
-    if (neo->active_pixel == 0) {
-        neo->color_index = (neo->color_index + 1) % kColorCount;
+void neopixel_step(neopixel_t* neo) {
+    if (neo == nullptr || !__neopixel_ready(neo)) {
+        return;
     }
-}
 
-void neopixel_shutdown(neopixel_t* neo) {
-    if (neo == nullptr) {
+    neo->last_update_ms = millis();
+
+    led_compositor_t* leds = &neo->leds;
+    if (!led_compositor_compose(leds, neo->last_update_ms)) {
+        neo->skipped++;
+        neopixel_flush(neo);
         return;
     }
-    if (neo->strip != nullptr) {
-        neo->strip->clear();
-        neo->strip->show();
-        delete neo->strip;
-        neo->strip = nullptr;
+
+    __neopixel_show(neo);
+}
+
+void neopixel_flush(neopixel_t* neo) {
+#if NEOPIXEL_RMT
+    if (neo == nullptr || !neo->ready || !neo->pending) {
+        return;
     }
+    __neopixel_send(neo);
+#endif
+}
+
+bool neopixel_busy(const neopixel_t* neo) {
+#if NEOPIXEL_RMT
+    return neo != nullptr && neo->busy;
+#else
+    return false;
+#endif
 }
 
-void neopixel_get_state(const neopixel_t* neo,
-                        uint16_t* active_pixel,
-                        uint8_t* color_index,
-                        uint32_t* interval_ms,
-                        bool* initialized) {
-    if (initialized != nullptr) {
-        bool ready = (neo != nullptr && neo->strip != nullptr);
-        *initialized = ready;
+void neopixel_set_done_callback(neopixel_t* neo, neopixel_done_fn fn, void* ctx) {
+    if (neo == nullptr) {
+        return;
     }
+    neo->on_done = nullptr;
+    neo->done_ctx = ctx;
+    neo->on_done = fn;
+}
+
+void neopixel_invalidate(neopixel_t* neo) {
     if (neo == nullptr) {
         return;
     }
-    if (active_pixel != nullptr) {
-        *active_pixel = neo->active_pixel;
+    led_compositor_invalidate(&neo->leds);
+}
+
+void neopixel_shutdown(neopixel_t* neo) {
+    if (neo == nullptr) {
+        return;
     }
-    if (color_index != nullptr) {
-        *color_index = neo->color_index;
+    __neopixel_stop(neo);
+    led_compositor_free(&neo->leds);
+}
+
+void neopixel_get_stats(const neopixel_t* neo, neopixel_stats_t* stats) {
+    if (stats == nullptr) {
+        return;
     }
-    if (interval_ms != nullptr) {
-        *interval_ms = neo->interval_ms;
+    memset(stats, 0, sizeof(*stats));
+    if (neo == nullptr) {
+        return;
     }
+    stats->initialized = __neopixel_ready(neo);
+    stats->count = neo->count;
+    stats->interval_ms = neo->interval_ms;
+    stats->shows = neo->shows;
+    stats->skipped = neo->skipped;
+    stats->deferred = neo->deferred;
+    stats->busy = neopixel_busy(neo);
 }
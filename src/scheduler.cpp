@@ -0,0 +1,246 @@
+#include "scheduler.h"
+
+#define SCHEDULER_NO_DEADLINE   UINT32_MAX
+
+static uint32_t __scheduler_micros(void) {
+    return micros();
+}
+
+// esp_timer task: the deadline passed
+static void __scheduler_timer_expired(void* arg) {
+    xTaskNotifyGive(static_cast<scheduler_t*>(arg)->waiter);
+}
+
+// Block on the waiter's task notification until a trigger or the
+// one-shot timer, which fires at the deadline itself rather than on the
+// RTOS tick after it
+void scheduler_wait_default(scheduler_t* sched, uint32_t timeout_us) {
+    if (timeout_us == 0) {
+        return;
+    }
+    if (timeout_us == SCHEDULER_NO_DEADLINE) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        return;
+    }
+
+    if (!sched->timer) {
+        esp_timer_create_args_t args = {};
+        args.callback = __scheduler_timer_expired;
+        args.arg = sched;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "scheduler";
+        if (esp_timer_create(&args, &sched->timer) != ESP_OK) {
+            sched->timer = NULL;
+        }
+    }
+    if (!sched->timer || esp_timer_start_once(sched->timer, timeout_us) != ESP_OK) {
+        // No timer: whole ticks, rounded up so the wait never ends early
+        TickType_t tick_us = portTICK_PERIOD_MS * 1000;
+        ulTaskNotifyTake(pdTRUE, (timeout_us + tick_us - 1) / tick_us);
+        return;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    esp_timer_stop(sched->timer);   // woken by a trigger first; fails harmlessly if it fired
+}
+
+static inline bool __scheduler_valid(const scheduler_t* sched, int job) {
+    return sched && job >= 0 && job < sched->job_count;
+}
+
+void scheduler_init(scheduler_t* sched, uint32_t (*now_us)(void)) {
+    if (!sched) {
+        return;
+    }
+    sched->job_count = 0;
+    sched->now_us = now_us ? now_us : __scheduler_micros;
+    sched->wait_us = scheduler_wait_default;
+    sched->wait_ctx = NULL;
+    sched->waiter = xTaskGetCurrentTaskHandle();
+    sched->timer = NULL;
+    sched->idle_us = 0;
+}
+
+void scheduler_set_wait(scheduler_t* sched, void (*wait_us)(scheduler_t* sched, uint32_t timeout_us), void* ctx) {
+    if (!sched) {
+        return;
+    }
+    sched->wait_us = wait_us ? wait_us : scheduler_wait_default;
+    sched->wait_ctx = ctx;
+}
+
+int scheduler_add(scheduler_t* sched, const char* name, void (*fn)(void* ctx), void* ctx, uint32_t period_us) {
+    if (!sched || !fn || sched->job_count >= SCHEDULER_MAX_JOBS) {
+        return -1;
+    }
+
+    scheduler_job_t* job = &sched->jobs[sched->job_count];
+    memset(job, 0, sizeof(*job));
+    job->name = name;
+    job->fn = fn;
+    job->ctx = ctx;
+    job->period_us = period_us;
+    job->armed = (period_us != 0);
+    job->due_us = sched->now_us();  // periodic jobs run on the first pass
+    return sched->job_count++;
+}
+
+void scheduler_trigger(scheduler_t* sched, int job) {
+    if (!__scheduler_valid(sched, job)) {
+        return;
+    }
+    scheduler_job_t* j = &sched->jobs[job];
+    if (!j->triggered) {
+        j->trigger_us = sched->now_us();
+        j->triggered = true;
+    }
+}
+
+void scheduler_trigger_from_isr(scheduler_t* sched, int job) {
+    if (!__scheduler_valid(sched, job)) {
+        return;
+    }
+    scheduler_job_t* j = &sched->jobs[job];
+    if (!j->triggered) {
+        j->trigger_us = sched->now_us();
+        j->triggered = true;
+    }
+    if (sched->waiter) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(sched->waiter, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+void scheduler_trigger_from_task(scheduler_t* sched, int job) {
+    scheduler_trigger(sched, job);
+    if (__scheduler_valid(sched, job) && sched->waiter) {
+        xTaskNotifyGive(sched->waiter);
+    }
+}
+
+void scheduler_schedule_in(scheduler_t* sched, int job, uint32_t delay_us) {
+    if (!__scheduler_valid(sched, job)) {
+        return;
+    }
+    scheduler_job_t* j = &sched->jobs[job];
+    j->due_us = sched->now_us() + delay_us;
+    j->armed = true;
+}
+
+void scheduler_set_period(scheduler_t* sched, int job, uint32_t period_us) {
+    if (!__scheduler_valid(sched, job)) {
+        return;
+    }
+    sched->jobs[job].period_us = period_us;
+}
+
+void scheduler_cancel(scheduler_t* sched, int job) {
+    if (!__scheduler_valid(sched, job)) {
+        return;
+    }
+    sched->jobs[job].armed = false;
+    sched->jobs[job].triggered = false;
+}
+
+uint32_t scheduler_run_pending(scheduler_t* sched) {
+    if (!sched) {
+        return SCHEDULER_NO_DEADLINE;
+    }
+
+    for (uint8_t i = 0; i < sched->job_count; i++) {
+        scheduler_job_t* job = &sched->jobs[i];
+        uint32_t now = sched->now_us();
+
+        bool due = job->armed && (int32_t)(now - job->due_us) >= 0;
+        bool triggered = job->triggered;
+        if (!due && !triggered) {
+            continue;
+        }
+
+        uint32_t late = 0;
+        if (due) {
+            late = now - job->due_us;
+            if (job->period_us == 0) {
+                job->armed = false;
+            } else {
+                job->due_us += job->period_us;
+                if ((int32_t)(now - job->due_us) >= 0) {
+                    job->due_us = now + job->period_us;  // fell behind: skip missed periods
+                }
+            }
+        }
+        if (triggered) {
+            job->triggered = false;
+            uint32_t trigger_late = now - job->trigger_us;
+            if (trigger_late > late) {
+                late = trigger_late;
+            }
+        }
+
+        job->fn(job->ctx);
+
+        uint32_t run = sched->now_us() - now;
+        scheduler_job_stats_t* stats = &job->stats;
+        stats->runs++;
+        stats->last_run_us = run;
+        stats->total_run_us += run;
+        if (run > stats->max_run_us) stats->max_run_us = run;
+        stats->last_late_us = late;
+        if (late > stats->max_late_us) stats->max_late_us = late;
+    }
+
+    // Time until the earliest deadline; a trigger raised meanwhile means "now"
+    uint32_t now = sched->now_us();
+    uint32_t next = SCHEDULER_NO_DEADLINE;
+    for (uint8_t i = 0; i < sched->job_count; i++) {
+        const scheduler_job_t* job = &sched->jobs[i];
+        if (job->triggered) {
+            return 0;
+        }
+        if (!job->armed) {
+            continue;
+        }
+        int32_t remaining = (int32_t)(job->due_us - now);
+        if (remaining <= 0) {
+            return 0;
+        }
+        if ((uint32_t)remaining < next) {
+            next = (uint32_t)remaining;
+        }
+    }
+    return next;
+}
+
+void scheduler_run(scheduler_t* sched) {
+    if (!sched) {
+        return;
+    }
+
+    uint32_t timeout = scheduler_run_pending(sched);
+    if (timeout == 0) {
+        return;
+    }
+
+    uint32_t start = sched->now_us();
+    sched->wait_us(sched, timeout);
+    sched->idle_us += sched->now_us() - start;
+}
+
+const scheduler_job_stats_t* scheduler_get_stats(const scheduler_t* sched, int job) {
+    if (!__scheduler_valid(sched, job)) {
+        return NULL;
+    }
+    return &sched->jobs[job].stats;
+}
+
+void scheduler_reset_stats(scheduler_t* sched) {
+    if (!sched) {
+        return;
+    }
+    for (uint8_t i = 0; i < sched->job_count; i++) {
+        memset(&sched->jobs[i].stats, 0, sizeof(scheduler_job_stats_t));
+    }
+    sched->idle_us = 0;
+}
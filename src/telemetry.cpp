@@ -0,0 +1,147 @@
+#include "telemetry.h"
+
+#include <math.h>
+#include <string.h>
+
+static inline void __telemetry_put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static inline void __telemetry_put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static inline int16_t __telemetry_fixed(float value, float scale) {
+    float scaled = roundf(value * scale);
+    if (!(scaled > -32768.0f)) {   // also catches NaN
+        return -32768;
+    }
+    if (scaled > 32767.0f) {
+        return 32767;
+    }
+    return (int16_t)scaled;
+}
+
+static inline uint16_t __telemetry_sat16(uint32_t value) {
+    return (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+}
+
+size_t telemetry_encode_status(const telemetry_sample_t* sample, uint16_t seq, uint8_t* out) {
+    out[0] = TELEMETRY_KIND_STATUS;
+    out[1] = sample->flags;
+    __telemetry_put_u16(out + 2, seq);
+    __telemetry_put_u32(out + 4, sample->time_ms);
+    __telemetry_put_u32(out + 8, (uint32_t)sample->encoder);
+    for (uint8_t i = 0; i < 3; i++) {
+        __telemetry_put_u16(out + 12 + i * 2, (uint16_t)__telemetry_fixed(sample->accel_g[i], 1000.0f));
+        __telemetry_put_u16(out + 18 + i * 2, (uint16_t)__telemetry_fixed(sample->gyro_dps[i], 10.0f));
+    }
+    __telemetry_put_u16(out + 24, (uint16_t)__telemetry_fixed(sample->roll, 100.0f));
+    __telemetry_put_u16(out + 26, (uint16_t)__telemetry_fixed(sample->pitch, 100.0f));
+    __telemetry_put_u16(out + 28, (uint16_t)__telemetry_fixed(sample->yaw, 100.0f));
+    __telemetry_put_u16(out + 30, (uint16_t)__telemetry_fixed(sample->temp_c, 100.0f));
+    __telemetry_put_u16(out + 32, __telemetry_sat16(sample->input_late_us));
+    __telemetry_put_u16(out + 34, __telemetry_sat16(sample->input_max_late_us));
+    __telemetry_put_u16(out + 36, __telemetry_sat16(sample->input_max_run_us));
+    __telemetry_put_u16(out + 38, (uint16_t)sample->hid_sent);
+    return TELEMETRY_STATUS_SIZE;
+}
+
+size_t telemetry_encode_key(uint8_t key, uint8_t action, uint32_t time_ms, uint8_t* out) {
+    out[0] = TELEMETRY_KIND_KEY;
+    out[1] = action;
+    out[2] = key;
+    out[3] = 0;
+    __telemetry_put_u32(out + 4, time_ms);
+    return TELEMETRY_KEY_SIZE;
+}
+
+void telemetry_queue_reset(telemetry_queue_t* queue) {
+    queue->head = 0;
+    queue->count = 0;
+    queue->offset = 0;
+    memset(&queue->stats, 0, sizeof(queue->stats));
+}
+
+static inline telemetry_frame_t* __telemetry_slot(telemetry_queue_t* queue, uint8_t index) {
+    return &queue->frames[(queue->head + index) % TELEMETRY_QUEUE_CAPACITY];
+}
+
+static void __telemetry_fill(telemetry_frame_t* frame, telemetry_kind_t kind, uint8_t opcode,
+                             const uint8_t* payload, size_t len) {
+    size_t header = ws_frame_header(opcode, len, frame->data);
+    memcpy(frame->data + header, payload, len);
+    frame->len = (uint8_t)(header + len);
+    frame->kind = (uint8_t)kind;
+}
+
+// Removes the unsent frame at `index` (> 0 while the head is partly sent)
+static void __telemetry_remove(telemetry_queue_t* queue, uint8_t index) {
+    for (uint8_t i = index; i + 1 < queue->count; i++) {
+        *__telemetry_slot(queue, i) = *__telemetry_slot(queue, i + 1);
+    }
+    queue->count--;
+}
+
+bool telemetry_queue_push(telemetry_queue_t* queue, telemetry_kind_t kind, uint8_t opcode,
+                          const uint8_t* payload, size_t len) {
+    if (len > TELEMETRY_MAX_PAYLOAD) {
+        return false;
+    }
+    uint8_t first_unsent = (queue->offset > 0) ? 1 : 0;
+
+    if (kind == TELEMETRY_KIND_STATUS) {
+        for (uint8_t i = queue->count; i > first_unsent; i--) {
+            telemetry_frame_t* frame = __telemetry_slot(queue, i - 1);
+            if (frame->kind == TELEMETRY_KIND_STATUS) {
+                __telemetry_fill(frame, kind, opcode, payload, len);
+                queue->stats.coalesced++;
+                return true;
+            }
+        }
+    }
+
+    if (queue->count == TELEMETRY_QUEUE_CAPACITY) {
+        if (first_unsent == 0) {
+            queue->head = (queue->head + 1) % TELEMETRY_QUEUE_CAPACITY;
+            queue->count--;
+        } else {
+            __telemetry_remove(queue, first_unsent);
+        }
+        queue->stats.dropped++;
+    }
+
+    __telemetry_fill(__telemetry_slot(queue, queue->count), kind, opcode, payload, len);
+    queue->count++;
+    queue->stats.queued++;
+    return true;
+}
+
+size_t telemetry_queue_peek(const telemetry_queue_t* queue, const uint8_t** data) {
+    if (queue->count == 0) {
+        return 0;
+    }
+    const telemetry_frame_t* frame = &queue->frames[queue->head];
+    *data = frame->data + queue->offset;
+    return frame->len - queue->offset;
+}
+
+void telemetry_queue_consume(telemetry_queue_t* queue, size_t len) {
+    if (queue->count == 0) {
+        return;
+    }
+    const telemetry_frame_t* frame = &queue->frames[queue->head];
+    queue->stats.bytes += len;
+    if (queue->offset + len < frame->len) {
+        queue->offset = (uint8_t)(queue->offset + len);
+        return;
+    }
+    queue->offset = 0;
+    queue->head = (queue->head + 1) % TELEMETRY_QUEUE_CAPACITY;
+    queue->count--;
+    queue->stats.sent++;
+}
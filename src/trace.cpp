@@ -0,0 +1,536 @@
+#include "trace.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TRACE_IDLE_DELAY_MS     20      // writer task poll period when nothing is sealed
+#define TRACE_AXES              6
+#define TRACE_EDGE_LEVEL        0x01
+#define TRACE_EDGE_STEP         0x02
+#define TRACE_EDGE_NEGATIVE     0x04
+
+static const uint32_t kCrcNibbles[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static inline void __trace_put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static inline void __trace_put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint16_t __trace_get_u16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static inline uint32_t __trace_get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static inline size_t __trace_put_varint(uint8_t* out, uint32_t value) {
+    size_t len = 0;
+    while (value >= 0x80) {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+}
+
+static inline size_t __trace_put_signed(uint8_t* out, int32_t value) {
+    return __trace_put_varint(out, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+// Bounds-checked cursor over a chunk payload
+static bool __trace_get_varint(const uint8_t* in, uint16_t length, uint16_t* offset, uint32_t* value) {
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (*offset >= length) {
+            return false;
+        }
+        uint8_t byte = in[(*offset)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool __trace_get_signed(const uint8_t* in, uint16_t length, uint16_t* offset, int32_t* value) {
+    uint32_t raw;
+    if (!__trace_get_varint(in, length, offset, &raw)) {
+        return false;
+    }
+    *value = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+    return true;
+}
+
+static int16_t __trace_quantize(float value, float scale) {
+    float raw = roundf(value * scale);
+    if (raw > 32767.0f) return 32767;
+    if (raw < -32768.0f) return -32768;
+    return (int16_t)raw;
+}
+
+static void __trace_codec_reset(trace_codec_t* codec, uint32_t base_us) {
+    codec->last_us = base_us;
+    memset(codec->last_imu, 0, sizeof(codec->last_imu));
+}
+
+static size_t __trace_put_time(trace_codec_t* codec, uint8_t* out, uint32_t timestamp_us) {
+    // Records arrive in processing order, so the time may step backwards
+    size_t len = __trace_put_signed(out, (int32_t)(timestamp_us - codec->last_us));
+    codec->last_us = timestamp_us;
+    return len;
+}
+
+// All six axes in sensor LSBs
+static void __trace_axes(const imu_sample_t* sample, int16_t* axes) {
+    axes[0] = __trace_quantize(sample->data.accel_x, TRACE_ACCEL_LSB_PER_G);
+    axes[1] = __trace_quantize(sample->data.accel_y, TRACE_ACCEL_LSB_PER_G);
+    axes[2] = __trace_quantize(sample->data.accel_z, TRACE_ACCEL_LSB_PER_G);
+    axes[3] = __trace_quantize(sample->data.gyro_x, TRACE_GYRO_LSB_PER_DPS);
+    axes[4] = __trace_quantize(sample->data.gyro_y, TRACE_GYRO_LSB_PER_DPS);
+    axes[5] = __trace_quantize(sample->data.gyro_z, TRACE_GYRO_LSB_PER_DPS);
+}
+
+static size_t __trace_encode(trace_codec_t* codec, const trace_record_t* record, uint8_t* out) {
+    size_t len = 0;
+    out[len++] = record->type;
+    len += __trace_put_time(codec, out + len, record->timestamp_us);
+
+    switch (record->type) {
+        case TRACE_REC_EDGE:
+        case TRACE_REC_SYNC: {
+            uint8_t bits = record->edge.level ? TRACE_EDGE_LEVEL : 0;
+            if (record->edge.delta != 0) {
+                bits |= TRACE_EDGE_STEP;
+                if (record->edge.delta < 0) bits |= TRACE_EDGE_NEGATIVE;
+            }
+            out[len++] = record->edge.pin;
+            out[len++] = bits;
+            break;
+        }
+        case TRACE_REC_IMU: {
+            uint8_t flags = record->imu.flags & (IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID);
+            out[len++] = flags;
+            int16_t axes[TRACE_AXES];
+            __trace_axes(&record->imu, axes);
+            for (uint8_t i = 0; i < TRACE_AXES; i++) {
+                uint8_t group = (i < 3) ? IMU_SAMPLE_ACCEL_VALID : IMU_SAMPLE_GYRO_VALID;
+                if (!(flags & group)) continue;
+                len += __trace_put_signed(out + len, (int32_t)axes[i] - codec->last_imu[i]);
+                codec->last_imu[i] = axes[i];
+            }
+            break;
+        }
+        case TRACE_REC_KEY:
+            out[len++] = record->key.key;
+            out[len++] = record->key.action;
+            break;
+        default:
+            break;
+    }
+    return len;
+}
+
+static bool __trace_decode(trace_codec_t* codec, const uint8_t* in, uint16_t length, uint16_t* offset,
+                           trace_record_t* record) {
+    if (*offset >= length) {
+        return false;
+    }
+    memset(record, 0, sizeof(*record));
+    record->type = in[(*offset)++];
+
+    int32_t delta;
+    if (!__trace_get_signed(in, length, offset, &delta)) {
+        return false;
+    }
+    codec->last_us += (uint32_t)delta;
+    record->timestamp_us = codec->last_us;
+
+    switch (record->type) {
+        case TRACE_REC_EDGE:
+        case TRACE_REC_SYNC: {
+            if (*offset + 2 > length) {
+                return false;
+            }
+            uint8_t bits;
+            record->edge.pin = in[(*offset)++];
+            bits = in[(*offset)++];
+            record->edge.level = (bits & TRACE_EDGE_LEVEL) ? HIGH : LOW;
+            if (bits & TRACE_EDGE_STEP) {
+                record->edge.delta = (bits & TRACE_EDGE_NEGATIVE) ? -1 : 1;
+            }
+            record->edge.timestamp_us = record->timestamp_us;
+            return true;
+        }
+        case TRACE_REC_IMU: {
+            if (*offset >= length) {
+                return false;
+            }
+            uint8_t flags = in[(*offset)++];
+            for (uint8_t i = 0; i < TRACE_AXES; i++) {
+                uint8_t group = (i < 3) ? IMU_SAMPLE_ACCEL_VALID : IMU_SAMPLE_GYRO_VALID;
+                if (!(flags & group)) continue;
+                if (!__trace_get_signed(in, length, offset, &delta)) {
+                    return false;
+                }
+                codec->last_imu[i] = (int16_t)(codec->last_imu[i] + delta);
+            }
+            imu_data_t* data = &record->imu.data;
+            data->accel_x = codec->last_imu[0] / TRACE_ACCEL_LSB_PER_G;
+            data->accel_y = codec->last_imu[1] / TRACE_ACCEL_LSB_PER_G;
+            data->accel_z = codec->last_imu[2] / TRACE_ACCEL_LSB_PER_G;
+            data->gyro_x = codec->last_imu[3] / TRACE_GYRO_LSB_PER_DPS;
+            data->gyro_y = codec->last_imu[4] / TRACE_GYRO_LSB_PER_DPS;
+            data->gyro_z = codec->last_imu[5] / TRACE_GYRO_LSB_PER_DPS;
+            record->imu.flags = flags;
+            record->imu.timestamp_us = record->timestamp_us;
+            return true;
+        }
+        case TRACE_REC_KEY:
+            if (*offset + 2 > length) {
+                return false;
+            }
+            record->key.key = in[(*offset)++];
+            record->key.action = in[(*offset)++];
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t trace_crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ kCrcNibbles[crc & 0x0F];
+        crc = (crc >> 4) ^ kCrcNibbles[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// Producer side ------------------------------------------------------------
+
+static void __trace_seal(trace_recorder_t* rec) {
+    uint32_t sealed = rec->sealed.load(std::memory_order_relaxed);
+    uint8_t* chunk = rec->chunks[sealed % TRACE_CHUNK_SLOTS];
+    uint8_t* payload = chunk + TRACE_CHUNK_HEADER_SIZE;
+    __trace_put_u32(chunk, TRACE_CHUNK_MAGIC);
+    __trace_put_u16(chunk + 4, rec->fill);
+    __trace_put_u16(chunk + 6, rec->count);
+    __trace_put_u32(chunk + 8, rec->base_us);
+    __trace_put_u32(chunk + 12, trace_crc32(payload, rec->fill));
+    rec->sealed.store(sealed + 1, std::memory_order_release);
+    rec->fill = 0;
+    rec->count = 0;
+}
+
+// The active slot is still owned by the writer when every slot is sealed
+static bool __trace_slot_free(const trace_recorder_t* rec) {
+    uint32_t sealed = rec->sealed.load(std::memory_order_relaxed);
+    uint32_t written = rec->written.load(std::memory_order_acquire);
+    return (uint32_t)(sealed - written) < TRACE_CHUNK_SLOTS;
+}
+
+static void __trace_append(trace_recorder_t* rec, const trace_record_t* record) {
+    if (!rec || !rec->active) {
+        return;
+    }
+    if (!__trace_slot_free(rec)) {
+        rec->stats.dropped++;
+        return;
+    }
+
+    uint8_t encoded[TRACE_RECORD_MAX];
+    trace_codec_t codec = rec->codec;
+    if (rec->count == 0) {
+        rec->base_us = record->timestamp_us;
+        __trace_codec_reset(&codec, rec->base_us);
+    }
+    size_t len = __trace_encode(&codec, record, encoded);
+
+    if (rec->fill + len > TRACE_CHUNK_PAYLOAD) {
+        __trace_seal(rec);
+        if (!__trace_slot_free(rec)) {
+            rec->stats.dropped++;
+            return;
+        }
+        rec->base_us = record->timestamp_us;
+        __trace_codec_reset(&codec, rec->base_us);
+        len = __trace_encode(&codec, record, encoded);
+    }
+
+    uint8_t* payload = rec->chunks[rec->sealed.load(std::memory_order_relaxed) % TRACE_CHUNK_SLOTS] +
+                       TRACE_CHUNK_HEADER_SIZE;
+    memcpy(payload + rec->fill, encoded, len);
+    rec->fill += len;
+    rec->count++;
+    rec->codec = codec;
+    rec->stats.records++;
+}
+
+static void __trace_task(void* ctx) {
+    trace_recorder_t* rec = static_cast<trace_recorder_t*>(ctx);
+    for (;;) {
+        if (trace_recorder_service(rec) == 0) {
+            vTaskDelay(pdMS_TO_TICKS(TRACE_IDLE_DELAY_MS));
+        }
+    }
+}
+
+void trace_recorder_init(trace_recorder_t* rec, bool (*sink)(void* ctx, const uint8_t* data, size_t len), void* ctx) {
+    if (!rec) {
+        return;
+    }
+    rec->fill = 0;
+    rec->count = 0;
+    rec->base_us = 0;
+    __trace_codec_reset(&rec->codec, 0);
+    rec->sealed.store(0);
+    rec->written.store(0);
+    rec->header_written = false;
+    rec->active = false;
+    rec->sink = sink;
+    rec->sink_ctx = ctx;
+    rec->task = NULL;
+    memset(&rec->stats, 0, sizeof(rec->stats));
+}
+
+bool trace_recorder_start(trace_recorder_t* rec, uint8_t core, uint8_t priority) {
+    if (!rec || !rec->sink) {
+        return false;
+    }
+    if (rec->active) {
+        return rec->task != NULL;
+    }
+    // The counters keep running across sessions; the writer is idle because
+    // the previous stop() drained it
+    rec->fill = 0;
+    rec->count = 0;
+    rec->header_written = false;
+    memset(&rec->stats, 0, sizeof(rec->stats));
+    rec->active = true;
+
+    if (rec->task) {
+        return true;
+    }
+    if (xTaskCreatePinnedToCore(__trace_task, "trace", TRACE_STACK_SIZE, rec,
+                                priority, &rec->task, core) != pdPASS) {
+        rec->task = NULL;
+        return false;
+    }
+    return true;
+}
+
+void trace_recorder_stop(trace_recorder_t* rec) {
+    if (!rec || !rec->active) {
+        return;
+    }
+    rec->active = false;
+    if (rec->count > 0) {
+        __trace_seal(rec);
+    }
+    while (rec->written.load(std::memory_order_acquire) != rec->sealed.load(std::memory_order_relaxed)) {
+        if (rec->task) {
+            vTaskDelay(1);
+        } else {
+            trace_recorder_service(rec);
+        }
+    }
+}
+
+size_t trace_recorder_service(trace_recorder_t* rec) {
+    if (!rec || !rec->sink) {
+        return 0;
+    }
+
+    size_t chunks = 0;
+    uint32_t written = rec->written.load(std::memory_order_relaxed);
+    while (written != rec->sealed.load(std::memory_order_acquire)) {
+        if (!rec->header_written) {
+            uint8_t header[TRACE_FILE_HEADER_SIZE];
+            __trace_put_u32(header, TRACE_FILE_MAGIC);
+            __trace_put_u16(header + 4, TRACE_VERSION);
+            __trace_put_u16(header + 6, 0);
+            if (!rec->sink(rec->sink_ctx, header, sizeof(header))) {
+                rec->stats.write_errors++;
+            }
+            rec->stats.bytes += sizeof(header);
+            rec->header_written = true;
+        }
+
+        const uint8_t* chunk = rec->chunks[written % TRACE_CHUNK_SLOTS];
+        size_t len = TRACE_CHUNK_HEADER_SIZE + __trace_get_u16(chunk + 4);
+        if (!rec->sink(rec->sink_ctx, chunk, len)) {
+            rec->stats.write_errors++;
+        }
+        rec->stats.chunks++;
+        rec->stats.bytes += len;
+        written++;
+        rec->written.store(written, std::memory_order_release);
+        chunks++;
+    }
+    return chunks;
+}
+
+void trace_record_edge(trace_recorder_t* rec, const input_event_t* event) {
+    if (!rec || !rec->active || !event) {
+        return;
+    }
+    trace_record_t record;
+    record.type = TRACE_REC_EDGE;
+    record.timestamp_us = event->timestamp_us;
+    record.edge = *event;
+    __trace_append(rec, &record);
+}
+
+void trace_record_sync(trace_recorder_t* rec, uint32_t timestamp_us, uint8_t pin, uint8_t level) {
+    if (!rec || !rec->active) {
+        return;
+    }
+    trace_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.type = TRACE_REC_SYNC;
+    record.timestamp_us = timestamp_us;
+    record.edge.timestamp_us = timestamp_us;
+    record.edge.pin = pin;
+    record.edge.level = level;
+    __trace_append(rec, &record);
+}
+
+void trace_record_imu(trace_recorder_t* rec, const imu_sample_t* sample) {
+    if (!rec || !rec->active || !sample) {
+        return;
+    }
+    trace_record_t record;
+    record.type = TRACE_REC_IMU;
+    record.timestamp_us = sample->timestamp_us;
+    record.imu = *sample;
+    __trace_append(rec, &record);
+}
+
+void trace_record_key(trace_recorder_t* rec, uint32_t timestamp_us, uint8_t key, trace_key_action_t action) {
+    if (!rec || !rec->active) {
+        return;
+    }
+    trace_record_t record;
+    record.type = TRACE_REC_KEY;
+    record.timestamp_us = timestamp_us;
+    record.key.key = key;
+    record.key.action = (uint8_t)action;
+    __trace_append(rec, &record);
+}
+
+// Consumer side ------------------------------------------------------------
+
+static bool __trace_read_exact(trace_reader_t* reader, uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t n = reader->read(reader->read_ctx, data, len);
+        if (n == 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Reads chunks until one passes its checks; false at the end of the source
+static bool __trace_next_chunk(trace_reader_t* reader) {
+    uint8_t header[TRACE_CHUNK_HEADER_SIZE];
+    if (!__trace_read_exact(reader, header, sizeof(header))) {
+        return false;
+    }
+    bool scanning = false;
+    for (;;) {
+        if (__trace_get_u32(header) != TRACE_CHUNK_MAGIC ||
+            __trace_get_u16(header + 4) > TRACE_CHUNK_PAYLOAD) {
+            // Slide one byte and look for the next magic
+            if (!scanning) {
+                scanning = true;
+                reader->bad_chunks++;
+            }
+            memmove(header, header + 1, sizeof(header) - 1);
+            if (!__trace_read_exact(reader, &header[sizeof(header) - 1], 1)) {
+                return false;
+            }
+            continue;
+        }
+
+        scanning = false;
+        uint16_t length = __trace_get_u16(header + 4);
+        if (!__trace_read_exact(reader, reader->chunk, length)) {
+            reader->bad_chunks++;
+            return false;
+        }
+        if (trace_crc32(reader->chunk, length) == __trace_get_u32(header + 12)) {
+            reader->length = length;
+            reader->offset = 0;
+            reader->remaining = __trace_get_u16(header + 6);
+            __trace_codec_reset(&reader->codec, __trace_get_u32(header + 8));
+            return true;
+        }
+        reader->bad_chunks++;
+        if (!__trace_read_exact(reader, header, sizeof(header))) {
+            return false;
+        }
+    }
+}
+
+void trace_reader_init(trace_reader_t* reader, size_t (*read)(void* ctx, uint8_t* data, size_t len), void* ctx) {
+    if (!reader) {
+        return;
+    }
+    reader->read = read;
+    reader->read_ctx = ctx;
+    reader->length = 0;
+    reader->offset = 0;
+    reader->remaining = 0;
+    __trace_codec_reset(&reader->codec, 0);
+    reader->bad_chunks = 0;
+    reader->header_checked = false;
+    reader->ended = (read == NULL);
+}
+
+bool trace_reader_next(trace_reader_t* reader, trace_record_t* record) {
+    if (!reader || !record || reader->ended) {
+        return false;
+    }
+
+    if (!reader->header_checked) {
+        uint8_t header[TRACE_FILE_HEADER_SIZE];
+        reader->header_checked = true;
+        if (!__trace_read_exact(reader, header, sizeof(header)) ||
+            __trace_get_u32(header) != TRACE_FILE_MAGIC ||
+            __trace_get_u16(header + 4) != TRACE_VERSION) {
+            reader->ended = true;
+            return false;
+        }
+    }
+
+    for (;;) {
+        if (reader->remaining > 0) {
+            if (__trace_decode(&reader->codec, reader->chunk, reader->length, &reader->offset, record)) {
+                reader->remaining--;
+                return true;
+            }
+            reader->bad_chunks++;  // CRC matched but the contents do not parse
+            reader->remaining = 0;
+        }
+        if (!__trace_next_chunk(reader)) {
+            reader->ended = true;
+            return false;
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#include "trace_replay.h"
+
+#include <string.h>
+
+static void __trace_replay_compare(trace_replay_t* replay, const trace_key_t* a, const trace_key_t* b) {
+    if (a->key != b->key || a->action != b->action) {
+        replay->result.mismatched++;
+    }
+}
+
+static void __trace_replay_emit(trace_replay_t* replay, uint8_t key, trace_key_action_t action) {
+    trace_key_t produced = {key, static_cast<uint8_t>(action)};
+    trace_key_t recorded;
+    if (spsc_ring_pop(&replay->recorded, &recorded)) {
+        __trace_replay_compare(replay, &recorded, &produced);
+    } else if (!spsc_ring_push(&replay->produced, produced)) {
+        replay->result.extra++;
+    }
+}
+
+static void __trace_replay_tap(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp) {
+    __trace_replay_emit(static_cast<trace_replay_t*>(ctx), key, TRACE_KEY_TAP);
+}
+
+static void __trace_replay_press(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp) {
+    __trace_replay_emit(static_cast<trace_replay_t*>(ctx), key, TRACE_KEY_PRESS);
+}
+
+static void __trace_replay_release(void* ctx, uint8_t key) {
+    __trace_replay_emit(static_cast<trace_replay_t*>(ctx), key, TRACE_KEY_RELEASE);
+}
+
+static void __trace_replay_check(trace_replay_t* replay, const trace_key_t* recorded) {
+    replay->result.keys++;
+    trace_key_t produced;
+    if (spsc_ring_pop(&replay->produced, &produced)) {
+        __trace_replay_compare(replay, recorded, &produced);
+    } else if (!spsc_ring_push(&replay->recorded, *recorded)) {
+        replay->result.missing++;
+    }
+}
+
+static bool __trace_replay_reset(trace_replay_t* replay, const trace_replay_config_t* config) {
+    button_reset(&replay->button, config->button_pin, LOW, 0);
+    encoder_reset(&replay->encoder, config->encoder_pin_a, config->encoder_pin_b, config->encoder_pin_btn, 0, HIGH);
+    keymap_output_t out = {__trace_replay_press, __trace_replay_release, __trace_replay_tap, NULL, replay};
+    if (!keymap_init(&replay->keymap, config->keymap, &out)) {
+        return false;
+    }
+    fusion_init(&replay->orientation, FUSION_DEFAULT_BETA);
+    gesture_init(&replay->gesture, NULL);
+    input_pipeline_init(&replay->inputs, &replay->button, &replay->encoder, &replay->keymap,
+                        &replay->orientation, &replay->gesture, config->map);
+    input_pipeline_resync(&replay->inputs);
+
+    spsc_ring_reset(&replay->produced);
+    spsc_ring_reset(&replay->recorded);
+    memset(&replay->result, 0, sizeof(replay->result));
+    return true;
+}
+
+static void __trace_replay_sync(trace_replay_t* replay, const input_event_t* event) {
+    encoder_t* enc = &replay->encoder;
+    if (event->pin == replay->button.pin) {
+        button_reset(&replay->button, replay->button.pin, event->level, event->timestamp_us);
+    } else if (event->pin == enc->pin_btn) {
+        encoder_reset(enc, enc->pin_a, enc->pin_b, enc->pin_btn, 0, event->level);
+    }
+    input_pipeline_resync(&replay->inputs);
+}
+
+static void __trace_replay_step(trace_replay_t* replay, uint32_t now) {
+    keymap_tick(&replay->keymap, now);
+    input_pipeline_poll(&replay->inputs, now);
+}
+
+bool trace_replay_run(trace_replay_t* replay, const trace_replay_config_t* config,
+                      size_t (*read)(void* ctx, uint8_t* data, size_t len), void* ctx,
+                      trace_replay_result_t* result) {
+    if (!__trace_replay_reset(replay, config)) {
+        return false;
+    }
+    trace_reader_init(&replay->reader, read, ctx);
+
+    uint32_t started_us = micros();
+    uint32_t first_us = 0;
+    uint32_t now = 0;
+    trace_record_t record;
+    while (trace_reader_next(&replay->reader, &record)) {
+        if (replay->result.records++ == 0) {
+            first_us = now = record.timestamp_us;
+        }
+        // The input job would have run every period up to this record
+        while ((int32_t)(record.timestamp_us - now) > (int32_t)config->poll_interval_us) {
+            now += config->poll_interval_us;
+            __trace_replay_step(replay, now);
+        }
+        if ((int32_t)(record.timestamp_us - now) > 0) {
+            now = record.timestamp_us;
+        }
+        keymap_tick(&replay->keymap, now);
+
+        switch (record.type) {
+            case TRACE_REC_SYNC:
+                __trace_replay_sync(replay, &record.edge);
+                break;
+            case TRACE_REC_EDGE:
+                if (record.edge.pin == replay->button.pin) {
+                    button_inject(&replay->button, &record.edge);
+                } else {
+                    encoder_inject(&replay->encoder, &record.edge);
+                }
+                input_pipeline_poll(&replay->inputs, now);
+                break;
+            case TRACE_REC_IMU:
+                input_pipeline_imu(&replay->inputs, &record.imu, now);
+                break;
+            case TRACE_REC_KEY:
+                __trace_replay_check(replay, &record.key);
+                break;
+            default:
+                break;
+        }
+    }
+    replay->result.extra += spsc_ring_size(&replay->produced);
+    replay->result.missing += spsc_ring_size(&replay->recorded);
+    replay->result.bad_chunks = replay->reader.bad_chunks;
+    replay->result.span_us = now - first_us;
+    replay->result.took_us = micros() - started_us;
+    *result = replay->result;
+    return true;
+}
+
+void trace_replay_print(const trace_replay_result_t* result, Print* out) {
+    out->printf("replay: records:%lu keys:%lu mismatched:%lu missing:%lu extra:%lu bad chunks:%lu span:%lums took:%lums\n",
+                static_cast<unsigned long>(result->records),
+                static_cast<unsigned long>(result->keys),
+                static_cast<unsigned long>(result->mismatched),
+                static_cast<unsigned long>(result->missing),
+                static_cast<unsigned long>(result->extra),
+                static_cast<unsigned long>(result->bad_chunks),
+                static_cast<unsigned long>(result->span_us / 1000),
+                static_cast<unsigned long>(result->took_us / 1000));
+}
@@ -0,0 +1,31 @@
+#include "web_assets.h"
+
+#include <string.h>
+
+const web_asset_t* web_asset_find(const char* path) {
+    if (path == NULL) {
+        return NULL;
+    }
+    if (strcmp(path, "/") == 0) {
+        path = "/index.html";
+    }
+    for (size_t i = 0; i < web_asset_count; i++) {
+        if (strcmp(web_assets[i].path, path) == 0) {
+            return &web_assets[i];
+        }
+    }
+    return NULL;
+}
+
+uint32_t web_assets_size(uint32_t* raw_size) {
+    uint32_t size = 0;
+    uint32_t raw = 0;
+    for (size_t i = 0; i < web_asset_count; i++) {
+        size += web_assets[i].size;
+        raw += web_assets[i].raw_size;
+    }
+    if (raw_size != NULL) {
+        *raw_size = raw;
+    }
+    return size;
+}
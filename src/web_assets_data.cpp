@@ -0,0 +1,141 @@
+// Generated by tools/embed_assets.py from data/ -- do not edit.
+#include "web_assets.h"
+
+// index.html: 2346 bytes, 1611 minified, 561 gzipped
+static constexpr uint8_t kAsset0[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x55, 0xdd, 0x6f, 0xda, 0x30,
+    0x10, 0x7f, 0xef, 0x5f, 0xe1, 0xe5, 0x61, 0x6a, 0xa5, 0x41, 0x40, 0x8c, 0x16, 0xb4, 0x84, 0x89,
+    0x8f, 0xa8, 0x45, 0x65, 0x05, 0x25, 0x4c, 0x53, 0x1f, 0x8d, 0x7d, 0x24, 0x5e, 0x1d, 0x27, 0xb2,
+    0x0d, 0x34, 0xff, 0x7d, 0xed, 0x00, 0x63, 0x20, 0xb6, 0x54, 0xf4, 0x25, 0x97, 0xdc, 0xdd, 0xef,
+    0xc3, 0x17, 0xc7, 0xf1, 0x3e, 0x8d, 0xa6, 0xc3, 0xf9, 0xf3, 0x2c, 0x40, 0x89, 0x4e, 0x79, 0xef,
+    0xca, 0xdb, 0x07, 0xc0, 0xd4, 0x04, 0xcd, 0x34, 0x87, 0x5e, 0x10, 0xcd, 0xd0, 0x78, 0x3a, 0x47,
+    0xa3, 0x7e, 0xf4, 0x30, 0x98, 0xf6, 0xc3, 0x91, 0xe7, 0x6e, 0x0b, 0x57, 0x5e, 0x0a, 0x1a, 0x23,
+    0x81, 0x53, 0xf0, 0x9d, 0x35, 0x83, 0x4d, 0x9e, 0x49, 0xed, 0x20, 0x92, 0x09, 0x0d, 0x42, 0xfb,
+    0xce, 0x86, 0x51, 0x9d, 0xf8, 0x14, 0xd6, 0x8c, 0x40, 0xad, 0x7c, 0xf8, 0x82, 0x98, 0x60, 0x9a,
+    0x61, 0x5e, 0x53, 0x04, 0x73, 0xf0, 0x9b, 0x8e, 0x21, 0xe1, 0x4c, 0xbc, 0x20, 0x09, 0xdc, 0x77,
+    0x98, 0x81, 0x3a, 0x48, 0x17, 0xb9, 0xe1, 0x63, 0x29, 0x8e, 0xc1, 0xcd, 0x45, 0xec, 0xa0, 0x44,
+    0xc2, 0xd2, 0x77, 0x96, 0x78, 0x6d, 0xeb, 0x75, 0x9b, 0x3a, 0x42, 0x29, 0x5d, 0x70, 0x50, 0x09,
+    0x80, 0xde, 0x63, 0x35, 0xbc, 0x6a, 0x97, 0x28, 0xb5, 0x87, 0x96, 0x1d, 0x75, 0x93, 0xf8, 0xbe,
+    0xf6, 0xdb, 0x98, 0x76, 0xef, 0x3a, 0xb7, 0xdd, 0x25, 0xed, 0xb6, 0x69, 0xab, 0xd5, 0xb1, 0x5c,
+    0xee, 0x6e, 0xbd, 0x8b, 0x8c, 0x16, 0x26, 0x50, 0xb6, 0x46, 0x84, 0x63, 0xa5, 0x0c, 0x53, 0x96,
+    0x0b, 0xbc, 0xb6, 0x3d, 0x49, 0xb3, 0x17, 0x05, 0x4f, 0xd1, 0x34, 0x44, 0x61, 0xd0, 0x1f, 0x8d,
+    0x9f, 0xee, 0x23, 0x74, 0xfd, 0x2b, 0x18, 0x44, 0xd3, 0xe1, 0x63, 0x30, 0xbf, 0x31, 0x14, 0x4d,
+    0x4b, 0x64, 0xa0, 0xc7, 0x04, 0xbb, 0x61, 0x38, 0x27, 0x59, 0x2c, 0x69, 0x2d, 0x96, 0x8c, 0x9e,
+    0xc9, 0xdb, 0x54, 0x7e, 0xd4, 0x58, 0x4e, 0xdb, 0xe9, 0x05, 0x82, 0x64, 0x14, 0xa4, 0xe7, 0xe6,
+    0x7f, 0x77, 0x48, 0x63, 0x9d, 0xd9, 0x91, 0x78, 0x2a, 0xc7, 0x02, 0x31, 0xea, 0x3b, 0xb0, 0x6d,
+    0x34, 0x29, 0xd7, 0xe6, 0x7a, 0x5b, 0xc4, 0x19, 0x6f, 0xff, 0x53, 0x7b, 0x84, 0x02, 0xdd, 0x63,
+    0x0d, 0xc8, 0x45, 0x83, 0x95, 0xd6, 0x99, 0xb0, 0x37, 0x93, 0xa0, 0x5a, 0x3d, 0x36, 0xa0, 0x3f,
+    0xd2, 0x06, 0x74, 0xa8, 0x2c, 0x4a, 0x9e, 0x7f, 0xd4, 0x38, 0x7c, 0xcc, 0x6f, 0x9f, 0x10, 0xe0,
+    0x20, 0xb1, 0x66, 0x99, 0xa8, 0x36, 0x89, 0x6d, 0xf7, 0xc1, 0x49, 0x7c, 0x99, 0xa4, 0x88, 0x57,
+    0x1c, 0x4b, 0x14, 0x9a, 0x15, 0xbf, 0x63, 0x2e, 0x85, 0xcc, 0x0e, 0x8a, 0x9f, 0x29, 0xc4, 0xdf,
+    0x5c, 0x75, 0x91, 0x6e, 0x98, 0x71, 0x6e, 0x86, 0x37, 0x63, 0x9a, 0x24, 0x26, 0x3e, 0xe3, 0x4d,
+    0xb5, 0x7a, 0x26, 0x99, 0xd9, 0x86, 0xe5, 0x74, 0x4e, 0x4c, 0x5c, 0x64, 0x61, 0xfc, 0xe3, 0x27,
+    0x9a, 0x43, 0x9a, 0xdb, 0x81, 0xaf, 0xe4, 0x3b, 0x56, 0xaf, 0x0f, 0xcd, 0x27, 0xfa, 0xc3, 0xcb,
+    0x0c, 0x88, 0x7c, 0xa5, 0xd1, 0xc4, 0x4c, 0x5e, 0x90, 0x02, 0x5d, 0xf3, 0xed, 0x4e, 0x4d, 0xf1,
+    0xab, 0xb9, 0xca, 0x95, 0xb8, 0xa9, 0x76, 0xc4, 0xb7, 0xd8, 0x83, 0x9b, 0xd5, 0x65, 0x6f, 0xe3,
+    0x61, 0x3c, 0x42, 0x21, 0xd8, 0xa3, 0x4f, 0xa1, 0xc8, 0xcc, 0xb8, 0x5a, 0x39, 0xb1, 0xdf, 0xfd,
+    0x47, 0xf6, 0xfa, 0x04, 0x2b, 0x8d, 0xcc, 0x07, 0x5a, 0x2d, 0xf5, 0x02, 0xc5, 0x79, 0xa9, 0xe3,
+    0xa0, 0x88, 0x64, 0xb9, 0x46, 0x4a, 0x12, 0x73, 0x58, 0x96, 0xf7, 0xf5, 0xdf, 0xf6, 0xb0, 0xa4,
+    0x8b, 0x4e, 0xe3, 0x6b, 0xa3, 0xd1, 0x68, 0xb5, 0x09, 0xbd, 0xeb, 0xb4, 0x6f, 0x4b, 0xae, 0xb2,
+    0x6e, 0xb1, 0xbb, 0xe3, 0xd2, 0x2d, 0x7f, 0x1a, 0x6f, 0x02, 0xf7, 0xa6, 0xc0, 0x4b, 0x06, 0x00,
+    0x00,
+};
+
+// script.js: 2775 bytes, 2260 minified, 983 gzipped
+static constexpr uint8_t kAsset1[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x55, 0xed, 0x6e, 0xdb, 0x36,
+    0x14, 0xfd, 0xef, 0xa7, 0x20, 0x8a, 0x22, 0xa2, 0x1a, 0x43, 0xb1, 0x9d, 0x20, 0x0b, 0x9a, 0x7a,
+    0x43, 0xea, 0x38, 0x9d, 0xd7, 0xd4, 0x1e, 0x66, 0x77, 0xc1, 0x10, 0x04, 0x2b, 0x2d, 0x5d, 0xdb,
+    0x6c, 0x65, 0xd2, 0xa0, 0x68, 0x3b, 0x42, 0x1a, 0x60, 0x4f, 0xb3, 0x07, 0xdb, 0x93, 0xec, 0x5e,
+    0x4a, 0xb6, 0x45, 0x27, 0x41, 0x7f, 0x08, 0x22, 0xc5, 0x73, 0xcf, 0xfd, 0x3a, 0xba, 0x5c, 0x09,
+    0xc3, 0xa6, 0xc2, 0xc2, 0x5a, 0xe4, 0xac, 0xcd, 0xbe, 0xac, 0xb3, 0xb7, 0x47, 0x47, 0xaf, 0x1f,
+    0xd6, 0x52, 0x25, 0x7a, 0x1d, 0xa5, 0x3a, 0x16, 0x56, 0x6a, 0x15, 0xcd, 0x74, 0x66, 0x1f, 0x8f,
+    0xd6, 0xd9, 0x97, 0xf3, 0xda, 0x0a, 0x0d, 0xd6, 0x30, 0xce, 0x74, 0xfc, 0x0d, 0xec, 0x79, 0xad,
+    0x44, 0x8a, 0x24, 0xe9, 0xae, 0x40, 0xd9, 0x6b, 0x99, 0x59, 0x50, 0x60, 0x78, 0x90, 0x6a, 0x91,
+    0x04, 0x75, 0xa6, 0x15, 0x2d, 0xc2, 0xf3, 0xda, 0x64, 0xa9, 0x62, 0xe2, 0x2a, 0xbf, 0x70, 0x20,
+    0x78, 0xc8, 0x1e, 0x6a, 0x52, 0x49, 0x7b, 0x03, 0xe3, 0xa1, 0x23, 0xe4, 0x88, 0x7c, 0xdc, 0x61,
+    0xa7, 0x60, 0xff, 0x00, 0x91, 0x48, 0x35, 0xcd, 0x78, 0xf8, 0x50, 0xdb, 0xfa, 0x8d, 0x32, 0x50,
+    0x09, 0x7f, 0x55, 0x39, 0x7e, 0xe5, 0x1b, 0xee, 0x91, 0xa2, 0x9b, 0x58, 0xab, 0x4c, 0xa7, 0x80,
+    0x39, 0x4d, 0x79, 0x30, 0x32, 0x39, 0x1a, 0x31, 0xab, 0x99, 0x5e, 0x80, 0x62, 0x82, 0x6d, 0xb1,
+    0x0c, 0x71, 0x0a, 0x1c, 0xc9, 0x7f, 0xff, 0xfc, 0x1b, 0x20, 0xeb, 0xd6, 0x29, 0xd6, 0x47, 0xc1,
+    0x7a, 0x07, 0xe5, 0x65, 0xdd, 0xaa, 0x98, 0x68, 0x2c, 0x95, 0x30, 0xf9, 0x28, 0x5f, 0x00, 0xc2,
+    0x03, 0x61, 0x8c, 0xc8, 0xc7, 0xcb, 0xc9, 0x04, 0x4c, 0x50, 0x45, 0x69, 0xe5, 0xfc, 0xb6, 0xb1,
+    0x18, 0x03, 0x5c, 0xf8, 0x47, 0x71, 0xaa, 0x33, 0x70, 0x67, 0x1d, 0x5a, 0xf9, 0x87, 0x73, 0xc8,
+    0x32, 0x31, 0x2d, 0x8e, 0x3f, 0x15, 0x6b, 0x2f, 0xf1, 0x82, 0x70, 0x57, 0x5d, 0x2f, 0xed, 0xce,
+    0x36, 0x37, 0x97, 0x37, 0x24, 0x94, 0x9f, 0x57, 0xe3, 0x3d, 0x2e, 0x17, 0xc0, 0x8f, 0xc9, 0x5c,
+    0xc4, 0x8e, 0x2c, 0x03, 0x3b, 0x92, 0x73, 0xd0, 0x4b, 0xcb, 0xbd, 0x16, 0xd4, 0x59, 0xab, 0xd1,
+    0x68, 0xf8, 0xf4, 0x84, 0x85, 0x7b, 0x04, 0x26, 0x75, 0x66, 0x71, 0x41, 0x1e, 0x12, 0x1d, 0x2f,
+    0xe7, 0xe8, 0x2d, 0xc2, 0xa8, 0xba, 0x29, 0xd0, 0xf2, 0x7d, 0xde, 0x4b, 0x10, 0x13, 0x46, 0x12,
+    0xfd, 0x99, 0x5f, 0x47, 0x9f, 0xae, 0x31, 0x79, 0xc2, 0x7b, 0x64, 0xd6, 0xc8, 0x45, 0x0a, 0x7c,
+    0x25, 0x61, 0x8d, 0xa2, 0x9b, 0x4c, 0x32, 0xf2, 0x99, 0xc5, 0x22, 0x85, 0x3a, 0x4b, 0xe4, 0x54,
+    0xda, 0x8c, 0xe8, 0x49, 0xbc, 0x2b, 0x91, 0x2e, 0x21, 0x43, 0x8e, 0xdb, 0x3b, 0x54, 0xa5, 0x36,
+    0x8c, 0xd3, 0x57, 0x89, 0x1f, 0x1a, 0xe7, 0xf8, 0x7a, 0xc7, 0x8e, 0xf1, 0x75, 0x78, 0x58, 0xc0,
+    0x09, 0x1a, 0x2d, 0x96, 0xd9, 0x8c, 0x3b, 0x6a, 0x0a, 0xab, 0xa7, 0x6c, 0xf3, 0x94, 0x17, 0x2e,
+    0xd8, 0x21, 0x5a, 0xbc, 0x61, 0x2d, 0x4c, 0xc0, 0x2c, 0x21, 0x64, 0x47, 0x85, 0xcb, 0x30, 0xb2,
+    0xfa, 0x4a, 0xde, 0x43, 0xc2, 0x4b, 0xd7, 0x2e, 0x71, 0x03, 0x76, 0x69, 0x54, 0xe9, 0x3f, 0xfa,
+    0xaa, 0xa5, 0xe2, 0x01, 0x5a, 0x04, 0xfb, 0x45, 0x1f, 0x5a, 0x61, 0x97, 0x99, 0xf3, 0xb7, 0x89,
+    0x79, 0x92, 0x8a, 0x29, 0x85, 0xbc, 0x89, 0xe1, 0xb3, 0x54, 0xf6, 0x8c, 0x37, 0xcb, 0x82, 0x53,
+    0x11, 0x03, 0x50, 0xb1, 0x4e, 0x50, 0x66, 0x75, 0x56, 0x09, 0xf4, 0xb8, 0xc5, 0xcf, 0xca, 0xd8,
+    0xaa, 0x58, 0x12, 0x2e, 0x02, 0x79, 0x41, 0x7b, 0xc0, 0x9a, 0x21, 0xfb, 0x85, 0x05, 0x83, 0x7e,
+    0xc0, 0xde, 0xe2, 0xeb, 0xea, 0x2a, 0xa8, 0x82, 0xc7, 0x4b, 0x6b, 0xb5, 0xaa, 0xc2, 0x5b, 0x0e,
+    0x7e, 0x39, 0xb8, 0x29, 0x0c, 0x3e, 0xff, 0xee, 0xe3, 0x53, 0x8f, 0xfb, 0xc4, 0x81, 0x3b, 0x83,
+    0x7e, 0xbf, 0xdb, 0x19, 0x75, 0x2f, 0x9d, 0xc5, 0xcd, 0x45, 0x6f, 0xd4, 0xeb, 0x7f, 0xf0, 0xcc,
+    0x44, 0x1c, 0x43, 0x1a, 0xd4, 0xfd, 0x46, 0x36, 0xb1, 0xb2, 0x4d, 0x14, 0x4e, 0x9d, 0x1d, 0xfb,
+    0x09, 0xe4, 0x46, 0x3f, 0xc1, 0x9e, 0x11, 0x16, 0x1f, 0x0f, 0xa9, 0x8d, 0x44, 0x0d, 0xb9, 0x29,
+    0xb6, 0x6f, 0xd0, 0x3a, 0x71, 0xe4, 0xfb, 0x16, 0x16, 0xe6, 0x0b, 0x30, 0xd8, 0x02, 0xe3, 0xf2,
+    0xf0, 0xdb, 0x7e, 0xdc, 0xd8, 0xb5, 0x1a, 0x6d, 0x77, 0x8d, 0xf6, 0x39, 0x52, 0x2c, 0xb0, 0x8a,
+    0xf3, 0x4a, 0x33, 0xa8, 0x63, 0x64, 0xbf, 0x95, 0xca, 0x21, 0x73, 0xcd, 0xc7, 0xf7, 0x3e, 0xe4,
+    0xe4, 0xc7, 0x90, 0xd3, 0x67, 0x9a, 0x3a, 0x93, 0xc9, 0x33, 0xfe, 0x2a, 0xed, 0x7f, 0x74, 0x52,
+    0xfa, 0xd8, 0xfd, 0xeb, 0xef, 0x8b, 0xce, 0xa8, 0x37, 0xe8, 0x0f, 0xe9, 0x1f, 0x08, 0x16, 0x06,
+    0xa7, 0x08, 0x1a, 0x06, 0x06, 0x52, 0x10, 0x19, 0xe5, 0x1c, 0x58, 0xb1, 0x08, 0xee, 0xbc, 0x91,
+    0xfd, 0x11, 0x72, 0x4f, 0x90, 0xa2, 0x38, 0x68, 0x57, 0xe9, 0x6e, 0xf7, 0xd5, 0x79, 0xc7, 0xbe,
+    0x7f, 0x7f, 0x46, 0xb2, 0x64, 0xff, 0x0d, 0xf2, 0x27, 0x72, 0x6e, 0x95, 0x67, 0x4a, 0xcc, 0x69,
+    0xbe, 0x71, 0xc2, 0xfc, 0x8c, 0x7f, 0xe5, 0x7d, 0xab, 0xc1, 0x0e, 0x0e, 0x9c, 0xc9, 0x3b, 0xdc,
+    0xfd, 0x74, 0x45, 0x8a, 0x1a, 0x62, 0x2b, 0xd5, 0x34, 0x9a, 0x18, 0x3d, 0xef, 0xcc, 0x84, 0xe9,
+    0xa0, 0xf6, 0xc9, 0x20, 0x24, 0x79, 0x35, 0xee, 0xa9, 0x66, 0xb8, 0xc3, 0xee, 0x14, 0x38, 0xde,
+    0x3c, 0xad, 0x96, 0x0a, 0x8f, 0x30, 0x4d, 0xe7, 0x87, 0x6a, 0xcc, 0x09, 0x5e, 0x66, 0x84, 0xfb,
+    0xf0, 0xc9, 0x1f, 0x59, 0x0e, 0xda, 0xca, 0x9d, 0x35, 0x61, 0xc5, 0x26, 0x4a, 0x84, 0x15, 0x78,
+    0xdb, 0x64, 0x56, 0xa8, 0x18, 0xf4, 0x84, 0x5d, 0xd0, 0xc4, 0x7f, 0xef, 0x26, 0xfe, 0x76, 0xe0,
+    0x60, 0x96, 0xe5, 0xdd, 0x71, 0x89, 0xe8, 0x3f, 0x71, 0x5b, 0x31, 0x46, 0x5f, 0xc4, 0xe6, 0x4a,
+    0x31, 0xce, 0x2d, 0x5c, 0x83, 0x9a, 0xda, 0x19, 0x6b, 0xb7, 0xd9, 0x89, 0x4b, 0xdb, 0xaf, 0x51,
+    0x23, 0xa4, 0x93, 0x26, 0x51, 0xfb, 0x83, 0x02, 0x23, 0x66, 0x90, 0xe2, 0xbd, 0xf1, 0x02, 0xd9,
+    0xd9, 0x4b, 0x5c, 0xad, 0x82, 0x6b, 0xdb, 0xe0, 0xdd, 0xa4, 0xda, 0x28, 0x66, 0x9e, 0x0f, 0xc6,
+    0x5f, 0x31, 0x81, 0xdf, 0x86, 0x83, 0x7e, 0xb4, 0x10, 0x66, 0x73, 0x23, 0x6c, 0xc2, 0x2f, 0xfb,
+    0x49, 0xf3, 0x09, 0x81, 0x78, 0x25, 0x44, 0xb4, 0xe3, 0xce, 0x2c, 0x7c, 0x7e, 0xc4, 0x12, 0x20,
+    0x4a, 0x5d, 0x70, 0xc5, 0xb0, 0x7d, 0xa8, 0xa8, 0x82, 0x0e, 0x6f, 0x25, 0xea, 0xef, 0xa5, 0xcb,
+    0x80, 0xfa, 0xec, 0xdd, 0x06, 0xce, 0xd5, 0x2d, 0x7e, 0xbe, 0xa3, 0x98, 0x1f, 0xff, 0x07, 0xe2,
+    0x98, 0x15, 0xf2, 0xd4, 0x08, 0x00, 0x00,
+};
+
+// style.css: 667 bytes, 503 minified, 326 gzipped
+static constexpr uint8_t kAsset2[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x50, 0xc1, 0x6e, 0x83, 0x30,
+    0x0c, 0xfd, 0x95, 0x4a, 0xbb, 0xb4, 0x12, 0x41, 0xc0, 0x5a, 0x0d, 0x25, 0xa7, 0xde, 0xf6, 0x1b,
+    0x86, 0x18, 0xb0, 0x1a, 0x12, 0x14, 0xdc, 0x42, 0x87, 0xf8, 0xf7, 0x25, 0xb4, 0x9d, 0x34, 0xf5,
+    0x60, 0x4b, 0xb6, 0x9f, 0x9f, 0x9f, 0x5f, 0xc7, 0xbd, 0x59, 0x1a, 0x67, 0x59, 0x34, 0xd0, 0x93,
+    0xb9, 0xcb, 0xb3, 0x27, 0x30, 0xc9, 0x37, 0x9a, 0x1b, 0x32, 0xd5, 0x90, 0x8c, 0x60, 0x47, 0x31,
+    0xa2, 0xa7, 0x46, 0x69, 0x1a, 0x07, 0x03, 0x77, 0x49, 0xd6, 0x90, 0x45, 0x51, 0x19, 0x57, 0x5f,
+    0x14, 0xe3, 0xcc, 0x02, 0x0c, 0xb5, 0x56, 0xd6, 0x68, 0x19, 0xfd, 0xda, 0xe5, 0x0f, 0xc2, 0x91,
+    0x7e, 0x50, 0xe6, 0x69, 0xe9, 0xb1, 0x57, 0xb5, 0x33, 0xce, 0xcb, 0xa9, 0x23, 0xc6, 0x35, 0x65,
+    0x37, 0x58, 0xb8, 0x2d, 0xee, 0x86, 0xbe, 0x31, 0x6e, 0x92, 0x1d, 0x69, 0x8d, 0x56, 0x55, 0x50,
+    0x5f, 0x5a, 0xef, 0xae, 0x56, 0x8b, 0x07, 0xfc, 0x23, 0x3b, 0xe7, 0x79, 0x51, 0xae, 0x95, 0xd3,
+    0xf7, 0xa5, 0x07, 0xdf, 0x92, 0x95, 0xd9, 0x9a, 0xd6, 0x81, 0x3c, 0x5c, 0x5a, 0x06, 0xd0, 0x9a,
+    0x6c, 0x2b, 0x4f, 0xd9, 0x30, 0x87, 0x2e, 0x78, 0x2d, 0x5a, 0x4f, 0x3a, 0x20, 0x67, 0x31, 0x91,
+    0xe6, 0x4e, 0x96, 0x59, 0x18, 0xa9, 0xd7, 0xe6, 0x0e, 0xae, 0xec, 0xfe, 0x9e, 0x88, 0x50, 0x15,
+    0x93, 0x68, 0x61, 0x90, 0x45, 0x14, 0xb9, 0x55, 0x8c, 0x7d, 0x98, 0x33, 0x46, 0x0d, 0xd7, 0xde,
+    0x8e, 0xd2, 0xe3, 0x80, 0xc0, 0xfb, 0xb8, 0x2c, 0x1a, 0xe2, 0xa4, 0x27, 0x1b, 0x2e, 0xec, 0x8b,
+    0xc8, 0x9d, 0xe4, 0x8d, 0x3f, 0x1c, 0x1e, 0xc7, 0x97, 0x37, 0xfd, 0xdb, 0xbb, 0xaa, 0x72, 0xb3,
+    0x18, 0x3b, 0xd0, 0xe1, 0xd1, 0x62, 0x98, 0x77, 0x31, 0xf2, 0x2d, 0x85, 0xf0, 0x6d, 0x05, 0xfb,
+    0xfc, 0x98, 0x25, 0xaf, 0x48, 0x4f, 0x4f, 0x36, 0xc1, 0xc4, 0x06, 0xff, 0x19, 0xb9, 0x69, 0xdc,
+    0x1a, 0x13, 0x52, 0xdb, 0xb1, 0xac, 0x9c, 0xd1, 0xea, 0x65, 0xd5, 0xe7, 0x31, 0xfb, 0x2a, 0xd7,
+    0xd4, 0x23, 0x44, 0x53, 0xde, 0x17, 0x9f, 0xb8, 0xe0, 0x67, 0x71, 0x2e, 0xd6, 0x5f, 0xfc, 0x32,
+    0xc0, 0xb2, 0xf7, 0x01, 0x00, 0x00,
+};
+
+const web_asset_t web_assets[] = {
+    {"/index.html", "text/html", "\"8e541509bbeccb14\"", kAsset0, sizeof(kAsset0), 2346, true},
+    {"/script.js", "application/javascript", "\"db80400035cd7856\"", kAsset1, sizeof(kAsset1), 2775, true},
+    {"/style.css", "text/css", "\"5ad97869fd95d338\"", kAsset2, sizeof(kAsset2), 667, true},
+};
+
+const size_t web_asset_count = sizeof(web_assets) / sizeof(web_assets[0]);
@@ -0,0 +1,589 @@
+#include "web_server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL    0
+#endif
+
+#define WEB_LISTEN_BACKLOG      2
+#define WEB_MAX_TEXT            32      // longest client command
+
+static const char kNotFound[] =
+    "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+static const char kBadRequest[] =
+    "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+static bool __web_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Bytes written, 0 if the socket would block, -1 if the connection is gone
+static int __web_send(int fd, const uint8_t* data, size_t len) {
+    ssize_t sent = send(fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent >= 0) {
+        return (int)sent;
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+}
+
+static void __web_close(web_server_t* server, web_client_t* client) {
+    if (client->state == WEB_CLIENT_FREE) {
+        return;
+    }
+    if (client->state == WEB_CLIENT_WEBSOCKET || client->state == WEB_CLIENT_CLOSING) {
+        const telemetry_queue_stats_t* q = &client->queue.stats;
+        server->closed.queued += q->queued;
+        server->closed.coalesced += q->coalesced;
+        server->closed.dropped += q->dropped;
+        server->closed.sent += q->sent;
+        server->closed.bytes += q->bytes;
+    }
+    close(client->fd);
+    client->file.close();
+    client->fd = -1;
+    client->state = WEB_CLIENT_FREE;
+}
+
+static uint32_t __web_interval_ms(uint16_t rate_hz) {
+    if (rate_hz == 0) {
+        rate_hz = 1;
+    }
+    if (rate_hz > TELEMETRY_MAX_RATE_HZ) {
+        rate_hz = TELEMETRY_MAX_RATE_HZ;
+    }
+    return 1000 / rate_hz;
+}
+
+#if !WEB_ASSETS_EMBEDDED
+static const char* __web_content_type(const char* path) {
+    const char* ext = strrchr(path, '.');
+    if (ext == NULL) {
+        return "application/octet-stream";
+    }
+    if (strcmp(ext, ".html") == 0) {
+        return "text/html";
+    }
+    if (strcmp(ext, ".css") == 0) {
+        return "text/css";
+    }
+    if (strcmp(ext, ".js") == 0) {
+        return "application/javascript";
+    }
+    if (strcmp(ext, ".json") == 0) {
+        return "application/json";
+    }
+    if (strcmp(ext, ".png") == 0) {
+        return "image/png";
+    }
+    if (strcmp(ext, ".ico") == 0) {
+        return "image/x-icon";
+    }
+    return "application/octet-stream";
+}
+#endif
+
+static void __web_respond(web_client_t* client, const char* head) {
+    size_t len = strlen(head);
+    memcpy(client->tx, head, len);
+    client->tx_len = len;
+    client->tx_off = 0;
+    client->state = WEB_CLIENT_RESPONSE;
+}
+
+// Case-insensitive header lookup in a NUL-terminated request head
+static bool __web_header(const char* head, const char* name, const char** value, size_t* value_len) {
+    size_t name_len = strlen(name);
+    const char* line = strstr(head, "\r\n");
+    while (line != NULL) {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char* start = line + name_len + 1;
+            while (*start == ' ' || *start == '\t') {
+                start++;
+            }
+            const char* end = strstr(start, "\r\n");
+            if (end == NULL) {
+                return false;
+            }
+            while (end > start && (end[-1] == ' ' || end[-1] == '\t')) {
+                end--;
+            }
+            *value = start;
+            *value_len = (size_t)(end - start);
+            return true;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return false;
+}
+
+static void __web_upgrade(web_server_t* server, web_client_t* client, const char* head) {
+    const char* key;
+    size_t key_len;
+    if (!__web_header(head, "Sec-WebSocket-Key", &key, &key_len) || key_len == 0) {
+        __web_respond(client, kBadRequest);
+        return;
+    }
+    char accept[WS_ACCEPT_KEY_LEN + 1];
+    ws_accept_key(key, key_len, accept);
+    int len = snprintf(reinterpret_cast<char*>(client->tx), sizeof(client->tx),
+                       "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+    client->tx_len = (size_t)len;
+    client->tx_off = 0;
+    client->state = WEB_CLIENT_WEBSOCKET;
+    client->interval_ms = __web_interval_ms(server->rate_hz);
+    client->last_status_ms = 0;
+    client->status_due = true;
+    client->seq = 0;
+    server->stats.upgrades++;
+}
+
+#if WEB_ASSETS_EMBEDDED
+// index.html is revalidated; everything it references carries ?v=<hash>
+static const char kCacheRevalidate[] = "no-cache";
+static const char kCacheImmutable[] = "public, max-age=31536000, immutable";
+
+static void __web_serve_file(web_server_t* server, web_client_t* client, const char* path, const char* head) {
+    const web_asset_t* asset = web_asset_find(path);
+    if (asset == NULL) {
+        server->stats.not_found++;
+        __web_respond(client, kNotFound);
+        return;
+    }
+    const char* cache = (strcmp(asset->content_type, "text/html") == 0) ? kCacheRevalidate : kCacheImmutable;
+
+    const char* match;
+    size_t match_len;
+    size_t etag_len = strlen(asset->etag);
+    if (__web_header(head, "If-None-Match", &match, &match_len) && match_len >= etag_len) {
+        for (size_t i = 0; i + etag_len <= match_len; i++) {
+            if (memcmp(match + i, asset->etag, etag_len) == 0) {
+                int len = snprintf(reinterpret_cast<char*>(client->tx), sizeof(client->tx),
+                                   "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: %s\r\n"
+                                   "Connection: close\r\n\r\n", asset->etag, cache);
+                client->tx_len = (size_t)len;
+                client->tx_off = 0;
+                client->state = WEB_CLIENT_RESPONSE;
+                server->stats.not_modified++;
+                return;
+            }
+        }
+    }
+
+    int len = snprintf(reinterpret_cast<char*>(client->tx), sizeof(client->tx),
+                       "HTTP/1.1 200 OK\r\nContent-Type: %s\r\n%sContent-Length: %lu\r\n"
+                       "ETag: %s\r\nCache-Control: %s\r\nConnection: close\r\n\r\n",
+                       asset->content_type, asset->gzip ? "Content-Encoding: gzip\r\n" : "",
+                       static_cast<unsigned long>(asset->size), asset->etag, cache);
+    client->tx_len = (size_t)len;
+    client->tx_off = 0;
+    client->body = asset->data;
+    client->body_len = asset->size;
+    client->body_off = 0;
+    client->state = WEB_CLIENT_RESPONSE;
+}
+#else
+static void __web_serve_file(web_server_t* server, web_client_t* client, const char* path, const char* head) {
+    (void)head;
+    if (strcmp(path, "/") == 0) {
+        path = "/index.html";
+    }
+    client->file = LittleFS.open(path, "r");
+    if (!client->file) {
+        server->stats.not_found++;
+        __web_respond(client, kNotFound);
+        return;
+    }
+    int len = snprintf(reinterpret_cast<char*>(client->tx), sizeof(client->tx),
+                       "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n",
+                       __web_content_type(path), static_cast<unsigned long>(client->file.size()));
+    client->tx_len = (size_t)len;
+    client->tx_off = 0;
+    client->state = WEB_CLIENT_RESPONSE;
+}
+#endif
+
+static void __web_request(web_server_t* server, web_client_t* client) {
+    char* head = reinterpret_cast<char*>(client->rx);
+    head[client->rx_len < WEB_RX_BUFFER ? client->rx_len : WEB_RX_BUFFER - 1] = '\0';
+    if (strstr(head, "\r\n\r\n") == NULL) {
+        if (client->rx_len >= WEB_RX_BUFFER - 1) {
+            __web_respond(client, kBadRequest);
+        }
+        return;
+    }
+    server->stats.requests++;
+    client->rx_len = 0;
+
+    char path[64];
+    if (sscanf(head, "GET %63s HTTP/1.", path) != 1) {
+        __web_respond(client, kBadRequest);
+        return;
+    }
+    char* query = strchr(path, '?');
+    if (query != NULL) {
+        *query = '\0';
+    }
+    if (strcmp(path, WEB_SOCKET_PATH) == 0) {
+        __web_upgrade(server, client, head);
+    } else {
+        __web_serve_file(server, client, path, head);
+    }
+}
+
+static void __web_queue_status(web_server_t* server, web_client_t* client, uint32_t now_ms) {
+    uint8_t payload[TELEMETRY_STATUS_SIZE];
+    size_t len = telemetry_encode_status(&server->latest, client->seq++, payload);
+    telemetry_queue_push(&client->queue, TELEMETRY_KIND_STATUS, WS_OP_BINARY, payload, len);
+    client->last_status_ms = now_ms;
+    client->status_due = false;
+}
+
+static void __web_command(web_client_t* client, const char* text) {
+    unsigned rate;
+    if (strcmp(text, "getReadings") == 0) {
+        client->status_due = true;
+    } else if (sscanf(text, "rate %u", &rate) == 1) {
+        client->interval_ms = __web_interval_ms((uint16_t)(rate > 0xFFFF ? 0xFFFF : rate));
+    }
+}
+
+static void __web_websocket_read(web_server_t* server, web_client_t* client, uint32_t now_ms) {
+    size_t offset = 0;
+    for (;;) {
+        ws_frame_t frame;
+        size_t consumed;
+        ws_parse_result_t result = ws_parse(client->rx + offset, client->rx_len - offset,
+                                            WEB_RX_BUFFER - WS_MAX_CLIENT_HEADER, &frame, &consumed);
+        if (result == WS_PARSE_INCOMPLETE) {
+            break;
+        }
+        if (result == WS_PARSE_ERROR) {
+            __web_close(server, client);
+            return;
+        }
+        offset += consumed;
+
+        if (frame.opcode == WS_OP_TEXT && frame.length <= WEB_MAX_TEXT) {
+            char text[WEB_MAX_TEXT + 1];
+            memcpy(text, frame.payload, frame.length);
+            text[frame.length] = '\0';
+            __web_command(client, text);
+        } else if (frame.opcode == WS_OP_PING && frame.length <= TELEMETRY_MAX_PAYLOAD) {
+            telemetry_queue_push(&client->queue, TELEMETRY_KIND_CONTROL, WS_OP_PONG, frame.payload, frame.length);
+        } else if (frame.opcode == WS_OP_CLOSE) {
+            telemetry_queue_push(&client->queue, TELEMETRY_KIND_CONTROL, WS_OP_CLOSE, NULL, 0);
+            client->state = WEB_CLIENT_CLOSING;
+            break;
+        }
+    }
+    memmove(client->rx, client->rx + offset, client->rx_len - offset);
+    client->rx_len -= offset;
+}
+
+static void __web_read(web_server_t* server, web_client_t* client, uint32_t now_ms) {
+    if (client->state != WEB_CLIENT_REQUEST && client->state != WEB_CLIENT_WEBSOCKET) {
+        return;
+    }
+    if (client->rx_len >= WEB_RX_BUFFER) {
+        __web_close(server, client);
+        return;
+    }
+    ssize_t got = recv(client->fd, client->rx + client->rx_len, WEB_RX_BUFFER - client->rx_len, MSG_DONTWAIT);
+    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        __web_close(server, client);
+        return;
+    }
+    if (got < 0) {
+        return;
+    }
+    client->rx_len += (size_t)got;
+    client->last_active_ms = now_ms;
+    if (client->state == WEB_CLIENT_REQUEST) {
+        __web_request(server, client);
+    } else {
+        __web_websocket_read(server, client, now_ms);
+    }
+}
+
+// Sends pending response bytes; false once the connection was closed
+static bool __web_flush_tx(web_server_t* server, web_client_t* client, size_t* budget) {
+    while (client->tx_off < client->tx_len && *budget > 0) {
+        size_t len = client->tx_len - client->tx_off;
+        if (len > *budget) {
+            len = *budget;
+        }
+        int sent = __web_send(client->fd, client->tx + client->tx_off, len);
+        if (sent < 0) {
+            __web_close(server, client);
+            return false;
+        }
+        if (sent == 0) {
+            return true;
+        }
+        client->tx_off += (size_t)sent;
+        *budget -= (size_t)sent;
+    }
+    return true;
+}
+
+static void __web_write(web_server_t* server, web_client_t* client) {
+    size_t budget = WEB_SEND_BUDGET;
+    if (!__web_flush_tx(server, client, &budget)) {
+        return;
+    }
+    if (client->tx_off < client->tx_len) {
+        return;
+    }
+
+    if (client->state == WEB_CLIENT_RESPONSE) {
+        // Embedded bodies go to the socket directly from flash, no staging copy
+        while (client->body_off < client->body_len && budget > 0) {
+            size_t len = client->body_len - client->body_off;
+            if (len > budget) {
+                len = budget;
+            }
+            int sent = __web_send(client->fd, client->body + client->body_off, len);
+            if (sent < 0) {
+                __web_close(server, client);
+                return;
+            }
+            if (sent == 0) {
+                return;
+            }
+            client->body_off += (size_t)sent;
+            budget -= (size_t)sent;
+        }
+        if (client->body_off < client->body_len) {
+            return;
+        }
+        while (client->file && budget > 0) {
+            client->tx_len = client->file.read(client->tx, sizeof(client->tx));
+            client->tx_off = 0;
+            if (client->tx_len == 0) {
+                client->file.close();
+                break;
+            }
+            if (!__web_flush_tx(server, client, &budget)) {
+                return;
+            }
+            if (client->tx_off < client->tx_len) {
+                return;
+            }
+        }
+        if (!client->file) {
+            __web_close(server, client);
+        }
+        return;
+    }
+    if (client->state != WEB_CLIENT_WEBSOCKET && client->state != WEB_CLIENT_CLOSING) {
+        return;
+    }
+
+    while (budget > 0) {
+        const uint8_t* data;
+        size_t len = telemetry_queue_peek(&client->queue, &data);
+        if (len == 0) {
+            break;
+        }
+        if (len > budget) {
+            len = budget;
+        }
+        int sent = __web_send(client->fd, data, len);
+        if (sent < 0) {
+            __web_close(server, client);
+            return;
+        }
+        if (sent == 0) {
+            return;
+        }
+        telemetry_queue_consume(&client->queue, (size_t)sent);
+        budget -= (size_t)sent;
+    }
+    if (client->state == WEB_CLIENT_CLOSING && client->queue.count == 0) {
+        __web_close(server, client);
+    }
+}
+
+static void __web_accept(web_server_t* server, uint32_t now_ms) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+        web_client_t* client = NULL;
+        for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+            if (server->clients[i].state == WEB_CLIENT_FREE) {
+                client = &server->clients[i];
+                break;
+            }
+        }
+        if (client == NULL || !__web_nonblocking(fd)) {
+            close(fd);
+            server->stats.rejected++;
+            continue;
+        }
+        // Keep the kernel backlog small so a slow reader shows up in our queue, where
+        // it is coalesced, instead of in stale socket buffers (ignored where unsupported)
+        int sndbuf = WEB_SOCKET_SNDBUF;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        client->fd = fd;
+        client->state = WEB_CLIENT_REQUEST;
+        client->last_active_ms = now_ms;
+        client->rx_len = 0;
+        client->tx_len = 0;
+        client->tx_off = 0;
+        client->body = NULL;
+        client->body_len = 0;
+        client->body_off = 0;
+        telemetry_queue_reset(&client->queue);
+        server->stats.accepted++;
+    }
+}
+
+bool web_server_begin(web_server_t* server, uint16_t port, uint16_t rate_hz) {
+    if (server == NULL) {
+        return false;
+    }
+    server->listen_fd = -1;
+    server->port = port;
+    server->rate_hz = rate_hz;
+    server->have_sample = false;
+    memset(&server->stats, 0, sizeof(server->stats));
+    memset(&server->closed, 0, sizeof(server->closed));
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        server->clients[i].fd = -1;
+        server->clients[i].state = WEB_CLIENT_FREE;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(fd, WEB_LISTEN_BACKLOG) != 0 || !__web_nonblocking(fd)) {
+        close(fd);
+        return false;
+    }
+    server->listen_fd = fd;
+    return true;
+}
+
+void web_server_end(web_server_t* server) {
+    if (server == NULL || server->listen_fd < 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        __web_close(server, &server->clients[i]);
+    }
+    close(server->listen_fd);
+    server->listen_fd = -1;
+}
+
+void web_server_poll(web_server_t* server, uint32_t now_ms) {
+    if (server == NULL || server->listen_fd < 0) {
+        return;
+    }
+    __web_accept(server, now_ms);
+
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        web_client_t* client = &server->clients[i];
+        if (client->state == WEB_CLIENT_FREE) {
+            continue;
+        }
+        __web_read(server, client, now_ms);
+        if (client->state == WEB_CLIENT_WEBSOCKET && client->status_due && server->have_sample) {
+            __web_queue_status(server, client, now_ms);
+        }
+        if (client->state != WEB_CLIENT_FREE) {
+            __web_write(server, client);
+        }
+        if (client->state == WEB_CLIENT_REQUEST && now_ms - client->last_active_ms > WEB_HTTP_TIMEOUT_MS) {
+            __web_close(server, client);
+        }
+    }
+}
+
+void web_server_publish(web_server_t* server, const telemetry_sample_t* sample, uint32_t now_ms) {
+    if (server == NULL || sample == NULL) {
+        return;
+    }
+    server->latest = *sample;
+    server->have_sample = true;
+    server->stats.published++;
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        web_client_t* client = &server->clients[i];
+        if (client->state != WEB_CLIENT_WEBSOCKET) {
+            continue;
+        }
+        if (client->status_due || now_ms - client->last_status_ms >= client->interval_ms) {
+            __web_queue_status(server, client, now_ms);
+        }
+    }
+}
+
+void web_server_publish_key(web_server_t* server, uint8_t key, uint8_t action, uint32_t now_ms) {
+    if (server == NULL) {
+        return;
+    }
+    uint8_t payload[TELEMETRY_KEY_SIZE];
+    size_t len = telemetry_encode_key(key, action, now_ms, payload);
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        web_client_t* client = &server->clients[i];
+        if (client->state == WEB_CLIENT_WEBSOCKET) {
+            telemetry_queue_push(&client->queue, TELEMETRY_KIND_KEY, WS_OP_BINARY, payload, len);
+        }
+    }
+}
+
+void web_server_set_rate(web_server_t* server, uint16_t rate_hz) {
+    if (server == NULL) {
+        return;
+    }
+    uint32_t interval_ms = __web_interval_ms(rate_hz);
+    server->rate_hz = (uint16_t)(1000 / interval_ms);
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        server->clients[i].interval_ms = interval_ms;
+    }
+}
+
+void web_server_get_stats(const web_server_t* server, web_server_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (server == NULL) {
+        return;
+    }
+    *stats = server->stats;
+    stats->frames = server->closed;
+    for (uint8_t i = 0; i < WEB_MAX_CLIENTS; i++) {
+        const web_client_t* client = &server->clients[i];
+        if (client->state != WEB_CLIENT_WEBSOCKET && client->state != WEB_CLIENT_CLOSING) {
+            continue;
+        }
+        const telemetry_queue_stats_t* q = &client->queue.stats;
+        stats->websockets++;
+        stats->frames.queued += q->queued;
+        stats->frames.coalesced += q->coalesced;
+        stats->frames.dropped += q->dropped;
+        stats->frames.sent += q->sent;
+        stats->frames.bytes += q->bytes;
+    }
+}
@@ -0,0 +1,174 @@
+#include "websocket.h"
+
+#include <string.h>
+
+static const char kWsGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline uint32_t __ws_rol(uint32_t value, uint8_t bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static void __ws_sha1_block(uint32_t state[5], const uint8_t block[64]) {
+    uint32_t w[80];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    }
+    for (uint8_t i = 16; i < 80; i++) {
+        w[i] = __ws_rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for (uint8_t i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t t = __ws_rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = __ws_rol(b, 30);
+        b = a;
+        a = t;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void ws_sha1(const uint8_t* data, size_t len, uint8_t digest[20]) {
+    uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    uint8_t block[64];
+    size_t offset = 0;
+    while (len - offset >= 64) {
+        __ws_sha1_block(state, data + offset);
+        offset += 64;
+    }
+
+    // Padding: 0x80, zeros, then the bit length in the last 8 bytes
+    size_t rest = len - offset;
+    memset(block, 0, sizeof(block));
+    memcpy(block, data + offset, rest);
+    block[rest] = 0x80;
+    if (rest >= 56) {
+        __ws_sha1_block(state, block);
+        memset(block, 0, sizeof(block));
+    }
+    uint64_t bits = (uint64_t)len * 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        block[63 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    __ws_sha1_block(state, block);
+
+    for (uint8_t i = 0; i < 5; i++) {
+        digest[i * 4] = (uint8_t)(state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)state[i];
+    }
+}
+
+void ws_accept_key(const char* key, size_t key_len, char accept[WS_ACCEPT_KEY_LEN + 1]) {
+    // Keys are 24 characters; anything longer is truncated rather than overflowing
+    uint8_t input[64 + sizeof(kWsGuid)];
+    if (key_len > 64) {
+        key_len = 64;
+    }
+    memcpy(input, key, key_len);
+    memcpy(input + key_len, kWsGuid, sizeof(kWsGuid) - 1);
+
+    uint8_t digest[21];
+    ws_sha1(input, key_len + sizeof(kWsGuid) - 1, digest);
+    digest[20] = 0;
+
+    char* out = accept;
+    for (uint8_t i = 0; i < 21; i += 3) {
+        uint32_t triple = ((uint32_t)digest[i] << 16) | ((uint32_t)digest[i + 1] << 8) | digest[i + 2];
+        *out++ = kBase64[(triple >> 18) & 0x3F];
+        *out++ = kBase64[(triple >> 12) & 0x3F];
+        *out++ = kBase64[(triple >> 6) & 0x3F];
+        *out++ = kBase64[triple & 0x3F];
+    }
+    accept[WS_ACCEPT_KEY_LEN - 1] = '=';  // 20 bytes leave one pad character
+    accept[WS_ACCEPT_KEY_LEN] = '\0';
+}
+
+size_t ws_frame_header(uint8_t opcode, size_t payload_len, uint8_t* out) {
+    out[0] = (uint8_t)(0x80 | (opcode & 0x0F));
+    if (payload_len < 126) {
+        out[1] = (uint8_t)payload_len;
+        return 2;
+    }
+    if (payload_len <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = (uint8_t)(payload_len >> 8);
+        out[3] = (uint8_t)payload_len;
+        return 4;
+    }
+    out[1] = 127;
+    uint64_t len = payload_len;
+    for (uint8_t i = 0; i < 8; i++) {
+        out[2 + i] = (uint8_t)(len >> (56 - i * 8));
+    }
+    return 10;
+}
+
+ws_parse_result_t ws_parse(uint8_t* buf, size_t len, size_t max_payload, ws_frame_t* frame, size_t* consumed) {
+    if (len < 2) {
+        return WS_PARSE_INCOMPLETE;
+    }
+    if ((buf[0] & 0x70) != 0 || (buf[1] & 0x80) == 0) {
+        return WS_PARSE_ERROR;
+    }
+
+    size_t header = 2;
+    uint64_t payload_len = buf[1] & 0x7F;
+    if (payload_len == 126) {
+        if (len < 4) {
+            return WS_PARSE_INCOMPLETE;
+        }
+        payload_len = ((uint64_t)buf[2] << 8) | buf[3];
+        header = 4;
+    } else if (payload_len == 127) {
+        if (len < 10) {
+            return WS_PARSE_INCOMPLETE;
+        }
+        payload_len = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            payload_len = (payload_len << 8) | buf[2 + i];
+        }
+        header = 10;
+    }
+    if (payload_len > max_payload) {
+        return WS_PARSE_ERROR;
+    }
+    if (len < header + 4 + payload_len) {
+        return WS_PARSE_INCOMPLETE;
+    }
+
+    const uint8_t* mask = buf + header;
+    uint8_t* payload = buf + header + 4;
+    for (size_t i = 0; i < payload_len; i++) {
+        payload[i] ^= mask[i & 3];
+    }
+
+    frame->opcode = buf[0] & 0x0F;
+    frame->fin = (buf[0] & 0x80) != 0;
+    frame->payload = payload;
+    frame->length = (size_t)payload_len;
+    *consumed = header + 4 + (size_t)payload_len;
+    return WS_PARSE_FRAME;
+}
@@ -0,0 +1,96 @@
+#include "ws2812.h"
+
+#include <string.h>
+
+// Nearest whole tick; 0 if `ns` is too short to represent
+static uint32_t __ws2812_ticks(uint32_t ns, uint32_t tick_ns) {
+    return (ns + tick_ns / 2) / tick_ns;
+}
+
+static inline ws2812_symbol_t* __ws2812_byte(const ws2812_encoder_t* enc, uint8_t value, ws2812_symbol_t* out) {
+    memcpy(out, enc->nibble[value >> 4], sizeof(enc->nibble[0]));
+    memcpy(out + 4, enc->nibble[value & 0x0F], sizeof(enc->nibble[0]));
+    return out + 8;
+}
+
+bool ws2812_encoder_init(ws2812_encoder_t* enc, const ws2812_timing_t* timing, uint32_t tick_ns) {
+    if (!enc || !timing || tick_ns == 0) {
+        return false;
+    }
+
+    uint32_t t0h = __ws2812_ticks(timing->t0h_ns, tick_ns);
+    uint32_t t0l = __ws2812_ticks(timing->t0l_ns, tick_ns);
+    uint32_t t1h = __ws2812_ticks(timing->t1h_ns, tick_ns);
+    uint32_t t1l = __ws2812_ticks(timing->t1l_ns, tick_ns);
+    uint32_t reset = __ws2812_ticks((uint32_t)timing->reset_us * 1000, tick_ns);
+    if (t0h == 0 || t0l == 0 || t1h == 0 || t1l == 0 || reset == 0) {
+        return false;
+    }
+    if (t0h > WS2812_MAX_DURATION || t0l > WS2812_MAX_DURATION ||
+        t1h > WS2812_MAX_DURATION || t1l > WS2812_MAX_DURATION ||
+        reset > 2u * WS2812_MAX_DURATION) {
+        return false;
+    }
+
+    ws2812_symbol_t bit0 = ws2812_symbol((uint16_t)t0h, true, (uint16_t)t0l, false);
+    ws2812_symbol_t bit1 = ws2812_symbol((uint16_t)t1h, true, (uint16_t)t1l, false);
+    for (uint8_t value = 0; value < 16; value++) {
+        for (uint8_t bit = 0; bit < 4; bit++) {
+            enc->nibble[value][bit] = (value & (0x08 >> bit)) ? bit1 : bit0;
+        }
+    }
+    // Both halves low; the line is already low after the last bit
+    uint16_t half = (uint16_t)((reset + 1) / 2);
+    enc->latch = ws2812_symbol(half, false, half, false);
+    enc->tick_ns = tick_ns;
+    return true;
+}
+
+void ws2812_frame_init(const ws2812_encoder_t* enc, uint16_t count, ws2812_symbol_t* frame) {
+    if (!enc || !frame) {
+        return;
+    }
+    ws2812_symbol_t* out = frame;
+    for (size_t i = 0; i < (size_t)count * 3; i++) {
+        out = __ws2812_byte(enc, 0, out);
+    }
+    *out = enc->latch;
+}
+
+void ws2812_encode(const ws2812_encoder_t* enc, const led_rgb_t* pixels, uint16_t first, uint16_t end,
+                   ws2812_symbol_t* frame) {
+    if (!enc || !pixels || !frame) {
+        return;
+    }
+    ws2812_symbol_t* out = frame + (size_t)first * WS2812_SYMBOLS_PER_PIXEL;
+    for (uint16_t i = first; i < end; i++) {
+        const led_rgb_t& color = pixels[i];
+        out = __ws2812_byte(enc, color.g, out);
+        out = __ws2812_byte(enc, color.r, out);
+        out = __ws2812_byte(enc, color.b, out);
+    }
+}
+
+size_t ws2812_decode(const ws2812_symbol_t* symbols, size_t count, uint8_t* grb, size_t len) {
+    if (!symbols || !grb) {
+        return 0;
+    }
+    size_t bytes = 0;
+    uint8_t value = 0;
+    uint8_t bits = 0;
+    for (size_t i = 0; i < count && bytes < len; i++) {
+        ws2812_symbol_t symbol = symbols[i];
+        if (!(symbol & 0x8000)) {
+            break;
+        }
+        uint16_t high = symbol & WS2812_MAX_DURATION;
+        uint16_t low = (symbol >> 16) & WS2812_MAX_DURATION;
+        value = (uint8_t)((value << 1) | (high > low ? 1 : 0));
+        if (++bits == 8) {
+            grb[bytes++] = value;
+            value = 0;
+            bits = 0;
+        }
+    }
+    return bytes;
+}
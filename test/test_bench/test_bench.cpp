@@ -0,0 +1,353 @@
+#include <unity.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "button.h"
+#include "encoder.h"
+#include "imu.h"
+#include "key_matrix.h"
+#include "led_compositor.h"
+#include "sim.h"
+#include "ws2812.h"
+
+#define BENCH_ROUNDS        101     // odd, so the median is a round
+#define BENCH_CALLS         64      // calls per timed round; one call is below the clock's resolution
+#define BENCH_RAW_ACCEL     0x1234
+#define BENCH_RAW_GYRO      0xEDCB
+#define BENCH_IMU_BURST     64      // accel + gyro samples per conversion burst
+#define BENCH_KEY_PATTERN   64      // scans in the looped key sample pattern
+#define BENCH_LED_FRAME_MS  7       // animation clock step between composed frames
+
+// Host timings vary with the machine, the load and the optimization level,
+// so nothing is compared with a stored figure: costs are checked against
+// each other, and the absolute bounds only catch gross regressions. The
+// stored baseline is the board's: test_bench_device, in cycles.
+#define BENCH_MAX_ISR_NS    5000    // any single ISR or conversion
+#define BENCH_FLAT_RATIO    4.0     // 64 keys against 1 key: the scan cost must stay flat
+#define BENCH_LINEAR_RATIO  2.0     // per-pixel cost of a long strip against a short one
+#define BENCH_FAST_RATIO    1.5     // a fast path against the path it replaces
+
+/**
+ * @brief Per-call timing of one benchmark, in nanoseconds.
+ */
+typedef struct bench_result {
+    const char* name;
+    double min;
+    double median;
+    double max;
+    uint32_t items;     ///< Work items per call; 0 if the call is not a batch
+} bench_result_t;
+
+static double rounds[BENCH_ROUNDS];
+static volatile float sink;             // keeps conversions from being optimized out
+
+static int __bench_compare(const void* a, const void* b) {
+    double x = *static_cast<const double*>(a);
+    double y = *static_cast<const double*>(b);
+    return (x > y) - (x < y);
+}
+
+// Times BENCH_ROUNDS rounds of BENCH_CALLS calls; `prepare` runs before
+// every call and is timed with it, so it must be a few stores at most
+static bench_result_t __bench_measure(const char* name, void (*fn)(void* ctx), void (*prepare)(void* ctx), void* ctx,
+                                      uint32_t items) {
+    for (uint16_t r = 0; r < BENCH_ROUNDS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint16_t i = 0; i < BENCH_CALLS; i++) {
+            if (prepare) {
+                prepare(ctx);
+            }
+            fn(ctx);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        rounds[r] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / BENCH_CALLS;
+    }
+    qsort(rounds, BENCH_ROUNDS, sizeof(rounds[0]), __bench_compare);
+
+    bench_result_t result = {name, rounds[0], rounds[BENCH_ROUNDS / 2], rounds[BENCH_ROUNDS - 1], items};
+    char message[160];
+    int len = snprintf(message, sizeof(message),
+                       "{\"bench\":\"%s\",\"unit\":\"ns\",\"n\":%u,\"min\":%.1f,\"median\":%.1f,\"max\":%.1f", name,
+                       BENCH_ROUNDS, result.min, result.median, result.max);
+    if (items > 0 && len < (int)sizeof(message)) {
+        double median = (result.median > 0.0) ? result.median : 1.0;
+        len += snprintf(message + len, sizeof(message) - len, ",\"items\":%lu,\"per_sec\":%.0f",
+                        (unsigned long)items, items * 1e9 / median);
+    }
+    if (len < (int)sizeof(message)) {
+        snprintf(message + len, sizeof(message) - len, "}");
+    }
+    TEST_MESSAGE(message);
+    return result;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Input ISRs and their drain ----------------------------------------------
+
+// Detached instances: interrupts are never attached, the ISR bodies are called directly
+static encoder_t bench_encoder;
+static button_t bench_button;
+
+static void __bench_encoder_prepare(void* ctx) {
+    spsc_ring_reset(&bench_encoder.events);
+}
+
+static void __bench_encoder_isr(void* ctx) {
+    encoder_bench_isr(&bench_encoder);
+}
+
+static void __bench_button_prepare(void* ctx) {
+    spsc_ring_reset(&bench_button.events);
+}
+
+static void __bench_button_isr(void* ctx) {
+    button_bench_isr(&bench_button);
+}
+
+// One queued edge per call, alternating like a press and release
+static void __bench_button_process_prepare(void* ctx) {
+    input_event_t event;
+    event.timestamp_us = micros();
+    event.pin = bench_button.pin;
+    event.level = !bench_button.raw_level;
+    event.delta = 0;
+    event.stamp = 0;
+    button_inject(&bench_button, &event);
+}
+
+static void __bench_button_process(void* ctx) {
+    button_process(&bench_button);
+}
+
+static void test_input_isrs(void) {
+    encoder_reset(&bench_encoder, RE_CW, RE_CCW, RE_BTN, 0x3, HIGH);
+    bench_result_t encoder = __bench_measure("encoder_isr_ab", __bench_encoder_isr, __bench_encoder_prepare, NULL, 0);
+    button_reset(&bench_button, BTN_1, LOW, micros());
+    bench_result_t isr = __bench_measure("button_isr", __bench_button_isr, __bench_button_prepare, NULL, 0);
+    button_reset(&bench_button, BTN_1, LOW, micros());
+    bench_result_t process = __bench_measure("button_process", __bench_button_process,
+                                             __bench_button_process_prepare, NULL, 0);
+
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_ISR_NS, encoder.median);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_ISR_NS, isr.median);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_ISR_NS, process.median);
+}
+
+// IMU conversions ---------------------------------------------------------
+
+// A FIFO-sized burst of accel + gyro triplets, converted value by value and in batch
+static uint16_t bench_imu_raw[BENCH_IMU_BURST * 6];
+static float bench_imu_out[BENCH_IMU_BURST * 6];
+
+static void __bench_convert_accel(void* ctx) {
+    sink = imu_bench_convert_accel(BENCH_RAW_ACCEL);
+}
+
+static void __bench_convert_gyro(void* ctx) {
+    sink = imu_bench_convert_gyro(BENCH_RAW_GYRO);
+}
+
+static void __bench_convert_scalar(void* ctx) {
+    for (uint16_t i = 0; i < BENCH_IMU_BURST * 6; i += 6) {
+        bench_imu_out[i + 0] = imu_bench_convert_accel(bench_imu_raw[i + 0]);
+        bench_imu_out[i + 1] = imu_bench_convert_accel(bench_imu_raw[i + 1]);
+        bench_imu_out[i + 2] = imu_bench_convert_accel(bench_imu_raw[i + 2]);
+        bench_imu_out[i + 3] = imu_bench_convert_gyro(bench_imu_raw[i + 3]);
+        bench_imu_out[i + 4] = imu_bench_convert_gyro(bench_imu_raw[i + 4]);
+        bench_imu_out[i + 5] = imu_bench_convert_gyro(bench_imu_raw[i + 5]);
+    }
+    sink = bench_imu_out[0];
+}
+
+static void __bench_convert_batch(void* ctx) {
+    imu_convert_accel_batch(bench_imu_raw, BENCH_IMU_BURST / 2, 3, bench_imu_out);
+    imu_convert_gyro_batch(bench_imu_raw + 3 * (BENCH_IMU_BURST / 2), BENCH_IMU_BURST / 2, 3,
+                           bench_imu_out + 3 * (BENCH_IMU_BURST / 2));
+    sink = bench_imu_out[0];
+}
+
+static void __bench_convert_batch_fixed(void* ctx) {
+    int16_t* out = reinterpret_cast<int16_t*>(bench_imu_out);
+    imu_convert_accel_mg_batch(bench_imu_raw, BENCH_IMU_BURST / 2, 3, out);
+    imu_convert_gyro_ddps_batch(bench_imu_raw + 3 * (BENCH_IMU_BURST / 2), BENCH_IMU_BURST / 2, 3,
+                                out + 3 * (BENCH_IMU_BURST / 2));
+    sink = out[0];
+}
+
+static void test_imu_conversions(void) {
+    bench_result_t accel = __bench_measure("imu_convert_accel", __bench_convert_accel, NULL, NULL, 0);
+    bench_result_t gyro = __bench_measure("imu_convert_gyro", __bench_convert_gyro, NULL, NULL, 0);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_ISR_NS, accel.median);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_ISR_NS, gyro.median);
+
+    for (uint16_t i = 0; i < BENCH_IMU_BURST * 6; i++) {
+        bench_imu_raw[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+    bench_result_t scalar = __bench_measure("imu_convert_scalar_64", __bench_convert_scalar, NULL, NULL,
+                                            BENCH_IMU_BURST);
+    bench_result_t batch = __bench_measure("imu_convert_batch_64", __bench_convert_batch, NULL, NULL,
+                                           BENCH_IMU_BURST);
+    bench_result_t fixed = __bench_measure("imu_convert_fixed_64", __bench_convert_batch_fixed, NULL, NULL,
+                                           BENCH_IMU_BURST);
+    TEST_ASSERT_LESS_THAN(scalar.median * BENCH_FAST_RATIO, batch.median);
+    TEST_ASSERT_LESS_THAN(scalar.median * BENCH_FAST_RATIO, fixed.median);
+}
+
+// Key matrix debouncing ---------------------------------------------------
+
+// Synthetic samples: key k is down for 8 of every 64 scans starting at
+// scan 2k, about two changes per scan at 64 keys
+static key_matrix_t bench_keys;
+static uint32_t bench_key_raw[BENCH_KEY_PATTERN][KEY_MATRIX_WORDS];
+static uint8_t bench_key_step;
+static uint32_t bench_key_state[KEY_MATRIX_WORDS];
+static uint8_t bench_key_count[KEY_MATRIX_MAX_KEYS];
+
+static void __bench_key_pattern(void) {
+    memset(bench_key_raw, 0, sizeof(bench_key_raw));
+    for (uint8_t s = 0; s < BENCH_KEY_PATTERN; s++) {
+        for (uint8_t k = 0; k < KEY_MATRIX_MAX_KEYS; k++) {
+            if ((uint8_t)(s - 2 * k) % BENCH_KEY_PATTERN < 8) {
+                bench_key_raw[s][k >> 5] |= 1u << (k & 31);
+            }
+        }
+    }
+}
+
+static void __bench_key_prepare(void* ctx) {
+    bench_key_step = (bench_key_step + 1) % BENCH_KEY_PATTERN;
+}
+
+static void __bench_key_update(void* ctx) {
+    key_matrix_update(&bench_keys, bench_key_raw[bench_key_step], 0);
+}
+
+// The per-key integrator the vertical counter replaces
+static void __bench_key_scalar(void* ctx) {
+    const uint32_t* raw = bench_key_raw[bench_key_step];
+    for (uint8_t k = 0; k < KEY_MATRIX_MAX_KEYS; k++) {
+        uint32_t mask = 1u << (k & 31);
+        if (!(raw[k >> 5] & mask) == !(bench_key_state[k >> 5] & mask)) {
+            bench_key_count[k] = 0;
+        } else if (++bench_key_count[k] >= KEY_MATRIX_DEBOUNCE_SCANS) {
+            bench_key_count[k] = 0;
+            bench_key_state[k >> 5] ^= mask;
+        }
+    }
+    sink = (float)bench_key_state[0];
+}
+
+static void __bench_key_event(void* ctx, uint8_t key, bool pressed, uint32_t now_us) {
+    static_cast<uint32_t*>(ctx)[key >> 5] |= 1u << (key & 31);
+}
+
+static bench_result_t __bench_key_report(const char* name, uint8_t keys) {
+    static uint32_t events[KEY_MATRIX_WORDS];
+    key_matrix_reset(&bench_keys, keys);
+    key_matrix_set_callback(&bench_keys, __bench_key_event, events);
+    bench_key_step = 0;
+    return __bench_measure(name, __bench_key_update, __bench_key_prepare, NULL, 1);
+}
+
+static void test_key_debounce_is_flat(void) {
+    __bench_key_pattern();
+    bench_result_t one = __bench_key_report("key_debounce_1", 1);
+    __bench_key_report("key_debounce_32", 32);
+    bench_result_t all = __bench_key_report("key_debounce_64", KEY_MATRIX_MAX_KEYS);
+    bench_key_step = 0;
+    bench_result_t scalar = __bench_measure("key_debounce_scalar_64", __bench_key_scalar, __bench_key_prepare,
+                                            NULL, 1);
+
+    TEST_ASSERT_LESS_THAN(one.median * BENCH_FLAT_RATIO, all.median);
+    TEST_ASSERT_LESS_THAN(scalar.median * BENCH_FAST_RATIO, all.median);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_ISR_NS, all.median);
+}
+
+// LED frames --------------------------------------------------------------
+
+// Full recomposite of a strip with a chase, a pulse and a solid indicator
+static led_compositor_t bench_leds;
+static uint32_t bench_led_clock;
+
+static void __bench_led_prepare(void* ctx) {
+    bench_led_clock += BENCH_LED_FRAME_MS;
+    led_compositor_invalidate(&bench_leds);
+}
+
+static void __bench_led_compose(void* ctx) {
+    led_compositor_compose(&bench_leds, bench_led_clock);
+}
+
+static bench_result_t __bench_led_report(const char* name, uint16_t count) {
+    TEST_ASSERT_TRUE(led_compositor_init(&bench_leds, count));
+    led_rgb_t chase = {255, 96, 0};
+    led_rgb_t pulse = {0, 64, 255};
+    led_rgb_t solid = {0, 255, 0};
+    led_layer_set(&bench_leds, 0, LED_EFFECT_CHASE, chase, 0, count, 2000, 0);
+    led_layer_set_tail(&bench_leds, 0, 4);
+    led_layer_set(&bench_leds, 1, LED_EFFECT_PULSE, pulse, 0, count, 1500, 0);
+    led_layer_set_alpha(&bench_leds, 1, 96);
+    led_layer_set_blend(&bench_leds, 1, LED_BLEND_ADD);
+    led_layer_set(&bench_leds, 2, LED_EFFECT_SOLID, solid, 0, 1, 0, 0);
+    led_compositor_set_brightness(&bench_leds, 128);
+    bench_led_clock = 0;
+    bench_result_t result = __bench_measure(name, __bench_led_compose, __bench_led_prepare, NULL, count);
+    led_compositor_free(&bench_leds);
+    return result;
+}
+
+// Full-frame encode of a gradient into RMT symbols
+static ws2812_encoder_t bench_ws2812;
+static led_rgb_t* bench_ws2812_pixels;
+static ws2812_symbol_t* bench_ws2812_frame;
+static uint16_t bench_ws2812_count;
+
+static void __bench_ws2812_encode(void* ctx) {
+    ws2812_encode(&bench_ws2812, bench_ws2812_pixels, 0, bench_ws2812_count, bench_ws2812_frame);
+}
+
+static bench_result_t __bench_ws2812_report(const char* name, uint16_t count) {
+    bench_ws2812_pixels = static_cast<led_rgb_t*>(malloc(count * sizeof(led_rgb_t)));
+    bench_ws2812_frame = static_cast<ws2812_symbol_t*>(malloc(ws2812_frame_symbols(count) * sizeof(ws2812_symbol_t)));
+    TEST_ASSERT_NOT_NULL(bench_ws2812_pixels);
+    TEST_ASSERT_NOT_NULL(bench_ws2812_frame);
+    TEST_ASSERT_TRUE(ws2812_encoder_init(&bench_ws2812, &WS2812_TIMING_DEFAULT, 25));
+    for (uint16_t i = 0; i < count; i++) {
+        bench_ws2812_pixels[i].r = (uint8_t)(i * 7);
+        bench_ws2812_pixels[i].g = (uint8_t)(255 - i * 3);
+        bench_ws2812_pixels[i].b = (uint8_t)(i * 13);
+    }
+    ws2812_frame_init(&bench_ws2812, count, bench_ws2812_frame);
+    bench_ws2812_count = count;
+    bench_result_t result = __bench_measure(name, __bench_ws2812_encode, NULL, NULL, count);
+    free(bench_ws2812_frame);
+    free(bench_ws2812_pixels);
+    return result;
+}
+
+// Frame cost grows with the pixel count and nothing faster
+static void test_led_frames_scale_linearly(void) {
+    __bench_led_report("led_compose_3", 3);
+    bench_result_t short_strip = __bench_led_report("led_compose_60", 60);
+    bench_result_t long_strip = __bench_led_report("led_compose_300", 300);
+    TEST_ASSERT_LESS_THAN(short_strip.median / 60 * BENCH_LINEAR_RATIO, long_strip.median / 300);
+
+    short_strip = __bench_ws2812_report("ws2812_encode_60", 60);
+    long_strip = __bench_ws2812_report("ws2812_encode_300", 300);
+    TEST_ASSERT_LESS_THAN(short_strip.median / 60 * BENCH_LINEAR_RATIO, long_strip.median / 300);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_input_isrs);
+    RUN_TEST(test_imu_conversions);
+    RUN_TEST(test_key_debounce_is_flat);
+    RUN_TEST(test_led_frames_scale_linearly);
+    return UNITY_END();
+}
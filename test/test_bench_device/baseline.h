@@ -0,0 +1,29 @@
+#ifndef __BENCH_BASELINE_H__
+#define __BENCH_BASELINE_H__
+
+#include <stdint.h>
+
+// Median CPU cycles per call on an esp32dev, as printed by test_bench_device.
+// A bench regresses when its median exceeds
+// median * (100 + BENCH_TOLERANCE_PCT) / 100 + BENCH_SLACK_CYCLES.
+// A 0 median has not been recorded yet: the run prints the entry to paste
+// here and reports the test as ignored. Record again after a deliberate
+// slowdown, a core update or a change of CPU clock.
+#define BENCH_BASELINE_CPU_MHZ  240
+#define BENCH_TOLERANCE_PCT     25
+#define BENCH_SLACK_CYCLES      200     // interrupt and cache jitter on the cheapest calls
+
+typedef struct bench_baseline {
+    const char* name;
+    uint32_t median;
+} bench_baseline_t;
+
+static const bench_baseline_t kBenchBaseline[] = {
+    {"encoder_isr_ab", 0},
+    {"button_isr", 0},
+    {"imu_convert_batch_64", 0},
+    {"imu_read", 0},
+    {"neopixel_process_60", 0},
+};
+
+#endif  // __BENCH_BASELINE_H__
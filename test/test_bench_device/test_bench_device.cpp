@@ -0,0 +1,249 @@
+#include <unity.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "baseline.h"
+#include "button.h"
+#include "encoder.h"
+#include "imu.h"
+#include "neopixel.h"
+#include "pin.h"
+
+#define BENCH_ROUNDS        101     // odd, so the median is a round
+#define BENCH_IMU_ROUNDS    21      // each read holds the bus for about half a millisecond
+#define BENCH_IMU_BURST     64      // accel + gyro samples per conversion burst
+#define BENCH_NEO_COUNT     60      // more than the board's strip, so the frame cost shows
+#define BENCH_IMU_ADDR      0x68
+
+/**
+ * @brief Per-call timing of one benchmark, in CPU cycles.
+ *
+ * The cost of reading the cycle counter twice is measured first and subtracted.
+ */
+typedef struct bench_result {
+    const char* name;
+    uint32_t min;
+    uint32_t median;
+    uint32_t max;
+} bench_result_t;
+
+static uint32_t rounds[BENCH_ROUNDS];
+static uint8_t unrecorded;              // benches of the current test without a baseline
+static volatile float sink;             // keeps conversions from being optimized out
+
+static void __bench_sort(uint32_t* values, uint16_t count) {
+    for (uint16_t i = 1; i < count; i++) {
+        uint32_t value = values[i];
+        uint16_t j = i;
+        while (j > 0 && values[j - 1] > value) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+}
+
+static void __bench_empty(void* ctx) {
+}
+
+static uint32_t __bench_time(void (*fn)(void* ctx), void* ctx) {
+    uint32_t start = ESP.getCycleCount();
+    fn(ctx);
+    return ESP.getCycleCount() - start;
+}
+
+// Cheapest observed cost of timing an empty call
+static uint32_t __bench_overhead(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint16_t i = 0; i < BENCH_ROUNDS; i++) {
+        uint32_t elapsed = __bench_time(__bench_empty, NULL);
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static const bench_baseline_t* __bench_baseline(const char* name) {
+    for (size_t i = 0; i < sizeof(kBenchBaseline) / sizeof(kBenchBaseline[0]); i++) {
+        if (strcmp(kBenchBaseline[i].name, name) == 0) {
+            return &kBenchBaseline[i];
+        }
+    }
+    return NULL;
+}
+
+// Fails the test if the median is over the stored one plus the tolerance
+static void __bench_compare(const bench_result_t* result) {
+    char message[160];
+    const bench_baseline_t* baseline = __bench_baseline(result->name);
+    snprintf(message, sizeof(message), "%s has no entry in baseline.h", result->name);
+    TEST_ASSERT_TRUE_MESSAGE(baseline != NULL, message);
+
+    if (baseline->median == 0) {
+        snprintf(message, sizeof(message), "not recorded, baseline.h entry: {\"%s\", %lu},", result->name,
+                 (unsigned long)result->median);
+        TEST_MESSAGE(message);
+        unrecorded++;
+        return;
+    }
+    uint32_t limit = baseline->median + baseline->median / 100 * BENCH_TOLERANCE_PCT + BENCH_SLACK_CYCLES;
+    if (result->median > limit) {
+        snprintf(message, sizeof(message), "%s regressed: median %lu cycles, baseline %lu, limit %lu", result->name,
+                 (unsigned long)result->median, (unsigned long)baseline->median, (unsigned long)limit);
+        TEST_FAIL_MESSAGE(message);
+    }
+}
+
+// Times `iterations` calls one by one; `prepare` runs untimed before each
+static bench_result_t __bench_measure(const char* name, void (*fn)(void* ctx), void (*prepare)(void* ctx), void* ctx,
+                                      uint16_t iterations) {
+    uint32_t overhead = __bench_overhead();
+    for (uint16_t i = 0; i < iterations; i++) {
+        if (prepare) {
+            prepare(ctx);
+        }
+        uint32_t elapsed = __bench_time(fn, ctx);
+        rounds[i] = (elapsed > overhead) ? elapsed - overhead : 0;
+    }
+    __bench_sort(rounds, iterations);
+
+    bench_result_t result = {name, rounds[0], rounds[iterations / 2], rounds[iterations - 1]};
+    char message[160];
+    snprintf(message, sizeof(message),
+             "{\"bench\":\"%s\",\"unit\":\"cycles\",\"mhz\":%lu,\"n\":%u,\"min\":%lu,\"median\":%lu,\"max\":%lu}",
+             name, (unsigned long)ESP.getCpuFreqMHz(), iterations, (unsigned long)result.min,
+             (unsigned long)result.median, (unsigned long)result.max);
+    TEST_MESSAGE(message);
+    __bench_compare(&result);
+    return result;
+}
+
+void setUp(void) {
+    unrecorded = 0;
+    if (ESP.getCpuFreqMHz() != BENCH_BASELINE_CPU_MHZ) {
+        TEST_IGNORE_MESSAGE("CPU clock differs from the one baseline.h was recorded at");
+    }
+}
+
+void tearDown(void) {}
+
+// Recorded comparisons passed; a missing one is not a pass
+static void __bench_finish(void) {
+    if (unrecorded > 0) {
+        TEST_IGNORE_MESSAGE("baseline.h has unrecorded entries; paste the lines above");
+    }
+}
+
+// Input ISRs --------------------------------------------------------------
+
+// Detached instances: interrupts are never attached, the ISR bodies are called directly
+static encoder_t bench_encoder;
+static button_t bench_button;
+
+static void __bench_encoder_prepare(void* ctx) {
+    spsc_ring_reset(&bench_encoder.events);
+}
+
+static void __bench_encoder_isr(void* ctx) {
+    encoder_bench_isr(&bench_encoder);
+}
+
+static void __bench_button_prepare(void* ctx) {
+    spsc_ring_reset(&bench_button.events);
+}
+
+static void __bench_button_isr(void* ctx) {
+    button_bench_isr(&bench_button);
+}
+
+static void test_input_isrs(void) {
+    encoder_reset(&bench_encoder, RE_CW, RE_CCW, RE_BTN, 0x3, HIGH);
+    __bench_measure("encoder_isr_ab", __bench_encoder_isr, __bench_encoder_prepare, NULL, BENCH_ROUNDS);
+    button_reset(&bench_button, BTN_1, LOW, micros());
+    __bench_measure("button_isr", __bench_button_isr, __bench_button_prepare, NULL, BENCH_ROUNDS);
+    __bench_finish();
+}
+
+// IMU ---------------------------------------------------------------------
+
+static imu_t bench_imu;
+static uint16_t bench_imu_raw[BENCH_IMU_BURST * 6];
+static float bench_imu_out[BENCH_IMU_BURST * 6];
+
+static void __bench_convert_batch(void* ctx) {
+    imu_convert_accel_batch(bench_imu_raw, BENCH_IMU_BURST / 2, 3, bench_imu_out);
+    imu_convert_gyro_batch(bench_imu_raw + 3 * (BENCH_IMU_BURST / 2), BENCH_IMU_BURST / 2, 3,
+                           bench_imu_out + 3 * (BENCH_IMU_BURST / 2));
+    sink = bench_imu_out[0];
+}
+
+static void __bench_imu_read(void* ctx) {
+    imu_data_t data;
+    imu_read(static_cast<imu_t*>(ctx), &data);
+}
+
+static void test_imu_conversion(void) {
+    for (uint16_t i = 0; i < BENCH_IMU_BURST * 6; i++) {
+        bench_imu_raw[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+    __bench_measure("imu_convert_batch_64", __bench_convert_batch, NULL, NULL, BENCH_ROUNDS);
+    __bench_finish();
+}
+
+// The whole bus transaction: what the stream task waits for per sample
+static void test_imu_read(void) {
+    if (!imu_init(&bench_imu, IMU_INT, BENCH_IMU_ADDR, &Wire)) {
+        TEST_IGNORE_MESSAGE("no BMI323 on the bus");
+    }
+    imu_data_t data;
+    TEST_ASSERT_TRUE(imu_read(&bench_imu, &data));
+    __bench_measure("imu_read", __bench_imu_read, NULL, &bench_imu, BENCH_IMU_ROUNDS);
+    __bench_finish();
+}
+
+// LED frames --------------------------------------------------------------
+
+static neopixel_t bench_neopixel;
+
+// Make the next neopixel_process() call render and push a frame, once the last one is out
+static void __bench_neopixel_prepare(void* ctx) {
+    neopixel_t* neo = static_cast<neopixel_t*>(ctx);
+    while (neopixel_busy(neo)) {
+    }
+    neo->last_update_ms = millis() - neo->interval_ms;
+    neopixel_invalidate(neo);
+}
+
+static void __bench_neopixel_process(void* ctx) {
+    neopixel_process(static_cast<neopixel_t*>(ctx));
+}
+
+// Compose, encode and show(): with the RMT output, what the frame costs the CPU
+static void test_neopixel_process(void) {
+    TEST_ASSERT_TRUE(neopixel_init(&bench_neopixel, NEO_DATA, BENCH_NEO_COUNT));
+    led_rgb_t chase = {255, 96, 0};
+    led_layer_set(&bench_neopixel.leds, 0, LED_EFFECT_CHASE, chase, 0, BENCH_NEO_COUNT, 2000, millis());
+    __bench_measure("neopixel_process_60", __bench_neopixel_process, __bench_neopixel_prepare, &bench_neopixel,
+                    BENCH_ROUNDS);
+    neopixel_stats_t stats;
+    neopixel_get_stats(&bench_neopixel, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.deferred);
+    neopixel_shutdown(&bench_neopixel);
+    __bench_finish();
+}
+
+void setup() {
+    delay(2000);    // the monitor attaches after the upload resets the board
+    UNITY_BEGIN();
+    RUN_TEST(test_input_isrs);
+    RUN_TEST(test_imu_conversion);
+    RUN_TEST(test_imu_read);
+    RUN_TEST(test_neopixel_process);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,162 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "binlog.h"
+
+#define CAPTURE_SIZE    8192
+
+// Print stub that keeps everything written to it
+class CapturePrint : public Print {
+public:
+    uint8_t data[CAPTURE_SIZE];
+    size_t len = 0;
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        size_t n = (size < CAPTURE_SIZE - len) ? size : CAPTURE_SIZE - len;
+        memcpy(data + len, buffer, n);
+        len += n;
+        return n;
+    }
+
+    const char* text() {
+        data[len < CAPTURE_SIZE ? len : CAPTURE_SIZE - 1] = '\0';
+        return reinterpret_cast<const char*>(data);
+    }
+};
+
+static CapturePrint capture;
+
+static const char* __format(const char* format, const uint32_t* args, uint8_t argc) {
+    static char line[160];
+    binlog_test_format(line, sizeof(line), format, args, argc);
+    return line;
+}
+
+void setUp(void) {
+    binlog_init(&capture, BINLOG_MODE_TEXT);
+    binlog_service(SIZE_MAX);       // anything a previous test left, including a drop report
+    capture.len = 0;
+}
+
+void tearDown(void) {}
+
+// Catalog records through the ring: %ld and %lu take the raw 32 bits, floats are bit-cast
+static void test_text_records(void) {
+    BINLOG_INFO(STATUS_INPUT, -5, 1, 0, 4000000000u, 2u, 3u);
+    BINLOG_INFO(STATUS_TIMING, 12.5f, -3.0f, 179.9f, 40u, 1500u, 210u);
+    BINLOG_INFO(KEY_DOWN, 'w');
+    TEST_ASSERT_EQUAL_UINT32(3, binlog_service(16));
+    TEST_ASSERT_EQUAL_STRING("Enc:-5 | Btn:1 | KeyGate:0 | IMU:4000000000 ovr:2 miss:3 | "
+                             "RPY:12.5/-3.0/179.9 | In late:40/1500us run:210us | "
+                             "w DOWN\n",
+                             capture.text());
+}
+
+// Length modifiers are dropped, flags and widths kept, %% is literal
+static void test_text_conversions(void) {
+    uint32_t args[] = {static_cast<uint32_t>(-42), 0xBEEFu, binlog_arg(3.14159f), 'x', 7u};
+    TEST_ASSERT_EQUAL_STRING("-42|0000beef|  3.14|x|7%",
+                             __format("%hd|%08lx|%6.2f|%c|%zu%%", args, 5));
+    TEST_ASSERT_EQUAL_STRING("100% of -42", __format("100%% of %ld", args, 1));
+    TEST_ASSERT_EQUAL_STRING("-42 and ", __format("%li and %lu", args, 1));     // missing argument: nothing
+    uint32_t negative = binlog_arg(-1.5);                                     // doubles travel as float
+    TEST_ASSERT_EQUAL_STRING("-1.5e+00", __format("%.1e", &negative, 1));
+}
+
+// sync id argc timestamp[4] args[4 * argc] checksum, little endian, as tools/binlog_decode.py reads it
+static void test_raw_frame_layout(void) {
+    binlog_set_mode(BINLOG_MODE_RAW);
+    uint32_t now = micros();
+    BINLOG_INFO(BLE_RECONNECTED, 2u, 0x01020304u);
+    TEST_ASSERT_EQUAL_UINT32(1, binlog_service(16));
+    binlog_set_mode(BINLOG_MODE_TEXT);
+
+    static const uint8_t kArgs[] = {2, 0, 0, 0, 0x04, 0x03, 0x02, 0x01};
+    TEST_ASSERT_EQUAL_UINT32(3 + 4 + sizeof(kArgs) + 1, capture.len);
+    TEST_ASSERT_EQUAL_HEX8(BINLOG_FRAME_SYNC, capture.data[0]);
+    TEST_ASSERT_EQUAL_UINT8(BINLOG_MSG_BLE_RECONNECTED, capture.data[1]);
+    TEST_ASSERT_EQUAL_UINT8(2, capture.data[2]);
+    uint32_t timestamp = capture.data[3] | (capture.data[4] << 8) | (capture.data[5] << 16) |
+                         ((uint32_t)capture.data[6] << 24);
+    TEST_ASSERT_EQUAL_UINT32(now, timestamp);
+    TEST_ASSERT_EQUAL_MEMORY(kArgs, capture.data + 7, sizeof(kArgs));
+
+    uint8_t sum = 0;
+    for (size_t i = 1; i + 1 < capture.len; i++) {
+        sum += capture.data[i];
+    }
+    TEST_ASSERT_EQUAL_HEX8(sum, capture.data[capture.len - 1]);
+}
+
+// A full ring drops records; the next service reports the count before the survivors
+static void test_overflow_is_reported_in_band(void) {
+    binlog_stats_t before;
+    binlog_get_stats(&before);
+    for (size_t i = 0; i < BINLOG_CAPACITY + 5; i++) {
+        BINLOG_INFO(KEY_ECHO, 'a');
+    }
+    binlog_stats_t after;
+    binlog_get_stats(&after);
+    uint32_t dropped = after.dropped - before.dropped;
+    TEST_ASSERT_GREATER_OR_EQUAL(5, dropped);
+
+    size_t kept = BINLOG_CAPACITY + 5 - dropped;
+    TEST_ASSERT_EQUAL_UINT32(kept, binlog_service(SIZE_MAX));
+    char expected[48];
+    snprintf(expected, sizeof(expected), "[binlog] %lu records dropped\n", (unsigned long)dropped);
+    size_t header = strlen(expected);
+    TEST_ASSERT_EQUAL_UINT32(header + kept, capture.len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, capture.data, header);
+
+    // Reported once
+    capture.len = 0;
+    BINLOG_INFO(KEY_ECHO, 'b');
+    TEST_ASSERT_EQUAL_UINT32(1, binlog_service(SIZE_MAX));
+    TEST_ASSERT_EQUAL_STRING("b", capture.text());
+}
+
+// Raw mode reports the drop as a DROPPED frame carrying the count
+static void test_overflow_frame(void) {
+    binlog_stats_t before;
+    binlog_get_stats(&before);
+    for (size_t i = 0; i < BINLOG_CAPACITY + 1; i++) {
+        BINLOG_INFO(KEY_ECHO, 'a');
+    }
+    binlog_stats_t after;
+    binlog_get_stats(&after);
+    uint32_t dropped = after.dropped - before.dropped;
+
+    binlog_set_mode(BINLOG_MODE_RAW);
+    binlog_service(SIZE_MAX);
+    binlog_set_mode(BINLOG_MODE_TEXT);
+    TEST_ASSERT_EQUAL_HEX8(BINLOG_FRAME_SYNC, capture.data[0]);
+    TEST_ASSERT_EQUAL_UINT8(BINLOG_MSG_DROPPED, capture.data[1]);
+    TEST_ASSERT_EQUAL_UINT8(1, capture.data[2]);
+    uint32_t count;
+    memcpy(&count, capture.data + 7, sizeof(count));
+    TEST_ASSERT_EQUAL_UINT32(dropped, count);
+}
+
+static void test_unknown_id(void) {
+    uint32_t arg = 0;
+    binlog_write_raw(static_cast<binlog_msg_t>(200), &arg, 1);
+    binlog_service(1);
+    TEST_ASSERT_EQUAL_STRING("[binlog] unknown message 200\n", capture.text());
+    TEST_ASSERT_NULL(binlog_format(BINLOG_MSG_COUNT));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_text_records);
+    RUN_TEST(test_text_conversions);
+    RUN_TEST(test_raw_frame_layout);
+    RUN_TEST(test_overflow_is_reported_in_band);
+    RUN_TEST(test_overflow_frame);
+    RUN_TEST(test_unknown_id);
+    return UNITY_END();
+}
@@ -0,0 +1,251 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "ble_link.h"
+#include "hid_transport.h"
+
+#define CHECK_CYCLES    500     // drops, switches and reconnects through the link manager
+#define CHECK_HOSTS     6       // more than BLE_LINK_MAX_HOSTS, so slots get reused
+
+// Model of the manager's slots
+typedef struct link_model {
+    int8_t slot_host[BLE_LINK_MAX_HOSTS];   ///< -1 = empty
+    uint32_t slot_used[BLE_LINK_MAX_HOSTS];
+    uint32_t seq;
+    uint32_t evictions;
+    uint8_t last_evicted;
+} link_model_t;
+
+static hid_transport_t transport;
+static hid_transport_fake_t fake;
+static ble_link_t link;
+static ble_link_config_t config;
+static ble_link_hooks_t hooks;
+static uint32_t fake_now_ms;
+static ble_link_record_t saved;
+static bool has_saved;
+
+static uint32_t __fake_clock(void) {
+    return fake_now_ms;
+}
+
+static bool __load(void* ctx, ble_link_record_t* record) {
+    if (has_saved) {
+        *record = saved;
+    }
+    return has_saved;
+}
+
+static bool __save(void* ctx, const ble_link_record_t* record) {
+    saved = *record;
+    has_saved = true;
+    return true;
+}
+
+static void __host_addr(uint8_t host, hid_transport_addr_t* addr) {
+    static const uint8_t base[6] = {0x5A, 0x1A, 0x00, 0x00, 0x00, 0x01};
+    addr->type = HID_TRANSPORT_ADDR_PUBLIC;
+    memcpy(addr->addr, base, sizeof(base));
+    addr->addr[5] = (uint8_t)(base[5] + host);
+}
+
+static bool __is_host(const hid_transport_addr_t* addr, uint8_t host) {
+    hid_transport_addr_t expected;
+    __host_addr(host, &expected);
+    return addr->type == expected.type && memcmp(addr->addr, expected.addr, sizeof(expected.addr)) == 0;
+}
+
+static void __connect(uint8_t host) {
+    hid_transport_addr_t addr;
+    __host_addr(host, &addr);
+    hid_transport_fake_link(&fake, true, &addr);
+}
+
+// Runs the manager at its deadlines, like the ble job, up to `until_ms`
+static void __run(ble_link_t* l, uint32_t until_ms) {
+    for (;;) {
+        uint32_t wait_ms = ble_link_service(l);
+        if (wait_ms == UINT32_MAX || fake_now_ms + wait_ms > until_ms) {
+            break;
+        }
+        fake_now_ms += wait_ms;
+    }
+    fake_now_ms = until_ms;
+    ble_link_service(l);
+}
+
+// Mirrors the manager's slot choice: same slot for a known host, else the least recently used
+static uint8_t __model_up(link_model_t* model, uint8_t host) {
+    uint8_t slot = BLE_LINK_NO_HOST;
+    for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+        if (model->slot_host[i] == host) {
+            slot = i;
+        }
+    }
+    if (slot == BLE_LINK_NO_HOST) {
+        slot = 0;
+        for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+            if (model->slot_used[i] < model->slot_used[slot]) {
+                slot = i;
+            }
+        }
+        if (model->slot_host[slot] >= 0) {
+            model->evictions++;
+            model->last_evicted = (uint8_t)model->slot_host[slot];
+        }
+        model->slot_host[slot] = (int8_t)host;
+    }
+    model->slot_used[slot] = ++model->seq;
+    return slot;
+}
+
+static uint32_t __random(uint32_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+void setUp(void) {
+    fake_now_ms = 0;
+    has_saved = false;
+    hid_transport_fake_init(&transport, &fake);
+    fake.connected = false;
+    ble_link_default_config(&config);
+    hooks = {__load, __save, NULL, NULL};
+    ble_link_init(&link, &transport, &config, &hooks);
+    link.now_ms = __fake_clock;
+}
+
+void tearDown(void) {}
+
+// Nothing stored: general advertising until the first host pairs
+static void test_first_host_pairs_on_general_advertising(void) {
+    ble_link_start(&link);
+    TEST_ASSERT_TRUE(fake.advertising);
+    TEST_ASSERT_FALSE(fake.directed);
+    TEST_ASSERT_EQUAL(BLE_LINK_GENERAL, link.state);
+
+    __run(&link, 1500);
+    __connect(0);
+    __run(&link, 1500);
+    TEST_ASSERT_EQUAL(BLE_LINK_CONNECTED, link.state);
+    TEST_ASSERT_EQUAL_UINT32(1500, link.stats.boot_ms);
+    TEST_ASSERT_TRUE(has_saved);
+}
+
+// Drops and switches against the model: every drop must be followed by
+// directed advertising to the host that left (or the one switched to) and
+// a fallback once the burst runs out, every eviction must delete the
+// oldest bond, and the reconnect stats and stored hosts must come out as
+// modelled. After a power cycle the saved record brings the burst
+// straight back to the last host.
+static void test_reconnect_cycles_match_model(void) {
+    link_model_t model;
+    memset(&model, 0, sizeof(model));
+    memset(model.slot_host, -1, sizeof(model.slot_host));
+    uint32_t seed = 0x9E3779B9u;
+    uint32_t reconnects = 0;
+    uint32_t total_ms = 0;
+    uint32_t max_ms = 0;
+    uint32_t hits = 0;
+    uint32_t fallbacks = 0;
+    uint32_t switches = 0;
+
+    ble_link_start(&link);
+    __connect(0);
+    __run(&link, 1500);
+    uint8_t host = 0;
+    __model_up(&model, host);
+
+    for (uint32_t cycle = 0; cycle < CHECK_CYCLES; cycle++) {
+        uint32_t down_ms = fake_now_ms + 1000 + __random(&seed) % 10000;
+        __run(&link, down_ms);
+
+        // Either a switch to another stored host or a drop; both direct the burst
+        uint8_t target = host;
+        uint8_t pick = (uint8_t)(__random(&seed) % BLE_LINK_MAX_HOSTS);
+        if (__random(&seed) % 4 == 0 && model.slot_host[pick] >= 0 && model.slot_host[pick] != host) {
+            target = (uint8_t)model.slot_host[pick];
+            ble_link_select(&link, pick);
+            switches++;
+        } else {
+            hid_transport_fake_link(&fake, false, NULL);
+        }
+        __run(&link, down_ms);
+        TEST_ASSERT_TRUE(fake.advertising);
+        TEST_ASSERT_TRUE(fake.directed);
+        TEST_ASSERT_TRUE(__is_host(&fake.target, target));
+        TEST_ASSERT_EQUAL(BLE_LINK_DIRECTED, link.state);
+
+        // The target answers within the burst, or the manager falls back and anyone may come
+        uint32_t up_ms;
+        if (__random(&seed) % 3 != 0) {
+            up_ms = down_ms + 1 + __random(&seed) % (config.directed_ms - 1);
+            host = target;
+            hits++;
+        } else {
+            __run(&link, down_ms + config.directed_ms);
+            TEST_ASSERT_TRUE(fake.advertising);
+            TEST_ASSERT_FALSE(fake.directed);
+            TEST_ASSERT_EQUAL(BLE_LINK_GENERAL, link.state);
+            up_ms = down_ms + config.directed_ms + __random(&seed) % 5000;
+            host = (uint8_t)(__random(&seed) % CHECK_HOSTS);
+            fallbacks++;
+        }
+        __run(&link, up_ms);
+        uint32_t forgotten = fake.forgotten;
+        __connect(host);
+        __run(&link, up_ms);
+        uint32_t evictions = model.evictions;
+        uint8_t slot = __model_up(&model, host);
+        TEST_ASSERT_EQUAL(BLE_LINK_CONNECTED, link.state);
+        TEST_ASSERT_EQUAL_UINT8(slot, link.peer);
+        TEST_ASSERT_EQUAL_UINT8(slot, link.record.last);
+        TEST_ASSERT_EQUAL_UINT32(model.evictions - evictions, fake.forgotten - forgotten);
+        if (model.evictions != evictions) {
+            TEST_ASSERT_TRUE(__is_host(&fake.last_forgotten, model.last_evicted));
+        }
+        reconnects++;
+        total_ms += up_ms - down_ms;
+        if (up_ms - down_ms > max_ms) {
+            max_ms = up_ms - down_ms;
+        }
+    }
+
+    ble_link_stats_t stats;
+    ble_link_get_stats(&link, &stats);
+    TEST_ASSERT_EQUAL_UINT32(reconnects, stats.reconnects);
+    TEST_ASSERT_EQUAL_UINT32(total_ms, stats.total_reconnect_ms);
+    TEST_ASSERT_EQUAL_UINT32(max_ms, stats.max_reconnect_ms);
+    TEST_ASSERT_EQUAL_UINT32(hits, stats.directed_hits);
+    TEST_ASSERT_EQUAL_UINT32(fallbacks, stats.fallbacks);
+    TEST_ASSERT_EQUAL_UINT32(switches, stats.switches);
+    TEST_ASSERT_EQUAL_UINT32(CHECK_CYCLES, stats.directed);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.save_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+    for (uint8_t i = 0; i < BLE_LINK_MAX_HOSTS; i++) {
+        const ble_link_host_t* stored = ble_link_host(&link, i);
+        TEST_ASSERT_EQUAL(model.slot_host[i] < 0, stored == NULL);
+        if (stored) {
+            TEST_ASSERT_TRUE(__is_host(&stored->addr, (uint8_t)model.slot_host[i]));
+        }
+    }
+
+    static ble_link_t reloaded;
+    hid_transport_fake_link(&fake, false, NULL);
+    ble_link_init(&reloaded, &transport, &config, &hooks);
+    reloaded.now_ms = __fake_clock;
+    ble_link_start(&reloaded);
+    TEST_ASSERT_EQUAL_MEMORY(&link.record, &reloaded.record, sizeof(link.record));
+    TEST_ASSERT_TRUE(fake.directed);
+    TEST_ASSERT_TRUE(__is_host(&fake.target, host));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_host_pairs_on_general_advertising);
+    RUN_TEST(test_reconnect_cycles_match_model);
+    return UNITY_END();
+}
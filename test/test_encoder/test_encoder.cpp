@@ -0,0 +1,106 @@
+#include <unity.h>
+
+#include <sim.h>
+
+#include "encoder.h"
+
+#define DETENT_GAP_US   10000   // 100 detents per second
+
+// Detached: interrupts are never attached, detents arrive through encoder_inject()
+static encoder_t encoder;
+
+// One detent at the current time
+static void __detent(int8_t dir) {
+    input_event_t event = {micros(), 0, RE_CW, LOW, dir};
+    encoder_inject(&encoder, &event);
+}
+
+// `count` detents DETENT_GAP_US apart, the last one now
+static void __turn(uint8_t count, int8_t dir) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (i > 0) {
+            sim_busy_us(DETENT_GAP_US);
+        }
+        __detent(dir);
+    }
+}
+
+void setUp(void) {
+    sim_busy_us(ENCODER_VELOCITY_TIMEOUT_US);   // away from the previous test's detents
+    encoder_reset(&encoder, RE_CW, RE_CCW, RE_BTN, ENCODER_DETENT_STATE, HIGH);
+}
+
+void tearDown(void) {}
+
+// Steady at the detent rate, slows with the time since the last detent, stops at the timeout
+static void test_velocity_decays_to_zero(void) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, encoder_get_velocity(&encoder));
+    __turn(3, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, encoder_get_velocity(&encoder));
+
+    sim_busy_us(4 * DETENT_GAP_US);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.0f, encoder_get_velocity(&encoder));
+    sim_busy_us(ENCODER_VELOCITY_TIMEOUT_US - 4 * DETENT_GAP_US - 1);
+    TEST_ASSERT_GREATER_THAN(0.0f, encoder_get_velocity(&encoder));
+    sim_busy_us(1);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, encoder_get_velocity(&encoder));
+
+    __turn(3, -1);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -100.0f, encoder_get_velocity(&encoder));
+}
+
+// Gain 1 up to min_speed, linear to max_gain at max_speed, flat above
+static void test_gain_interpolates_between_speeds(void) {
+    encoder_accel_t accel = {20.0f, 120.0f, 5.0f};
+    encoder_set_accel(&encoder, &accel);
+
+    __turn(2, 1);                                   // 100/s: 80% of the way, gain 4.2
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, encoder_get_velocity(&encoder));
+    TEST_ASSERT_EQUAL_INT32(8, encoder_take_accel_delta(&encoder));
+
+    sim_busy_us(ENCODER_VELOCITY_TIMEOUT_US);
+    encoder_set_accel(&encoder, &accel);
+    __turn(2, 1);
+    sim_busy_us(DETENT_GAP_US * 5);                 // read at min_speed: no gain
+    TEST_ASSERT_EQUAL_INT32(2, encoder_take_accel_delta(&encoder));
+
+    accel.max_speed = 50.0f;
+    encoder_set_accel(&encoder, &accel);
+    __turn(2, 1);                                   // over max_speed: max_gain
+    TEST_ASSERT_EQUAL_INT32(10, encoder_take_accel_delta(&encoder));
+
+    encoder_set_accel(&encoder, NULL);
+    __turn(2, 1);
+    TEST_ASSERT_EQUAL_INT32(2, encoder_take_accel_delta(&encoder));
+}
+
+// Half steps add up to whole ones, and are dropped when the turn reverses
+static void test_residual_carries_and_resets_on_reversal(void) {
+    encoder_accel_t accel = {0.0f, 4.0f, 1.5f};     // any movement is at max gain
+    encoder_set_accel(&encoder, &accel);
+
+    static const int32_t kSteps[] = {1, 2, 1, 2};
+    for (uint8_t i = 0; i < 4; i++) {
+        __turn(1, 1);
+        TEST_ASSERT_EQUAL_INT32(kSteps[i], encoder_take_accel_delta(&encoder));
+        sim_busy_us(DETENT_GAP_US);
+    }
+
+    __turn(1, 1);
+    TEST_ASSERT_EQUAL_INT32(1, encoder_take_accel_delta(&encoder));   // +0.5 carried
+    sim_busy_us(DETENT_GAP_US);
+    __turn(1, -1);
+    TEST_ASSERT_EQUAL_INT32(-1, encoder_take_accel_delta(&encoder));  // -1.5, not -1.0
+    sim_busy_us(DETENT_GAP_US);
+    __turn(1, -1);
+    TEST_ASSERT_EQUAL_INT32(-2, encoder_take_accel_delta(&encoder));
+    TEST_ASSERT_EQUAL_INT32(0, encoder_take_accel_delta(&encoder));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_velocity_decays_to_zero);
+    RUN_TEST(test_gain_interpolates_between_speeds);
+    RUN_TEST(test_residual_carries_and_resets_on_reversal);
+    return UNITY_END();
+}
@@ -0,0 +1,135 @@
+#include <unity.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+#include "fusion.h"
+
+#define RATE_HZ             100
+#define DT_S                (1.0f / RATE_HZ)
+#define DEG_TO_RAD_F        0.017453292f
+#define ANGLE_TOLERANCE_DEG 1.0f
+#define BENCH_UPDATES       200000
+#define BENCH_MAX_NS        5000    // a few hundred ns on any host; only catches gross regressions
+
+static fusion_t fusion;
+
+void setUp(void) {
+    fusion_init(&fusion, FUSION_DEFAULT_BETA);
+}
+
+void tearDown(void) {}
+
+// Gravity as seen by a board rolled by `roll_deg` about X
+static void __tilted(imu_data_t* data, float roll_deg) {
+    data->accel_x = 0.0f;
+    data->accel_y = sinf(roll_deg * DEG_TO_RAD_F);
+    data->accel_z = cosf(roll_deg * DEG_TO_RAD_F);
+    data->gyro_x = 0.0f;
+    data->gyro_y = 0.0f;
+    data->gyro_z = 0.0f;
+    data->temp = 23.0f;
+}
+
+static void test_first_sample_seeds_tilt(void) {
+    imu_data_t data;
+    __tilted(&data, 30.0f);
+    fusion_update_dt(&fusion, &data, DT_S);
+    float roll, pitch;
+    fusion_get_euler(&fusion, &roll, &pitch, NULL);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 30.0f, roll);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 0.0f, pitch);
+}
+
+// Gyro alone: 90 deg/s about Z for one second
+static void test_gyro_integrates_yaw(void) {
+    imu_data_t data;
+    __tilted(&data, 0.0f);
+    data.gyro_z = 90.0f;
+    for (int i = 0; i < RATE_HZ; i++) {
+        fusion_update_dt(&fusion, &data, DT_S);
+    }
+    float roll, pitch, yaw;
+    fusion_get_euler(&fusion, &roll, &pitch, &yaw);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 90.0f, yaw);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 0.0f, roll);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 0.0f, pitch);
+}
+
+// A tilt the gyro missed is pulled in by the accelerometer within seconds
+static void test_accel_corrects_drift(void) {
+    imu_data_t data;
+    __tilted(&data, 0.0f);
+    fusion_update_dt(&fusion, &data, DT_S);
+    __tilted(&data, 20.0f);
+    for (int i = 0; i < 10 * RATE_HZ; i++) {
+        fusion_update_dt(&fusion, &data, DT_S);
+    }
+    float roll;
+    fusion_get_euler(&fusion, &roll, NULL, NULL);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 20.0f, roll);
+}
+
+// A stationary, tilted board keeps its attitude and its quaternion normalized
+static void test_stationary_is_stable(void) {
+    imu_data_t data;
+    __tilted(&data, -45.0f);
+    for (int i = 0; i < 60 * RATE_HZ; i++) {
+        fusion_update_dt(&fusion, &data, DT_S);
+    }
+    float q[4];
+    fusion_get_quaternion(&fusion, q);
+    float norm = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, norm);
+    float roll, yaw;
+    fusion_get_euler(&fusion, &roll, NULL, &yaw);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, -45.0f, roll);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 0.0f, yaw);
+}
+
+static void test_timestamps_drive_dt(void) {
+    imu_sample_t sample = {};
+    __tilted(&sample.data, 0.0f);
+    sample.data.gyro_z = 90.0f;
+    sample.flags = IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID;
+    for (int i = 0; i <= RATE_HZ; i++) {
+        sample.timestamp_us = 1000000u + (uint32_t)i * (1000000u / RATE_HZ);
+        fusion_update(&fusion, &sample);
+    }
+    float yaw;
+    fusion_get_euler(&fusion, NULL, NULL, &yaw);
+    TEST_ASSERT_FLOAT_WITHIN(ANGLE_TOLERANCE_DEG, 90.0f, yaw);
+}
+
+// Host wall clock: the figure is printed, the bound is deliberately loose
+static void test_update_cost(void) {
+    imu_data_t data;
+    __tilted(&data, 10.0f);
+    data.gyro_x = 3.0f;
+    data.gyro_z = -7.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_UPDATES; i++) {
+        data.accel_x = (i & 1) ? 0.01f : -0.01f;
+        fusion_update_dt(&fusion, &data, DT_S);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / BENCH_UPDATES;
+
+    char message[64];
+    snprintf(message, sizeof(message), "fusion_update_dt: %.1f ns/update", ns);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_UPDATES, fusion.updates);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_NS, ns);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_seeds_tilt);
+    RUN_TEST(test_gyro_integrates_yaw);
+    RUN_TEST(test_accel_corrects_drift);
+    RUN_TEST(test_stationary_is_stable);
+    RUN_TEST(test_timestamps_drive_dt);
+    RUN_TEST(test_update_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,282 @@
+#include <unity.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gesture.h"
+#include "trace.h"
+
+#define TRACE_BUFFER_SIZE   (64 * 1024)
+#define MAX_EVENTS          8
+#define DEG_TO_RAD_F        0.017453292f
+#define PI_F                3.14159265f
+#define BENCH_SAMPLES       200000
+#define BENCH_MAX_NS        5000    // the budget at 400 Hz is 2.5 ms; this only catches gross regressions
+
+/**
+ * Board motion over time: angles in degrees, linear acceleration in g.
+ */
+typedef struct motion {
+    float roll;             ///< About X (flick down is positive)
+    float pitch;            ///< About Y (nose down is positive)
+    float yaw;              ///< About Z (flick right is positive)
+    float linear_y;         ///< Hand acceleration along Y
+} motion_t;
+
+typedef void (*motion_fn)(float t, motion_t* m);
+
+/**
+ * One recording and what the recognizer has to report for it, in order.
+ */
+typedef struct recording {
+    const char* name;
+    motion_fn motion;
+    float seconds;
+    uint16_t rate_hz;
+    uint8_t expected_count;
+    gesture_type_t expected[4];
+    bool active[4];
+} recording_t;
+
+static uint8_t trace_data[TRACE_BUFFER_SIZE];
+static size_t trace_len;
+static size_t trace_pos;
+static trace_recorder_t recorder;
+static uint32_t noise_state;
+
+static bool __buffer_sink(void* ctx, const uint8_t* data, size_t len) {
+    if (trace_len + len > sizeof(trace_data)) {
+        return false;
+    }
+    memcpy(trace_data + trace_len, data, len);
+    trace_len += len;
+    return true;
+}
+
+static size_t __buffer_read(void* ctx, uint8_t* data, size_t len) {
+    size_t n = trace_len - trace_pos;
+    if (n > len) n = len;
+    memcpy(data, trace_data + trace_pos, n);
+    trace_pos += n;
+    return n;
+}
+
+// Deterministic sensor noise in [-1, 1)
+static float __noise(void) {
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (float)(noise_state >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+// Smooth move by `degrees` between `start` and `start + width`: the rate is
+// a half-sine pulse
+static float __move(float t, float start, float width, float degrees) {
+    if (t <= start) return 0.0f;
+    if (t >= start + width) return degrees;
+    return degrees * 0.5f * (1.0f - cosf(PI_F * (t - start) / width));
+}
+
+static void __still(float t, motion_t* m) {}
+
+static void __flick_right(float t, motion_t* m) {
+    m->yaw = __move(t, 0.5f, 0.12f, 55.0f);
+}
+
+static void __flick_left(float t, motion_t* m) {
+    m->yaw = __move(t, 0.5f, 0.12f, -55.0f);
+}
+
+// Out and back: the return is too slow to be a flick or to settle into a tilt
+static void __flick_down(float t, motion_t* m) {
+    m->roll = __move(t, 0.5f, 0.12f, 55.0f) - __move(t, 0.65f, 0.3f, 55.0f);
+}
+
+static void __flick_up(float t, motion_t* m) {
+    m->roll = __move(t, 0.5f, 0.12f, -55.0f) - __move(t, 0.65f, 0.3f, -55.0f);
+}
+
+// 5 Hz wrist shake, short enough to end inside the refractory time: the
+// hand moves along Y while the wrist twists about Z
+static void __shake(float t, motion_t* m) {
+    if (t < 0.5f || t > 1.1f) return;
+    float phase = 2.0f * PI_F * 5.0f * (t - 0.5f);
+    m->linear_y = 1.2f * sinf(phase);
+    m->yaw = 15.0f * sinf(phase);
+}
+
+static void __tilt_right(float t, motion_t* m) {
+    m->roll = __move(t, 0.3f, 0.4f, 40.0f) - __move(t, 2.0f, 0.4f, 40.0f);
+}
+
+static void __tilt_back(float t, motion_t* m) {
+    m->pitch = __move(t, 0.3f, 0.4f, -40.0f) - __move(t, 2.0f, 0.4f, -40.0f);
+}
+
+// Turning the board around at a walking pace is not a gesture
+static void __slow_turn(float t, motion_t* m) {
+    m->yaw = __move(t, 0.3f, 1.5f, 120.0f);
+}
+
+// A lean at hand speed, back before the hold time is up
+static void __brief_lean(float t, motion_t* m) {
+    m->roll = __move(t, 0.3f, 0.3f, -35.0f) - __move(t, 0.65f, 0.3f, -35.0f);
+}
+
+static const recording_t kRecordings[] = {
+    {"still", __still, 3.0f, 200, 0, {}, {}},
+    {"flick-right", __flick_right, 1.5f, 200, 1, {GESTURE_FLICK_RIGHT}, {true}},
+    {"flick-right@100", __flick_right, 1.5f, 100, 1, {GESTURE_FLICK_RIGHT}, {true}},
+    {"flick-right@400", __flick_right, 1.5f, 400, 1, {GESTURE_FLICK_RIGHT}, {true}},
+    {"flick-left", __flick_left, 1.5f, 200, 1, {GESTURE_FLICK_LEFT}, {true}},
+    {"flick-down", __flick_down, 1.5f, 200, 1, {GESTURE_FLICK_DOWN}, {true}},
+    {"flick-up", __flick_up, 1.5f, 200, 1, {GESTURE_FLICK_UP}, {true}},
+    {"shake", __shake, 2.0f, 200, 1, {GESTURE_SHAKE}, {true}},
+    {"tilt-right", __tilt_right, 3.5f, 200, 2, {GESTURE_TILT_RIGHT, GESTURE_TILT_RIGHT}, {true, false}},
+    {"tilt-back@100", __tilt_back, 3.5f, 100, 2, {GESTURE_TILT_BACK, GESTURE_TILT_BACK}, {true, false}},
+    {"slow-turn", __slow_turn, 2.5f, 200, 0, {}, {}},
+    {"brief-lean", __brief_lean, 1.5f, 200, 0, {}, {}},
+};
+
+// What the IMU reports for the motion at `t`: gravity in the board frame
+// plus linear acceleration, rates by finite difference, and sensor noise
+static void __sense(motion_fn motion, float t, float dt, imu_data_t* data) {
+    motion_t now = {}, before = {};
+    motion(t, &now);
+    motion(t - dt, &before);
+    float roll = now.roll * DEG_TO_RAD_F;
+    float pitch = now.pitch * DEG_TO_RAD_F;
+    data->accel_x = sinf(pitch) + 0.01f * __noise();
+    data->accel_y = cosf(pitch) * sinf(roll) + now.linear_y + 0.01f * __noise();
+    data->accel_z = cosf(pitch) * cosf(roll) + 0.01f * __noise();
+    data->gyro_x = (now.roll - before.roll) / dt + 0.5f + 1.5f * __noise();
+    data->gyro_y = (now.pitch - before.pitch) / dt - 0.3f + 1.5f * __noise();
+    data->gyro_z = (now.yaw - before.yaw) / dt + 0.2f + 1.5f * __noise();
+    data->temp = 0.0f;
+}
+
+// Records the motion the way the firmware does, into trace_data
+static void __record(const recording_t* rec) {
+    trace_len = 0;
+    trace_pos = 0;
+    noise_state = 12345;
+    trace_recorder_init(&recorder, __buffer_sink, NULL);
+    recorder.active = true;     // no writer task: stop() drains through the sink directly
+
+    uint32_t period_us = 1000000u / rec->rate_hz;
+    uint32_t samples = (uint32_t)(rec->seconds * rec->rate_hz);
+    imu_sample_t sample = {};
+    sample.flags = IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID;
+    for (uint32_t i = 0; i < samples; i++) {
+        sample.timestamp_us = 5000000u + i * period_us;
+        __sense(rec->motion, (float)i / rec->rate_hz, 1.0f / rec->rate_hz, &sample.data);
+        trace_record_imu(&recorder, &sample);
+        trace_recorder_service(&recorder);
+    }
+    trace_recorder_stop(&recorder);
+    TEST_ASSERT_EQUAL_UINT32(samples, recorder.stats.records);
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.stats.dropped);
+}
+
+// Plays the recorded trace through a fresh recognizer
+static uint8_t __classify(gesture_event_t* events, uint8_t capacity) {
+    gesture_t g;
+    gesture_init(&g, NULL);
+    trace_reader_t reader;
+    trace_reader_init(&reader, __buffer_read, NULL);
+    trace_record_t record;
+    gesture_event_t event;
+    uint8_t count = 0;
+    while (trace_reader_next(&reader, &record)) {
+        if (record.type == TRACE_REC_IMU && gesture_update(&g, &record.imu, &event) && count < capacity) {
+            events[count++] = event;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, reader.bad_chunks);
+    return count;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_recordings_classify(void) {
+    uint8_t correct = 0;
+    for (size_t i = 0; i < sizeof(kRecordings) / sizeof(kRecordings[0]); i++) {
+        const recording_t* rec = &kRecordings[i];
+        __record(rec);
+        gesture_event_t events[MAX_EVENTS];
+        uint8_t count = __classify(events, MAX_EVENTS);
+
+        char message[96];
+        int len = snprintf(message, sizeof(message), "%s:", rec->name);
+        for (uint8_t e = 0; e < count && len < (int)sizeof(message); e++) {
+            len += snprintf(message + len, sizeof(message) - len, " %s%s", events[e].active ? "" : "/",
+                            gesture_name(events[e].type));
+        }
+        TEST_MESSAGE(message);
+
+        bool match = (count == rec->expected_count);
+        for (uint8_t e = 0; match && e < count; e++) {
+            match = events[e].type == rec->expected[e] && events[e].active == rec->active[e];
+        }
+        correct += match ? 1 : 0;
+    }
+    TEST_ASSERT_EQUAL_UINT8(sizeof(kRecordings) / sizeof(kRecordings[0]), correct);
+}
+
+// Peak rate, swept angle and tilt angle come out close to the motion's own
+static void test_event_strengths(void) {
+    gesture_event_t events[MAX_EVENTS];
+    __record(&kRecordings[1]);
+    TEST_ASSERT_EQUAL_UINT8(1, __classify(events, MAX_EVENTS));
+    // the pulse peaks at 55 deg * pi / (2 * 0.12 s)
+    TEST_ASSERT_FLOAT_WITHIN(40.0f, 55.0f * PI_F / 0.24f, events[0].strength);
+
+    __record(&kRecordings[8]);
+    TEST_ASSERT_EQUAL_UINT8(2, __classify(events, MAX_EVENTS));
+    TEST_ASSERT_FLOAT_WITHIN(15.0f, 30.0f, events[0].strength);   // caught while the lean is still settling
+    TEST_ASSERT_GREATER_OR_EQUAL(25.0f, events[0].strength);
+}
+
+// Host wall clock over a recorded mix of motions: loose bound, figure printed
+static void test_update_cost(void) {
+    __record(&kRecordings[7]);
+    static imu_sample_t samples[1024];
+    trace_reader_t reader;
+    trace_reader_init(&reader, __buffer_read, NULL);
+    trace_record_t record;
+    uint32_t count = 0;
+    while (count < 1024 && trace_reader_next(&reader, &record)) {
+        if (record.type == TRACE_REC_IMU) samples[count++] = record.imu;
+    }
+    TEST_ASSERT_GREATER_THAN(0, count);
+
+    gesture_t g;
+    gesture_init(&g, NULL);
+    gesture_event_t event;
+    uint32_t events = 0;
+    imu_sample_t sample;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        sample = samples[i % count];
+        sample.timestamp_us = i * 5000u;
+        events += gesture_update(&g, &sample, &event) ? 1 : 0;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / BENCH_SAMPLES;
+
+    char message[64];
+    snprintf(message, sizeof(message), "gesture_update: %.1f ns/sample, %lu events", ns, (unsigned long)events);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_SAMPLES, g.count);
+    TEST_ASSERT_LESS_THAN(BENCH_MAX_NS, ns);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recordings_classify);
+    RUN_TEST(test_event_strengths);
+    RUN_TEST(test_update_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,211 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "hid_report.h"
+
+#define SINK_CAPACITY   64
+#define WINDOW_US       HID_COMPOSER_DEFAULT_WINDOW_US
+#define USAGE_A         0x04
+#define USAGE_B         0x05
+#define MOD_LEFT_SHIFT  0x02
+
+// Records what it is handed and answers with `result`
+typedef struct fake_sink {
+    hid_send_result_t result;
+    hid_key_report_t reports[SINK_CAPACITY];   ///< Most recent ones, by count modulo capacity
+    uint32_t count;     ///< Reports handed over (whatever the answer)
+} fake_sink_t;
+
+static hid_composer_t hid;
+static fake_sink_t sink;
+static uint32_t fake_now;
+
+static uint32_t __fake_clock(void) {
+    return fake_now;
+}
+
+static hid_send_result_t __fake_send(void* ctx, const hid_key_report_t* report) {
+    fake_sink_t* s = static_cast<fake_sink_t*>(ctx);
+    s->reports[s->count % SINK_CAPACITY] = *report;
+    s->count++;
+    return s->result;
+}
+
+static bool __holds(const hid_key_report_t* report, uint8_t usage) {
+    for (uint8_t i = 0; i < HID_REPORT_MAX_KEYS; i++) {
+        if (report->keys[i] == usage) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const hid_key_report_t* __last_report(void) {
+    return &sink.reports[(sink.count - 1) % SINK_CAPACITY];
+}
+
+// Polls the way the input job does until the composer has nothing left
+static void __drain(void) {
+    for (int i = 0; i < 4 * HID_REPORT_QUEUE_CAPACITY && hid_composer_busy(&hid); i++) {
+        uint32_t wait = hid_composer_poll(&hid);
+        fake_now += wait ? wait : 1;
+    }
+}
+
+void setUp(void) {
+    memset(&sink, 0, sizeof(sink));
+    sink.result = HID_SEND_OK;
+    fake_now = 1000000;
+    latency_reset();
+    hid_composer_init(&hid, __fake_send, &sink);
+    hid_composer_set_clock(&hid, __fake_clock);
+}
+
+void tearDown(void) {}
+
+static void test_press_is_sent_from_poll(void) {
+    TEST_ASSERT_TRUE(hid_composer_press(&hid, 'a'));
+    TEST_ASSERT_EQUAL_UINT32(0, sink.count);   // never from the caller of press
+    hid_composer_poll(&hid);
+    TEST_ASSERT_EQUAL_UINT32(1, sink.count);
+    TEST_ASSERT_TRUE(__holds(&sink.reports[0], USAGE_A));
+    TEST_ASSERT_EQUAL_UINT32(1, hid.stats.sent);
+    TEST_ASSERT_FALSE(hid_composer_busy(&hid));
+}
+
+static void test_shifted_character_sets_shift(void) {
+    hid_composer_tap(&hid, 'A');
+    __drain();
+    TEST_ASSERT_EQUAL_UINT32(2, sink.count);
+    TEST_ASSERT_EQUAL_HEX8(MOD_LEFT_SHIFT, sink.reports[0].modifiers);
+    TEST_ASSERT_TRUE(__holds(&sink.reports[0], USAGE_A));
+    TEST_ASSERT_EQUAL_HEX8(0, sink.reports[1].modifiers);
+    TEST_ASSERT_FALSE(__holds(&sink.reports[1], USAGE_A));
+}
+
+// Changes inside one window share a report
+static void test_changes_within_window_coalesce(void) {
+    hid_composer_press(&hid, 'a');
+    hid_composer_poll(&hid);
+    fake_now += 100;
+    hid_composer_press(&hid, 'b');
+    fake_now += 100;
+    hid_composer_press(&hid, 'c');
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_US - 200, hid_composer_poll(&hid));
+    TEST_ASSERT_EQUAL_UINT32(1, sink.count);
+    __drain();
+    TEST_ASSERT_EQUAL_UINT32(2, sink.count);
+    TEST_ASSERT_TRUE(__holds(&sink.reports[1], USAGE_A));
+    TEST_ASSERT_TRUE(__holds(&sink.reports[1], USAGE_B));
+    TEST_ASSERT_EQUAL_UINT32(2, hid.stats.composed);
+}
+
+// A tap inside the window is never merged away
+static void test_tap_is_never_lost(void) {
+    hid_composer_press(&hid, 'a');
+    hid_composer_poll(&hid);
+    fake_now += 10;
+    hid_composer_tap(&hid, 'b');
+    __drain();
+    bool seen = false;
+    for (uint32_t i = 0; i < sink.count; i++) {
+        seen = seen || __holds(&sink.reports[i], USAGE_B);
+    }
+    TEST_ASSERT_TRUE(seen);
+    TEST_ASSERT_FALSE(__holds(__last_report(), USAGE_B));
+}
+
+// A refused report stays queued and is resent in order
+static void test_busy_sink_keeps_reports(void) {
+    sink.result = HID_SEND_BUSY;
+    hid_composer_tap(&hid, 'a');
+    hid_composer_poll(&hid);
+    hid_composer_poll(&hid);
+    TEST_ASSERT_EQUAL_UINT32(0, hid.stats.sent);
+    TEST_ASSERT_EQUAL_UINT32(2, hid.stats.congested);
+    TEST_ASSERT_TRUE(hid_composer_busy(&hid));
+
+    sink.result = HID_SEND_OK;
+    uint32_t refused = sink.count;
+    __drain();
+    TEST_ASSERT_EQUAL_UINT32(2, hid.stats.sent);
+    TEST_ASSERT_TRUE(__holds(&sink.reports[refused], USAGE_A));
+    TEST_ASSERT_FALSE(__holds(&sink.reports[refused + 1], USAGE_A));
+}
+
+// Offline: reports leave the queue but are neither sent nor timed
+static void test_discarded_reports_are_not_sent(void) {
+    sink.result = HID_SEND_DISCARDED;
+    hid_composer_set_origin(&hid, LATENCY_SRC_BUTTON, latency_stamp());
+    hid_composer_tap(&hid, 'a');
+    __drain();
+    TEST_ASSERT_EQUAL_UINT32(2, sink.count);
+    TEST_ASSERT_EQUAL_UINT32(0, hid.stats.sent);
+    TEST_ASSERT_EQUAL_UINT32(2, hid.stats.discarded);
+    TEST_ASSERT_FALSE(hid_composer_busy(&hid));
+
+    latency_summary_t summary;
+    latency_get_summary(LATENCY_SRC_BUTTON, &summary);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.samples);
+}
+
+static void test_sent_reports_are_timed(void) {
+    hid_composer_set_origin(&hid, LATENCY_SRC_BUTTON, latency_stamp());
+    hid_composer_press(&hid, 'a');
+    __drain();
+    latency_summary_t summary;
+    latency_get_summary(LATENCY_SRC_BUTTON, &summary);
+    TEST_ASSERT_EQUAL_UINT32(1, summary.samples);
+}
+
+// A stalled sink under the merge policy: the queue stops growing, the
+// newest report carries the latest state
+static void test_full_queue_merges(void) {
+    sink.result = HID_SEND_BUSY;
+    for (uint8_t i = 0; i < HID_REPORT_QUEUE_CAPACITY + 4; i++) {
+        hid_composer_tap(&hid, 'a' + (i % 20));
+        fake_now += WINDOW_US;
+        hid_composer_poll(&hid);
+    }
+    TEST_ASSERT_EQUAL_UINT8(HID_REPORT_QUEUE_CAPACITY, hid.queue_count);
+    TEST_ASSERT_GREATER_THAN(0, hid.stats.merged);
+    sink.result = HID_SEND_OK;
+    __drain();
+    TEST_ASSERT_EQUAL_UINT32(0, __last_report()->keys[0]);
+}
+
+// Under the drop policy the host still ends on the real state
+static void test_full_queue_drops_then_resyncs(void) {
+    hid_composer_set_backpressure(&hid, HID_BACKPRESSURE_DROP, 1);
+    sink.result = HID_SEND_BUSY;
+    for (uint8_t i = 0; i < HID_REPORT_QUEUE_CAPACITY + 4; i++) {
+        hid_composer_tap(&hid, 'a');
+        fake_now += WINDOW_US;
+        hid_composer_poll(&hid);
+    }
+    hid_composer_press(&hid, 'b');
+    fake_now += WINDOW_US;
+    hid_composer_poll(&hid);
+    TEST_ASSERT_GREATER_THAN(0, hid.stats.dropped);
+
+    sink.result = HID_SEND_OK;
+    __drain();
+    const hid_key_report_t* last = __last_report();
+    TEST_ASSERT_TRUE(__holds(last, USAGE_B));
+    TEST_ASSERT_FALSE(__holds(last, USAGE_A));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_press_is_sent_from_poll);
+    RUN_TEST(test_shifted_character_sets_shift);
+    RUN_TEST(test_changes_within_window_coalesce);
+    RUN_TEST(test_tap_is_never_lost);
+    RUN_TEST(test_busy_sink_keeps_reports);
+    RUN_TEST(test_discarded_reports_are_not_sent);
+    RUN_TEST(test_sent_reports_are_timed);
+    RUN_TEST(test_full_queue_merges);
+    RUN_TEST(test_full_queue_drops_then_resyncs);
+    return UNITY_END();
+}
@@ -0,0 +1,145 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "hid_report.h"
+#include "hid_transport.h"
+
+#define CHECK_STEPS     2000    // key actions through the composer and fake link
+#define CHECK_KEYS      6       // 'a'.. : every key fits in one report
+
+static hid_transport_t transport;
+static hid_transport_fake_t fake;
+static uint32_t fake_now;
+
+static uint32_t __fake_clock(void) {
+    return fake_now;
+}
+
+static hid_send_result_t __send(void* ctx, const hid_key_report_t* report) {
+    return hid_transport_send(static_cast<hid_transport_t*>(ctx), report) ? HID_SEND_OK : HID_SEND_BUSY;
+}
+
+// 'a' + k is usage 0x04 + k
+static bool __holds(const hid_key_report_t* report, uint8_t usage) {
+    for (uint8_t i = 0; i < HID_REPORT_MAX_KEYS; i++) {
+        if (report->keys[i] == usage) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t __random(uint32_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+void setUp(void) {
+    fake_now = 0;
+    hid_transport_fake_init(&transport, &fake);
+    fake.now_us = __fake_clock;
+}
+
+void tearDown(void) {}
+
+// Only `per_event` reports fit in one connection event
+static void test_fake_refuses_past_event_budget(void) {
+    hid_key_report_t report;
+    memset(&report, 0, sizeof(report));
+    for (uint8_t i = 0; i < fake.per_event; i++) {
+        TEST_ASSERT_TRUE(hid_transport_send(&transport, &report));
+    }
+    TEST_ASSERT_FALSE(hid_transport_send(&transport, &report));
+    TEST_ASSERT_EQUAL_UINT32(1, transport.stats.refused);
+
+    fake_now += fake.interval_us;
+    TEST_ASSERT_TRUE(hid_transport_send(&transport, &report));
+    TEST_ASSERT_EQUAL_UINT32(fake.per_event + 1, fake.received);
+
+    hid_transport_fake_link(&fake, false, NULL);
+    TEST_ASSERT_FALSE(hid_transport_send(&transport, &report));
+    TEST_ASSERT_EQUAL_UINT32(fake.per_event + 1, fake.received);
+}
+
+// Composer over a congested fake link on a virtual clock, one key action
+// per coalescing window: every press and tap must reach the host exactly
+// once, nothing may be left queued and the last report must be empty
+static void test_composer_over_congested_link(void) {
+    static hid_composer_t composer;
+    uint32_t seed = 0x2545F491u;
+    uint32_t expected[CHECK_KEYS] = {};
+    uint32_t seen[CHECK_KEYS] = {};
+    bool held[CHECK_KEYS] = {};
+    hid_key_report_t last;
+    memset(&last, 0, sizeof(last));
+    uint32_t checked = 0;
+
+    fake.per_event = 1;         // a tap's press and the previous release contend
+    hid_composer_init(&composer, __send, &transport);
+    hid_composer_set_clock(&composer, __fake_clock);
+
+    // One action per step, then check what the host got so far
+    for (uint32_t step = 0; step < CHECK_STEPS + 100; step++) {
+        if (step < CHECK_STEPS) {
+            uint8_t k = __random(&seed) % CHECK_KEYS;
+            uint8_t key = (uint8_t)('a' + k);
+            if (held[k]) {
+                hid_composer_release(&composer, key);
+                held[k] = false;
+            } else if (__random(&seed) & 1) {
+                hid_composer_press(&composer, key);
+                held[k] = true;
+                expected[k]++;
+            } else {
+                hid_composer_tap(&composer, key);
+                expected[k]++;
+            }
+        } else {
+            for (uint8_t k = 0; k < CHECK_KEYS; k++) {
+                if (held[k]) {
+                    hid_composer_release(&composer, (uint8_t)('a' + k));
+                    held[k] = false;
+                }
+            }
+        }
+        // Poll whenever the composer asks to, like the hid job, until the next action
+        uint32_t next_us = fake_now + HID_COMPOSER_DEFAULT_WINDOW_US + __random(&seed) % HID_COMPOSER_DEFAULT_WINDOW_US;
+        for (;;) {
+            uint32_t wait_us = hid_composer_poll(&composer);
+            if (wait_us == 0 || fake_now + wait_us >= next_us) {
+                break;
+            }
+            fake_now += wait_us;
+        }
+        fake_now = next_us;
+
+        for (; checked < fake.received; checked++) {
+            const hid_key_report_t* report = hid_transport_fake_report(&fake, checked);
+            TEST_ASSERT_NOT_NULL(report);
+            for (uint8_t k = 0; k < CHECK_KEYS; k++) {
+                if (__holds(report, 0x04 + k) && !__holds(&last, 0x04 + k)) {
+                    seen[k]++;
+                }
+            }
+            last = *report;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, seen, CHECK_KEYS);
+    hid_key_report_t empty;
+    memset(&empty, 0, sizeof(empty));
+    TEST_ASSERT_FALSE(hid_composer_busy(&composer));
+    TEST_ASSERT_EQUAL_MEMORY(&empty, &last, sizeof(last));
+    TEST_ASSERT_EQUAL_UINT32(composer.stats.sent, fake.received);
+    TEST_ASSERT_GREATER_THAN(0, transport.stats.refused);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fake_refuses_past_event_budget);
+    RUN_TEST(test_composer_over_congested_link);
+    return UNITY_END();
+}
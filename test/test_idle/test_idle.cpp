@@ -0,0 +1,149 @@
+#include <unity.h>
+
+#include <sim.h>
+
+#include "button.h"
+#include "encoder.h"
+#include "idle.h"
+#include "scheduler.h"
+
+#define POLL_PERIOD_US      100000  // slow job, so waits between its runs can sleep
+#define SETTLE_US           50000   // past the button debounce
+
+static button_t button;
+static encoder_t encoder;
+static scheduler_t sched;
+static idle_manager_t idle;
+static idle_config_t config;
+static bool link_up;
+static uint32_t idle_changes;
+
+// As main.cpp's light-sleep hooks, minus the jobs it pauses
+static bool __can_sleep(void* ctx) {
+    return !link_up;
+}
+
+static void __on_idle(void* ctx, bool to_idle) {
+    idle_changes++;
+}
+
+static bool __on_wake(void* ctx) {
+    bool moved = button_resync(&button);
+    if (encoder_resync(&encoder)) {
+        moved = true;
+    }
+    return moved;
+}
+
+static void __poll_job(void* ctx) {
+    button_process(&button);
+    encoder_process(&encoder);
+}
+
+static void __run_for(uint32_t us) {
+    uint32_t end_us = micros() + us;
+    while ((int32_t)(micros() - end_us) < 0) {
+        scheduler_run(&sched);
+    }
+}
+
+// Idle after the configured quiet time, with at least one light sleep behind it
+static void __run_until_asleep(void) {
+    __run_for(config.idle_after_ms * 1000 + config.max_sleep_ms * 1000);
+    TEST_ASSERT_TRUE(idle.idle);
+    TEST_ASSERT_GREATER_THAN(0, idle.stats.sleeps);
+}
+
+void setUp(void) {
+    sim_gpio_set_pull(BTN_1, LOW);
+    sim_gpio_set_pull(RE_BTN, HIGH);
+    sim_gpio_set_pull(RE_CW, HIGH);
+    sim_gpio_set_pull(RE_CCW, HIGH);
+    link_up = false;
+    idle_changes = 0;
+
+    button_init(&button, BTN_1);
+    encoder_init(&encoder, RE_CW, RE_CCW, RE_BTN);
+    scheduler_init(&sched, NULL);
+    scheduler_add(&sched, "poll", __poll_job, NULL, POLL_PERIOD_US);
+    idle_default_config(&config);
+    idle_hooks_t hooks = {__can_sleep, __on_idle, __on_wake, NULL};
+    idle_init(&idle, &sched, &config, &hooks, true);
+    TEST_ASSERT_TRUE(idle_add_wake_pin(&idle, BTN_1, CHANGE));
+    TEST_ASSERT_TRUE(idle_add_wake_pin(&idle, RE_CW, CHANGE));
+    TEST_ASSERT_TRUE(idle_add_wake_pin(&idle, RE_CCW, CHANGE));
+    TEST_ASSERT_TRUE(idle_add_wake_pin(&idle, RE_BTN, CHANGE));
+}
+
+void tearDown(void) {
+    sim_gpio_release(BTN_1);
+    sim_gpio_release(RE_CW);
+    sim_gpio_release(RE_CCW);
+    sim_gpio_release(RE_BTN);
+}
+
+// The edge that wakes the chip never reaches the ISR: on_wake must feed it
+// through encoder_resync(), and the edges after the wake arrive as usual,
+// so a turn that starts in light sleep loses no detent
+static void test_encoder_edge_in_sleep_is_resynced(void) {
+    __run_until_asleep();
+    encoder_process(&encoder);
+    encoder_take_delta(&encoder);
+
+    uint32_t sleeps = idle.stats.sleeps;
+    uint64_t t = sim_now_us() + 30000;
+    sim_gpio_set_at(t, RE_CW, LOW);             // 11 -> 01: wakes the chip
+    sim_gpio_set_at(t + 5000, RE_CCW, LOW);     // 01 -> 00: seen by the ISR
+    __run_for(60000);
+
+    TEST_ASSERT_EQUAL_UINT32(1, idle.stats.gpio_wakes);
+    TEST_ASSERT_EQUAL_UINT32(1, idle.stats.resynced);
+    TEST_ASSERT_EQUAL_UINT32(sleeps + 1, idle.stats.sleeps);
+    TEST_ASSERT_FALSE(idle.idle);               // the wake counted as activity
+    encoder_process(&encoder);
+    int32_t delta = encoder_take_delta(&encoder);
+    TEST_ASSERT_EQUAL_INT32(2, delta < 0 ? -delta : delta);
+}
+
+// A press that wakes the chip is debounced from the resynced edge
+static void test_button_press_in_sleep_is_resynced(void) {
+    __run_until_asleep();
+    TEST_ASSERT_FALSE(button_read(&button));
+    sim_gpio_set_at(sim_now_us() + 20000, BTN_1, HIGH);
+    __run_for(20000 + SETTLE_US + POLL_PERIOD_US);
+
+    TEST_ASSERT_EQUAL_UINT32(1, idle.stats.gpio_wakes);
+    TEST_ASSERT_EQUAL_UINT32(1, idle.stats.resynced);
+    TEST_ASSERT_TRUE(button_read(&button));
+}
+
+// A connected host keeps the chip awake: the manager still goes idle but only waits
+static void test_no_light_sleep_while_connected(void) {
+    link_up = true;
+    __run_for(config.idle_after_ms * 1000 + 3 * config.max_sleep_ms * 1000);
+    TEST_ASSERT_TRUE(idle.idle);
+    TEST_ASSERT_EQUAL_UINT32(1, idle_changes);
+    TEST_ASSERT_EQUAL_UINT32(0, idle.stats.sleeps);
+
+    link_up = false;
+    __run_for(config.max_sleep_ms * 1000);
+    TEST_ASSERT_GREATER_THAN(0, idle.stats.sleeps);
+    TEST_ASSERT_EQUAL_UINT32(0, idle.stats.gpio_wakes);
+}
+
+static void test_wake_pin_table_overflow_is_reported(void) {
+    TEST_ASSERT_TRUE(idle_add_wake_pin(&idle, IMU_INT, RISING));
+    TEST_ASSERT_TRUE(idle_add_wake_pin(&idle, BTN_0, DISABLED));
+    TEST_ASSERT_EQUAL_UINT8(IDLE_MAX_WAKE_PINS, idle.pin_count);
+    TEST_ASSERT_FALSE(idle_add_wake_pin(&idle, NEO_DATA, DISABLED));
+    TEST_ASSERT_EQUAL_UINT8(IDLE_MAX_WAKE_PINS, idle.pin_count);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_encoder_edge_in_sleep_is_resynced);
+    RUN_TEST(test_button_press_in_sleep_is_resynced);
+    RUN_TEST(test_no_light_sleep_while_connected);
+    RUN_TEST(test_wake_pin_table_overflow_is_reported);
+    return UNITY_END();
+}
@@ -0,0 +1,308 @@
+#include <unity.h>
+
+#include <Wire.h>
+#include <math.h>
+#include <string.h>
+
+#include "imu.h"
+#include "sim.h"
+
+#define FAKE_ADDR           0x68
+#define FAKE_DUMMY_BYTES    2
+#define FAKE_FIFO_FILL_REG  0x15
+#define FAKE_FIFO_DATA_REG  0x16
+#define FAKE_FIFO_WORDS     256
+#define ACC_DUMMY           0x7F01
+#define GYR_DUMMY           0x7F02
+
+// Register file behind its own bus that counts every transaction
+typedef struct fake_bmi323 {
+    sim_i2c_device_t device;
+    uint16_t regs[128];
+    uint8_t reg;
+    uint16_t fifo[FAKE_FIFO_WORDS];     ///< FIFO_DATA pops from here; FIFO_FILL_LEVEL reports the rest
+    uint16_t fifo_head;
+    uint16_t fifo_len;
+    uint32_t writes;
+    uint32_t reads;
+    size_t last_read_len;
+} fake_bmi323_t;
+
+static TwoWire bus;
+static fake_bmi323_t fake;
+static imu_t imu;
+
+static void __fake_write(void* ctx, const uint8_t* data, size_t len) {
+    fake_bmi323_t* dev = static_cast<fake_bmi323_t*>(ctx);
+    dev->writes++;
+    if (len > 0) {
+        dev->reg = data[0] & 0x7F;
+    }
+}
+
+static size_t __fake_read(void* ctx, uint8_t* data, size_t len) {
+    fake_bmi323_t* dev = static_cast<fake_bmi323_t*>(ctx);
+    dev->reads++;
+    dev->last_read_len = len;
+    for (size_t i = 0; i < len; i++) {
+        if (i < FAKE_DUMMY_BYTES) {
+            data[i] = 0xFF;
+            continue;
+        }
+        size_t word = (i - FAKE_DUMMY_BYTES) / 2;
+        uint16_t value;
+        if (dev->reg == FAKE_FIFO_DATA_REG) {
+            value = dev->fifo[(dev->fifo_head + word) % FAKE_FIFO_WORDS];
+        } else if (dev->reg == FAKE_FIFO_FILL_REG && word == 0) {
+            value = dev->fifo_len;
+        } else {
+            value = dev->regs[(dev->reg + word) & 0x7F];
+        }
+        data[i] = ((i - FAKE_DUMMY_BYTES) & 1) ? (uint8_t)(value >> 8) : (uint8_t)(value & 0xFF);
+    }
+    if (dev->reg == FAKE_FIFO_DATA_REG && len > FAKE_DUMMY_BYTES) {
+        uint16_t words = (uint16_t)((len - FAKE_DUMMY_BYTES) / 2);
+        dev->fifo_head = (uint16_t)((dev->fifo_head + words) % FAKE_FIFO_WORDS);
+        dev->fifo_len = (words > dev->fifo_len) ? 0 : (uint16_t)(dev->fifo_len - words);
+    }
+    return len;
+}
+
+void setUp(void) {
+    static bool attached = false;
+    memset(fake.regs, 0, sizeof(fake.regs));
+    fake.fifo_head = 0;
+    fake.fifo_len = 0;
+    if (!attached) {
+        fake.device.address = FAKE_ADDR;
+        fake.device.ctx = &fake;
+        fake.device.write = __fake_write;
+        fake.device.read = __fake_read;
+        sim_i2c_attach(&bus, &fake.device);
+        attached = true;
+    }
+    // Skips imu_init(): only the read path is under test
+    memset(&imu, 0, sizeof(imu));
+    imu.i2c_addr = FAKE_ADDR;
+    imu.wire = &bus;
+    imu.initialized = true;
+    imu_fifo_parser_reset(&imu.fifo_parser);
+}
+
+void tearDown(void) {}
+
+static void test_read_is_one_burst(void) {
+    uint32_t writes = fake.writes;
+    uint32_t reads = fake.reads;
+    imu_data_t data;
+    TEST_ASSERT_TRUE(imu_read(&imu, &data));
+    TEST_ASSERT_EQUAL_UINT32(1, fake.writes - writes);
+    TEST_ASSERT_EQUAL_UINT32(1, fake.reads - reads);
+    TEST_ASSERT_EQUAL_UINT32(FAKE_DUMMY_BYTES + 7 * 2, fake.last_read_len);
+}
+
+static void test_read_decodes_every_register(void) {
+    int16_t accel[3] = {(int16_t)imu_config_t::accel_lsb_per_g(), -1234, -32768};
+    int16_t gyro[3] = {100, -200, 32767};
+    for (uint8_t i = 0; i < 3; i++) {
+        fake.regs[0x03 + i] = (uint16_t)accel[i];
+        fake.regs[0x06 + i] = (uint16_t)gyro[i];
+    }
+    fake.regs[0x09] = 512;     // +1 degC over 23
+
+    imu_data_t data;
+    TEST_ASSERT_TRUE(imu_read(&imu, &data));
+    float accel_scale = imu_config_t::accel_scale();
+    float gyro_scale = imu_config_t::gyro_scale();
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, data.accel_x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -1234 * accel_scale, data.accel_y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -32768 * accel_scale, data.accel_z);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 100 * gyro_scale, data.gyro_x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -200 * gyro_scale, data.gyro_y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 32767 * gyro_scale, data.gyro_z);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 24.0f, data.temp);
+}
+
+static void test_read_sample_adds_sensor_time(void) {
+    fake.regs[0x0A] = 0xBEEF;
+    uint32_t reads = fake.reads;
+    imu_sample_t sample;
+    TEST_ASSERT_TRUE(imu_read_sample(&imu, &sample));
+    TEST_ASSERT_EQUAL_UINT32(1, fake.reads - reads);
+    TEST_ASSERT_EQUAL_UINT32(FAKE_DUMMY_BYTES + 8 * 2, fake.last_read_len);
+    TEST_ASSERT_EQUAL_HEX16(0xBEEF, sample.sensor_time);
+}
+
+static void test_read_fails_without_device(void) {
+    imu.i2c_addr = FAKE_ADDR + 1;
+    imu_data_t data;
+    TEST_ASSERT_FALSE(imu_read(&imu, &data));
+}
+
+// accel, gyro, temp and sensor time, as FIFO_CONF enables them
+static void __make_frame(uint16_t* frame, int16_t ax, int16_t gz, uint16_t time) {
+    frame[0] = (uint16_t)ax;
+    frame[1] = 0;
+    frame[2] = (uint16_t)(int16_t)imu_config_t::accel_lsb_per_g();
+    frame[3] = 0;
+    frame[4] = 0;
+    frame[5] = (uint16_t)gz;
+    frame[6] = 0;
+    frame[7] = time;
+}
+
+static void __fake_fifo_push(const uint16_t* words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        fake.fifo[(fake.fifo_head + fake.fifo_len) % FAKE_FIFO_WORDS] = words[i];
+        fake.fifo_len++;
+    }
+}
+
+// A saturated -8 g reading is 0x8000, the old empty marker: it is data
+static void test_fifo_parse_keeps_saturated_frames(void) {
+    uint16_t words[3 * IMU_FIFO_FRAME_WORDS];
+    __make_frame(&words[0], -32768, 10, 100);
+    __make_frame(&words[8], -32768, 20, 101);
+    __make_frame(&words[16], 5, 30, 102);
+
+    imu_fifo_parser_t parser;
+    imu_fifo_parser_reset(&parser);
+    imu_sample_t out[4];
+    size_t consumed = 0;
+    TEST_ASSERT_EQUAL_UINT32(3, imu_fifo_parse(&parser, words, 24, out, 4, &consumed));
+    TEST_ASSERT_EQUAL_UINT32(24, consumed);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.skipped_frames);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -32768 * imu_config_t::accel_scale(), out[0].data.accel_x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, out[1].data.accel_z);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 30 * imu_config_t::gyro_scale(), out[2].data.gyro_z);
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT16(100 + i, out[i].sensor_time);
+    }
+}
+
+static void test_fifo_parse_carries_partial_frames(void) {
+    uint16_t words[2 * IMU_FIFO_FRAME_WORDS];
+    __make_frame(&words[0], 1, 2, 7);
+    __make_frame(&words[8], 3, 4, 8);
+
+    imu_fifo_parser_t parser;
+    imu_fifo_parser_reset(&parser);
+    imu_sample_t out[2];
+    TEST_ASSERT_EQUAL_UINT32(0, imu_fifo_parse(&parser, words, 5, out, 2, NULL));
+    TEST_ASSERT_EQUAL_UINT8(5, parser.frame_len);
+    TEST_ASSERT_EQUAL_UINT32(1, imu_fifo_parse(&parser, words + 5, 6, out, 2, NULL));
+    TEST_ASSERT_EQUAL_UINT32(1, imu_fifo_parse(&parser, words + 11, 5, out + 1, 1, NULL));
+    TEST_ASSERT_EQUAL_UINT16(7, out[0].sensor_time);
+    TEST_ASSERT_EQUAL_UINT16(8, out[1].sensor_time);
+    TEST_ASSERT_EQUAL_UINT8(0, parser.frame_len);
+}
+
+static void test_fifo_parse_skips_dummy_frames(void) {
+    uint16_t words[2 * IMU_FIFO_FRAME_WORDS];
+    __make_frame(&words[0], 0, 0, 1);
+    words[0] = ACC_DUMMY;
+    words[3] = GYR_DUMMY;
+    __make_frame(&words[8], 0, 0, 2);
+    words[8 + 3] = GYR_DUMMY;    // accel alone still makes a sample
+
+    imu_fifo_parser_t parser;
+    imu_fifo_parser_reset(&parser);
+    imu_sample_t out[2];
+    TEST_ASSERT_EQUAL_UINT32(1, imu_fifo_parse(&parser, words, 16, out, 2, NULL));
+    TEST_ASSERT_EQUAL_UINT32(1, parser.skipped_frames);
+    TEST_ASSERT_EQUAL_UINT16(2, out[0].sensor_time);
+    TEST_ASSERT_EQUAL_UINT8(IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_TEMP_VALID, out[0].flags);
+}
+
+static void test_fifo_parse_stops_at_capacity(void) {
+    uint16_t words[3 * IMU_FIFO_FRAME_WORDS];
+    for (uint8_t i = 0; i < 3; i++) {
+        __make_frame(&words[i * IMU_FIFO_FRAME_WORDS], 0, 0, i);
+    }
+    imu_fifo_parser_t parser;
+    imu_fifo_parser_reset(&parser);
+    imu_sample_t out[2];
+    size_t consumed = 0;
+    TEST_ASSERT_EQUAL_UINT32(2, imu_fifo_parse(&parser, words, 24, out, 2, &consumed));
+    TEST_ASSERT_EQUAL_UINT32(16, consumed);
+}
+
+// Drains whole frames only, in bursts that fit the Wire buffer
+static void test_fifo_read_drains_whole_frames(void) {
+    uint16_t frame[IMU_FIFO_FRAME_WORDS];
+    for (uint16_t i = 0; i < 20; i++) {
+        __make_frame(frame, (int16_t)(i == 3 ? -32768 : i), 0, i);
+        __fake_fifo_push(frame, IMU_FIFO_FRAME_WORDS);
+    }
+    __fake_fifo_push(frame, 3);     // frame still being written
+    imu.fifo_enabled = true;
+
+    imu_sample_t out[32];
+    size_t count = 0;
+    TEST_ASSERT_TRUE(imu_fifo_read(&imu, out, 32, &count));
+    TEST_ASSERT_EQUAL_UINT32(20, count);
+    TEST_ASSERT_EQUAL_UINT16(3, fake.fifo_len);
+    for (uint16_t i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_UINT16(i, out[i].sensor_time);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -32768 * imu_config_t::accel_scale(), out[3].data.accel_x);
+    TEST_ASSERT_LESS_OR_EQUAL(SIM_I2C_BUFFER, fake.last_read_len);
+}
+
+// Exact reference for the fixed-point kernels: raw * units_per_lsb is a
+// dyadic rational, so floor(x + 0.5) in double arithmetic has no error
+static int16_t __fixed_reference(int16_t raw, double units_per_lsb) {
+    double value = floor(raw * units_per_lsb + 0.5);
+    return (int16_t)(value > 32767.0 ? 32767.0 : (value < -32768.0 ? -32768.0 : value));
+}
+
+// Every raw value through the batch kernels and the per-value path: floats
+// match bit for bit, fixed point is the rounded datasheet scale
+static void test_batch_conversion_matches_scalar(void) {
+    static constexpr uint16_t kChunk = 64;      // triplet-aligned
+    uint16_t raw[kChunk * 3];
+    float accel[kChunk * 3];
+    float gyro[kChunk * 3];
+    int16_t accel_mg[kChunk * 3];
+    int16_t gyro_ddps[kChunk * 3];
+    // Full range over 32768 LSB, independent of the kernel constants
+    double mg_per_lsb = 1000.0 * (2 << imu_config_t::accel_range) / 32768.0;
+    double ddps_per_lsb = 10.0 * (125 << imu_config_t::gyro_range) / 32768.0;
+    uint32_t mismatches = 0;
+
+    for (uint32_t base = 0; base < 0x10000; base += kChunk * 3) {
+        uint16_t n = (uint16_t)((0x10000 - base < kChunk * 3) ? (0x10000 - base) : kChunk * 3);
+        for (uint16_t i = 0; i < kChunk * 3; i++) {
+            raw[i] = (uint16_t)(base + (i < n ? i : 0));
+        }
+        imu_convert_accel_batch(raw, kChunk, 3, accel);
+        imu_convert_gyro_batch(raw, kChunk, 3, gyro);
+        imu_convert_accel_mg_batch(raw, kChunk, 3, accel_mg);
+        imu_convert_gyro_ddps_batch(raw, kChunk, 3, gyro_ddps);
+        for (uint16_t i = 0; i < n; i++) {
+            float a = imu_bench_convert_accel(raw[i]);
+            float g = imu_bench_convert_gyro(raw[i]);
+            if (memcmp(&a, &accel[i], sizeof(a)) != 0 || memcmp(&g, &gyro[i], sizeof(g)) != 0 ||
+                accel_mg[i] != __fixed_reference((int16_t)raw[i], mg_per_lsb) ||
+                gyro_ddps[i] != __fixed_reference((int16_t)raw[i], ddps_per_lsb)) {
+                mismatches++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_is_one_burst);
+    RUN_TEST(test_read_decodes_every_register);
+    RUN_TEST(test_read_sample_adds_sensor_time);
+    RUN_TEST(test_read_fails_without_device);
+    RUN_TEST(test_fifo_parse_keeps_saturated_frames);
+    RUN_TEST(test_fifo_parse_carries_partial_frames);
+    RUN_TEST(test_fifo_parse_skips_dummy_frames);
+    RUN_TEST(test_fifo_parse_stops_at_capacity);
+    RUN_TEST(test_fifo_read_drains_whole_frames);
+    RUN_TEST(test_batch_conversion_matches_scalar);
+    return UNITY_END();
+}
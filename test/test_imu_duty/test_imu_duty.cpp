@@ -0,0 +1,110 @@
+#include <unity.h>
+
+#include <Wire.h>
+#include <string.h>
+
+#include "imu.h"
+#include "imu_duty.h"
+#include "sim.h"
+
+#define IMU_ADDR            0x68
+#define WATERMARK_FRAMES    4
+#define ACC_CONF            0x20
+#define GYR_CONF            0x21
+#define FIFO_CONF           0x36
+
+static TwoWire bus;
+static sim_bmi323_t model;
+static imu_t imu;
+static imu_duty_t duty;
+static imu_duty_config_t config;
+
+// Neither the imu_init() defaults nor the idle settings
+static constexpr imu_settings_t kActive = {
+    {IMU_MODE_HIGH_PERF, IMU_ODR_400HZ, IMU_AVG_4},
+    {IMU_MODE_NORMAL, IMU_ODR_200HZ, IMU_AVG_2},
+};
+
+static uint16_t __conf_word(const imu_sensor_settings_t* sensor, uint8_t range) {
+    return imu_conf_word(sensor->mode, sensor->avg, range, sensor->odr);
+}
+
+static void __assert_settings(const imu_settings_t* expected, const imu_settings_t* actual) {
+    TEST_ASSERT_EQUAL_UINT8(expected->accel.mode, actual->accel.mode);
+    TEST_ASSERT_EQUAL_UINT8(expected->accel.odr, actual->accel.odr);
+    TEST_ASSERT_EQUAL_UINT8(expected->accel.avg, actual->accel.avg);
+    TEST_ASSERT_EQUAL_UINT8(expected->gyro.mode, actual->gyro.mode);
+    TEST_ASSERT_EQUAL_UINT8(expected->gyro.odr, actual->gyro.odr);
+    TEST_ASSERT_EQUAL_UINT8(expected->gyro.avg, actual->gyro.avg);
+}
+
+// The chip, the driver's cache and the policy all agree on the runtime settings
+static void __assert_active(void) {
+    TEST_ASSERT_FALSE(imu_duty_idle(&duty));
+    __assert_settings(&kActive, &imu.settings);
+    TEST_ASSERT_EQUAL_HEX16(__conf_word(&kActive.accel, imu_config_t::accel_range), model.regs[ACC_CONF]);
+    TEST_ASSERT_EQUAL_HEX16(__conf_word(&kActive.gyro, imu_config_t::gyro_range), model.regs[GYR_CONF]);
+    TEST_ASSERT_TRUE(imu.fifo_enabled);
+    TEST_ASSERT_TRUE(model.regs[FIFO_CONF] != 0);
+}
+
+// Still samples until the policy gives up on the sensor
+static void __sleep(void) {
+    imu_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.flags = IMU_SAMPLE_ACCEL_VALID | IMU_SAMPLE_GYRO_VALID;
+    sample.data.accel_z = 1.0f;
+    sample.timestamp_us = micros();
+    TEST_ASSERT_FALSE(imu_duty_on_sample(&duty, &imu, &sample));
+    sample.timestamp_us += config.idle_after_ms * 1000;
+    TEST_ASSERT_TRUE(imu_duty_on_sample(&duty, &imu, &sample));
+    TEST_ASSERT_TRUE(imu_duty_idle(&duty));
+    TEST_ASSERT_EQUAL_HEX16(__conf_word(&config.idle.accel, imu_config_t::accel_range), model.regs[ACC_CONF]);
+}
+
+void setUp(void) {
+    memset(&imu, 0, sizeof(imu));
+    sim_bmi323_init(&model, &bus, IMU_ADDR, IMU_INT);
+    TEST_ASSERT_TRUE(imu_init(&imu, IMU_INT, IMU_ADDR, &bus));
+    imu_duty_default_config(&config);
+    config.idle_after_ms = 100;
+}
+
+void tearDown(void) {}
+
+// Wake re-arms the FIFO; that must not drop the settings the next sleep saves
+static void test_fifo_wake_keeps_runtime_settings(void) {
+    TEST_ASSERT_TRUE(imu_configure(&imu, &kActive));
+    TEST_ASSERT_TRUE(imu_fifo_enable(&imu, WATERMARK_FRAMES));
+    TEST_ASSERT_TRUE(imu_enable_interrupt(&imu, IMU_INT_FIFO_WATERMARK));
+    imu_duty_init(&duty, &config, true);
+    __assert_active();
+
+    __sleep();
+    __assert_settings(&kActive, &duty.active);
+    imu_duty_resume(&duty, &imu);
+    __assert_active();
+
+    __sleep();
+    __assert_settings(&kActive, &duty.active);
+    imu_duty_resume(&duty, &imu);
+    __assert_active();
+    TEST_ASSERT_EQUAL_UINT16(WATERMARK_FRAMES, imu.fifo_watermark_frames);
+    TEST_ASSERT_EQUAL_UINT32(2, duty.stats.sleeps);
+}
+
+// The FIFO can be switched on after the settings: it keeps them too
+static void test_fifo_enable_keeps_settings(void) {
+    TEST_ASSERT_TRUE(imu_configure(&imu, &kActive));
+    TEST_ASSERT_TRUE(imu_any_motion_enable(&imu, config.wake_threshold_mg, config.wake_duration_ms));
+    TEST_ASSERT_TRUE(imu_fifo_enable(&imu, WATERMARK_FRAMES));
+    __assert_settings(&kActive, &imu.settings);
+    TEST_ASSERT_TRUE(imu.any_motion_enabled);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_wake_keeps_runtime_settings);
+    RUN_TEST(test_fifo_enable_keeps_settings);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+#include <unity.h>
+
+#include "button.h"
+#include "encoder.h"
+#include "input_event.h"
+#include "sim.h"
+
+#define PIN_BUTTON      BTN_1
+#define BOUNCE_EDGES    9       // contact bounce on press, ending high
+#define BOUNCE_GAP_US   150
+#define DETENTS         40      // one fast spin: 4 transitions each, more than the queue holds
+
+static button_t button;
+static encoder_t encoder;
+static uint32_t notified;
+static uint32_t presses;
+static int32_t spun;
+
+static void __count_notify(void* ctx) {
+    notified++;
+}
+
+static void __count_press(button_t* btn) {
+    presses++;
+}
+
+static void __count_spin(encoder_t* enc, int32_t delta) {
+    spun += delta;
+}
+
+void setUp(void) {
+    notified = 0;
+    presses = 0;
+    spun = 0;
+    input_event_set_notify(__count_notify, NULL);
+}
+
+void tearDown(void) {
+    input_event_set_notify(NULL, NULL);
+}
+
+// A bounce train is queued edge by edge, in order, with ISR timestamps
+static void test_button_bounce_burst(void) {
+    sim_gpio_set_pull(PIN_BUTTON, LOW);
+    button_init(&button, PIN_BUTTON);
+    button_set_callback(&button, __count_press, NULL);
+
+    uint32_t start_us = micros();
+    for (uint8_t i = 0; i < BOUNCE_EDGES; i++) {
+        sim_gpio_set(PIN_BUTTON, (i & 1) ? LOW : HIGH);
+        sim_busy_us(BOUNCE_GAP_US);
+    }
+    TEST_ASSERT_EQUAL_UINT32(BOUNCE_EDGES, notified);
+    TEST_ASSERT_EQUAL_UINT32(BOUNCE_EDGES, spsc_ring_size(&button.events));
+
+    input_event_t event;
+    uint32_t last_us = start_us;
+    for (uint8_t i = 0; i < BOUNCE_EDGES; i++) {
+        TEST_ASSERT_TRUE(spsc_ring_pop(&button.events, &event));
+        TEST_ASSERT_EQUAL_UINT8(PIN_BUTTON, event.pin);
+        TEST_ASSERT_EQUAL_UINT8((i & 1) ? LOW : HIGH, event.level);
+        TEST_ASSERT_GREATER_OR_EQUAL(last_us, event.timestamp_us);
+        last_us = event.timestamp_us;
+    }
+    TEST_ASSERT_EQUAL_UINT32(start_us + (BOUNCE_EDGES - 1) * BOUNCE_GAP_US, last_us);
+    sim_gpio_release(PIN_BUTTON);
+}
+
+// The same train drained late still debounces to one press
+static void test_button_burst_debounces_once(void) {
+    sim_gpio_set_pull(PIN_BUTTON, LOW);
+    button_init(&button, PIN_BUTTON);
+    button_set_callback(&button, __count_press, NULL);
+
+    for (uint8_t i = 0; i < BOUNCE_EDGES; i++) {
+        sim_gpio_set(PIN_BUTTON, (i & 1) ? LOW : HIGH);
+        sim_busy_us(BOUNCE_GAP_US);
+    }
+    button_process(&button);
+    TEST_ASSERT_EQUAL_UINT32(0, presses);
+    sim_busy_us(button.debounce_ms * 1000);
+    button_process(&button);
+    TEST_ASSERT_EQUAL_UINT32(1, presses);
+    TEST_ASSERT_TRUE(button_read(&button));
+    TEST_ASSERT_EQUAL_UINT32(0, button_get_overruns(&button));
+    sim_gpio_release(PIN_BUTTON);
+}
+
+// More edges than the queue holds: the rest are counted and the level is
+// taken from the pin
+static void test_button_overflow_resyncs(void) {
+    sim_gpio_set_pull(PIN_BUTTON, LOW);
+    button_init(&button, PIN_BUTTON);
+    button_set_callback(&button, __count_press, NULL);
+
+    uint32_t edges = INPUT_EVENT_QUEUE_CAPACITY + 9;
+    for (uint32_t i = 0; i < edges; i++) {
+        sim_gpio_set(PIN_BUTTON, (i & 1) ? LOW : HIGH);
+        sim_busy_us(10);
+    }
+    TEST_ASSERT_EQUAL_UINT32(edges - INPUT_EVENT_QUEUE_CAPACITY, button_get_overruns(&button));
+    button_process(&button);
+    sim_busy_us(button.debounce_ms * 1000);
+    button_process(&button);
+    TEST_ASSERT_TRUE(button_read(&button));
+    TEST_ASSERT_EQUAL_UINT32(1, presses);
+    sim_gpio_release(PIN_BUTTON);
+}
+
+// Gray code from AB = 11, the rest position with the lines pulled up
+static void __encoder_turn(uint8_t detents, bool up, uint32_t gap_us) {
+    static const uint8_t kUp[4] = {0x1, 0x0, 0x2, 0x3};
+    static const uint8_t kDown[4] = {0x2, 0x0, 0x1, 0x3};
+    const uint8_t* seq = up ? kUp : kDown;
+    for (uint8_t d = 0; d < detents; d++) {
+        for (uint8_t i = 0; i < 4; i++) {
+            uint8_t prev = (i == 0) ? 0x3 : seq[i - 1];
+            if ((prev ^ seq[i]) & 0x2) {
+                sim_gpio_set(RE_CW, (seq[i] >> 1) & 1);
+            } else {
+                sim_gpio_set(RE_CCW, seq[i] & 1);
+            }
+            sim_busy_us(gap_us);
+        }
+    }
+}
+
+// A fast spin overflows the queue: callbacks for lost edges go, the position stays exact
+static void test_encoder_burst_keeps_position(void) {
+    sim_gpio_set_pull(RE_CW, HIGH);
+    sim_gpio_set_pull(RE_CCW, HIGH);
+    sim_gpio_set_pull(RE_BTN, HIGH);
+    encoder_init(&encoder, RE_CW, RE_CCW, RE_BTN);
+    encoder_set_spin_callback(&encoder, __count_spin);
+
+    __encoder_turn(DETENTS, true, 50);
+    __encoder_turn(3, false, 50);
+    int32_t expected = (int32_t)(DETENTS - 3) * (4 / ENCODER_STEP_MODE);
+    TEST_ASSERT_EQUAL_INT32(expected, encoder_get_position(&encoder));
+    TEST_ASSERT_EQUAL_UINT32((DETENTS + 3) * 4, notified);
+    TEST_ASSERT_EQUAL_UINT32((DETENTS + 3) * 4 - INPUT_EVENT_QUEUE_CAPACITY, encoder_get_overruns(&encoder));
+
+    encoder_process(&encoder);
+    TEST_ASSERT_EQUAL_INT32(expected, encoder_get_position(&encoder));
+    TEST_ASSERT_EQUAL_INT32(expected, encoder_take_delta(&encoder));
+    TEST_ASSERT_EQUAL_INT32(0, encoder_take_delta(&encoder));
+    TEST_ASSERT_LESS_OR_EQUAL(expected, spun);
+}
+
+// Within capacity every step reaches the spin callback
+static void test_encoder_burst_within_capacity(void) {
+    sim_gpio_set_pull(RE_CW, HIGH);
+    sim_gpio_set_pull(RE_CCW, HIGH);
+    sim_gpio_set_pull(RE_BTN, HIGH);
+    encoder_init(&encoder, RE_CW, RE_CCW, RE_BTN);
+    encoder_set_spin_callback(&encoder, __count_spin);
+
+    uint8_t detents = INPUT_EVENT_QUEUE_CAPACITY / 4;
+    __encoder_turn(detents, false, 50);
+    TEST_ASSERT_EQUAL_UINT32(0, encoder_get_overruns(&encoder));
+    encoder_process(&encoder);
+    TEST_ASSERT_EQUAL_INT32(-(int32_t)detents * (4 / ENCODER_STEP_MODE), spun);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_button_bounce_burst);
+    RUN_TEST(test_button_burst_debounces_once);
+    RUN_TEST(test_button_overflow_resyncs);
+    RUN_TEST(test_encoder_burst_keeps_position);
+    RUN_TEST(test_encoder_burst_within_capacity);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "key_matrix.h"
+
+#define CHECK_SCANS     4096
+#define SETTLE_SCANS    32      // quiet scans closing the bounce check
+#define MIN_HOLD        16      // scans a true key level lasts at least
+#define MAX_BOUNCE      10      // chatter after a true edge, in scans
+
+// Per-key integrator the vertical counter must match: a level that
+// differs from the state for KEY_MATRIX_DEBOUNCE_SCANS scans in a row
+typedef struct key_reference {
+    uint32_t state[KEY_MATRIX_WORDS];
+    uint8_t count[KEY_MATRIX_MAX_KEYS];
+} key_reference_t;
+
+// One key's true level, and the chattering samples the scanner sees of it
+typedef struct key_track {
+    bool level;
+    bool sample;
+    uint16_t hold;              ///< Scans until the next true edge
+    uint8_t bounce;             ///< Chatter scans left after the last edge
+    uint8_t run;                ///< Scans left in the current chatter run
+    uint8_t settle;             ///< Scans until glitches may start
+    uint8_t glitch;             ///< Scans left in an isolated glitch
+    uint32_t edges;
+    uint32_t events;
+} key_track_t;
+
+static key_matrix_t keys;
+static key_reference_t reference;
+static key_track_t tracks[KEY_MATRIX_MAX_KEYS];
+static uint32_t events[KEY_MATRIX_WORDS];
+
+static void __reference_update(key_reference_t* ref, const uint32_t* raw, uint8_t key_count, uint32_t* toggled) {
+    memset(toggled, 0, KEY_MATRIX_WORDS * sizeof(uint32_t));
+    for (uint8_t k = 0; k < key_count; k++) {
+        uint32_t mask = 1u << (k & 31);
+        bool sample = raw[k >> 5] & mask;
+        bool state = ref->state[k >> 5] & mask;
+        if (sample == state) {
+            ref->count[k] = 0;
+        } else if (++ref->count[k] >= KEY_MATRIX_DEBOUNCE_SCANS) {
+            ref->count[k] = 0;
+            ref->state[k >> 5] ^= mask;
+            toggled[k >> 5] |= mask;
+        }
+    }
+}
+
+static uint32_t __random(uint32_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Chatter and glitches come in runs of at most KEY_MATRIX_DEBOUNCE_SCANS - 1
+// equal samples, so each true edge must give exactly one event
+static bool __key_sample(key_track_t* t, uint32_t* seed, bool quiet) {
+    static constexpr uint8_t kMaxRun = KEY_MATRIX_DEBOUNCE_SCANS - 1;
+    if (t->hold == 0 && !quiet) {
+        t->level = !t->level;
+        t->edges++;
+        t->hold = MIN_HOLD + __random(seed) % 48;
+        t->bounce = __random(seed) % MAX_BOUNCE;
+        t->run = 0;
+        t->glitch = 0;
+        t->settle = t->bounce + KEY_MATRIX_DEBOUNCE_SCANS;
+    }
+    if (t->hold > 0) {
+        t->hold--;
+    }
+    if (t->settle > 0) {
+        t->settle--;
+    }
+
+    if (t->bounce > 0) {
+        t->bounce--;
+        if (t->run == 0) {
+            t->sample = !t->sample;
+            t->run = 1 + __random(seed) % kMaxRun;
+        }
+        t->run--;
+    } else if (t->glitch > 0) {
+        t->glitch--;
+        t->sample = !t->level;
+    } else {
+        bool steady = (t->sample == t->level);   // glitches never run into each other
+        t->sample = t->level;
+        if (!quiet && steady && t->settle == 0 && __random(seed) % 64 == 0) {
+            t->glitch = __random(seed) % kMaxRun;
+            t->sample = !t->level;
+        }
+    }
+    return t->sample;
+}
+
+static void __count_event(void* ctx, uint8_t key, bool pressed, uint32_t now_us) {
+    static_cast<uint32_t*>(ctx)[key >> 5] |= 1u << (key & 31);
+    tracks[key].events++;
+}
+
+void setUp(void) {
+    memset(tracks, 0, sizeof(tracks));
+    memset(&reference, 0, sizeof(reference));
+    memset(events, 0, sizeof(events));
+    key_matrix_reset(&keys, KEY_MATRIX_MAX_KEYS);
+    key_matrix_set_callback(&keys, __count_event, events);
+}
+
+void tearDown(void) {}
+
+// A clean press registers on exactly the KEY_MATRIX_DEBOUNCE_SCANS-th scan
+static void test_press_needs_debounce_scans(void) {
+    uint32_t raw[KEY_MATRIX_WORDS] = {};
+    raw[1] = 1u << 3;     // key 35
+    for (uint8_t scan = 1; scan < KEY_MATRIX_DEBOUNCE_SCANS; scan++) {
+        TEST_ASSERT_EQUAL_UINT8(0, key_matrix_update(&keys, raw, scan));
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, key_matrix_update(&keys, raw, KEY_MATRIX_DEBOUNCE_SCANS));
+    TEST_ASSERT_TRUE(key_matrix_pressed(&keys, 35));
+    TEST_ASSERT_EQUAL_UINT32(1, tracks[35].events);
+    TEST_ASSERT_EQUAL_UINT8(0, key_matrix_update(&keys, raw, KEY_MATRIX_DEBOUNCE_SCANS + 1));
+}
+
+// Bouncing and glitching samples for every key through the scanner and
+// the scalar reference: same events on the same scans, one per true edge
+static void test_bounce_injection_matches_reference(void) {
+    uint32_t seed = 0x9E3779B9u;
+    uint32_t raw[KEY_MATRIX_WORDS];
+    uint32_t toggled[KEY_MATRIX_WORDS];
+    uint32_t mismatches = 0;
+
+    for (uint8_t k = 0; k < KEY_MATRIX_MAX_KEYS; k++) {
+        tracks[k].hold = __random(&seed) % MIN_HOLD;
+    }
+    for (uint32_t scan = 0; scan < CHECK_SCANS + SETTLE_SCANS; scan++) {
+        bool quiet = scan >= CHECK_SCANS;
+        memset(raw, 0, sizeof(raw));
+        memset(events, 0, sizeof(events));
+        for (uint8_t k = 0; k < KEY_MATRIX_MAX_KEYS; k++) {
+            raw[k >> 5] |= (uint32_t)__key_sample(&tracks[k], &seed, quiet) << (k & 31);
+        }
+        key_matrix_update(&keys, raw, scan);
+        __reference_update(&reference, raw, KEY_MATRIX_MAX_KEYS, toggled);
+        for (uint8_t w = 0; w < KEY_MATRIX_WORDS; w++) {
+            mismatches += __builtin_popcount(events[w] ^ toggled[w]);
+            mismatches += __builtin_popcount(keys.state[w] ^ reference.state[w]);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+
+    uint32_t edges = 0;
+    for (uint8_t k = 0; k < KEY_MATRIX_MAX_KEYS; k++) {
+        TEST_ASSERT_EQUAL_UINT32(tracks[k].edges, tracks[k].events);
+        TEST_ASSERT_EQUAL(tracks[k].level, key_matrix_pressed(&keys, k));
+        edges += tracks[k].edges;
+    }
+    TEST_ASSERT_EQUAL_UINT32(edges, keys.stats.events);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_press_needs_debounce_scans);
+    RUN_TEST(test_bounce_injection_matches_reference);
+    return UNITY_END();
+}
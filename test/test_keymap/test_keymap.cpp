@@ -0,0 +1,231 @@
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "keymap.h"
+
+#define MS              1000u
+#define LOG_CAPACITY    256
+
+enum {
+    BTN_HOLD = 0,
+    BTN_TAP_HOLD,
+    BTN_REPEAT,
+    BTN_FN,
+    BTN_TOGGLE,
+    BTN_COMBO_A,
+    BTN_COMBO_B,
+};
+
+static constexpr keymap_layer_t kLayers[] = {
+    // 0: base
+    {
+        {keymap_hold('w'), keymap_tap_hold('x', 'y', 200 * MS), keymap_repeat('r', 300 * MS, 100 * MS),
+         keymap_layer_hold(1), keymap_toggle_layer(2, 50 * MS), keymap_tap('5'), keymap_tap('6'), keymap_none()},
+        {keymap_axis_hold('u', 'd', 2), keymap_axis_hold(0, 0, 0)},
+    },
+    // 1: while BTN_FN is held
+    {
+        {keymap_tap('q'), keymap_trans(), keymap_trans(), keymap_trans(),
+         keymap_trans(), keymap_trans(), keymap_trans(), keymap_trans()},
+        {keymap_axis_hold('+', '-', 1), keymap_axis_hold(0, 0, 0)},
+    },
+    // 2: toggled, mutes BTN_HOLD
+    {
+        {keymap_none(), keymap_trans(), keymap_trans(), keymap_trans(),
+         keymap_trans(), keymap_trans(), keymap_trans(), keymap_trans()},
+        {keymap_axis_hold(0, 0, 0), keymap_axis_hold(0, 0, 0)},
+    },
+};
+static constexpr keymap_combo_t kCombos[] = {
+    {(1u << BTN_COMBO_A) | (1u << BTN_COMBO_B), keymap_tap('c')},
+};
+static constexpr keymap_t kKeymap = {kLayers, sizeof(kLayers) / sizeof(kLayers[0]), kCombos,
+                                     sizeof(kCombos) / sizeof(kCombos[0]), 40 * MS};
+
+/**
+ * One recorded input: a button edge, or encoder detents when `button` is ENCODER.
+ */
+typedef struct replay_step {
+    uint32_t ms;
+    uint8_t button;
+    int8_t value;           ///< 1/0 for down/up, detents for the encoder
+} replay_step_t;
+
+static constexpr uint8_t ENCODER = 0xFF;
+
+static keymap_engine_t km;
+static char out_log[LOG_CAPACITY];
+
+static void __log(const char* fmt, uint8_t key) {
+    size_t len = strlen(out_log);
+    snprintf(out_log + len, sizeof(out_log) - len, fmt, (char)key);
+}
+
+static void __press(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp) {
+    __log(" +%c", key);
+}
+
+static void __release(void* ctx, uint8_t key) {
+    __log(" -%c", key);
+}
+
+static void __tap(void* ctx, uint8_t key, keymap_input_t input, uint32_t stamp) {
+    __log(" *%c", key);
+}
+
+static void __layer(void* ctx, uint8_t layer, bool active) {
+    __log(active ? " L%c" : " l%c", (uint8_t)('0' + layer));
+}
+
+// Feeds the steps in order, running every timer that falls due in between
+// and after the last step until `end_ms`
+static const char* __replay(const replay_step_t* steps, size_t count, uint32_t end_ms) {
+    uint32_t due_us = 0;
+    bool armed = false;
+    for (size_t i = 0; i <= count; i++) {
+        uint32_t at_us = (i < count ? steps[i].ms : end_ms) * MS;
+        while (armed && (int32_t)(at_us - due_us) >= 0) {
+            uint32_t wait = keymap_tick(&km, due_us);
+            armed = (wait != 0);
+            due_us += wait;
+        }
+        if (i == count) {
+            break;
+        }
+        uint32_t wait;
+        if (steps[i].button == ENCODER) {
+            wait = keymap_encoder(&km, 0, steps[i].value, at_us, 0);
+        } else {
+            wait = keymap_button(&km, steps[i].button, steps[i].value != 0, at_us, 0);
+        }
+        armed = (wait != 0);
+        due_us = at_us + wait;
+    }
+    return out_log + (out_log[0] == ' ' ? 1 : 0);
+}
+
+void setUp(void) {
+    out_log[0] = '\0';
+    keymap_output_t out = {__press, __release, __tap, __layer, NULL};
+    TEST_ASSERT_TRUE(keymap_init(&km, &kKeymap, &out));
+}
+
+void tearDown(void) {}
+
+static void test_hold_and_tap_hold(void) {
+    static const replay_step_t steps[] = {
+        {0, BTN_HOLD, 1},
+        {80, BTN_HOLD, 0},
+        {100, BTN_TAP_HOLD, 1},     // released inside the term: tap
+        {150, BTN_TAP_HOLD, 0},
+        {200, BTN_TAP_HOLD, 1},     // held past it: hold the alternate
+        {700, BTN_TAP_HOLD, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("+w -w *x +y -y", __replay(steps, sizeof(steps) / sizeof(steps[0]), 1000));
+}
+
+static void test_repeat(void) {
+    static const replay_step_t steps[] = {
+        {0, BTN_REPEAT, 1},         // first after 300 ms, then every 100 ms
+        {650, BTN_REPEAT, 0},
+        {700, BTN_REPEAT, 1},       // released before the first repeat
+        {900, BTN_REPEAT, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("*r *r *r *r", __replay(steps, sizeof(steps) / sizeof(steps[0]), 1500));
+}
+
+static void test_layers(void) {
+    static const replay_step_t steps[] = {
+        {0, BTN_FN, 1},
+        {10, BTN_HOLD, 1},          // layer 1 overrides it
+        {20, BTN_HOLD, 0},
+        {30, BTN_FN, 0},
+        {50, BTN_TOGGLE, 1},        // the lockout from boot is over
+        {52, BTN_TOGGLE, 0},
+        {55, BTN_HOLD, 1},          // muted by layer 2
+        {60, BTN_HOLD, 0},
+        {70, BTN_TOGGLE, 1},        // inside the lockout: ignored
+        {75, BTN_TOGGLE, 0},
+        {200, BTN_TOGGLE, 1},
+        {205, BTN_TOGGLE, 0},
+        {210, BTN_HOLD, 1},
+        {220, BTN_HOLD, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("L1 *q l1 L2 l2 +w -w", __replay(steps, sizeof(steps) / sizeof(steps[0]), 300));
+}
+
+// As the gate toggle always was: a press in the lockout after boot is ignored
+static void test_toggle_locked_out_after_boot(void) {
+    static const replay_step_t steps[] = {
+        {10, BTN_TOGGLE, 1},
+        {15, BTN_TOGGLE, 0},
+        {49, BTN_TOGGLE, 1},
+        {55, BTN_TOGGLE, 0},
+        {60, BTN_TOGGLE, 1},
+        {65, BTN_TOGGLE, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("L2", __replay(steps, sizeof(steps) / sizeof(steps[0]), 100));
+}
+
+// A key pressed on a layer is released on it, even if the layer went away
+static void test_press_survives_layer_change(void) {
+    static const replay_step_t steps[] = {
+        {0, BTN_HOLD, 1},
+        {10, BTN_FN, 1},
+        {20, BTN_HOLD, 0},
+        {30, BTN_FN, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("+w L1 -w l1", __replay(steps, sizeof(steps) / sizeof(steps[0]), 100));
+}
+
+static void test_combo(void) {
+    static const replay_step_t steps[] = {
+        {0, BTN_COMBO_A, 1},        // both within the term: the combo
+        {20, BTN_COMBO_B, 1},
+        {60, BTN_COMBO_A, 0},
+        {70, BTN_COMBO_B, 0},
+        {100, BTN_COMBO_A, 1},      // alone: its own action once the term runs out
+        {300, BTN_COMBO_A, 0},
+        {400, BTN_COMBO_B, 1},      // tapped quickly: acts on release
+        {410, BTN_COMBO_B, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("*c *5 *6", __replay(steps, sizeof(steps) / sizeof(steps[0]), 500));
+}
+
+static void test_encoder_axis(void) {
+    static const replay_step_t steps[] = {
+        {0, ENCODER, 1},
+        {10, ENCODER, 1},           // threshold 2: hold 'u'
+        {20, ENCODER, -3},          // past zero to -1: let go
+        {30, ENCODER, -1},          // -2: hold 'd'
+        {40, BTN_FN, 1},            // layer change resets the count, threshold 1 there
+        {50, ENCODER, 1},
+        {60, BTN_FN, 0},
+    };
+    TEST_ASSERT_EQUAL_STRING("+u -u +d -d L1 ++ -+ l1", __replay(steps, sizeof(steps) / sizeof(steps[0]), 100));
+}
+
+static void test_rejects_oversized_keymap(void) {
+    static constexpr keymap_t kTooMany = {kLayers, KEYMAP_MAX_LAYERS + 1, NULL, 0, 0};
+    static constexpr keymap_t kEmpty = {kLayers, 0, NULL, 0, 0};
+    keymap_output_t out = {__press, __release, __tap, __layer, NULL};
+    TEST_ASSERT_FALSE(keymap_init(&km, &kTooMany, &out));
+    TEST_ASSERT_EQUAL_UINT32(0, keymap_button(&km, BTN_HOLD, true, 0, 0));
+    TEST_ASSERT_FALSE(keymap_init(&km, &kEmpty, &out));
+    TEST_ASSERT_EQUAL_STRING("", out_log);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hold_and_tap_hold);
+    RUN_TEST(test_repeat);
+    RUN_TEST(test_layers);
+    RUN_TEST(test_toggle_locked_out_after_boot);
+    RUN_TEST(test_press_survives_layer_change);
+    RUN_TEST(test_combo);
+    RUN_TEST(test_encoder_axis);
+    RUN_TEST(test_rejects_oversized_keymap);
+    return UNITY_END();
+}
@@ -0,0 +1,94 @@
+#include <unity.h>
+
+#include <sim.h>
+
+#include "latency.h"
+
+#define FAR_US          100000000u  // clock position past every recorded value
+#define OVERFLOW_US     (1u << (LATENCY_OCTAVES + 1))   // first value of the overflow bucket
+
+// One sample of exactly `us`
+static void __record(latency_source_t source, uint32_t us) {
+    latency_record(source, latency_stamp() - us);
+}
+
+static latency_summary_t __summary(latency_source_t source) {
+    latency_summary_t summary;
+    latency_get_summary(source, &summary);
+    return summary;
+}
+
+void setUp(void) {
+    if (micros() < FAR_US) {
+        sim_busy_us(FAR_US);
+    }
+    latency_reset();
+}
+
+void tearDown(void) {}
+
+static void test_percentiles_and_max(void) {
+    for (uint8_t i = 0; i < 98; i++) {
+        __record(LATENCY_SRC_BUTTON, 100);
+    }
+    __record(LATENCY_SRC_BUTTON, 5000);
+    __record(LATENCY_SRC_BUTTON, 20000);
+
+    latency_summary_t summary = __summary(LATENCY_SRC_BUTTON);
+    TEST_ASSERT_EQUAL_UINT32(100, summary.samples);
+    TEST_ASSERT_EQUAL_UINT32(111, summary.p50_us);     // 96..111
+    TEST_ASSERT_EQUAL_UINT32(5119, summary.p99_us);    // 99th of 100: 4096..5119
+    TEST_ASSERT_EQUAL_UINT32(20000, summary.max_us);
+
+    TEST_ASSERT_EQUAL_UINT32(0, __summary(LATENCY_SRC_ENCODER).samples);
+}
+
+// p50 of {value, a far larger one} is the upper bound of value's bucket
+static void test_bucket_bounds_at_octave_edges(void) {
+    static const uint32_t kCases[][2] = {
+        {0, 0}, {3, 3},                 // exact below 4 us
+        {4, 4}, {7, 7},                 // 1 us wide in the first octave
+        {8, 9}, {9, 9}, {10, 11}, {15, 15},
+        {16, 19}, {1023, 1023}, {1024, 1279}, {1280, 1535},
+        {OVERFLOW_US - 1, OVERFLOW_US - 1},
+    };
+    for (uint8_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++) {
+        latency_reset();
+        __record(LATENCY_SRC_ENCODER, kCases[i][0]);
+        __record(LATENCY_SRC_ENCODER, 2 * OVERFLOW_US);
+        TEST_ASSERT_EQUAL_UINT32(kCases[i][1], __summary(LATENCY_SRC_ENCODER).p50_us);
+    }
+}
+
+// Past the last octave the bucket has no bound: percentiles there report the exact max
+static void test_overflow_bucket_reports_max(void) {
+    __record(LATENCY_SRC_WAKE, OVERFLOW_US);
+    __record(LATENCY_SRC_WAKE, 3 * OVERFLOW_US);
+    latency_summary_t summary = __summary(LATENCY_SRC_WAKE);
+    TEST_ASSERT_EQUAL_UINT32(3 * OVERFLOW_US, summary.p50_us);
+    TEST_ASSERT_EQUAL_UINT32(3 * OVERFLOW_US, summary.p99_us);
+    TEST_ASSERT_EQUAL_UINT32(3 * OVERFLOW_US, summary.max_us);
+}
+
+// 0 is "no stamp": an input that was never stamped records nothing
+static void test_zero_stamp_is_ignored(void) {
+    latency_record(LATENCY_SRC_BUTTON, 0);
+    latency_record(LATENCY_SRC_COUNT, latency_stamp());
+    TEST_ASSERT_EQUAL_UINT32(0, __summary(LATENCY_SRC_BUTTON).samples);
+    TEST_ASSERT_EQUAL_UINT32(0, __summary(LATENCY_SRC_BUTTON).max_us);
+    TEST_ASSERT_TRUE(latency_stamp() != 0);
+
+    __record(LATENCY_SRC_BUTTON, 250);
+    latency_summary_t summary = __summary(LATENCY_SRC_BUTTON);
+    TEST_ASSERT_EQUAL_UINT32(1, summary.samples);
+    TEST_ASSERT_EQUAL_UINT32(250, summary.p50_us);     // clamped to the max in its bucket
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_percentiles_and_max);
+    RUN_TEST(test_bucket_bounds_at_octave_edges);
+    RUN_TEST(test_overflow_bucket_reports_max);
+    RUN_TEST(test_zero_stamp_is_ignored);
+    return UNITY_END();
+}
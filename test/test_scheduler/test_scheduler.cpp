@@ -0,0 +1,150 @@
+#include <unity.h>
+
+#include "scheduler.h"
+
+static scheduler_t sched;
+static uint32_t fake_now;
+static uint32_t waits;
+static uint32_t last_wait_us;
+static uint32_t runs_a;
+static uint32_t runs_b;
+static uint32_t run_cost_us;
+
+static uint32_t __fake_clock(void) {
+    return fake_now;
+}
+
+// Sleeps exactly as long as asked: any lateness is the scheduler's own
+static void __fake_wait(scheduler_t* s, uint32_t timeout_us) {
+    waits++;
+    last_wait_us = timeout_us;
+    if (timeout_us != UINT32_MAX) {
+        fake_now += timeout_us;
+    }
+}
+
+static void __job_a(void* ctx) {
+    runs_a++;
+    fake_now += run_cost_us;
+}
+
+static void __job_b(void* ctx) {
+    runs_b++;
+}
+
+void setUp(void) {
+    fake_now = 1000;
+    waits = 0;
+    last_wait_us = 0;
+    runs_a = 0;
+    runs_b = 0;
+    run_cost_us = 0;
+    scheduler_init(&sched, __fake_clock);
+    scheduler_set_wait(&sched, __fake_wait, NULL);
+}
+
+void tearDown(void) {}
+
+static void test_periodic_jobs_run_on_time(void) {
+    int a = scheduler_add(&sched, "a", __job_a, NULL, 2000);
+    int b = scheduler_add(&sched, "b", __job_b, NULL, 5000);
+    while (fake_now < 1000 + 20000) {
+        scheduler_run(&sched);
+    }
+    scheduler_run_pending(&sched);
+    TEST_ASSERT_EQUAL_UINT32(11, runs_a);   // t = 0, 2, ..., 20 ms
+    TEST_ASSERT_EQUAL_UINT32(5, runs_b);    // t = 0, 5, ..., 20 ms
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler_get_stats(&sched, a)->max_late_us);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler_get_stats(&sched, b)->max_late_us);
+    TEST_ASSERT_EQUAL_UINT32(20000, sched.idle_us);
+}
+
+// Each wait ends at the next deadline, however far below a tick it is
+static void test_wait_is_time_to_next_deadline(void) {
+    scheduler_add(&sched, "a", __job_a, NULL, 2000);
+    scheduler_add(&sched, "b", __job_b, NULL, 700);
+    scheduler_run(&sched);
+    TEST_ASSERT_EQUAL_UINT32(700, last_wait_us);
+    scheduler_run(&sched);
+    TEST_ASSERT_EQUAL_UINT32(700, last_wait_us);
+    scheduler_run(&sched);
+    TEST_ASSERT_EQUAL_UINT32(600, last_wait_us);   // a is due at 2000
+}
+
+static void test_one_shot_runs_once(void) {
+    int a = scheduler_add(&sched, "a", __job_a, NULL, 0);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, scheduler_run_pending(&sched));
+    scheduler_schedule_in(&sched, a, 300);
+    TEST_ASSERT_EQUAL_UINT32(300, scheduler_run_pending(&sched));
+    scheduler_run(&sched);
+    scheduler_run(&sched);
+    TEST_ASSERT_EQUAL_UINT32(1, runs_a);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, last_wait_us);
+}
+
+static void test_trigger_runs_at_once(void) {
+    int a = scheduler_add(&sched, "a", __job_a, NULL, 0);
+    scheduler_trigger(&sched, a);
+    fake_now += 40;
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, scheduler_run_pending(&sched));
+    TEST_ASSERT_EQUAL_UINT32(1, runs_a);
+    TEST_ASSERT_EQUAL_UINT32(40, scheduler_get_stats(&sched, a)->last_late_us);
+}
+
+// A run longer than the period skips the missed deadlines instead of bursting
+static void test_overrun_skips_missed_periods(void) {
+    int a = scheduler_add(&sched, "a", __job_a, NULL, 1000);
+    run_cost_us = 3500;
+    scheduler_run(&sched);
+    run_cost_us = 0;
+    TEST_ASSERT_EQUAL_UINT32(1, runs_a);
+    TEST_ASSERT_EQUAL_UINT32(0, waits);     // next one is due "now"
+    TEST_ASSERT_EQUAL_UINT32(1000, scheduler_run_pending(&sched));
+    TEST_ASSERT_EQUAL_UINT32(2, runs_a);
+    TEST_ASSERT_EQUAL_UINT32(3500, scheduler_get_stats(&sched, a)->max_run_us);
+}
+
+static void test_deadlines_survive_clock_wrap(void) {
+    fake_now = UINT32_MAX - 1500;
+    int a = scheduler_add(&sched, "a", __job_a, NULL, 1000);
+    for (int i = 0; i < 4; i++) {
+        scheduler_run(&sched);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, runs_a);
+    TEST_ASSERT_EQUAL_UINT32(4, waits);
+    TEST_ASSERT_EQUAL_UINT32(1000, last_wait_us);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler_get_stats(&sched, a)->max_late_us);
+}
+
+static void test_job_table_is_bounded(void) {
+    for (uint8_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        TEST_ASSERT_EQUAL_INT(i, scheduler_add(&sched, "j", __job_b, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, scheduler_add(&sched, "j", __job_b, NULL, 0));
+    TEST_ASSERT_NULL(scheduler_get_stats(&sched, SCHEDULER_MAX_JOBS));
+}
+
+// The default wait on the simulated board: sleeps to the microsecond
+static void test_default_wait_ends_at_deadline(void) {
+    scheduler_init(&sched, NULL);
+    int a = scheduler_add(&sched, "a", __job_b, NULL, 1700);
+    for (int i = 0; i < 5; i++) {
+        scheduler_run(&sched);
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, runs_b);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler_get_stats(&sched, a)->max_late_us);
+    TEST_ASSERT_EQUAL_UINT32(5 * 1700, sched.idle_us);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_periodic_jobs_run_on_time);
+    RUN_TEST(test_wait_is_time_to_next_deadline);
+    RUN_TEST(test_one_shot_runs_once);
+    RUN_TEST(test_trigger_runs_at_once);
+    RUN_TEST(test_overrun_skips_missed_periods);
+    RUN_TEST(test_deadlines_survive_clock_wrap);
+    RUN_TEST(test_job_table_is_bounded);
+    RUN_TEST(test_default_wait_ends_at_deadline);
+    return UNITY_END();
+}
@@ -0,0 +1,161 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "trace_replay.h"
+
+#define TRACE_BUFFER_SIZE   (16 * 1024)
+#define POLL_US             2000
+#define SETTLE_US           40000   // past the 20 ms debounce
+
+// Button 0 holds 'x', the encoder button taps 'y'
+static constexpr keymap_layer_t kLayers[] = {
+    {{keymap_hold('x'), keymap_tap('y')}, {}},
+};
+static constexpr keymap_t kKeymap = {kLayers, 1, NULL, 0, 0};
+static constexpr input_pipeline_map_t kMap = {
+    0, 1, 0,
+    {INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND,
+     INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND,
+     INPUT_PIPELINE_UNBOUND, INPUT_PIPELINE_UNBOUND},
+};
+static constexpr trace_replay_config_t kConfig = {&kKeymap, &kMap, BTN_1, RE_CW, RE_CCW, RE_BTN, POLL_US};
+
+static uint8_t trace_data[TRACE_BUFFER_SIZE];
+static size_t trace_len;
+static size_t trace_pos;
+static trace_recorder_t recorder;
+static trace_replay_t replay;
+
+static bool __buffer_sink(void* ctx, const uint8_t* data, size_t len) {
+    if (trace_len + len > sizeof(trace_data)) {
+        return false;
+    }
+    memcpy(trace_data + trace_len, data, len);
+    trace_len += len;
+    return true;
+}
+
+static size_t __buffer_read(void* ctx, uint8_t* data, size_t len) {
+    size_t n = trace_len - trace_pos;
+    if (n > len) n = len;
+    memcpy(data, trace_data + trace_pos, n);
+    trace_pos += n;
+    return n;
+}
+
+static void __edge(uint32_t t_us, uint8_t pin, uint8_t level) {
+    input_event_t event = {t_us, 0, pin, level, 0};
+    trace_record_edge(&recorder, &event);
+}
+
+static void __key(uint32_t t_us, uint8_t key, trace_key_action_t action) {
+    trace_record_key(&recorder, t_us, key, action);
+}
+
+// Idle levels at the start, as trace_start() records them
+static void __begin(void) {
+    trace_recorder_init(&recorder, __buffer_sink, NULL);
+    recorder.active = true;     // no writer task: stop() drains through the sink directly
+    trace_record_sync(&recorder, 0, BTN_1, LOW);
+    trace_record_sync(&recorder, 0, RE_BTN, HIGH);
+}
+
+static void __replay(trace_replay_result_t* result) {
+    trace_recorder_stop(&recorder);
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.stats.write_errors);
+    TEST_ASSERT_TRUE(trace_replay_run(&replay, &kConfig, __buffer_read, NULL, result));
+}
+
+// A press held for a while, then an encoder click, recorded as the live pipeline produced them
+static void __clean_session(void) {
+    __edge(10000, BTN_1, HIGH);
+    __key(10000 + 20000, 'x', TRACE_KEY_PRESS);
+    __edge(200000, BTN_1, LOW);
+    __key(200000 + 20000, 'x', TRACE_KEY_RELEASE);
+    __edge(300000, RE_BTN, LOW);
+    __edge(300000 + SETTLE_US, RE_BTN, HIGH);
+}
+
+void setUp(void) {
+    trace_len = 0;
+    trace_pos = 0;
+}
+
+void tearDown(void) {}
+
+static void test_matching_trace_replays_clean(void) {
+    __begin();
+    __clean_session();
+    __key(300000, 'y', TRACE_KEY_TAP);
+    trace_replay_result_t result;
+    __replay(&result);
+    TEST_ASSERT_EQUAL_UINT32(3, result.keys);
+    TEST_ASSERT_EQUAL_UINT32(0, result.mismatched);
+    TEST_ASSERT_EQUAL_UINT32(0, result.missing);
+    TEST_ASSERT_EQUAL_UINT32(0, result.extra);
+    TEST_ASSERT_EQUAL_UINT32(0, result.bad_chunks);
+    TEST_ASSERT_EQUAL_UINT32(7 + 2, result.records);
+    TEST_ASSERT_EQUAL_UINT32(300000 + SETTLE_US, result.span_us);
+}
+
+// Keys are paired in order, whichever side comes first
+static void test_wrong_missing_and_extra_keys_are_counted(void) {
+    __begin();
+    __clean_session();
+    __key(300000, 'z', TRACE_KEY_TAP);          // produced 'y'
+    __key(400000, 'q', TRACE_KEY_TAP);          // never produced
+    trace_replay_result_t result;
+    __replay(&result);
+    TEST_ASSERT_EQUAL_UINT32(4, result.keys);
+    TEST_ASSERT_EQUAL_UINT32(1, result.mismatched);
+    TEST_ASSERT_EQUAL_UINT32(1, result.missing);
+    TEST_ASSERT_EQUAL_UINT32(0, result.extra);
+
+    trace_len = 0;
+    trace_pos = 0;
+    __begin();
+    __clean_session();                          // the tap was not recorded
+    __replay(&result);
+    TEST_ASSERT_EQUAL_UINT32(2, result.keys);
+    TEST_ASSERT_EQUAL_UINT32(0, result.mismatched);
+    TEST_ASSERT_EQUAL_UINT32(1, result.extra);
+}
+
+// A button already down when recording started was never pressed in the
+// trace: the replay must not invent the press, and later presses still count
+static void test_sync_levels_seed_the_pipeline(void) {
+    trace_recorder_init(&recorder, __buffer_sink, NULL);
+    recorder.active = true;
+    trace_record_sync(&recorder, 0, BTN_1, HIGH);
+    trace_record_sync(&recorder, 0, RE_BTN, HIGH);
+    __edge(50000, BTN_1, LOW);
+    __edge(200000, BTN_1, HIGH);
+    __key(200000 + 20000, 'x', TRACE_KEY_PRESS);
+    __edge(200000 + SETTLE_US, RE_BTN, HIGH);
+    trace_replay_result_t result;
+    __replay(&result);
+    TEST_ASSERT_EQUAL_UINT32(1, result.keys);
+    TEST_ASSERT_EQUAL_UINT32(0, result.mismatched);
+    TEST_ASSERT_EQUAL_UINT32(0, result.missing);
+    TEST_ASSERT_EQUAL_UINT32(0, result.extra);
+}
+
+static void test_rejects_bad_keymap(void) {
+    static constexpr keymap_t kEmpty = {kLayers, 0, NULL, 0, 0};
+    trace_replay_config_t config = kConfig;
+    config.keymap = &kEmpty;
+    __begin();
+    trace_recorder_stop(&recorder);
+    trace_replay_result_t result;
+    TEST_ASSERT_FALSE(trace_replay_run(&replay, &config, __buffer_read, NULL, &result));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matching_trace_replays_clean);
+    RUN_TEST(test_wrong_missing_and_extra_keys_are_counted);
+    RUN_TEST(test_sync_levels_seed_the_pipeline);
+    RUN_TEST(test_rejects_bad_keymap);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "ws2812.h"
+
+#define TICK_NS     25      // 40 MHz peripheral clock
+#define PIXELS      8
+
+static ws2812_encoder_t enc;
+static led_rgb_t pixels[PIXELS];
+static ws2812_symbol_t frame[PIXELS * WS2812_SYMBOLS_PER_PIXEL + 1];
+static uint8_t grb[PIXELS * 3 + 3];
+
+static void __fill(uint8_t seed) {
+    for (uint8_t i = 0; i < PIXELS; i++) {
+        pixels[i].r = (uint8_t)(seed + i * 31);
+        pixels[i].g = (uint8_t)(seed ^ (i * 77));
+        pixels[i].b = (uint8_t)(255 - seed - i * 13);
+    }
+}
+
+static void __assert_pixel(const led_rgb_t* expected, uint16_t index) {
+    TEST_ASSERT_EQUAL_HEX8(expected->g, grb[index * 3 + 0]);
+    TEST_ASSERT_EQUAL_HEX8(expected->r, grb[index * 3 + 1]);
+    TEST_ASSERT_EQUAL_HEX8(expected->b, grb[index * 3 + 2]);
+}
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(ws2812_encoder_init(&enc, &WS2812_TIMING_DEFAULT, TICK_NS));
+    ws2812_frame_init(&enc, PIXELS, frame);
+    memset(grb, 0xA5, sizeof(grb));
+}
+
+void tearDown(void) {}
+
+// Bytes go out green, red, blue, MSB first, and decoding stops at the latch
+static void test_round_trip_is_grb(void) {
+    __fill(0x11);
+    pixels[0] = {0x80, 0x01, 0xFF};
+    ws2812_encode(&enc, pixels, 0, PIXELS, frame);
+    TEST_ASSERT_EQUAL_UINT32(PIXELS * 3, ws2812_decode(frame, sizeof(frame) / sizeof(frame[0]), grb, sizeof(grb)));
+    for (uint16_t i = 0; i < PIXELS; i++) {
+        __assert_pixel(&pixels[i], i);
+    }
+    TEST_ASSERT_EQUAL_HEX8(0xA5, grb[PIXELS * 3]);
+
+    // Green 0x01 is seven 0 bits then a 1: the first symbols carry the green MSB
+    TEST_ASSERT_EQUAL_HEX32(enc.nibble[0][0], frame[0]);
+    TEST_ASSERT_EQUAL_HEX32(enc.nibble[1][3], frame[7]);
+    TEST_ASSERT_EQUAL_HEX32(enc.nibble[8][0], frame[8]);
+}
+
+// Re-encoding a range leaves the other pixels' symbols and the latch in place
+static void test_partial_encode_touches_only_its_range(void) {
+    __fill(0x22);
+    ws2812_encode(&enc, pixels, 0, PIXELS, frame);
+    led_rgb_t before[PIXELS];
+    memcpy(before, pixels, sizeof(before));
+
+    __fill(0x99);
+    ws2812_encode(&enc, pixels, 2, 5, frame);
+    ws2812_encode(&enc, pixels, PIXELS - 1, PIXELS, frame);
+    TEST_ASSERT_EQUAL_UINT32(PIXELS * 3, ws2812_decode(frame, sizeof(frame) / sizeof(frame[0]), grb, sizeof(grb)));
+    for (uint16_t i = 0; i < PIXELS; i++) {
+        bool changed = (i >= 2 && i < 5) || i == PIXELS - 1;
+        __assert_pixel(changed ? &pixels[i] : &before[i], i);
+    }
+    TEST_ASSERT_EQUAL_HEX32(enc.latch, frame[PIXELS * WS2812_SYMBOLS_PER_PIXEL]);
+
+    ws2812_encode(&enc, pixels, 3, 3, frame);   // empty range
+    TEST_ASSERT_EQUAL_UINT32(PIXELS * 3, ws2812_decode(frame, sizeof(frame) / sizeof(frame[0]), grb, sizeof(grb)));
+    __assert_pixel(&pixels[3], 3);
+}
+
+// Bit halves are the timing in ticks; the latch is low for the reset time
+static void test_symbols_follow_the_timing(void) {
+    const ws2812_timing_t& t = WS2812_TIMING_DEFAULT;
+    TEST_ASSERT_EQUAL_HEX32(ws2812_symbol(t.t0h_ns / TICK_NS, true, t.t0l_ns / TICK_NS, false), enc.nibble[0][0]);
+    TEST_ASSERT_EQUAL_HEX32(ws2812_symbol(t.t1h_ns / TICK_NS, true, t.t1l_ns / TICK_NS, false), enc.nibble[15][3]);
+
+    ws2812_symbol_t latch = frame[PIXELS * WS2812_SYMBOLS_PER_PIXEL];
+    TEST_ASSERT_EQUAL_HEX32(enc.latch, latch);
+    TEST_ASSERT_EQUAL_HEX32(0, latch & 0x80008000u);
+    uint32_t low_ticks = (latch & WS2812_MAX_DURATION) + ((latch >> 16) & WS2812_MAX_DURATION);
+    TEST_ASSERT_GREATER_OR_EQUAL(t.reset_us * 1000u / TICK_NS, low_ticks);
+
+    // The latch alone decodes to nothing
+    TEST_ASSERT_EQUAL_UINT32(0, ws2812_decode(&latch, 1, grb, sizeof(grb)));
+}
+
+static void test_rejects_unrepresentable_timing(void) {
+    ws2812_encoder_t other;
+    TEST_ASSERT_FALSE(ws2812_encoder_init(&other, &WS2812_TIMING_DEFAULT, 1000));   // 400 ns rounds to 0
+    TEST_ASSERT_FALSE(ws2812_encoder_init(&other, &WS2812_TIMING_DEFAULT, 1));      // 300 us overflows the latch
+    TEST_ASSERT_FALSE(ws2812_encoder_init(&other, &WS2812_TIMING_DEFAULT, 0));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_is_grb);
+    RUN_TEST(test_partial_encode_touches_only_its_range);
+    RUN_TEST(test_symbols_follow_the_timing);
+    RUN_TEST(test_rejects_unrepresentable_timing);
+    return UNITY_END();
+}
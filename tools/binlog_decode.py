@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Decode raw binlog frames (see include/binlog.h) into readable text.
+
+Usage:
+    binlog_decode.py [capture.bin]             # decode a capture file
+    pio device monitor --raw | binlog_decode.py  # decode live from stdin
+    binlog_decode.py --timestamps capture.bin    # prefix each record with its time
+
+Bytes outside valid frames (boot messages, console replies) are passed
+through unchanged, so raw mode can be switched on at any time with the
+"log raw" console command.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+MAX_ARGS = 8
+CATALOG = os.path.join(os.path.dirname(__file__), "..", "include", "binlog_messages.h")
+SPEC = re.compile(r"%(%|[-+ #0]*\d*(?:\.\d+)?[lhz]*([diuxXocfeg]))")
+
+
+def load_catalog(path):
+    formats = []
+    pattern = re.compile(r'^BINLOG_MESSAGE\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            match = pattern.match(line.strip())
+            if match:
+                formats.append(match.group(2).encode().decode("unicode_escape"))
+    return formats
+
+
+def format_record(fmt, args):
+    values = iter(args)
+
+    def convert(match):
+        if match.group(1) == "%":
+            return "%"
+        conversion = match.group(2)
+        spec = re.sub(r"[lhz]", "", match.group(0))
+        raw = next(values, 0)
+        if conversion in "di":
+            value = struct.unpack("<i", struct.pack("<I", raw))[0]
+        elif conversion in "feg":
+            value = struct.unpack("<f", struct.pack("<I", raw))[0]
+        else:
+            value = raw
+        return spec % value
+
+    return SPEC.sub(convert, fmt)
+
+
+def decode(data, formats, timestamps):
+    out = []
+    i = 0
+    while i < len(data):
+        if data[i] == FRAME_SYNC and i + 7 < len(data):
+            msg_id, argc = data[i + 1], data[i + 2]
+            end = i + 7 + 4 * argc
+            if msg_id < len(formats) and argc <= MAX_ARGS and end < len(data):
+                if sum(data[i + 1:end]) & 0xFF == data[end]:
+                    timestamp = struct.unpack_from("<I", data, i + 3)[0]
+                    args = struct.unpack_from("<%dI" % argc, data, i + 7)
+                    text = format_record(formats[msg_id], args)
+                    if timestamps:
+                        text = "[%10.6f] %s" % (timestamp / 1e6, text)
+                    out.append(text)
+                    i = end + 1
+                    continue
+        out.append(chr(data[i]))
+        i += 1
+    return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="raw capture (default: stdin)")
+    parser.add_argument("--catalog", default=CATALOG, help="path to binlog_messages.h")
+    parser.add_argument("--timestamps", action="store_true", help="prefix records with device time")
+    args = parser.parse_args()
+
+    formats = load_catalog(args.catalog)
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    sys.stdout.write(decode(data, formats, args.timestamps))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Compile the dashboard in data/ into src/web_assets_data.cpp.
+
+Usage:
+    embed_assets.py                 # regenerate (also runs before every pio build)
+    embed_assets.py --check         # exit 1 if the generated file is stale
+    embed_assets.py --report        # print per-asset sizes
+
+Each file is minified (whitespace and comments only, never renaming),
+gzipped deterministically and hashed; the first 16 hex digits of the
+SHA-256 of the minified bytes become its ETag. index.html is rewritten
+to reference the other assets as "name?v=<hash>" so they can be cached
+for a year, while index.html itself is revalidated with If-None-Match.
+Output is only rewritten when it changes, so builds stay incremental.
+
+Listed in platformio.ini as "pre:tools/embed_assets.py"; it then runs
+inside PlatformIO's SCons environment with the project directory taken
+from there.
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+OUTPUT = os.path.join("src", "web_assets_data.cpp")
+INDEX = "index.html"
+
+
+def minify(name, text):
+    ext = os.path.splitext(name)[1]
+    if ext == ".css":
+        text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+        text = re.sub(r"\s+", " ", text)
+        return re.sub(r"\s*([{};:,>])\s*", r"\1", text).replace(";}", "}").strip()
+    if ext == ".js":
+        # Line structure is kept so automatic semicolon insertion is unaffected
+        lines = (line.strip() for line in text.splitlines())
+        return "\n".join(line for line in lines if line and not line.startswith("//"))
+    if ext == ".html":
+        text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+        lines = (line.strip() for line in text.splitlines())
+        return "\n".join(line for line in lines if line)
+    return None
+
+
+def load_assets(data_dir):
+    assets = []
+    for name in sorted(os.listdir(data_dir)):
+        path = os.path.join(data_dir, name)
+        if not os.path.isfile(path) or name.startswith("."):
+            continue
+        with open(path, "rb") as f:
+            raw = f.read()
+        text = minify(name, raw.decode("utf-8")) if name.endswith((".css", ".js", ".html")) else None
+        body = text.encode("utf-8") if text is not None else raw
+        assets.append({"name": name, "raw_size": len(raw), "body": body})
+
+    # Versioned references first, so index.html's own hash covers them
+    for asset in assets:
+        asset["etag"] = hashlib.sha256(asset["body"]).hexdigest()[:16]
+    for asset in assets:
+        if asset["name"] != INDEX:
+            continue
+        html = asset["body"].decode("utf-8")
+        for other in assets:
+            if other is asset:
+                continue
+            pattern = r'((?:href|src)=")' + re.escape(other["name"]) + '"'
+            html = re.sub(pattern, r'\g<1>' + other["name"] + "?v=" + other["etag"] + '"', html)
+        asset["body"] = html.encode("utf-8")
+        asset["etag"] = hashlib.sha256(asset["body"]).hexdigest()[:16]
+
+    for asset in assets:
+        packed = gzip.compress(asset["body"], compresslevel=9, mtime=0)
+        asset["gzip"] = len(packed) < len(asset["body"])
+        asset["data"] = packed if asset["gzip"] else asset["body"]
+    return assets
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def render(assets):
+    out = [
+        "// Generated by tools/embed_assets.py from data/ -- do not edit.",
+        "#include \"web_assets.h\"",
+        "",
+    ]
+    for i, asset in enumerate(assets):
+        out.append(f"// {asset['name']}: {asset['raw_size']} bytes, {len(asset['body'])} minified, "
+                   f"{len(asset['data'])} {'gzipped' if asset['gzip'] else 'stored'}")
+        out.append(f"static constexpr uint8_t kAsset{i}[] = {{")
+        out.append(c_bytes(asset["data"]))
+        out.append("};")
+        out.append("")
+    out.append("const web_asset_t web_assets[] = {")
+    for i, asset in enumerate(assets):
+        content_type = CONTENT_TYPES.get(os.path.splitext(asset["name"])[1], "application/octet-stream")
+        out.append(f"    {{\"/{asset['name']}\", \"{content_type}\", \"\\\"{asset['etag']}\\\"\", "
+                   f"kAsset{i}, sizeof(kAsset{i}), {asset['raw_size']}, {'true' if asset['gzip'] else 'false'}}},")
+    out.append("};")
+    out.append("")
+    out.append("const size_t web_asset_count = sizeof(web_assets) / sizeof(web_assets[0]);")
+    out.append("")
+    return "\n".join(out)
+
+
+def generate(project_dir, check=False, report=False):
+    assets = load_assets(os.path.join(project_dir, "data"))
+    text = render(assets)
+    path = os.path.join(project_dir, OUTPUT)
+    current = None
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            current = f.read()
+
+    if report:
+        for asset in assets:
+            print(f"{asset['name']:<16} {asset['raw_size']:>7} raw {len(asset['body']):>7} min "
+                  f"{len(asset['data']):>7} flash  etag {asset['etag']}")
+        print(f"{'total':<16} {sum(a['raw_size'] for a in assets):>7} raw "
+              f"{sum(len(a['body']) for a in assets):>7} min {sum(len(a['data']) for a in assets):>7} flash")
+    if check:
+        if current != text:
+            print(f"{OUTPUT} is stale; run tools/embed_assets.py", file=sys.stderr)
+            return 1
+        return 0
+    if current != text:
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(text)
+        print(f"embed_assets: wrote {OUTPUT} ({len(assets)} assets)")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="fail if the generated file is stale")
+    parser.add_argument("--report", action="store_true", help="print per-asset sizes")
+    args = parser.parse_args()
+    return generate(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."), args.check, args.report)
+
+
+try:
+    Import("env")  # noqa: F821 -- defined when PlatformIO runs this as an extra script
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main())
+else:
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
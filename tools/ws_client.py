@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Loopback client for the telemetry WebSocket (see include/web_server.h).
+
+Usage:
+    .pio/build/native/program --ms=0 --realtime &
+    ws_client.py --port 8080 --rate 100 --seconds 5     # measure the stream
+    ws_client.py --port 8080 --stall 3                  # stop reading for 3 s
+    ws_client.py --port 8080 --get /                    # fetch a dashboard asset
+    ws_client.py --port 8080 --get / --etag '"<hash>"'  # expect 304 Not Modified
+
+Prints every status frame with --verbose, then a summary: frames per
+second, key events and skipped snapshots (sequence numbers the server
+coalesced away or dropped because this client fell behind). --stall stops reading after
+the handshake so the server's send queue fills, then drains the socket
+and checks that the stream resumes with fresh, well-formed frames.
+Exits 1 if no status frame arrived or a frame was malformed.
+"""
+
+import argparse
+import base64
+import gzip
+import os
+import socket
+import struct
+import sys
+import time
+
+KIND_STATUS = 1
+KIND_KEY = 2
+STATUS = struct.Struct("<BBHIi3h3h3hh3HH")
+KEY = struct.Struct("<BBBxI")
+ACTIONS = ("press", "release", "tap")
+
+
+def http_get(host, port, path, etag=None):
+    request = f"GET {path} HTTP/1.1\r\nHost: {host}\r\nAccept-Encoding: gzip\r\n"
+    if etag:
+        request += f"If-None-Match: {etag}\r\n"
+    with socket.create_connection((host, port), timeout=5) as sock:
+        sock.sendall((request + "\r\n").encode())
+        data = b""
+        while True:
+            chunk = sock.recv(4096)
+            if not chunk:
+                break
+            data += chunk
+    head, _, body = data.partition(b"\r\n\r\n")
+    print(head.decode(errors="replace"))
+    if b"\r\ncontent-encoding: gzip" in head.lower():
+        print(f"({len(body)} body bytes, {len(gzip.decompress(body))} decompressed)")
+    else:
+        print(f"({len(body)} body bytes)")
+    return 0 if head.startswith((b"HTTP/1.1 200", b"HTTP/1.1 304")) else 1
+
+
+def handshake(host, port, rcvbuf=None):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    if rcvbuf:
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, rcvbuf)
+    sock.settimeout(5)
+    sock.connect((host, port))
+    key = base64.b64encode(os.urandom(16)).decode()
+    sock.sendall((f"GET /ws HTTP/1.1\r\nHost: {host}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n").encode())
+    head = b""
+    while b"\r\n\r\n" not in head:
+        chunk = sock.recv(1)
+        if not chunk:
+            raise ConnectionError("closed during handshake")
+        head += chunk
+    if not head.startswith(b"HTTP/1.1 101"):
+        raise ConnectionError(head.decode(errors="replace"))
+    return sock
+
+
+def send_text(sock, text):
+    payload = text.encode()
+    mask = os.urandom(4)
+    masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+    sock.sendall(bytes([0x81, 0x80 | len(payload)]) + mask + masked)
+
+
+class Reader:
+    def __init__(self, sock):
+        self.sock = sock
+        self.buf = b""
+
+    def frame(self):
+        while True:
+            if len(self.buf) >= 2:
+                length = self.buf[1] & 0x7F
+                header = 2
+                if length == 126:
+                    header = 4
+                    if len(self.buf) >= 4:
+                        length = struct.unpack(">H", self.buf[2:4])[0]
+                if len(self.buf) >= header and len(self.buf) >= header + length:
+                    opcode = self.buf[0] & 0x0F
+                    payload = self.buf[header:header + length]
+                    self.buf = self.buf[header + length:]
+                    return opcode, payload
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("closed")
+            self.buf += chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--rate", type=int, help="request a status rate in Hz")
+    parser.add_argument("--seconds", type=float, default=3.0, help="how long to listen")
+    parser.add_argument("--stall", type=float, default=0.0, help="stop reading for this long first")
+    parser.add_argument("--get", metavar="PATH", help="fetch PATH over plain HTTP and exit")
+    parser.add_argument("--etag", help="send If-None-Match with --get")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    if args.get:
+        return http_get(args.host, args.port, args.get, args.etag)
+
+    # A small receive window makes a stall reach the server's queue quickly
+    sock = handshake(args.host, args.port, 1024 if args.stall > 0 else None)
+    if args.rate:
+        send_text(sock, f"rate {args.rate}")
+    send_text(sock, "getReadings")
+    if args.stall > 0:
+        time.sleep(args.stall)
+
+    reader = Reader(sock)
+    statuses = keys = skipped = bad = 0
+    last_seq = None
+    start = time.monotonic()
+    while time.monotonic() - start < args.seconds:
+        opcode, payload = reader.frame()
+        if opcode != 0x2 or not payload:
+            continue
+        if payload[0] == KIND_STATUS and len(payload) == STATUS.size:
+            (_, flags, seq, t_ms, enc, ax, ay, az, gx, gy, gz, roll, pitch, yaw, temp,
+             late, max_late, max_run, hid_sent) = STATUS.unpack(payload)
+            if last_seq is not None:
+                skipped += (seq - last_seq - 1) & 0xFFFF
+            last_seq = seq
+            statuses += 1
+            if args.verbose:
+                print(f"#{seq} t={t_ms}ms enc={enc} gate={flags & 1} btn={flags >> 1 & 1} ble={flags >> 2 & 1} "
+                      f"acc=({ax / 1000:.3f},{ay / 1000:.3f},{az / 1000:.3f})g "
+                      f"rpy=({roll / 100:.1f},{pitch / 100:.1f},{yaw / 100:.1f}) "
+                      f"late={late}/{max_late}us run={max_run}us hid={hid_sent}")
+        elif payload[0] == KIND_KEY and len(payload) == KEY.size:
+            _, action, key, t_ms = KEY.unpack(payload)
+            keys += 1
+            if args.verbose:
+                print(f"key {ACTIONS[action] if action < len(ACTIONS) else action} {key!r} t={t_ms}ms")
+        else:
+            bad += 1
+    elapsed = time.monotonic() - start
+    sock.close()
+
+    print(f"status frames: {statuses} ({statuses / elapsed:.1f}/s), key events: {keys}, "
+          f"skipped snapshots: {skipped}, malformed: {bad}")
+    return 0 if statuses > 0 and bad == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())